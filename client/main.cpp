@@ -2,6 +2,7 @@
 
 int main()
 {
-  auto api = vulkan::VulkanApi::createApi();
+  auto api = vulkan::VulkanApi::createApi({.mainWindowInfo = {.renderThread = true}});
+  api->run();
   return 0;
 }
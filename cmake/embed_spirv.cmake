@@ -0,0 +1,41 @@
+# =============================
+# Embed SPIR-V
+# =============================
+# Writes a SPIR-V binary as a constexpr std::array<uint32_t, N> header, run as
+# cmake -DINPUT=<spv> -DOUTPUT=<hpp> -DNAME=<identifier> -DSOURCE=<shader name> -P embed_spirv.cmake
+
+file(READ "${INPUT}" SPIRV_HEX HEX)
+string(LENGTH "${SPIRV_HEX}" SPIRV_LENGTH)
+math(EXPR SPIRV_REMAINDER "${SPIRV_LENGTH} % 8")
+if(SPIRV_LENGTH EQUAL 0 OR NOT SPIRV_REMAINDER EQUAL 0)
+  message(FATAL_ERROR "${INPUT} is not a SPIR-V binary, size is not a multiple of 4")
+endif()
+string(SUBSTRING "${SPIRV_HEX}" 0 8 SPIRV_MAGIC)
+if(NOT SPIRV_MAGIC STREQUAL "03022307")
+  message(FATAL_ERROR "${INPUT} is not a SPIR-V binary, magic number is missing")
+endif()
+math(EXPR SPIRV_WORDS "${SPIRV_LENGTH} / 8")
+
+# SPIR-V words are stored little endian, each one is written byte swapped as a single literal
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " SPIRV_ARRAY "${SPIRV_HEX}")
+string(REGEX REPLACE "(0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, 0x[0-9a-f]+, )"
+  "\\1\n    " SPIRV_ARRAY "${SPIRV_ARRAY}")
+string(REGEX REPLACE "[ ,\n]+$" "" SPIRV_ARRAY "${SPIRV_ARRAY}")
+string(REGEX REPLACE " \n" "\n" SPIRV_ARRAY "${SPIRV_ARRAY}")
+string(TOUPPER "${NAME}" SPIRV_GUARD)
+
+file(WRITE "${OUTPUT}" "// Generated from ${SOURCE} at build time, do not edit
+#ifndef LIB_VULKAN_SHADERS_${SPIRV_GUARD}
+#define LIB_VULKAN_SHADERS_${SPIRV_GUARD}
+
+#include <array>
+#include <cstdint>
+
+namespace vulkan::shaders {
+inline constexpr std::array<uint32_t, ${SPIRV_WORDS}> ${NAME} = {
+    ${SPIRV_ARRAY},
+};
+}  // namespace vulkan::shaders
+
+#endif /* LIB_VULKAN_SHADERS_${SPIRV_GUARD} */
+")
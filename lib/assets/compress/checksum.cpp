@@ -0,0 +1,91 @@
+#include "checksum.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace assets {
+static constexpr uint64_t prime1 = 0x9E37'79B1'85EB'CA87ULL;
+static constexpr uint64_t prime2 = 0xC2B2'AE3D'27D4'EB4FULL;
+static constexpr uint64_t prime3 = 0x1656'67B1'9E37'79F9ULL;
+static constexpr uint64_t prime4 = 0x85EB'CA77'C2B2'AE63ULL;
+static constexpr uint64_t prime5 = 0x27D4'EB2F'1656'67C5ULL;
+
+static uint64_t read64(const std::byte* data)
+{
+  uint64_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static uint32_t read32(const std::byte* data)
+{
+  uint32_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static uint64_t round(uint64_t accumulator, uint64_t input)
+{
+  accumulator += input * prime2;
+  return std::rotl(accumulator, 31) * prime1;
+}
+
+static uint64_t merge(uint64_t hash, uint64_t accumulator)
+{
+  hash ^= round(0, accumulator);
+  return (hash * prime1) + prime4;
+}
+
+uint64_t checksum(std::span<const std::byte> data, uint64_t seed)
+{
+  const std::byte* cursor = data.data();
+  const std::byte* const end = cursor + data.size();
+  uint64_t hash = 0;
+
+  if (data.size() >= 32) {
+    uint64_t lane1 = seed + prime1 + prime2;
+    uint64_t lane2 = seed + prime2;
+    uint64_t lane3 = seed;
+    uint64_t lane4 = seed - prime1;
+    for (; end - cursor >= 32; cursor += 32) {
+      lane1 = round(lane1, read64(cursor));
+      lane2 = round(lane2, read64(cursor + 8));
+      lane3 = round(lane3, read64(cursor + 16));
+      lane4 = round(lane4, read64(cursor + 24));
+    }
+    hash = std::rotl(lane1, 1) + std::rotl(lane2, 7) + std::rotl(lane3, 12) + std::rotl(lane4, 18);
+    hash = merge(hash, lane1);
+    hash = merge(hash, lane2);
+    hash = merge(hash, lane3);
+    hash = merge(hash, lane4);
+  }
+  else {
+    hash = seed + prime5;
+  }
+  hash += data.size();
+
+  for (; end - cursor >= 8; cursor += 8) {
+    hash ^= round(0, read64(cursor));
+    hash = (std::rotl(hash, 27) * prime1) + prime4;
+  }
+  if (end - cursor >= 4) {
+    hash ^= read32(cursor) * prime1;
+    hash = (std::rotl(hash, 23) * prime2) + prime3;
+    cursor += 4;
+  }
+  for (; cursor != end; ++cursor) {
+    hash ^= static_cast<uint64_t>(*cursor) * prime5;
+    hash = std::rotl(hash, 11) * prime1;
+  }
+
+  hash ^= hash >> 33U;
+  hash *= prime2;
+  hash ^= hash >> 29U;
+  hash *= prime3;
+  hash ^= hash >> 32U;
+  return hash;
+}
+}  // namespace assets
@@ -0,0 +1,13 @@
+#ifndef LIB_ASSETS_COMPRESS_CHECKSUM
+#define LIB_ASSETS_COMPRESS_CHECKSUM
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace assets {
+// XXH64, 32 bytes per step where FNV-1a takes one, fast enough to check chunks while they are copied
+[[nodiscard]] uint64_t checksum(std::span<const std::byte> data, uint64_t seed = 0);
+}  // namespace assets
+
+#endif /* LIB_ASSETS_COMPRESS_CHECKSUM */
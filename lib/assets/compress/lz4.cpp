@@ -0,0 +1,174 @@
+#include "lz4.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace assets {
+static constexpr uint32_t hashBits = 12;
+static constexpr size_t minMatch = 4;
+static constexpr size_t maxOffset = 65'535;
+// The format ends every block with at least 5 literals, and the last match starts 12 bytes before the end
+static constexpr size_t lastLiterals = 5;
+static constexpr size_t matchLimit = 12;
+// Literal runs without matches make the search skip ahead faster, as the reference encoder does
+static constexpr uint32_t skipStrength = 6;
+// Short literal runs and matches are copied as fixed 16 byte blocks when the buffers have room past them, bytes beyond
+// the run are overwritten by the next sequence
+static constexpr size_t wildCopy = 16;
+
+static uint32_t read32(const std::byte* data)
+{
+  uint32_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static uint32_t hashOf(uint32_t sequence)
+{
+  return (sequence * 2'654'435'761U) >> (32 - hashBits);
+}
+
+// 15 in the token nibble, then 255 per byte until the rest fits
+static void writeLength(std::vector<std::byte>& out, size_t length)
+{
+  for (; length >= 255; length -= 255) {
+    out.push_back(std::byte{255});
+  }
+  out.push_back(static_cast<std::byte>(length));
+}
+
+static void writeSequence(std::vector<std::byte>& out, std::span<const std::byte> literals, size_t offset, size_t matchLength)
+{
+  const size_t literalNibble = std::min<size_t>(literals.size(), 15);
+  const size_t matchNibble = matchLength == 0 ? 0 : std::min<size_t>(matchLength - minMatch, 15);
+  out.push_back(static_cast<std::byte>((literalNibble << 4U) | matchNibble));
+  if (literalNibble == 15) {
+    writeLength(out, literals.size() - 15);
+  }
+  out.insert(out.end(), literals.begin(), literals.end());
+  if (matchLength == 0) {
+    return;
+  }
+  out.push_back(static_cast<std::byte>(offset & 0xFFU));
+  out.push_back(static_cast<std::byte>(offset >> 8U));
+  if (matchNibble == 15) {
+    writeLength(out, matchLength - minMatch - 15);
+  }
+}
+
+std::vector<std::byte> compressLz4(std::span<const std::byte> data)
+{
+  std::vector<std::byte> out;
+  out.reserve(data.size() + (data.size() / 255) + 16);
+  size_t anchor = 0;
+  if (data.size() > matchLimit) {
+    // Positions + 1, 0 is an empty slot
+    std::array<uint32_t, size_t{1} << hashBits> table{};
+    const size_t searchEnd = data.size() - matchLimit;
+    const size_t matchEnd = data.size() - lastLiterals;
+    size_t position = 0;
+    while (position < searchEnd) {
+      const uint32_t sequence = read32(&data[position]);
+      uint32_t& slot = table[hashOf(sequence)];
+      const size_t candidate = slot;
+      slot = static_cast<uint32_t>(position + 1);
+      if (candidate == 0 || position - (candidate - 1) > maxOffset || read32(&data[candidate - 1]) != sequence) {
+        position += 1 + ((position - anchor) >> skipStrength);
+        continue;
+      }
+
+      const size_t match = candidate - 1;
+      size_t length = minMatch;
+      while (position + length < matchEnd && data[match + length] == data[position + length]) {
+        ++length;
+      }
+      writeSequence(out, data.subspan(anchor, position - anchor), position - match, length);
+      position += length;
+      anchor = position;
+    }
+  }
+  writeSequence(out, data.subspan(anchor), 0, 0);
+  return out;
+}
+
+// 15 in the token nibble is followed by bytes added on until one is below 255
+static size_t readLength(std::span<const std::byte> in, size_t& cursor, size_t length)
+{
+  if (length != 15) {
+    return length;
+  }
+  uint8_t next = 255;
+  while (next == 255) {
+    if (cursor >= in.size()) {
+      throw std::runtime_error("LZ4 length runs past the end of the block");
+    }
+    next = static_cast<uint8_t>(in[cursor++]);
+    length += next;
+  }
+  return length;
+}
+
+void decompressLz4(std::span<const std::byte> compressed, std::span<std::byte> out)
+{
+  size_t in = 0;
+  size_t written = 0;
+  while (true) {
+    if (in >= compressed.size()) {
+      throw std::runtime_error("LZ4 block ends without its last literals");
+    }
+    const auto token = static_cast<uint8_t>(compressed[in++]);
+    const size_t literals = readLength(compressed, in, token >> 4U);
+    if (literals > compressed.size() - in || literals > out.size() - written) {
+      throw std::runtime_error(std::format("LZ4 literals of {} bytes overflow the block", literals));
+    }
+    if (literals <= wildCopy && compressed.size() - in >= wildCopy && out.size() - written >= wildCopy) {
+      std::memcpy(out.data() + written, compressed.data() + in, wildCopy);
+    }
+    else {
+      std::memcpy(out.data() + written, compressed.data() + in, literals);
+    }
+    in += literals;
+    written += literals;
+    if (in == compressed.size()) {
+      break;
+    }
+
+    if (compressed.size() - in < 2) {
+      throw std::runtime_error("LZ4 match offset is cut off");
+    }
+    const size_t offset = static_cast<size_t>(compressed[in]) | (static_cast<size_t>(compressed[in + 1]) << 8U);
+    in += 2;
+    const size_t length = readLength(compressed, in, token & 0xFU) + minMatch;
+    if (offset == 0 || offset > written || length > out.size() - written) {
+      throw std::runtime_error(std::format("LZ4 match of {} bytes at offset {} is outside of the output", length, offset));
+    }
+    std::byte* target = out.data() + written;
+    const std::byte* source = target - offset;
+    if (offset >= wildCopy && length <= 2 * wildCopy && out.size() - written >= 2 * wildCopy) {
+      std::memcpy(target, source, wildCopy);
+      std::memcpy(target + wildCopy, source + wildCopy, wildCopy);
+    }
+    else if (offset >= length) {
+      std::memcpy(target, source, length);
+    }
+    else {
+      // Overlapping matches repeat the last offset bytes, whole periods are copied doubling each time
+      std::memcpy(target, source, offset);
+      for (size_t copied = offset; copied < length; copied *= 2) {
+        std::memcpy(target + copied, target, std::min(copied, length - copied));
+      }
+    }
+    written += length;
+  }
+  if (written != out.size()) {
+    throw std::runtime_error(std::format("LZ4 block decodes to {} bytes, expected {}", written, out.size()));
+  }
+}
+}  // namespace assets
@@ -0,0 +1,16 @@
+#ifndef LIB_ASSETS_COMPRESS_LZ4
+#define LIB_ASSETS_COMPRESS_LZ4
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace assets {
+// LZ4 block format (no frame), readable by any LZ4 decoder. Greedy matching over a 4k entry hash table, about the
+// ratio of LZ4 level 1
+[[nodiscard]] std::vector<std::byte> compressLz4(std::span<const std::byte> data);
+// Decodes into out without allocating, throws on malformed input or when the result does not fill out exactly
+void decompressLz4(std::span<const std::byte> compressed, std::span<std::byte> out);
+}  // namespace assets
+
+#endif /* LIB_ASSETS_COMPRESS_LZ4 */
@@ -0,0 +1,186 @@
+#include "archive.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "compress/checksum.hpp"
+#include "compress/lz4.hpp"
+#include "format.hpp"
+
+namespace assets {
+template <typename T>
+static T readAt(std::span<const std::byte> file, size_t offset)
+{
+  T value{};
+  std::memcpy(&value, file.subspan(offset, sizeof(T)).data(), sizeof(T));
+  return value;
+}
+
+static std::string_view view(std::span<const std::byte> bytes)
+{
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+Archive::Archive(const std::filesystem::path& path) : _file(path)
+{
+  const std::span<const std::byte> file = _file.get();
+  if (file.size() < sizeof(Header)) {
+    throw std::runtime_error(std::format("{} is too small for an asset container", path.string()));
+  }
+  _header = readAt<Header>(file, 0);
+  if (_header.magic != fileMagic) {
+    throw std::runtime_error(std::format("{} is not an asset container", path.string()));
+  }
+  if (_header.version != fileVersion) {
+    throw std::runtime_error(std::format("{} has container version {}, expected {}", path.string(), _header.version, fileVersion));
+  }
+  const uint64_t tocSize = (uint64_t{_header.chunkCount} * sizeof(ChunkEntry)) + (uint64_t{_header.levelCount} * sizeof(MipRegion)) +
+                           _header.nameBytes;
+  if (_header.fileSize != file.size() || _header.tocSize != tocSize || sizeof(Header) + tocSize > file.size() || _header.alignment == 0) {
+    throw std::runtime_error(std::format("{} is truncated or its header is corrupted", path.string()));
+  }
+  if (checksum(file.subspan(sizeof(Header), tocSize)) != _header.tocChecksum) {
+    throw std::runtime_error(std::format("{} has a corrupted table of contents", path.string()));
+  }
+  for (uint32_t index = 0; index < _header.chunkCount; ++index) {
+    const ChunkEntry entry = getChunk(index);
+    check(entry, index);
+    _rawSize += entry.rawSize;
+  }
+}
+
+uint32_t Archive::getChunkCount() const
+{
+  return _header.chunkCount;
+}
+
+ChunkEntry Archive::getChunk(uint32_t index) const
+{
+  if (index >= _header.chunkCount) {
+    throw std::runtime_error(std::format("Chunk {} of {} does not exist", index, _header.chunkCount));
+  }
+  return readAt<ChunkEntry>(_file.get(), sizeof(Header) + (size_t{index} * sizeof(ChunkEntry)));
+}
+
+std::optional<ChunkEntry> Archive::find(std::string_view name) const
+{
+  const uint64_t hash = checksum(std::as_bytes(std::span(name)));
+  uint32_t first = 0;
+  uint32_t count = _header.chunkCount;
+  while (count > 0) {
+    const uint32_t half = count / 2;
+    if (getChunk(first + half).nameHash < hash) {
+      first += half + 1;
+      count -= half + 1;
+    }
+    else {
+      count = half;
+    }
+  }
+  for (uint32_t index = first; index < _header.chunkCount; ++index) {
+    const ChunkEntry entry = getChunk(index);
+    if (entry.nameHash != hash) {
+      break;
+    }
+    if (getName(entry) == name) {
+      return entry;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string_view Archive::getName(const ChunkEntry& entry) const
+{
+  return view(_file.get().subspan(namesOffset() + entry.nameOffset, entry.nameSize));
+}
+
+MipRegion Archive::getLevel(const TextureInfo& texture, uint32_t level) const
+{
+  if (level >= texture.levelCount) {
+    throw std::runtime_error(std::format("Level {} of a texture with {} levels", level, texture.levelCount));
+  }
+  return readAt<MipRegion>(_file.get(), levelsOffset() + (size_t{texture.firstLevel + level} * sizeof(MipRegion)));
+}
+
+std::span<const std::byte> Archive::getStored(const ChunkEntry& entry) const
+{
+  return _file.get().subspan(entry.offset, entry.size);
+}
+
+void Archive::read(const ChunkEntry& entry, std::span<std::byte> out) const
+{
+  if (out.size() != entry.rawSize) {
+    throw std::runtime_error(std::format("Chunk {} has {} bytes, the target {}", getName(entry), entry.rawSize, out.size()));
+  }
+  const std::span<const std::byte> stored = getStored(entry);
+  switch (entry.compression) {
+  case Compression::none: std::memcpy(out.data(), stored.data(), stored.size()); break;
+  case Compression::lz4: decompressLz4(stored, out); break;
+  }
+}
+
+bool Archive::verify(const ChunkEntry& entry) const
+{
+  return checksum(getStored(entry)) == entry.checksum;
+}
+
+const Header& Archive::getHeader() const
+{
+  return _header;
+}
+
+uint64_t Archive::getRawSize() const
+{
+  return _rawSize;
+}
+
+size_t Archive::levelsOffset() const
+{
+  return sizeof(Header) + (size_t{_header.chunkCount} * sizeof(ChunkEntry));
+}
+
+size_t Archive::namesOffset() const
+{
+  return levelsOffset() + (size_t{_header.levelCount} * sizeof(MipRegion));
+}
+
+// Everything later calls rely on, so a damaged table throws here and not while streaming
+void Archive::check(const ChunkEntry& entry, uint32_t index) const
+{
+  const uint64_t dataStart = sizeof(Header) + _header.tocSize;
+  const bool inFile = entry.offset >= dataStart && entry.offset <= _header.fileSize && entry.size <= _header.fileSize - entry.offset &&
+                      entry.offset % _header.alignment == 0;
+  const bool named = uint64_t{entry.nameOffset} + entry.nameSize <= _header.nameBytes;
+  const bool packed = (entry.compression == Compression::none && entry.rawSize == entry.size) || entry.compression == Compression::lz4;
+  bool typed = false;
+  switch (entry.type) {
+  case ChunkType::mesh: {
+    const auto mesh = info<MeshInfo>(entry);
+    typed = uint64_t{mesh.vertexCount} * mesh.vertexStride <= mesh.indexOffset &&
+            mesh.indexOffset + (uint64_t{mesh.indexCount} * sizeof(uint32_t)) <= entry.rawSize;
+    break;
+  }
+  case ChunkType::texture: {
+    const auto texture = info<TextureInfo>(entry);
+    typed = uint64_t{texture.firstLevel} + texture.levelCount <= _header.levelCount;
+    for (uint32_t level = 0; typed && level < texture.levelCount; ++level) {
+      const MipRegion region = getLevel(texture, level);
+      typed = region.offset <= entry.rawSize && region.size <= entry.rawSize - region.offset;
+    }
+    break;
+  }
+  case ChunkType::shader: typed = entry.compression == Compression::none && entry.size % sizeof(uint32_t) == 0; break;
+  case ChunkType::blob: typed = true; break;
+  }
+  if (!inFile || !named || !packed || !typed) {
+    throw std::runtime_error(std::format("Chunk {} of the container is corrupted", index));
+  }
+}
+}  // namespace assets
@@ -0,0 +1,56 @@
+#ifndef LIB_ASSETS_CONTAINER_ARCHIVE
+#define LIB_ASSETS_CONTAINER_ARCHIVE
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "format.hpp"
+#include "mapped_file.hpp"
+
+namespace assets {
+// Memory mapped container. Opening checks the header and the table of contents, entries, levels and names are read
+// from the mapping on every call and nothing is allocated after the open. Chunk data is checked only by verify.
+// Thread safe, all members are const
+class Archive {
+public:
+  Archive(const Archive&) = delete;
+  Archive(Archive&&) = delete;
+  Archive& operator=(const Archive&) = delete;
+  Archive& operator=(Archive&&) = delete;
+
+  explicit Archive(const std::filesystem::path& path);
+  ~Archive() = default;
+
+  [[nodiscard]] uint32_t getChunkCount() const;
+  [[nodiscard]] ChunkEntry getChunk(uint32_t index) const;
+  // Binary search over the name hashes
+  [[nodiscard]] std::optional<ChunkEntry> find(std::string_view name) const;
+  [[nodiscard]] std::string_view getName(const ChunkEntry& entry) const;
+  [[nodiscard]] MipRegion getLevel(const TextureInfo& texture, uint32_t level) const;
+
+  // Bytes as they are in the file
+  [[nodiscard]] std::span<const std::byte> getStored(const ChunkEntry& entry) const;
+  // Copies or decompresses the chunk into out, which has to hold exactly rawSize bytes
+  void read(const ChunkEntry& entry, std::span<std::byte> out) const;
+  [[nodiscard]] bool verify(const ChunkEntry& entry) const;
+
+  [[nodiscard]] const Header& getHeader() const;
+  // Bytes of all chunks once decompressed
+  [[nodiscard]] uint64_t getRawSize() const;
+
+private:
+  MappedFile _file;
+  Header _header{};
+  uint64_t _rawSize = 0;
+
+  [[nodiscard]] size_t levelsOffset() const;
+  [[nodiscard]] size_t namesOffset() const;
+  void check(const ChunkEntry& entry, uint32_t index) const;
+};
+}  // namespace assets
+
+#endif /* LIB_ASSETS_CONTAINER_ARCHIVE */
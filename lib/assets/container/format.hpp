@@ -0,0 +1,125 @@
+#ifndef LIB_ASSETS_CONTAINER_FORMAT
+#define LIB_ASSETS_CONTAINER_FORMAT
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace assets {
+// Structures below are the file layout as it is, little endian and without padding
+static_assert(std::endian::native == std::endian::little, "Asset containers are read in place on little endian hosts only");
+
+inline constexpr uint32_t fileMagic = 0x4B50'4B56;  // "VKPK"
+// Readers reject other versions, any layout change bumps it
+inline constexpr uint32_t fileVersion = 1;
+
+enum class ChunkType : uint32_t {
+  // MeshInfo, vertices followed by uint32_t indices at indexOffset
+  mesh,
+  // TextureInfo, blocks of every mip level at the offsets of its MipRegions
+  texture,
+  // SPIR-V words, never compressed so they map straight into vkCreateShaderModule
+  shader,
+  blob,
+};
+
+enum class Compression : uint32_t {
+  none,
+  // LZ4 block format, the whole chunk is one block
+  lz4,
+};
+
+// Layout of a file:
+//   Header
+//   ChunkEntry[chunkCount]  sorted by name hash, then name
+//   MipRegion[levelCount]
+//   names                   nameBytes of UTF-8 without terminators
+//   chunk data              every chunk at a multiple of alignment
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t chunkCount;
+  uint32_t levelCount;
+  uint32_t nameBytes;
+  uint32_t reserved;
+  // Of every chunk in the file, a multiple of the optimalBufferCopyOffsetAlignment the packer was given
+  uint64_t alignment;
+  // Entries, levels and names right after the header
+  uint64_t tocSize;
+  uint64_t tocChecksum;
+  uint64_t fileSize;
+};
+
+struct ChunkEntry {
+  // From the start of the file
+  uint64_t offset;
+  uint64_t size;
+  // Size after decompression, size for uncompressed chunks
+  uint64_t rawSize;
+  // checksum() of the size stored bytes
+  uint64_t checksum;
+  // checksum() of the name
+  uint64_t nameHash;
+  uint32_t nameOffset;
+  uint32_t nameSize;
+  ChunkType type;
+  Compression compression;
+  // MeshInfo or TextureInfo, read with info<T>()
+  std::array<uint32_t, 14> info;
+};
+
+// Where one mip level lies in the decompressed texture chunk
+struct MipRegion {
+  uint32_t width;
+  uint32_t height;
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Vertex attribute decoding is up to the shaders, quantized meshes bring their offsets and scales
+struct MeshInfo {
+  uint32_t vertexCount;
+  uint32_t vertexStride;
+  uint32_t indexCount;
+  // Bytes from the chunk start, indices are uint32_t
+  uint32_t indexOffset;
+  std::array<float, 3> positionOffset;
+  std::array<float, 3> positionScale;
+  std::array<float, 2> uvOffset;
+  std::array<float, 2> uvScale;
+};
+
+struct TextureInfo {
+  // VkFormat of the blocks
+  uint32_t format;
+  uint32_t width;
+  uint32_t height;
+  // MipRegions firstLevel to firstLevel + levelCount of the file
+  uint32_t firstLevel;
+  uint32_t levelCount;
+};
+
+static_assert(sizeof(Header) == 56 && std::is_trivially_copyable_v<Header>);
+static_assert(sizeof(ChunkEntry) == 112 && std::is_trivially_copyable_v<ChunkEntry>);
+static_assert(sizeof(MipRegion) == 24 && std::is_trivially_copyable_v<MipRegion>);
+static_assert(sizeof(MeshInfo) <= sizeof(ChunkEntry::info) && sizeof(TextureInfo) <= sizeof(ChunkEntry::info));
+
+template <typename T>
+[[nodiscard]] T info(const ChunkEntry& entry)
+{
+  T value{};
+  std::memcpy(&value, entry.info.data(), sizeof(T));
+  return value;
+}
+
+template <typename T>
+void setInfo(ChunkEntry& entry, const T& value)
+{
+  entry.info = {};
+  std::memcpy(entry.info.data(), &value, sizeof(T));
+}
+}  // namespace assets
+
+#endif /* LIB_ASSETS_CONTAINER_FORMAT */
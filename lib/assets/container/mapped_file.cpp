@@ -0,0 +1,92 @@
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <span>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace assets {
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  _file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (_file == INVALID_HANDLE_VALUE) {
+    _file = nullptr;
+    throw std::runtime_error(std::format("Failed to open {}! error: {}", path.string(), GetLastError()));
+  }
+  LARGE_INTEGER size{};
+  if (GetFileSizeEx(_file, &size) == 0 || size.QuadPart <= 0) {
+    CloseHandle(_file);
+    throw std::runtime_error(std::format("Failed to map {}, it is empty or its size is unknown", path.string()));
+  }
+  _size = static_cast<size_t>(size.QuadPart);
+  _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void* view = _mapping != nullptr ? MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (view == nullptr) {
+    const DWORD error = GetLastError();
+    if (_mapping != nullptr) {
+      CloseHandle(_mapping);
+    }
+    CloseHandle(_file);
+    throw std::runtime_error(std::format("Failed to map {}! error: {}", path.string(), error));
+  }
+  _data = static_cast<const std::byte*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+  UnmapViewOfFile(_data);
+  CloseHandle(_mapping);
+  CloseHandle(_file);
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  const int descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+  if (descriptor < 0) {
+    throw std::runtime_error(std::format("Failed to open {}! error: {}", path.string(), std::generic_category().message(errno)));
+  }
+  struct stat status{};
+  if (fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+    close(descriptor);
+    throw std::runtime_error(std::format("Failed to map {}, it is empty or its size is unknown", path.string()));
+  }
+  _size = static_cast<size_t>(status.st_size);
+  // The mapping keeps its own reference to the file
+  void* view = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  const int error = errno;
+  close(descriptor);
+  if (view == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    throw std::runtime_error(std::format("Failed to map {}! error: {}", path.string(), std::generic_category().message(error)));
+  }
+  // Read ahead starts now, while the caller still parses the table of contents
+  madvise(view, _size, MADV_WILLNEED);
+  _data = static_cast<const std::byte*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+  munmap(const_cast<std::byte*>(_data), _size);  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+#endif
+
+std::span<const std::byte> MappedFile::get() const
+{
+  return {_data, _size};
+}
+}  // namespace assets
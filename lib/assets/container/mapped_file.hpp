@@ -0,0 +1,32 @@
+#ifndef LIB_ASSETS_CONTAINER_MAPPED_FILE
+#define LIB_ASSETS_CONTAINER_MAPPED_FILE
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace assets {
+// Read only view of a whole file, pages come in on first touch and stay shared with the page cache
+class MappedFile {
+public:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  explicit MappedFile(const std::filesystem::path& path);
+  ~MappedFile();
+
+  [[nodiscard]] std::span<const std::byte> get() const;
+
+private:
+  const std::byte* _data = nullptr;
+  size_t _size = 0;
+#ifdef _WIN32
+  void* _file = nullptr;
+  void* _mapping = nullptr;
+#endif
+};
+}  // namespace assets
+
+#endif /* LIB_ASSETS_CONTAINER_MAPPED_FILE */
@@ -0,0 +1,220 @@
+#include "packer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "compress/checksum.hpp"
+#include "compress/lz4.hpp"
+#include "format.hpp"
+
+namespace assets {
+// Texel blocks and SPIR-V words stay aligned in the mapping
+static constexpr uint64_t minAlignment = 16;
+static constexpr uint64_t indexAlignment = 16;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+static void append(std::vector<std::byte>& out, const T& value)
+{
+  const size_t offset = out.size();
+  out.resize(offset + sizeof(T));
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+static void writeBytes(std::ofstream& stream, std::span<const std::byte> bytes)
+{
+  stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+Packer::Packer(const PackOptions& options) : _options(options)
+{
+  if (!std::has_single_bit(_options.alignment) || _options.alignment < minAlignment) {
+    throw std::runtime_error(std::format("Chunk alignment {} is not a power of two of at least {}", _options.alignment, minAlignment));
+  }
+}
+
+void Packer::addMesh(std::string name, MeshInfo info, std::span<const std::byte> vertices, std::span<const uint32_t> indices)
+{
+  if (info.vertexStride == 0 || vertices.size() % info.vertexStride != 0) {
+    throw std::runtime_error(std::format("Mesh {} has {} vertex bytes, not a multiple of the stride {}", name, vertices.size(), info.vertexStride));
+  }
+  info.vertexCount = static_cast<uint32_t>(vertices.size() / info.vertexStride);
+  info.indexCount = static_cast<uint32_t>(indices.size());
+  info.indexOffset = static_cast<uint32_t>(alignUp(vertices.size(), indexAlignment));
+
+  std::vector<std::byte> data(info.indexOffset + indices.size_bytes());
+  std::ranges::copy(vertices, data.begin());
+  std::ranges::copy(std::as_bytes(indices), data.begin() + info.indexOffset);
+  add(std::move(name), ChunkType::mesh, std::move(data));
+  setInfo(_chunks.back().entry, info);
+}
+
+void Packer::addTexture(std::string name, uint32_t format, std::span<const MipRegion> levels, std::span<const std::byte> data)
+{
+  for (const MipRegion& level : levels) {
+    if (level.offset > data.size() || level.size > data.size() - level.offset) {
+      throw std::runtime_error(std::format("Level {}x{} of texture {} is outside of its data", level.width, level.height, name));
+    }
+  }
+  if (levels.empty()) {
+    throw std::runtime_error(std::format("Texture {} has no levels", name));
+  }
+  add(std::move(name), ChunkType::texture, {data.begin(), data.end()});
+  Chunk& chunk = _chunks.back();
+  chunk.levels.assign(levels.begin(), levels.end());
+  setInfo(chunk.entry,
+          TextureInfo{
+              .format = format,
+              .width = levels.front().width,
+              .height = levels.front().height,
+              .firstLevel = 0,
+              .levelCount = static_cast<uint32_t>(levels.size()),
+          });
+}
+
+void Packer::addShader(std::string name, std::span<const uint32_t> code)
+{
+  const std::span<const std::byte> bytes = std::as_bytes(code);
+  add(std::move(name), ChunkType::shader, {bytes.begin(), bytes.end()});
+}
+
+void Packer::addBlob(std::string name, std::span<const std::byte> data)
+{
+  add(std::move(name), ChunkType::blob, {data.begin(), data.end()});
+}
+
+void Packer::add(std::string name, ChunkType type, std::vector<std::byte> data)
+{
+  ChunkEntry entry{};
+  entry.type = type;
+  entry.nameHash = checksum(std::as_bytes(std::span(name)));
+  entry.rawSize = data.size();
+  _chunks.push_back({.name = std::move(name), .type = type, .entry = entry, .levels = {}, .data = std::move(data)});
+}
+
+PackStats Packer::write(const std::filesystem::path& path) const
+{
+  std::vector<size_t> order(_chunks.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::ranges::sort(order, [this](size_t a, size_t b) {
+    return std::pair(_chunks[a].entry.nameHash, std::string_view(_chunks[a].name)) <
+           std::pair(_chunks[b].entry.nameHash, std::string_view(_chunks[b].name));
+  });
+  for (size_t i = 1; i < order.size(); ++i) {
+    if (_chunks[order[i]].name == _chunks[order[i - 1]].name) {
+      throw std::runtime_error(std::format("Chunk name {} is used twice", _chunks[order[i]].name));
+    }
+  }
+
+  // Shaders stay uncompressed so they can be handed out straight from the mapping
+  std::vector<std::vector<std::byte>> compressed(_chunks.size());
+  if (_options.lz4) {
+    tbb::parallel_for(size_t{0}, _chunks.size(), [&](size_t index) {
+      if (_chunks[index].type != ChunkType::shader) {
+        compressed[index] = compressLz4(_chunks[index].data);
+        if (compressed[index].size() >= _chunks[index].data.size()) {
+          compressed[index] = {};
+        }
+      }
+    });
+  }
+
+  PackStats stats{};
+  std::vector<ChunkEntry> entries;
+  std::vector<MipRegion> levels;
+  std::string names;
+  for (const size_t index : order) {
+    const Chunk& chunk = _chunks[index];
+    const bool packed = !compressed[index].empty();
+    const std::span<const std::byte> stored = packed ? std::span<const std::byte>(compressed[index]) : std::span<const std::byte>(chunk.data);
+    ChunkEntry entry = chunk.entry;
+    entry.size = stored.size();
+    entry.checksum = checksum(stored);
+    entry.nameOffset = static_cast<uint32_t>(names.size());
+    entry.nameSize = static_cast<uint32_t>(chunk.name.size());
+    entry.compression = packed ? Compression::lz4 : Compression::none;
+    if (chunk.type == ChunkType::texture) {
+      auto texture = info<TextureInfo>(entry);
+      texture.firstLevel = static_cast<uint32_t>(levels.size());
+      setInfo(entry, texture);
+      levels.insert(levels.end(), chunk.levels.begin(), chunk.levels.end());
+    }
+    names += chunk.name;
+    entries.push_back(entry);
+    stats.compressed += packed ? 1U : 0U;
+    stats.rawBytes += entry.rawSize;
+    stats.storedBytes += entry.size;
+  }
+
+  const size_t tocSize = (entries.size() * sizeof(ChunkEntry)) + (levels.size() * sizeof(MipRegion)) + names.size();
+  std::vector<std::byte> toc;
+  toc.reserve(tocSize);
+  uint64_t offset = alignUp(sizeof(Header) + tocSize, _options.alignment);
+  for (ChunkEntry& entry : entries) {
+    entry.offset = offset;
+    offset = alignUp(offset + entry.size, _options.alignment);
+    append(toc, entry);
+  }
+  for (const MipRegion& level : levels) {
+    append(toc, level);
+  }
+  const std::span<const std::byte> nameBytes = std::as_bytes(std::span(names));
+  toc.insert(toc.end(), nameBytes.begin(), nameBytes.end());
+  const uint64_t fileSize = entries.empty() ? sizeof(Header) + toc.size() : entries.back().offset + entries.back().size;
+
+  const Header header{
+      .magic = fileMagic,
+      .version = fileVersion,
+      .chunkCount = static_cast<uint32_t>(entries.size()),
+      .levelCount = static_cast<uint32_t>(levels.size()),
+      .nameBytes = static_cast<uint32_t>(names.size()),
+      .reserved = 0,
+      .alignment = _options.alignment,
+      .tocSize = toc.size(),
+      .tocChecksum = checksum(toc),
+      .fileSize = fileSize,
+  };
+
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to create {}", path.string()));
+  }
+  std::vector<std::byte> head;
+  append(head, header);
+  head.insert(head.end(), toc.begin(), toc.end());
+  const std::vector<std::byte> padding(_options.alignment);
+  uint64_t written = head.size();
+  writeBytes(stream, head);
+  for (size_t i = 0; i < order.size(); ++i) {
+    const size_t index = order[i];
+    writeBytes(stream, std::span(padding).first(entries[i].offset - written));
+    writeBytes(stream, compressed[index].empty() ? std::span<const std::byte>(_chunks[index].data) : std::span<const std::byte>(compressed[index]));
+    written = entries[i].offset + entries[i].size;
+  }
+  if (!stream.flush()) {
+    throw std::runtime_error(std::format("Failed to write {}", path.string()));
+  }
+
+  stats.chunks = header.chunkCount;
+  stats.fileSize = fileSize;
+  return stats;
+}
+}  // namespace assets
@@ -0,0 +1,59 @@
+#ifndef LIB_ASSETS_CONTAINER_PACKER
+#define LIB_ASSETS_CONTAINER_PACKER
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "format.hpp"
+
+namespace assets {
+struct PackOptions {
+  // optimalBufferCopyOffsetAlignment of the devices the file is for, or a multiple of it. 256 covers the common ones
+  uint64_t alignment = 256;
+  bool lz4 = false;
+};
+
+struct PackStats {
+  uint32_t chunks = 0;
+  uint32_t compressed = 0;
+  uint64_t rawBytes = 0;
+  uint64_t storedBytes = 0;
+  uint64_t fileSize = 0;
+};
+
+// Collects chunks in memory and writes them as one container. Names have to be unique
+class Packer {
+public:
+  explicit Packer(const PackOptions& options = {});
+
+  // vertexCount, indexCount and indexOffset of info are filled in, indices follow the vertices 16 byte aligned
+  void addMesh(std::string name, MeshInfo info, std::span<const std::byte> vertices, std::span<const uint32_t> indices);
+  // format is the VkFormat of the blocks, levels point into data
+  void addTexture(std::string name, uint32_t format, std::span<const MipRegion> levels, std::span<const std::byte> data);
+  void addShader(std::string name, std::span<const uint32_t> code);
+  void addBlob(std::string name, std::span<const std::byte> data);
+
+  // Chunks are compressed in parallel on TBB, ones LZ4 does not make smaller are stored as they are
+  PackStats write(const std::filesystem::path& path) const;
+
+private:
+  struct Chunk {
+    std::string name;
+    ChunkType type;
+    ChunkEntry entry;
+    std::vector<MipRegion> levels;
+    std::vector<std::byte> data;
+  };
+
+  PackOptions _options;
+  std::vector<Chunk> _chunks;
+
+  void add(std::string name, ChunkType type, std::vector<std::byte> data);
+};
+}  // namespace assets
+
+#endif /* LIB_ASSETS_CONTAINER_PACKER */
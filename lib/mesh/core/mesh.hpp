@@ -0,0 +1,30 @@
+#ifndef LIB_MESH_CORE_MESH
+#define LIB_MESH_CORE_MESH
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mesh {
+// Vertex as importers produce it, before quantization
+struct Vertex {
+  std::array<float, 3> position;
+  std::array<float, 3> normal;
+  std::array<float, 2> uv;
+};
+
+// Indexed triangle list
+struct Mesh {
+  std::string name;
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+};
+
+struct Bounds {
+  std::array<float, 3> min;
+  std::array<float, 3> max;
+};
+}  // namespace mesh
+
+#endif /* LIB_MESH_CORE_MESH */
@@ -0,0 +1,168 @@
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define MESH_SIMD 1
+#else
+#define MESH_SIMD 0
+#endif
+
+namespace mesh::simd {
+#if MESH_SIMD
+namespace stdx = std::experimental;
+using Floats = stdx::native_simd<float>;
+static constexpr size_t lanes = Floats::size();
+#endif
+
+static constexpr float unormMax = 65535.0F;
+static constexpr float snormMax = 32767.0F;
+
+static int16_t snorm16(float value)
+{
+  const float scaled = std::clamp(value, -1.0F, 1.0F) * snormMax;
+  return static_cast<int16_t>(scaled + (scaled < 0.0F ? -0.5F : 0.5F));
+}
+
+uint32_t width()
+{
+#if MESH_SIMD
+  return static_cast<uint32_t>(lanes);
+#else
+  return 1;
+#endif
+}
+
+std::pair<float, float> minMax(std::span<const float> values)
+{
+  if (values.empty()) {
+    return {0.0F, 0.0F};
+  }
+  float low = std::numeric_limits<float>::max();
+  float high = std::numeric_limits<float>::lowest();
+  size_t i = 0;
+#if MESH_SIMD
+  if (values.size() >= lanes) {
+    Floats lows(values.data(), stdx::element_aligned);
+    Floats highs = lows;
+    for (i = lanes; i + lanes <= values.size(); i += lanes) {
+      const Floats chunk(values.data() + i, stdx::element_aligned);
+      lows = stdx::min(lows, chunk);
+      highs = stdx::max(highs, chunk);
+    }
+    low = stdx::hmin(lows);
+    high = stdx::hmax(highs);
+  }
+#endif
+  for (; i < values.size(); ++i) {
+    low = std::min(low, values[i]);
+    high = std::max(high, values[i]);
+  }
+  return {low, high};
+}
+
+void unorm16(std::span<const float> values, float offset, float scale, std::span<uint16_t> out)
+{
+  size_t i = 0;
+#if MESH_SIMD
+  using Shorts = stdx::rebind_simd_t<uint16_t, Floats>;
+  const Floats base = offset;
+  const Floats factor = scale;
+  for (; i + lanes <= values.size(); i += lanes) {
+    const Floats scaled = (Floats(values.data() + i, stdx::element_aligned) - base) * factor;
+    const Floats clamped = stdx::min(stdx::max(scaled, Floats(0.0F)), Floats(unormMax)) + Floats(0.5F);
+    stdx::static_simd_cast<Shorts>(clamped).copy_to(out.data() + i, stdx::element_aligned);
+  }
+#endif
+  for (; i < values.size(); ++i) {
+    out[i] = static_cast<uint16_t>(std::clamp((values[i] - offset) * scale, 0.0F, unormMax) + 0.5F);
+  }
+}
+
+// Projects onto the octahedron |x| + |y| + |z| = 1, the lower half folds over the diagonals of the upper one
+void octahedral(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<int16_t> u, std::span<int16_t> v)
+{
+  size_t i = 0;
+#if MESH_SIMD
+  using Shorts = stdx::rebind_simd_t<int16_t, Floats>;
+  const Floats one = 1.0F;
+  const auto snorm = [&one](const Floats& value) {
+    Floats scaled = stdx::min(stdx::max(value, -one), one) * Floats(snormMax);
+    Floats rounding = 0.5F;
+    stdx::where(scaled < 0.0F, rounding) = -0.5F;
+    return stdx::static_simd_cast<Shorts>(scaled + rounding);
+  };
+  for (; i + lanes <= x.size(); i += lanes) {
+    Floats px(x.data() + i, stdx::element_aligned);
+    Floats py(y.data() + i, stdx::element_aligned);
+    const Floats pz(z.data() + i, stdx::element_aligned);
+    Floats norm = stdx::abs(px) + stdx::abs(py) + stdx::abs(pz);
+    stdx::where(norm <= 0.0F, norm) = one;
+    px /= norm;
+    py /= norm;
+    Floats signX = one;
+    Floats signY = one;
+    stdx::where(px < 0.0F, signX) = -one;
+    stdx::where(py < 0.0F, signY) = -one;
+    const Floats foldX = (one - stdx::abs(py)) * signX;
+    const Floats foldY = (one - stdx::abs(px)) * signY;
+    const auto lower = pz < 0.0F;
+    stdx::where(lower, px) = foldX;
+    stdx::where(lower, py) = foldY;
+    snorm(px).copy_to(u.data() + i, stdx::element_aligned);
+    snorm(py).copy_to(v.data() + i, stdx::element_aligned);
+  }
+#endif
+  for (; i < x.size(); ++i) {
+    float norm = std::abs(x[i]) + std::abs(y[i]) + std::abs(z[i]);
+    norm = norm > 0.0F ? norm : 1.0F;
+    float px = x[i] / norm;
+    float py = y[i] / norm;
+    if (z[i] < 0.0F) {
+      const float foldX = (1.0F - std::abs(py)) * (px < 0.0F ? -1.0F : 1.0F);
+      py = (1.0F - std::abs(px)) * (py < 0.0F ? -1.0F : 1.0F);
+      px = foldX;
+    }
+    u[i] = snorm16(px);
+    v[i] = snorm16(py);
+  }
+}
+
+void sphereDistance(std::span<const float> x,
+                    std::span<const float> y,
+                    std::span<const float> z,
+                    std::span<const float> radius,
+                    const std::array<float, 3>& eye,
+                    float minDistance,
+                    float scale,
+                    std::span<float> out)
+{
+  size_t i = 0;
+#if MESH_SIMD
+  const Floats eyeX = eye[0];
+  const Floats eyeY = eye[1];
+  const Floats eyeZ = eye[2];
+  for (; i + lanes <= x.size(); i += lanes) {
+    const Floats dx = Floats(x.data() + i, stdx::element_aligned) - eyeX;
+    const Floats dy = Floats(y.data() + i, stdx::element_aligned) - eyeY;
+    const Floats dz = Floats(z.data() + i, stdx::element_aligned) - eyeZ;
+    const Floats distance = stdx::sqrt((dx * dx) + (dy * dy) + (dz * dz)) - Floats(radius.data() + i, stdx::element_aligned);
+    (stdx::max(distance, Floats(minDistance)) * scale).copy_to(out.data() + i, stdx::element_aligned);
+  }
+#endif
+  for (; i < x.size(); ++i) {
+    const float dx = x[i] - eye[0];
+    const float dy = y[i] - eye[1];
+    const float dz = z[i] - eye[2];
+    out[i] = std::max(std::sqrt((dx * dx) + (dy * dy) + (dz * dz)) - radius[i], minDistance) * scale;
+  }
+}
+}  // namespace mesh::simd
@@ -0,0 +1,35 @@
+#ifndef LIB_MESH_CORE_SIMD
+#define LIB_MESH_CORE_SIMD
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+// Streaming kernels of the mesh processing steps over plain float arrays. Uses std::experimental::simd at the native
+// width of the target (-march=native in release), scalar loops where the standard library has no simd
+namespace mesh::simd {
+// Lanes of the native float vector, 1 on the scalar fallback
+[[nodiscard]] uint32_t width();
+
+[[nodiscard]] std::pair<float, float> minMax(std::span<const float> values);
+// round(clamp((value - offset) * scale, 0, 65535))
+void unorm16(std::span<const float> values, float offset, float scale, std::span<uint16_t> out);
+// Octahedral mapping of unit vectors given as 3 streams, written as snorm16 pairs
+void octahedral(std::span<const float> x,
+                std::span<const float> y,
+                std::span<const float> z,
+                std::span<int16_t> u,
+                std::span<int16_t> v);
+// max(distance(eye, center) - radius, minDistance) * scale for spheres given as 4 streams
+void sphereDistance(std::span<const float> x,
+                    std::span<const float> y,
+                    std::span<const float> z,
+                    std::span<const float> radius,
+                    const std::array<float, 3>& eye,
+                    float minDistance,
+                    float scale,
+                    std::span<float> out);
+}  // namespace mesh::simd
+
+#endif /* LIB_MESH_CORE_SIMD */
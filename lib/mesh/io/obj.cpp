@@ -0,0 +1,138 @@
+#include "obj.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+using Vec3 = std::array<float, 3>;
+
+static Vec3 cross(const Vec3& a, const Vec3& b)
+{
+  return {(a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0])};
+}
+
+static Vec3 normalize(const Vec3& value)
+{
+  const float length = std::sqrt((value[0] * value[0]) + (value[1] * value[1]) + (value[2] * value[2]));
+  return length > 0.0F ? Vec3{value[0] / length, value[1] / length, value[2] / length} : Vec3{0.0F, 0.0F, 1.0F};
+}
+
+// 1 based, negative counts back from the last element read so far
+static size_t objIndex(std::string_view text, size_t count, std::string_view line)
+{
+  int64_t value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size() || value == 0) {
+    throw std::runtime_error(std::format("Invalid index {} in \"{}\"", text, line));
+  }
+  const int64_t index = value < 0 ? static_cast<int64_t>(count) + value : value - 1;
+  if (index < 0 || static_cast<size_t>(index) >= count) {
+    throw std::runtime_error(std::format("Index {} out of range in \"{}\"", text, line));
+  }
+  return static_cast<size_t>(index);
+}
+
+Mesh loadObj(const std::filesystem::path& path)
+{
+  std::ifstream stream(path);
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to open {}", path.string()));
+  }
+  std::vector<Vec3> positions;
+  std::vector<Vec3> normals;
+  std::vector<std::array<float, 2>> uvs;
+  std::unordered_map<std::string, uint32_t> corners;
+  Mesh result{.name = path.stem().string(), .vertices = {}, .indices = {}};
+  bool hasNormals = true;
+
+  const auto addCorner = [&](const std::string& token, std::string_view line) {
+    const auto [found, added] = corners.try_emplace(token, static_cast<uint32_t>(result.vertices.size()));
+    if (!added) {
+      return found->second;
+    }
+    const std::string_view view = token;
+    const size_t first = view.find('/');
+    const size_t second = first == std::string_view::npos ? std::string_view::npos : view.find('/', first + 1);
+    Vertex vertex{.position = positions[objIndex(view.substr(0, first), positions.size(), line)], .normal = {}, .uv = {}};
+    if (first != std::string_view::npos) {
+      const std::string_view uv = view.substr(first + 1, second == std::string_view::npos ? std::string_view::npos : second - first - 1);
+      if (!uv.empty()) {
+        vertex.uv = uvs[objIndex(uv, uvs.size(), line)];
+      }
+    }
+    if (second != std::string_view::npos) {
+      vertex.normal = normals[objIndex(view.substr(second + 1), normals.size(), line)];
+    }
+    else {
+      hasNormals = false;
+    }
+    result.vertices.push_back(vertex);
+    return found->second;
+  };
+
+  for (std::string line; std::getline(stream, line);) {
+    std::istringstream words(line);
+    std::string kind;
+    words >> kind;
+    if (kind == "v") {
+      Vec3& position = positions.emplace_back();
+      words >> position[0] >> position[1] >> position[2];
+    }
+    else if (kind == "vn") {
+      Vec3& normal = normals.emplace_back();
+      words >> normal[0] >> normal[1] >> normal[2];
+    }
+    else if (kind == "vt") {
+      std::array<float, 2>& uv = uvs.emplace_back();
+      words >> uv[0] >> uv[1];
+    }
+    else if (kind == "f") {
+      std::vector<uint32_t> face;
+      for (std::string token; words >> token;) {
+        face.push_back(addCorner(token, line));
+      }
+      for (size_t i = 2; i < face.size(); ++i) {
+        result.indices.insert(result.indices.end(), {face[0], face[i - 1], face[i]});
+      }
+    }
+  }
+  if (result.indices.empty()) {
+    throw std::runtime_error(std::format("{} has no faces", path.string()));
+  }
+
+  if (!hasNormals) {
+    for (Vertex& vertex : result.vertices) {
+      vertex.normal = {};
+    }
+    for (size_t i = 0; i < result.indices.size(); i += 3) {
+      const Vec3& a = result.vertices[result.indices[i]].position;
+      const Vec3& b = result.vertices[result.indices[i + 1]].position;
+      const Vec3& c = result.vertices[result.indices[i + 2]].position;
+      const Vec3 normal = cross({b[0] - a[0], b[1] - a[1], b[2] - a[2]}, {c[0] - a[0], c[1] - a[1], c[2] - a[2]});
+      for (size_t corner = 0; corner < 3; ++corner) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+          result.vertices[result.indices[i + corner]].normal[axis] += normal[axis];
+        }
+      }
+    }
+    for (Vertex& vertex : result.vertices) {
+      vertex.normal = normalize(vertex.normal);
+    }
+  }
+  return result;
+}
+}  // namespace mesh
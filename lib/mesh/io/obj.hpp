@@ -0,0 +1,14 @@
+#ifndef LIB_MESH_IO_OBJ
+#define LIB_MESH_IO_OBJ
+
+#include <filesystem>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+// Wavefront OBJ: positions, uvs, normals and polygons triangulated as fans. Corners with the same v/vt/vn share a
+// vertex, meshes without normals get smooth ones. Everything else in the file is skipped
+[[nodiscard]] Mesh loadObj(const std::filesystem::path& path);
+}  // namespace mesh
+
+#endif /* LIB_MESH_IO_OBJ */
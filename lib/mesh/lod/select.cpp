@@ -0,0 +1,70 @@
+#include "select.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include "core/simd.hpp"
+#include "simplify.hpp"
+
+namespace mesh {
+static constexpr size_t blockSize = 1024;
+
+// Coarsest level with an error of at most budget, levels[0] always qualifies
+static uint32_t coarsest(const LodErrors& lods, float budget)
+{
+  uint32_t level = 0;
+  while (level + 1 < lods.count && lods.errors[level + 1] <= budget) {
+    ++level;
+  }
+  return level;
+}
+
+LodErrors lodErrors(const Lods& lods)
+{
+  LodErrors result{.errors = {}, .count = static_cast<uint32_t>(std::min<size_t>(lods.levels.size(), maxLodLevels))};
+  for (uint32_t level = 0; level < result.count; ++level) {
+    result.errors[level] = lods.levels[level].error;
+  }
+  return result;
+}
+
+uint64_t selectLods(const LodCamera& camera, std::span<const LodErrors> meshes, LodInstances& instances)
+{
+  // Object space error allowed at the distance of the instance
+  const float scale = camera.threshold / camera.projection;
+  const float coarsen = 1.0F - camera.hysteresis;
+  return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, instances.x.size(), blockSize), uint64_t{0},
+      [&](const tbb::blocked_range<size_t>& range, uint64_t switches) {
+        std::array<float, blockSize> budgets{};
+        for (size_t first = range.begin(); first < range.end(); first += blockSize) {
+          const size_t count = std::min(blockSize, range.end() - first);
+          simd::sphereDistance(std::span(instances.x).subspan(first, count), std::span(instances.y).subspan(first, count),
+                               std::span(instances.z).subspan(first, count), std::span(instances.radius).subspan(first, count),
+                               camera.position, camera.near, scale, std::span(budgets).first(count));
+          for (size_t i = 0; i < count; ++i) {
+            const LodErrors& lods = meshes[instances.mesh[first + i]];
+            const uint32_t current = std::min<uint32_t>(instances.level[first + i], lods.count - 1);
+            uint32_t level = current;
+            if (lods.errors[current] > budgets[i]) {
+              level = coarsest(lods, budgets[i]);
+            }
+            else {
+              level = std::max(current, coarsest(lods, budgets[i] * coarsen));
+            }
+            switches += level != instances.level[first + i] ? 1U : 0U;
+            instances.level[first + i] = static_cast<uint8_t>(level);
+          }
+        }
+        return switches;
+      },
+      std::plus<>());
+}
+}  // namespace mesh
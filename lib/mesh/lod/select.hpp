@@ -0,0 +1,53 @@
+#ifndef LIB_MESH_LOD_SELECT
+#define LIB_MESH_LOD_SELECT
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "simplify.hpp"
+
+namespace mesh {
+inline constexpr uint32_t maxLodLevels = 8;
+
+struct LodCamera {
+  std::array<float, 3> position;
+  // Pixels an object space unit covers at distance 1, viewport height / (2 * tan(fovY / 2))
+  float projection;
+  // Pixels a level may be off the full mesh
+  float threshold = 1.0F;
+  // Share of the threshold a coarser level has to stay below before an instance switches to it, so instances at the
+  // edge of two levels do not switch back and forth while the camera moves a little
+  float hysteresis = 0.25F;
+  // Distances are clamped to it, instances the camera is inside of get the full mesh
+  float near = 0.1F;
+};
+
+// Level errors of one mesh, finest first
+struct LodErrors {
+  std::array<float, maxLodLevels> errors;
+  uint32_t count;
+};
+
+// Instances as streams, bounding spheres in world space
+struct LodInstances {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+  std::vector<uint32_t> mesh;
+  // Selected level of every instance, kept between frames for the hysteresis
+  std::vector<uint8_t> level;
+};
+
+// Errors of the first maxLodLevels levels of the chain
+[[nodiscard]] LodErrors lodErrors(const Lods& lods);
+
+// Picks the coarsest level of every instance whose error projects to at most threshold pixels. The projection runs
+// over the streams in native float vectors, the level search per instance. Blocks of instances run in parallel on
+// TBB. Returns the instances that changed level
+uint64_t selectLods(const LodCamera& camera, std::span<const LodErrors> meshes, LodInstances& instances);
+}  // namespace mesh
+
+#endif /* LIB_MESH_LOD_SELECT */
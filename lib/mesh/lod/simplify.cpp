@@ -0,0 +1,336 @@
+#include "simplify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/mesh.hpp"
+#include "optimize/vertex_cache.hpp"
+
+namespace mesh {
+using Vec3 = std::array<double, 3>;
+
+// Levels that keep more than this share of the triangles before them end the chain
+static constexpr double minReduction = 0.9;
+
+static Vec3 sub(const Vec3& a, const Vec3& b)
+{
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static Vec3 cross(const Vec3& a, const Vec3& b)
+{
+  return {(a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0])};
+}
+
+static double dot(const Vec3& a, const Vec3& b)
+{
+  return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+// Area weighted sum of squared distances to a set of planes, the symmetric 4x4 matrix as its 10 distinct entries
+struct Quadric {
+  std::array<double, 10> m{};
+  double area = 0.0;
+
+  void addPlane(const Vec3& normal, double d, double weight)
+  {
+    const std::array<double, 4> p = {normal[0], normal[1], normal[2], d};
+    size_t entry = 0;
+    for (size_t row = 0; row < 4; ++row) {
+      for (size_t column = row; column < 4; ++column) {
+        m[entry++] += weight * p[row] * p[column];
+      }
+    }
+    area += weight;
+  }
+
+  void add(const Quadric& other)
+  {
+    for (size_t entry = 0; entry < m.size(); ++entry) {
+      m[entry] += other.m[entry];
+    }
+    area += other.area;
+  }
+
+  [[nodiscard]] double evaluate(const Vec3& point) const
+  {
+    const std::array<double, 4> p = {point[0], point[1], point[2], 1.0};
+    double sum = 0.0;
+    size_t entry = 0;
+    for (size_t row = 0; row < 4; ++row) {
+      for (size_t column = row; column < 4; ++column) {
+        sum += (row == column ? 1.0 : 2.0) * m[entry++] * p[row] * p[column];
+      }
+    }
+    return std::max(sum, 0.0);
+  }
+
+  // Root of the mean squared distance over the area the planes came from
+  [[nodiscard]] double distance(const Vec3& point) const { return area > 0.0 ? std::sqrt(evaluate(point) / area) : 0.0; }
+};
+
+struct Collapse {
+  double cost;
+  uint32_t from;
+  uint32_t to;
+
+  bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+class Simplifier {
+public:
+  explicit Simplifier(const Mesh& mesh)
+      : _indices(mesh.indices),
+        _positions(mesh.vertices.size()),
+        _quadrics(mesh.vertices.size()),
+        _locked(mesh.vertices.size(), false),
+        _parent(mesh.vertices.size()),
+        _triangles(mesh.vertices.size()),
+        _live(mesh.indices.size() / 3, true),
+        _liveCount(mesh.indices.size() / 3)
+  {
+    for (size_t vertex = 0; vertex < mesh.vertices.size(); ++vertex) {
+      const auto& position = mesh.vertices[vertex].position;
+      _positions[vertex] = {double{position[0]}, double{position[1]}, double{position[2]}};
+    }
+    std::iota(_parent.begin(), _parent.end(), 0U);
+
+    // Edges used by one triangle are borders or attribute seams, their vertices never move
+    std::unordered_map<uint64_t, uint32_t> edges;
+    for (size_t triangle = 0; triangle < _live.size(); ++triangle) {
+      const std::span<const uint32_t> corners = corner(triangle);
+      for (size_t edge = 0; edge < 3; ++edge) {
+        edges[key(corners[edge], corners[(edge + 1) % 3])]++;
+        _triangles[corners[edge]].push_back(static_cast<uint32_t>(triangle));
+      }
+      const Vec3 normal = cross(sub(_positions[corners[1]], _positions[corners[0]]), sub(_positions[corners[2]], _positions[corners[0]]));
+      const double length = std::sqrt(dot(normal, normal));
+      if (length > 0.0) {
+        const Vec3 unit = {normal[0] / length, normal[1] / length, normal[2] / length};
+        Quadric plane;
+        plane.addPlane(unit, -dot(unit, _positions[corners[0]]), length * 0.5);
+        for (const uint32_t vertex : corners) {
+          _quadrics[vertex].add(plane);
+        }
+      }
+    }
+    for (const auto& [edge, uses] : edges) {
+      if (uses == 1) {
+        _locked[edge >> 32U] = true;
+        _locked[edge & UINT32_MAX] = true;
+      }
+    }
+    for (const auto& [edge, uses] : edges) {
+      push(static_cast<uint32_t>(edge >> 32U), static_cast<uint32_t>(edge & UINT32_MAX));
+    }
+  }
+
+  // Collapses edges cheapest first until at most target triangles are left or no collapse is possible
+  void reduce(size_t target)
+  {
+    while (_liveCount > target && !_queue.empty()) {
+      const Collapse next = _queue.top();
+      _queue.pop();
+      const uint32_t from = find(next.from);
+      const uint32_t to = find(next.to);
+      if (from == to) {
+        continue;
+      }
+      // Edges of a collapsed end were queued again by that collapse
+      if (from != next.from || to != next.to) {
+        continue;
+      }
+      // Either end may have taken over other vertices since the edge was queued
+      const double current = cost(from, to);
+      if (current > next.cost) {
+        _queue.push({.cost = current, .from = from, .to = to});
+        continue;
+      }
+      if (!flips(from, to)) {
+        collapse(from, to);
+        _error = std::max(_error, _quadrics[to].distance(_positions[to]));
+      }
+    }
+  }
+
+  [[nodiscard]] std::vector<uint32_t> indices() const
+  {
+    std::vector<uint32_t> result;
+    result.reserve(_liveCount * 3);
+    for (size_t triangle = 0; triangle < _live.size(); ++triangle) {
+      if (_live[triangle]) {
+        for (const uint32_t vertex : corner(triangle)) {
+          result.push_back(find(vertex));
+        }
+      }
+    }
+    return result;
+  }
+
+  [[nodiscard]] size_t getLiveCount() const { return _liveCount; }
+  [[nodiscard]] double getError() const { return _error; }
+
+private:
+  std::vector<uint32_t> _indices;
+  std::vector<Vec3> _positions;
+  std::vector<Quadric> _quadrics;
+  std::vector<bool> _locked;
+  // Vertex a collapsed vertex went to, itself for vertices still in the mesh
+  mutable std::vector<uint32_t> _parent;
+  // Triangles around every vertex, dead ones are skipped rather than removed
+  std::vector<std::vector<uint32_t>> _triangles;
+  std::vector<bool> _live;
+  size_t _liveCount;
+  double _error = 0.0;
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> _queue;
+
+  static uint64_t key(uint32_t a, uint32_t b) { return (uint64_t{std::min(a, b)} << 32U) | std::max(a, b); }
+
+  [[nodiscard]] std::span<const uint32_t> corner(size_t triangle) const { return std::span(_indices).subspan(triangle * 3, 3); }
+
+  // Halves the path on the way, chains grow with every collapse onto a vertex that was collapsed onto before
+  [[nodiscard]] uint32_t find(uint32_t vertex) const
+  {
+    while (_parent[vertex] != vertex) {
+      _parent[vertex] = _parent[_parent[vertex]];
+      vertex = _parent[vertex];
+    }
+    return vertex;
+  }
+
+  // Error of both quadrics at the position of to
+  [[nodiscard]] double cost(uint32_t from, uint32_t to) const
+  {
+    Quadric sum = _quadrics[from];
+    sum.add(_quadrics[to]);
+    return sum.evaluate(_positions[to]);
+  }
+
+  // Queues both directions of the edge that move an unlocked vertex
+  void push(uint32_t a, uint32_t b)
+  {
+    if (!_locked[a]) {
+      _queue.push({.cost = cost(a, b), .from = a, .to = b});
+    }
+    if (!_locked[b]) {
+      _queue.push({.cost = cost(b, a), .from = b, .to = a});
+    }
+  }
+
+  // A triangle around from that would turn over once from sits on to
+  [[nodiscard]] bool flips(uint32_t from, uint32_t to) const
+  {
+    for (const uint32_t triangle : _triangles[from]) {
+      if (!_live[triangle]) {
+        continue;
+      }
+      std::array<uint32_t, 3> vertices{};
+      std::ranges::transform(corner(triangle), vertices.begin(), [this](uint32_t vertex) { return find(vertex); });
+      if (std::ranges::find(vertices, to) != vertices.end()) {
+        continue;
+      }
+      std::array<Vec3, 3> before{};
+      std::array<Vec3, 3> after{};
+      for (size_t i = 0; i < 3; ++i) {
+        before[i] = _positions[vertices[i]];
+        after[i] = _positions[vertices[i] == from ? to : vertices[i]];
+      }
+      const Vec3 normalBefore = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+      const Vec3 normalAfter = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+      // Degenerate triangles have no side to turn over
+      if (dot(normalBefore, normalBefore) > 0.0 && dot(normalBefore, normalAfter) <= 0.0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void collapse(uint32_t from, uint32_t to)
+  {
+    _parent[from] = to;
+    _quadrics[to].add(_quadrics[from]);
+    for (const uint32_t triangle : _triangles[from]) {
+      if (!_live[triangle]) {
+        continue;
+      }
+      const std::span<const uint32_t> corners = corner(triangle);
+      const uint32_t a = find(corners[0]);
+      const uint32_t b = find(corners[1]);
+      const uint32_t c = find(corners[2]);
+      if (a == b || b == c || a == c) {
+        _live[triangle] = false;
+        --_liveCount;
+        continue;
+      }
+      _triangles[to].push_back(triangle);
+    }
+    for (const uint32_t triangle : _triangles[from]) {
+      if (_live[triangle]) {
+        for (const uint32_t vertex : corner(triangle)) {
+          if (const uint32_t other = find(vertex); other != to) {
+            push(to, other);
+          }
+        }
+      }
+    }
+    _triangles[from].clear();
+  }
+};
+
+static std::pair<std::array<float, 3>, float> boundingSphere(const Mesh& mesh)
+{
+  if (mesh.vertices.empty()) {
+    return {{0.0F, 0.0F, 0.0F}, 0.0F};
+  }
+  std::array<float, 3> low = mesh.vertices.front().position;
+  std::array<float, 3> high = low;
+  for (const Vertex& vertex : mesh.vertices) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      low[axis] = std::min(low[axis], vertex.position[axis]);
+      high[axis] = std::max(high[axis], vertex.position[axis]);
+    }
+  }
+  const std::array<float, 3> center = {(low[0] + high[0]) * 0.5F, (low[1] + high[1]) * 0.5F, (low[2] + high[2]) * 0.5F};
+  float radius = 0.0F;
+  for (const Vertex& vertex : mesh.vertices) {
+    const float x = vertex.position[0] - center[0];
+    const float y = vertex.position[1] - center[1];
+    const float z = vertex.position[2] - center[2];
+    radius = std::max(radius, std::sqrt((x * x) + (y * y) + (z * z)));
+  }
+  return {center, radius};
+}
+
+Lods buildLods(const Mesh& mesh, const LodOptions& options)
+{
+  const auto [center, radius] = boundingSphere(mesh);
+  Lods lods{.levels = {{.indices = mesh.indices, .error = 0.0F}}, .center = center, .radius = radius};
+
+  Simplifier simplifier(mesh);
+  for (uint32_t level = 0; level < options.maxLevels; ++level) {
+    const size_t before = simplifier.getLiveCount();
+    const auto target = static_cast<size_t>(static_cast<double>(before) * double{options.ratio});
+    if (target < options.minTriangles) {
+      break;
+    }
+    simplifier.reduce(target);
+    if (static_cast<double>(simplifier.getLiveCount()) > static_cast<double>(before) * minReduction) {
+      break;
+    }
+    LodLevel lod{.indices = simplifier.indices(), .error = static_cast<float>(simplifier.getError())};
+    optimizeVertexCache(lod.indices, mesh.vertices.size());
+    lods.levels.push_back(std::move(lod));
+  }
+  return lods;
+}
+}  // namespace mesh
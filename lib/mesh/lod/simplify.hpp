@@ -0,0 +1,41 @@
+#ifndef LIB_MESH_LOD_SIMPLIFY
+#define LIB_MESH_LOD_SIMPLIFY
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+struct LodOptions {
+  // Levels besides the full mesh
+  uint32_t maxLevels = 6;
+  // Triangles of a level against the one before
+  float ratio = 0.5F;
+  uint32_t minTriangles = 64;
+};
+
+struct LodLevel {
+  // Into the vertices of the mesh, every level shares its vertex buffer
+  std::vector<uint32_t> indices;
+  // Object space distance the level may be off the full mesh, 0 for the full mesh and non decreasing over the chain
+  float error;
+};
+
+// Finest first, levels[0] is the mesh as it was given
+struct Lods {
+  std::vector<LodLevel> levels;
+  // Bounding sphere of the mesh
+  std::array<float, 3> center;
+  float radius;
+};
+
+// Chain of simplified index buffers by quadric error edge collapse (Garland and Heckbert) onto existing vertices, each
+// level continues from the one before. Vertices on borders and attribute seams stay in place and collapses that flip a
+// triangle are skipped, so the chain ends early on meshes that cannot get any simpler. Every level goes through the
+// vertex cache optimization
+[[nodiscard]] Lods buildLods(const Mesh& mesh, const LodOptions& options = {});
+}  // namespace mesh
+
+#endif /* LIB_MESH_LOD_SIMPLIFY */
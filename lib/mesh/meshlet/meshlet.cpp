@@ -0,0 +1,151 @@
+#include "meshlet.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+using Vec3 = std::array<float, 3>;
+
+static constexpr uint32_t maxLocal = 256;
+static constexpr uint32_t notLocal = UINT32_MAX;
+static constexpr float disabledCone = 2.0F;
+// Normals further apart than about 84 degrees leave a cone that hardly ever culls
+static constexpr float minSpread = 0.1F;
+
+static Vec3 sub(const Vec3& a, const Vec3& b)
+{
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static float dot(const Vec3& a, const Vec3& b)
+{
+  return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+static Vec3 normalize(const Vec3& value)
+{
+  const float length = std::sqrt(dot(value, value));
+  return length > 0.0F ? Vec3{value[0] / length, value[1] / length, value[2] / length} : Vec3{};
+}
+
+static void bound(const Mesh& mesh, const Meshlets& meshlets, Meshlet& meshlet)
+{
+  const auto vertices = std::span(meshlets.vertices).subspan(meshlet.vertexOffset, meshlet.vertexCount);
+  const auto triangles = std::span(meshlets.triangles).subspan(meshlet.triangleOffset, static_cast<size_t>(meshlet.triangleCount) * 3);
+  const auto position = [&](uint8_t local) -> const Vec3& { return mesh.vertices[vertices[local]].position; };
+
+  Vec3 low;
+  Vec3 high;
+  low.fill(std::numeric_limits<float>::max());
+  high.fill(std::numeric_limits<float>::lowest());
+  for (const uint32_t vertex : vertices) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      low[axis] = std::min(low[axis], mesh.vertices[vertex].position[axis]);
+      high[axis] = std::max(high[axis], mesh.vertices[vertex].position[axis]);
+    }
+  }
+  meshlet.center = {(low[0] + high[0]) * 0.5F, (low[1] + high[1]) * 0.5F, (low[2] + high[2]) * 0.5F};
+  float radius = 0.0F;
+  for (const uint32_t vertex : vertices) {
+    const Vec3 offset = sub(mesh.vertices[vertex].position, meshlet.center);
+    radius = std::max(radius, dot(offset, offset));
+  }
+  meshlet.radius = std::sqrt(radius);
+
+  std::array<Vec3, maxLocal> normals{};
+  Vec3 axis{};
+  for (size_t triangle = 0; triangle < meshlet.triangleCount; ++triangle) {
+    const Vec3& a = position(triangles[triangle * 3]);
+    const Vec3 ab = sub(position(triangles[(triangle * 3) + 1]), a);
+    const Vec3 ac = sub(position(triangles[(triangle * 3) + 2]), a);
+    normals[triangle] = normalize({(ab[1] * ac[2]) - (ab[2] * ac[1]), (ab[2] * ac[0]) - (ab[0] * ac[2]), (ab[0] * ac[1]) - (ab[1] * ac[0])});
+    for (size_t i = 0; i < 3; ++i) {
+      axis[i] += normals[triangle][i];
+    }
+  }
+  meshlet.coneAxis = normalize(axis);
+  meshlet.coneApex = meshlet.center;
+  meshlet.coneCutoff = disabledCone;
+
+  float spread = 1.0F;
+  for (size_t triangle = 0; triangle < meshlet.triangleCount; ++triangle) {
+    if (dot(normals[triangle], normals[triangle]) > 0.0F) {
+      spread = std::min(spread, dot(normals[triangle], meshlet.coneAxis));
+    }
+  }
+  if (spread <= minSpread) {
+    return;
+  }
+  // Apex behind every triangle plane along the axis, so the test holds for the whole meshlet and not just its center
+  float distance = 0.0F;
+  for (size_t triangle = 0; triangle < meshlet.triangleCount; ++triangle) {
+    const float facing = dot(meshlet.coneAxis, normals[triangle]);
+    if (facing > 0.0F) {
+      distance = std::max(distance, dot(sub(meshlet.center, position(triangles[triangle * 3])), normals[triangle]) / facing);
+    }
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    meshlet.coneApex[i] = meshlet.center[i] - (meshlet.coneAxis[i] * distance);
+  }
+  meshlet.coneCutoff = std::sqrt(1.0F - (spread * spread));
+}
+
+Meshlets buildMeshlets(const Mesh& mesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+  maxVertices = std::clamp(maxVertices, 3U, maxLocal);
+  maxTriangles = std::clamp(maxTriangles, 1U, maxLocal);
+  Meshlets result;
+  result.vertices.reserve(mesh.indices.size());
+  result.triangles.reserve(mesh.indices.size());
+
+  std::vector<uint32_t> local(mesh.vertices.size(), notLocal);
+  Meshlet current{};
+  const auto finish = [&] {
+    if (current.triangleCount == 0) {
+      return;
+    }
+    bound(mesh, result, current);
+    result.meshlets.push_back(current);
+    for (const uint32_t vertex : std::span(result.vertices).subspan(current.vertexOffset)) {
+      local[vertex] = notLocal;
+    }
+    current = {};
+    current.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+    current.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+  };
+
+  for (size_t triangle = 0; triangle + 2 < mesh.indices.size(); triangle += 3) {
+    const uint32_t a = mesh.indices[triangle];
+    const uint32_t b = mesh.indices[triangle + 1];
+    const uint32_t c = mesh.indices[triangle + 2];
+    const uint32_t fresh = (local[a] == notLocal ? 1U : 0U) + (local[b] == notLocal && b != a ? 1U : 0U) +
+                           (local[c] == notLocal && c != a && c != b ? 1U : 0U);
+    if (current.vertexCount + fresh > maxVertices || current.triangleCount == maxTriangles) {
+      finish();
+    }
+    for (const uint32_t vertex : {a, b, c}) {
+      if (local[vertex] == notLocal) {
+        local[vertex] = current.vertexCount++;
+        result.vertices.push_back(vertex);
+      }
+      result.triangles.push_back(static_cast<uint8_t>(local[vertex]));
+    }
+    ++current.triangleCount;
+  }
+  finish();
+  return result;
+}
+
+bool coneCulled(const Meshlet& meshlet, const std::array<float, 3>& eye)
+{
+  return dot(normalize(sub(meshlet.coneApex, eye)), meshlet.coneAxis) >= meshlet.coneCutoff;
+}
+}  // namespace mesh
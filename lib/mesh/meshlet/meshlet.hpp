@@ -0,0 +1,48 @@
+#ifndef LIB_MESH_MESHLET_MESHLET
+#define LIB_MESH_MESHLET_MESHLET
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+// Limits VK_EXT_mesh_shader implementations run well with, 124 triangles keep the primitive indices in 3 * 124 bytes
+inline constexpr uint32_t defaultMeshletVertices = 64;
+inline constexpr uint32_t defaultMeshletTriangles = 124;
+
+struct Meshlet {
+  // Into Meshlets::vertices and Meshlets::triangles, triangles counts bytes
+  uint32_t vertexOffset;
+  uint32_t triangleOffset;
+  uint32_t vertexCount;
+  uint32_t triangleCount;
+  // Bounding sphere
+  std::array<float, 3> center;
+  float radius;
+  // Normal cone: every triangle faces away from an eye where dot(normalize(apex - eye), axis) >= cutoff
+  std::array<float, 3> coneApex;
+  std::array<float, 3> coneAxis;
+  // Above 1 when the normals spread too far for a cone
+  float coneCutoff;
+};
+
+struct Meshlets {
+  std::vector<Meshlet> meshlets;
+  // Mesh vertex of every meshlet vertex
+  std::vector<uint32_t> vertices;
+  // 3 meshlet local vertices per triangle
+  std::vector<uint8_t> triangles;
+};
+
+// Greedy in index order, so run the vertex cache optimization first. Limits are clamped to 256 vertices
+[[nodiscard]] Meshlets buildMeshlets(const Mesh& mesh,
+                                     uint32_t maxVertices = defaultMeshletVertices,
+                                     uint32_t maxTriangles = defaultMeshletTriangles);
+
+// All triangles of the meshlet face away from the eye
+[[nodiscard]] bool coneCulled(const Meshlet& meshlet, const std::array<float, 3>& eye);
+}  // namespace mesh
+
+#endif /* LIB_MESH_MESHLET_MESHLET */
@@ -0,0 +1,170 @@
+#include "overdraw.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core/mesh.hpp"
+#include "vertex_cache.hpp"
+
+namespace mesh {
+using Vec3 = std::array<float, 3>;
+
+struct Cluster {
+  size_t first;
+  size_t count;
+  float key;
+};
+
+static Vec3 sub(const Vec3& a, const Vec3& b)
+{
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static Vec3 cross(const Vec3& a, const Vec3& b)
+{
+  return {(a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0])};
+}
+
+static float dot(const Vec3& a, const Vec3& b)
+{
+  return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+// FIFO of defaultCacheSize entries, a vertex is cached while fewer than defaultCacheSize misses came after it
+class Fifo {
+public:
+  explicit Fifo(size_t vertexCount) : _entered(vertexCount, 0) {}
+
+  uint32_t misses(std::span<const uint32_t> triangle)
+  {
+    uint32_t misses = 0;
+    for (const uint32_t index : triangle) {
+      if (_time - _entered[index] >= defaultCacheSize) {
+        ++_time;
+        _entered[index] = _time;
+        ++misses;
+      }
+    }
+    return misses;
+  }
+
+  void flush() { _time += defaultCacheSize; }
+
+private:
+  std::vector<uint64_t> _entered;
+  uint64_t _time = defaultCacheSize;
+};
+
+// Hard boundaries where all 3 vertices miss, the cache starts over there in any order. Inside, a soft boundary follows
+// every triangle where the ACMR since the last one, started with a cold cache, is within threshold of the cluster's
+static std::vector<Cluster> makeClusters(std::span<const uint32_t> indices, size_t vertexCount, float threshold)
+{
+  const size_t triangles = indices.size() / 3;
+  const auto corners = [indices](size_t triangle) { return indices.subspan(triangle * 3, 3); };
+  std::vector<size_t> hard;
+  Fifo fifo(vertexCount);
+  for (size_t triangle = 0; triangle < triangles; ++triangle) {
+    if (fifo.misses(corners(triangle)) == 3 || triangle == 0) {
+      hard.push_back(triangle);
+    }
+  }
+  hard.push_back(triangles);
+
+  std::vector<Cluster> clusters;
+  for (size_t i = 0; i + 1 < hard.size(); ++i) {
+    const size_t end = hard[i + 1];
+    fifo.flush();
+    uint32_t total = 0;
+    for (size_t triangle = hard[i]; triangle < end; ++triangle) {
+      total += fifo.misses(corners(triangle));
+    }
+    const float limit = threshold * static_cast<float>(total) / static_cast<float>(end - hard[i]);
+
+    fifo.flush();
+    size_t first = hard[i];
+    uint32_t running = 0;
+    for (size_t triangle = hard[i]; triangle < end; ++triangle) {
+      running += fifo.misses(corners(triangle));
+      if (triangle + 1 == end || static_cast<float>(running) / static_cast<float>(triangle + 1 - first) <= limit) {
+        clusters.push_back({.first = first, .count = triangle + 1 - first, .key = 0.0F});
+        first = triangle + 1;
+        running = 0;
+        fifo.flush();
+      }
+    }
+  }
+  return clusters;
+}
+
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold)
+{
+  if (indices.size() % 3 != 0) {
+    throw std::runtime_error("Index count is not a multiple of 3");
+  }
+  if (indices.empty()) {
+    return;
+  }
+  std::vector<Cluster> clusters = makeClusters(indices, vertices.size(), threshold);
+
+  // Area weighted centroids and normals, the cross product is twice the area along the normal
+  const auto triangle = [&](size_t index, Vec3& centroid) {
+    const Vec3& a = vertices[indices[index * 3]].position;
+    const Vec3& b = vertices[indices[(index * 3) + 1]].position;
+    const Vec3& c = vertices[indices[(index * 3) + 2]].position;
+    const Vec3 normal = cross(sub(b, a), sub(c, a));
+    const float area = std::sqrt(dot(normal, normal));
+    for (size_t axis = 0; axis < 3; ++axis) {
+      centroid[axis] += area * (a[axis] + b[axis] + c[axis]) / 3.0F;
+    }
+    return std::pair(normal, area);
+  };
+  Vec3 meshCentroid{};
+  float meshArea = 0.0F;
+  for (size_t index = 0; index < indices.size() / 3; ++index) {
+    meshArea += triangle(index, meshCentroid).second;
+  }
+  if (meshArea <= 0.0F) {
+    return;
+  }
+  for (float& axis : meshCentroid) {
+    axis /= meshArea;
+  }
+
+  for (Cluster& cluster : clusters) {
+    Vec3 centroid{};
+    Vec3 normal{};
+    float area = 0.0F;
+    for (size_t index = cluster.first; index < cluster.first + cluster.count; ++index) {
+      const auto [weighted, triangleArea] = triangle(index, centroid);
+      for (size_t axis = 0; axis < 3; ++axis) {
+        normal[axis] += weighted[axis];
+      }
+      area += triangleArea;
+    }
+    const float length = std::sqrt(dot(normal, normal));
+    if (area <= 0.0F || length <= 0.0F) {
+      continue;
+    }
+    for (float& axis : centroid) {
+      axis /= area;
+    }
+    cluster.key = dot(sub(centroid, meshCentroid), normal) / length;
+  }
+
+  std::ranges::stable_sort(clusters, std::ranges::greater(), &Cluster::key);
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (const Cluster& cluster : clusters) {
+    const auto source = indices.subspan(cluster.first * 3, cluster.count * 3);
+    output.insert(output.end(), source.begin(), source.end());
+  }
+  std::ranges::copy(output, indices.begin());
+}
+}  // namespace mesh
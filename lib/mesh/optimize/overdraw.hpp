@@ -0,0 +1,17 @@
+#ifndef LIB_MESH_OPTIMIZE_OVERDRAW
+#define LIB_MESH_OPTIMIZE_OVERDRAW
+
+#include <cstdint>
+#include <span>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+// Reorders clusters of a vertex cache optimized index buffer so outer, outward facing ones draw first and hide the
+// rest behind them (Sander et al., "Fast triangle reordering for vertex locality and reduced overdraw"). Clusters end
+// where the cache starts over anyway, and inside those wherever the ACMR so far stays within threshold of the
+// cluster's, so the cache costs at most about threshold times as much
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold = 1.05F);
+}  // namespace mesh
+
+#endif /* LIB_MESH_OPTIMIZE_OVERDRAW */
@@ -0,0 +1,181 @@
+#include "vertex_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace mesh {
+static constexpr uint32_t lruSize = 32;
+static constexpr uint32_t maxValence = 32;
+static constexpr uint32_t noTriangle = UINT32_MAX;
+
+// Forsyth's constants: the last triangle's vertices score a flat 0.75, then falling off with the LRU position. Vertices
+// with few triangles left score higher, so no triangle is left behind alone
+struct ScoreTable {
+  std::array<float, lruSize> cache;
+  std::array<float, maxValence + 1> valence;
+};
+
+static ScoreTable makeScores()
+{
+  static constexpr float decayPower = 1.5F;
+  static constexpr float lastTriangleScore = 0.75F;
+  static constexpr float valenceScale = 2.0F;
+  static constexpr float valencePower = 0.5F;
+  ScoreTable table{};
+  for (uint32_t position = 0; position < lruSize; ++position) {
+    table.cache[position] = position < 3 ? lastTriangleScore
+                                         : std::pow(1.0F - (static_cast<float>(position - 3) / static_cast<float>(lruSize - 3)), decayPower);
+  }
+  table.valence[0] = 0.0F;
+  for (uint32_t valence = 1; valence <= maxValence; ++valence) {
+    table.valence[valence] = valenceScale * std::pow(static_cast<float>(valence), -valencePower);
+  }
+  return table;
+}
+
+static float vertexScore(const ScoreTable& table, int32_t position, uint32_t remaining)
+{
+  if (remaining == 0) {
+    return -1.0F;
+  }
+  const float cache = position < 0 ? 0.0F : table.cache[static_cast<size_t>(position)];
+  return cache + table.valence[std::min(remaining, maxValence)];
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount)
+{
+  if (indices.size() % 3 != 0) {
+    throw std::runtime_error("Index count is not a multiple of 3");
+  }
+  if (std::ranges::any_of(indices, [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+    throw std::runtime_error("Index out of the vertex range");
+  }
+  static const ScoreTable table = makeScores();
+  const size_t triangles = indices.size() / 3;
+
+  // Triangles of every vertex, the ones not emitted yet first
+  std::vector<uint32_t> remaining(vertexCount, 0);
+  for (const uint32_t index : indices) {
+    ++remaining[index];
+  }
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+    offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    adjacency[filled[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<int32_t> position(vertexCount, -1);
+  std::vector<float> score(vertexCount);
+  for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+    score[vertex] = vertexScore(table, -1, remaining[vertex]);
+  }
+  std::vector<float> triangleScore(triangles);
+  for (size_t triangle = 0; triangle < triangles; ++triangle) {
+    triangleScore[triangle] = score[indices[triangle * 3]] + score[indices[(triangle * 3) + 1]] + score[indices[(triangle * 3) + 2]];
+  }
+
+  std::vector<bool> emitted(triangles, false);
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  std::array<uint32_t, lruSize + 3> cache{};
+  std::array<uint32_t, lruSize + 3> next{};
+  size_t cached = 0;
+  size_t cursor = 0;
+  uint32_t best = triangles == 0 ? noTriangle : 0;
+  while (best != noTriangle) {
+    emitted[best] = true;
+    const std::span<const uint32_t> corners = std::span<const uint32_t>(indices).subspan(static_cast<size_t>(best) * 3, 3);
+    output.insert(output.end(), corners.begin(), corners.end());
+
+    // The emitted triangle moves past the live ones of its vertices
+    for (const uint32_t vertex : corners) {
+      const std::span<uint32_t> live(adjacency.data() + offsets[vertex], remaining[vertex]);
+      std::swap(*std::ranges::find(live, best), live.back());
+      --remaining[vertex];
+    }
+
+    // Its vertices go to the front of the LRU, whatever falls off the end is scored as uncached
+    size_t count = 0;
+    for (const uint32_t vertex : corners) {
+      const std::span<const uint32_t> front(next.data(), count);
+      if (std::ranges::find(front, vertex) == front.end()) {
+        next[count++] = vertex;
+      }
+    }
+    for (size_t i = 0; i < cached; ++i) {
+      if (std::ranges::find(corners, cache[i]) == corners.end()) {
+        next[count++] = cache[i];
+      }
+    }
+    for (size_t i = lruSize; i < count; ++i) {
+      position[next[i]] = -1;
+    }
+    cached = std::min<size_t>(count, lruSize);
+
+    for (size_t i = 0; i < count; ++i) {
+      const uint32_t vertex = next[i];
+      if (i < lruSize) {
+        position[vertex] = static_cast<int32_t>(i);
+      }
+      const float updated = vertexScore(table, position[vertex], remaining[vertex]);
+      const float delta = updated - score[vertex];
+      score[vertex] = updated;
+      for (const uint32_t triangle : std::span(adjacency.data() + offsets[vertex], remaining[vertex])) {
+        triangleScore[triangle] += delta;
+      }
+    }
+    std::copy_n(next.begin(), cached, cache.begin());
+
+    // Best live triangle touching the cache, a scan in input order once the cache has nothing left
+    best = noTriangle;
+    float bestScore = -1.0F;
+    for (size_t i = 0; i < cached; ++i) {
+      for (const uint32_t triangle : std::span(adjacency.data() + offsets[cache[i]], remaining[cache[i]])) {
+        if (triangleScore[triangle] > bestScore) {
+          bestScore = triangleScore[triangle];
+          best = triangle;
+        }
+      }
+    }
+    while (best == noTriangle && cursor < triangles) {
+      if (!emitted[cursor]) {
+        best = static_cast<uint32_t>(cursor);
+      }
+      ++cursor;
+    }
+  }
+  std::ranges::copy(output, indices.begin());
+}
+
+uint64_t cacheMisses(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+  // Time a vertex entered the FIFO, it is still cached while fewer than cacheSize misses happened since
+  std::vector<uint64_t> entered(vertexCount, 0);
+  uint64_t misses = 0;
+  for (const uint32_t index : indices) {
+    if (entered[index] == 0 || misses - entered[index] + 1 > cacheSize) {
+      ++misses;
+      entered[index] = misses;
+    }
+  }
+  return misses;
+}
+
+double acmr(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+  if (indices.empty()) {
+    return 0.0;
+  }
+  return static_cast<double>(cacheMisses(indices, vertexCount, cacheSize)) / static_cast<double>(indices.size() / 3);
+}
+}  // namespace mesh
@@ -0,0 +1,22 @@
+#ifndef LIB_MESH_OPTIMIZE_VERTEX_CACHE
+#define LIB_MESH_OPTIMIZE_VERTEX_CACHE
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mesh {
+// Post transform cache most GPUs behave close to
+inline constexpr uint32_t defaultCacheSize = 16;
+
+// Reorders the triangles for the post transform vertex cache, Forsyth's linear speed greedy scoring with a 32 entry
+// LRU model. Triangles and their winding stay the same
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// Vertex shader invocations of a FIFO cache of cacheSize entries
+[[nodiscard]] uint64_t cacheMisses(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+// Average cache miss ratio, misses per triangle. 0.5 is the best a regular grid gets, 3 is no reuse at all
+[[nodiscard]] double acmr(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+}  // namespace mesh
+
+#endif /* LIB_MESH_OPTIMIZE_VERTEX_CACHE */
@@ -0,0 +1,63 @@
+#include "vertex_fetch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+static constexpr uint32_t unused = UINT32_MAX;
+static constexpr size_t fetchLines = 16 * 1024 / fetchLine;
+
+size_t optimizeVertexFetch(Mesh& mesh)
+{
+  std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+  uint32_t next = 0;
+  for (uint32_t& index : mesh.indices) {
+    if (index >= mesh.vertices.size()) {
+      throw std::runtime_error(std::format("Index {} past the {} vertices of {}", index, mesh.vertices.size(), mesh.name));
+    }
+    if (remap[index] == unused) {
+      remap[index] = next++;
+    }
+    index = remap[index];
+  }
+
+  std::vector<Vertex> vertices(next);
+  for (size_t vertex = 0; vertex < remap.size(); ++vertex) {
+    if (remap[vertex] != unused) {
+      vertices[remap[vertex]] = mesh.vertices[vertex];
+    }
+  }
+  const size_t dropped = mesh.vertices.size() - next;
+  mesh.vertices = std::move(vertices);
+  return dropped;
+}
+
+uint64_t fetchedBytes(std::span<const uint32_t> indices, size_t vertexSize)
+{
+  if (indices.empty()) {
+    return 0;
+  }
+  // Same FIFO model as cacheMisses, a line is cached while fewer than fetchLines others were fetched after it
+  const uint64_t lastLine = ((std::ranges::max(indices) + 1ULL) * vertexSize - 1) / fetchLine;
+  std::vector<uint64_t> entered(lastLine + 1, 0);
+  uint64_t fetches = 0;
+  for (const uint32_t index : indices) {
+    const uint64_t end = ((index + 1ULL) * vertexSize - 1) / fetchLine;
+    for (uint64_t line = index * uint64_t{vertexSize} / fetchLine; line <= end; ++line) {
+      if (entered[line] == 0 || fetches - entered[line] + 1 > fetchLines) {
+        ++fetches;
+        entered[line] = fetches;
+      }
+    }
+  }
+  return fetches * fetchLine;
+}
+}  // namespace mesh
@@ -0,0 +1,22 @@
+#ifndef LIB_MESH_OPTIMIZE_VERTEX_FETCH
+#define LIB_MESH_OPTIMIZE_VERTEX_FETCH
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+// Bytes of a vertex fetch cache line
+inline constexpr size_t fetchLine = 64;
+
+// Orders the vertices by first use in the index buffer, so fetches walk the vertex buffer front to back, and drops
+// vertices no triangle uses. Run after the triangle order is final. Returns the dropped vertex count
+size_t optimizeVertexFetch(Mesh& mesh);
+
+// Bytes the vertex fetch reads through a 16KB FIFO of 64 byte lines, vertexSize bytes per vertex
+[[nodiscard]] uint64_t fetchedBytes(std::span<const uint32_t> indices, size_t vertexSize);
+}  // namespace mesh
+
+#endif /* LIB_MESH_OPTIMIZE_VERTEX_FETCH */
@@ -0,0 +1,104 @@
+#include "process.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include "core/mesh.hpp"
+#include "lod/simplify.hpp"
+#include "meshlet/meshlet.hpp"
+#include "optimize/overdraw.hpp"
+#include "optimize/vertex_cache.hpp"
+#include "optimize/vertex_fetch.hpp"
+#include "quantize/quantize.hpp"
+
+namespace mesh {
+using Seconds = std::chrono::duration<double>;
+using Bytes = std::function<uint64_t(size_t)>;
+
+static uint64_t total(size_t count, const Bytes& value)
+{
+  return tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, count), uint64_t{0},
+      [&value](const tbb::blocked_range<size_t>& range, uint64_t sum) {
+        for (size_t i = range.begin(); i != range.end(); ++i) {
+          sum += value(i);
+        }
+        return sum;
+      },
+      std::plus<>());
+}
+
+// Bytes are measured outside of the timed part
+static StepReport run(std::string step,
+                      std::string measure,
+                      std::span<const Mesh> meshes,
+                      const std::function<void(size_t)>& work,
+                      const Bytes& before,
+                      const Bytes& after)
+{
+  StepReport report{.step = std::move(step), .measure = std::move(measure), .meshes = meshes.size()};
+  report.triangles = total(meshes.size(), [meshes](size_t i) { return uint64_t{meshes[i].indices.size() / 3}; });
+  report.bytesBefore = total(meshes.size(), before);
+  const auto start = std::chrono::steady_clock::now();
+  tbb::parallel_for(size_t{0}, meshes.size(), work);
+  report.seconds = Seconds(std::chrono::steady_clock::now() - start).count();
+  report.bytesAfter = total(meshes.size(), after);
+  return report;
+}
+
+ProcessResult process(std::vector<Mesh> meshes, const ProcessOptions& options)
+{
+  ProcessResult result{.meshes = std::vector<ProcessedMesh>(meshes.size()), .steps = {}};
+
+  // Every miss runs the vertex shader on a whole Vertex
+  const Bytes transformed = [&meshes](size_t i) {
+    return cacheMisses(meshes[i].indices, meshes[i].vertices.size()) * sizeof(Vertex);
+  };
+  const Bytes fetched = [&meshes](size_t i) { return fetchedBytes(meshes[i].indices, sizeof(Vertex)); };
+
+  result.steps.push_back(run(
+      "vertex cache", "vertex shader input", meshes,
+      [&meshes](size_t i) { optimizeVertexCache(meshes[i].indices, meshes[i].vertices.size()); }, transformed, transformed));
+  result.steps.push_back(run(
+      "overdraw", "vertex shader input", meshes,
+      [&](size_t i) { optimizeOverdraw(meshes[i].indices, meshes[i].vertices, options.overdrawThreshold); }, transformed,
+      transformed));
+  result.steps.push_back(run(
+      "vertex fetch", "vertex fetch", meshes, [&meshes](size_t i) { static_cast<void>(optimizeVertexFetch(meshes[i])); }, fetched,
+      fetched));
+  result.steps.push_back(run(
+      "lod chain", "index data", meshes, [&](size_t i) { result.meshes[i].lods = buildLods(meshes[i], options.lod); },
+      [&meshes](size_t i) { return uint64_t{meshes[i].indices.size() * sizeof(uint32_t)}; },
+      [&result](size_t i) {
+        uint64_t bytes = 0;
+        for (const LodLevel& level : result.meshes[i].lods.levels) {
+          bytes += level.indices.size() * sizeof(uint32_t);
+        }
+        return bytes;
+      }));
+  result.steps.push_back(run(
+      "quantization", "vertex buffer", meshes, [&](size_t i) { result.meshes[i].quantized = quantize(meshes[i]); },
+      [&meshes](size_t i) { return uint64_t{meshes[i].vertices.size() * sizeof(Vertex)}; },
+      [&result](size_t i) { return uint64_t{result.meshes[i].quantized.vertices.size() * sizeof(QuantizedVertex)}; }));
+  result.steps.push_back(run(
+      "meshlets", "index data", meshes,
+      [&](size_t i) { result.meshes[i].meshlets = buildMeshlets(meshes[i], options.meshletVertices, options.meshletTriangles); },
+      [&meshes](size_t i) { return uint64_t{meshes[i].indices.size() * sizeof(uint32_t)}; },
+      [&result](size_t i) {
+        const Meshlets& meshlets = result.meshes[i].meshlets;
+        return uint64_t{(meshlets.meshlets.size() * sizeof(Meshlet)) + (meshlets.vertices.size() * sizeof(uint32_t)) +
+                        meshlets.triangles.size()};
+      }));
+  return result;
+}
+}  // namespace mesh
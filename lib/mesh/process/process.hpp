@@ -0,0 +1,50 @@
+#ifndef LIB_MESH_PROCESS_PROCESS
+#define LIB_MESH_PROCESS_PROCESS
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/mesh.hpp"
+#include "lod/simplify.hpp"
+#include "meshlet/meshlet.hpp"
+#include "quantize/quantize.hpp"
+
+namespace mesh {
+struct ProcessOptions {
+  float overdrawThreshold = 1.05F;
+  uint32_t meshletVertices = defaultMeshletVertices;
+  uint32_t meshletTriangles = defaultMeshletTriangles;
+  LodOptions lod;
+};
+
+struct StepReport {
+  std::string step;
+  // What bytesBefore and bytesAfter measure
+  std::string measure;
+  uint64_t meshes = 0;
+  uint64_t triangles = 0;
+  // Wall time of the step over all meshes
+  double seconds = 0.0;
+  uint64_t bytesBefore = 0;
+  uint64_t bytesAfter = 0;
+};
+
+struct ProcessedMesh {
+  QuantizedMesh quantized;
+  Meshlets meshlets;
+  // Index buffers into quantized.vertices, levels[0] is quantized.indices
+  Lods lods;
+};
+
+struct ProcessResult {
+  std::vector<ProcessedMesh> meshes;
+  std::vector<StepReport> steps;
+};
+
+// Import time pipeline: vertex cache order, overdraw order, vertex fetch order, LOD chain, quantization and meshlets. Every step
+// runs over all meshes in parallel on TBB before the next one starts, so each gets its own time and byte count
+[[nodiscard]] ProcessResult process(std::vector<Mesh> meshes, const ProcessOptions& options = {});
+}  // namespace mesh
+
+#endif /* LIB_MESH_PROCESS_PROCESS */
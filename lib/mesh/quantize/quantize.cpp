@@ -0,0 +1,123 @@
+#include "quantize.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "core/mesh.hpp"
+#include "core/simd.hpp"
+
+namespace mesh {
+static constexpr float unormMax = 65535.0F;
+static constexpr float snormMax = 32767.0F;
+
+// Attributes split into one stream each, the simd kernels want them contiguous
+struct Streams {
+  std::array<std::vector<float>, 3> position;
+  std::array<std::vector<float>, 3> normal;
+  std::array<std::vector<float>, 2> uv;
+};
+
+static Streams split(const Mesh& mesh)
+{
+  Streams streams;
+  for (auto* stream : {&streams.position[0], &streams.position[1], &streams.position[2], &streams.normal[0], &streams.normal[1],
+                       &streams.normal[2], &streams.uv[0], &streams.uv[1]}) {
+    stream->resize(mesh.vertices.size());
+  }
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    const Vertex& vertex = mesh.vertices[i];
+    for (size_t axis = 0; axis < 3; ++axis) {
+      streams.position[axis][i] = vertex.position[axis];
+      streams.normal[axis][i] = vertex.normal[axis];
+    }
+    streams.uv[0][i] = vertex.uv[0];
+    streams.uv[1][i] = vertex.uv[1];
+  }
+  return streams;
+}
+
+// Offset and step of one unorm16 unit, a flat axis keeps step 0
+static std::pair<float, float> range(std::span<const float> values)
+{
+  const auto [low, high] = simd::minMax(values);
+  return {low, (high - low) / unormMax};
+}
+
+QuantizedMesh quantize(const Mesh& mesh)
+{
+  const Streams streams = split(mesh);
+  const size_t count = mesh.vertices.size();
+  QuantizedMesh result{.name = mesh.name,
+                       .vertices = std::vector<QuantizedVertex>(count),
+                       .indices = mesh.indices,
+                       .positionOffset = {},
+                       .positionScale = {},
+                       .uvOffset = {},
+                       .uvScale = {}};
+
+  std::array<std::vector<uint16_t>, 5> unorms;
+  for (size_t axis = 0; axis < 5; ++axis) {
+    const std::span<const float> values = axis < 3 ? streams.position[axis] : streams.uv[axis - 3];
+    const auto [offset, step] = range(values);
+    if (axis < 3) {
+      result.positionOffset[axis] = offset;
+      result.positionScale[axis] = step;
+    }
+    else {
+      result.uvOffset[axis - 3] = offset;
+      result.uvScale[axis - 3] = step;
+    }
+    unorms[axis].resize(count);
+    simd::unorm16(values, offset, step > 0.0F ? 1.0F / step : 0.0F, unorms[axis]);
+  }
+  std::vector<int16_t> u(count);
+  std::vector<int16_t> v(count);
+  simd::octahedral(streams.normal[0], streams.normal[1], streams.normal[2], u, v);
+
+  for (size_t i = 0; i < count; ++i) {
+    result.vertices[i] = {.position = {unorms[0][i], unorms[1][i], unorms[2][i], 0}, .normal = {u[i], v[i]}, .uv = {unorms[3][i], unorms[4][i]}};
+  }
+  return result;
+}
+
+Vertex dequantize(const QuantizedMesh& mesh, const QuantizedVertex& vertex)
+{
+  Vertex result{.position = {}, .normal = decodeOctahedral(vertex.normal), .uv = {}};
+  for (size_t axis = 0; axis < 3; ++axis) {
+    result.position[axis] = mesh.positionOffset[axis] + (static_cast<float>(vertex.position[axis]) * mesh.positionScale[axis]);
+  }
+  for (size_t axis = 0; axis < 2; ++axis) {
+    result.uv[axis] = mesh.uvOffset[axis] + (static_cast<float>(vertex.uv[axis]) * mesh.uvScale[axis]);
+  }
+  return result;
+}
+
+std::array<int16_t, 2> encodeOctahedral(const std::array<float, 3>& normal)
+{
+  std::array<int16_t, 2> encoded{};
+  simd::octahedral(std::span(&normal[0], 1), std::span(&normal[1], 1), std::span(&normal[2], 1), std::span(&encoded[0], 1),
+                   std::span(&encoded[1], 1));
+  return encoded;
+}
+
+std::array<float, 3> decodeOctahedral(const std::array<int16_t, 2>& encoded)
+{
+  const float x = std::max(static_cast<float>(encoded[0]) / snormMax, -1.0F);
+  const float y = std::max(static_cast<float>(encoded[1]) / snormMax, -1.0F);
+  const float z = 1.0F - std::abs(x) - std::abs(y);
+  // Points past the diagonals are the folded lower half
+  const float fold = std::max(-z, 0.0F);
+  std::array<float, 3> normal = {x + (x < 0.0F ? fold : -fold), y + (y < 0.0F ? fold : -fold), z};
+  const float length = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+  for (float& axis : normal) {
+    axis /= length;
+  }
+  return normal;
+}
+}  // namespace mesh
@@ -0,0 +1,41 @@
+#ifndef LIB_MESH_QUANTIZE_QUANTIZE
+#define LIB_MESH_QUANTIZE_QUANTIZE
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/mesh.hpp"
+
+namespace mesh {
+// 16 bytes against the 32 of Vertex, matches VK_FORMAT_R16G16B16A16_UNORM, R16G16_SNORM and R16G16_UNORM attributes
+struct QuantizedVertex {
+  // unorm16 in the bounds of the mesh, w keeps the attribute 8 bytes
+  std::array<uint16_t, 4> position;
+  // Octahedral snorm16
+  std::array<int16_t, 2> normal;
+  // unorm16 in the uv bounds of the mesh
+  std::array<uint16_t, 2> uv;
+};
+
+struct QuantizedMesh {
+  std::string name;
+  std::vector<QuantizedVertex> vertices;
+  std::vector<uint32_t> indices;
+  // value = offset + unorm * scale, what the vertex shader applies
+  std::array<float, 3> positionOffset;
+  std::array<float, 3> positionScale;
+  std::array<float, 2> uvOffset;
+  std::array<float, 2> uvScale;
+};
+
+// Positions and uvs on 16 bits in the mesh bounds, normals octahedral on 2 snorm16
+[[nodiscard]] QuantizedMesh quantize(const Mesh& mesh);
+[[nodiscard]] Vertex dequantize(const QuantizedMesh& mesh, const QuantizedVertex& vertex);
+
+[[nodiscard]] std::array<int16_t, 2> encodeOctahedral(const std::array<float, 3>& normal);
+[[nodiscard]] std::array<float, 3> decodeOctahedral(const std::array<int16_t, 2>& encoded);
+}  // namespace mesh
+
+#endif /* LIB_MESH_QUANTIZE_QUANTIZE */
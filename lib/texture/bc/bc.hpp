@@ -0,0 +1,34 @@
+#ifndef LIB_TEXTURE_BC_BC
+#define LIB_TEXTURE_BC_BC
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "core/lanes.hpp"
+
+// Block encoders and decoders, one 4x4 block per call. Channels are 0 to 255 floats, pixels in row order
+namespace texture {
+struct Block {
+  Pixels r;
+  Pixels g;
+  Pixels b;
+  Pixels a;
+};
+
+void encodeBc1(const Block& block, std::span<std::byte, 8> out);
+void encodeBc3(const Block& block, std::span<std::byte, 16> out);
+void encodeBc4(const Pixels& values, std::span<std::byte, 8> out);
+void encodeBc5(const Block& block, std::span<std::byte, 16> out);
+void encodeBc7(const Block& block, std::span<std::byte, 16> out);
+
+// Both color modes, transparent black in the 3 color one
+[[nodiscard]] Block decodeBc1(std::span<const std::byte, 8> in);
+[[nodiscard]] Block decodeBc3(std::span<const std::byte, 16> in);
+[[nodiscard]] Pixels decodeBc4(std::span<const std::byte, 8> in);
+[[nodiscard]] Block decodeBc5(std::span<const std::byte, 16> in);
+// Mode 6 only, what encodeBc7 writes
+[[nodiscard]] Block decodeBc7(std::span<const std::byte, 16> in);
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_BC_BC */
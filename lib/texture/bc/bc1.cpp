@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "bc.hpp"
+#include "core/lanes.hpp"
+#include "endpoints.hpp"
+
+namespace texture {
+// Weight of color1 for every index of the 4 color mode
+static constexpr std::array<float, 4> colorWeights = {0.0F, 1.0F, 1.0F / 3.0F, 2.0F / 3.0F};
+
+struct ColorFit {
+  uint16_t color0;
+  uint16_t color1;
+  Indices indices;
+  float error;
+};
+
+static uint16_t pack565(const Color<3>& color)
+{
+  const auto quantize = [](float value, float top) { return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0F, 255.0F) * top / 255.0F)); };
+  return static_cast<uint16_t>((quantize(color[0], 31.0F) << 11U) | (quantize(color[1], 63.0F) << 5U) | quantize(color[2], 31.0F));
+}
+
+static Color<3> unpack565(uint16_t packed)
+{
+  const auto r = static_cast<uint32_t>(packed >> 11U) & 31U;
+  const auto g = static_cast<uint32_t>(packed >> 5U) & 63U;
+  const auto b = static_cast<uint32_t>(packed) & 31U;
+  return {static_cast<float>((r << 3U) | (r >> 2U)), static_cast<float>((g << 2U) | (g >> 4U)), static_cast<float>((b << 3U) | (b >> 2U))};
+}
+
+static std::array<Color<3>, 4> palette(uint16_t color0, uint16_t color1)
+{
+  const Color<3> first = unpack565(color0);
+  const Color<3> second = unpack565(color1);
+  std::array<Color<3>, 4> colors{};
+  for (size_t k = 0; k < colors.size(); ++k) {
+    for (size_t c = 0; c < 3; ++c) {
+      colors[k][c] = first[c] + ((second[c] - first[c]) * colorWeights[k]);
+    }
+  }
+  return colors;
+}
+
+// Endpoints in either order, color0 > color1 selects the 4 color mode. Equal colors need no indices
+static ColorFit fitColor(const Channels<3>& channels, const Color<3>& first, const Color<3>& second)
+{
+  uint16_t color0 = pack565(first);
+  uint16_t color1 = pack565(second);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+  ColorFit fit{.color0 = color0, .color1 = color1, .indices = {}, .error = 0.0F};
+  const auto colors = palette(color0, color1);
+  if (color0 == color1) {
+    static_cast<void>(nearest(channels, std::array<Color<3>, 1>{colors[0]}, fit.error));
+    return fit;
+  }
+  fit.indices = nearest(channels, colors, fit.error);
+  return fit;
+}
+
+static void encodeColor(const Block& block, std::span<std::byte, 8> out)
+{
+  const Channels<3> channels = {load(block.r), load(block.g), load(block.b)};
+  auto ends = fitEndpoints(channels);
+  inset(ends, 16.0F);
+  ColorFit best = fitColor(channels, ends.first, ends.second);
+  // One least squares pass over the indices of the line fit
+  if (const auto refined = refineEndpoints(channels, weightsOf(best.indices, colorWeights))) {
+    const ColorFit candidate = fitColor(channels, refined->first, refined->second);
+    best = candidate.error < best.error ? candidate : best;
+  }
+
+  uint32_t indices = 0;
+  for (size_t i = 0; i < blockPixels; ++i) {
+    indices |= best.indices[i] << (2 * i);
+  }
+  const std::array<uint16_t, 2> colors = {best.color0, best.color1};
+  for (size_t i = 0; i < 2; ++i) {
+    out[i * 2] = static_cast<std::byte>(colors[i] & 0xffU);
+    out[(i * 2) + 1] = static_cast<std::byte>(colors[i] >> 8U);
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    out[4 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xffU);
+  }
+}
+
+static Block decodeColor(std::span<const std::byte, 8> in, bool fourColor)
+{
+  const auto color0 = static_cast<uint16_t>(std::to_integer<uint32_t>(in[0]) | (std::to_integer<uint32_t>(in[1]) << 8U));
+  const auto color1 = static_cast<uint16_t>(std::to_integer<uint32_t>(in[2]) | (std::to_integer<uint32_t>(in[3]) << 8U));
+  std::array<Color<4>, 4> colors{};
+  const auto four = palette(color0, color1);
+  for (size_t k = 0; k < colors.size(); ++k) {
+    colors[k] = {four[k][0], four[k][1], four[k][2], 255.0F};
+  }
+  if (!fourColor && color0 <= color1) {
+    for (size_t c = 0; c < 3; ++c) {
+      colors[2][c] = (colors[0][c] + colors[1][c]) / 2.0F;
+    }
+    colors[3] = {0.0F, 0.0F, 0.0F, 0.0F};
+  }
+
+  Block block{};
+  for (size_t i = 0; i < blockPixels; ++i) {
+    const uint32_t index = (std::to_integer<uint32_t>(in[4 + (i / 4)]) >> (2 * (i % 4))) & 3U;
+    block.r[i] = colors[index][0];
+    block.g[i] = colors[index][1];
+    block.b[i] = colors[index][2];
+    block.a[i] = colors[index][3];
+  }
+  return block;
+}
+
+void encodeBc1(const Block& block, std::span<std::byte, 8> out)
+{
+  encodeColor(block, out);
+}
+
+void encodeBc3(const Block& block, std::span<std::byte, 16> out)
+{
+  encodeBc4(block.a, out.first<8>());
+  encodeColor(block, out.last<8>());
+}
+
+Block decodeBc1(std::span<const std::byte, 8> in)
+{
+  return decodeColor(in, false);
+}
+
+Block decodeBc3(std::span<const std::byte, 16> in)
+{
+  Block block = decodeColor(in.last<8>(), true);
+  block.a = decodeBc4(in.first<8>());
+  return block;
+}
+}  // namespace texture
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "bc.hpp"
+#include "core/lanes.hpp"
+#include "endpoints.hpp"
+
+namespace texture {
+// Weight of the second endpoint for every index of the 8 value mode
+static constexpr std::array<float, 8> valueWeights = {0.0F, 1.0F, 1.0F / 7.0F, 2.0F / 7.0F, 3.0F / 7.0F, 4.0F / 7.0F, 5.0F / 7.0F, 6.0F / 7.0F};
+
+struct ValueFit {
+  uint8_t value0;
+  uint8_t value1;
+  Indices indices;
+  float error;
+};
+
+// value0 > value1 selects the 8 value mode, equal values need no indices
+static ValueFit fitValues(const Channels<1>& channels, float first, float second)
+{
+  const auto quantize = [](float value) { return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0F, 255.0F))); };
+  uint8_t value0 = quantize(first);
+  uint8_t value1 = quantize(second);
+  if (value0 < value1) {
+    std::swap(value0, value1);
+  }
+  ValueFit fit{.value0 = value0, .value1 = value1, .indices = {}, .error = 0.0F};
+  std::array<Color<1>, 8> values{};
+  for (size_t k = 0; k < values.size(); ++k) {
+    values[k][0] = static_cast<float>(value0) + ((static_cast<float>(value1) - static_cast<float>(value0)) * valueWeights[k]);
+  }
+  if (value0 == value1) {
+    static_cast<void>(nearest(channels, std::array<Color<1>, 1>{values[0]}, fit.error));
+    return fit;
+  }
+  fit.indices = nearest(channels, values, fit.error);
+  return fit;
+}
+
+void encodeBc4(const Pixels& values, std::span<std::byte, 8> out)
+{
+  const Channels<1> channels = {load(values)};
+  ValueFit best = fitValues(channels, hmax(channels[0]), hmin(channels[0]));
+  if (const auto refined = refineEndpoints(channels, weightsOf(best.indices, valueWeights))) {
+    const ValueFit candidate = fitValues(channels, refined->first[0], refined->second[0]);
+    best = candidate.error < best.error ? candidate : best;
+  }
+
+  uint64_t indices = 0;
+  for (size_t i = 0; i < blockPixels; ++i) {
+    indices |= uint64_t{best.indices[i]} << (3 * i);
+  }
+  out[0] = static_cast<std::byte>(best.value0);
+  out[1] = static_cast<std::byte>(best.value1);
+  for (size_t i = 0; i < 6; ++i) {
+    out[2 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xffU);
+  }
+}
+
+void encodeBc5(const Block& block, std::span<std::byte, 16> out)
+{
+  encodeBc4(block.r, out.first<8>());
+  encodeBc4(block.g, out.last<8>());
+}
+
+Pixels decodeBc4(std::span<const std::byte, 8> in)
+{
+  const auto value0 = std::to_integer<uint32_t>(in[0]);
+  const auto value1 = std::to_integer<uint32_t>(in[1]);
+  std::array<float, 8> values{};
+  values[0] = static_cast<float>(value0);
+  values[1] = static_cast<float>(value1);
+  if (value0 > value1) {
+    for (uint32_t k = 1; k < 7; ++k) {
+      values[k + 1] = static_cast<float>(((7 - k) * value0) + (k * value1)) / 7.0F;
+    }
+  }
+  else {
+    for (uint32_t k = 1; k < 5; ++k) {
+      values[k + 1] = static_cast<float>(((5 - k) * value0) + (k * value1)) / 5.0F;
+    }
+    values[6] = 0.0F;
+    values[7] = 255.0F;
+  }
+
+  uint64_t indices = 0;
+  for (size_t i = 0; i < 6; ++i) {
+    indices |= uint64_t{std::to_integer<uint8_t>(in[2 + i])} << (8 * i);
+  }
+  Pixels pixels{};
+  for (size_t i = 0; i < blockPixels; ++i) {
+    pixels[i] = values[(indices >> (3 * i)) & 7U];
+  }
+  return pixels;
+}
+
+Block decodeBc5(std::span<const std::byte, 16> in)
+{
+  Block block{};
+  block.r = decodeBc4(in.first<8>());
+  block.g = decodeBc4(in.last<8>());
+  block.a.fill(255.0F);
+  return block;
+}
+}  // namespace texture
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "bc.hpp"
+#include "core/lanes.hpp"
+#include "endpoints.hpp"
+
+// Mode 6 only: one subset, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices. The mode every fast BC7 encoder
+// starts with, good on smooth blocks, behind the partitioned modes on blocks with two distinct colors
+namespace texture {
+static constexpr uint32_t mode = 6;
+static constexpr std::array<uint32_t, 16> interpolation = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Endpoint {
+  std::array<uint32_t, 4> value;
+  uint32_t pbit;
+};
+
+struct ModeFit {
+  Endpoint first;
+  Endpoint second;
+  Indices indices;
+  float error;
+};
+
+static constexpr std::array<float, 16> makeWeights()
+{
+  std::array<float, 16> weights{};
+  for (size_t k = 0; k < weights.size(); ++k) {
+    weights[k] = static_cast<float>(interpolation[k]) / 64.0F;
+  }
+  return weights;
+}
+
+static constexpr std::array<float, 16> weights = makeWeights();
+
+// 8 bit endpoint = 7 bits << 1 | p-bit, the p-bit with the smaller error
+static Endpoint quantize(const Color<4>& color)
+{
+  Endpoint best{};
+  float bestError = -1.0F;
+  for (uint32_t pbit = 0; pbit < 2; ++pbit) {
+    Endpoint candidate{.value = {}, .pbit = pbit};
+    float error = 0.0F;
+    for (size_t c = 0; c < 4; ++c) {
+      const auto value = static_cast<uint32_t>(std::lround(std::clamp((color[c] - static_cast<float>(pbit)) / 2.0F, 0.0F, 127.0F)));
+      candidate.value[c] = value;
+      const float difference = static_cast<float>((value << 1U) | pbit) - color[c];
+      error += difference * difference;
+    }
+    if (bestError < 0.0F || error < bestError) {
+      best = candidate;
+      bestError = error;
+    }
+  }
+  return best;
+}
+
+static std::array<Color<4>, 16> palette(const Endpoint& first, const Endpoint& second)
+{
+  std::array<Color<4>, 16> colors{};
+  for (size_t k = 0; k < colors.size(); ++k) {
+    for (size_t c = 0; c < 4; ++c) {
+      const uint32_t low = (first.value[c] << 1U) | first.pbit;
+      const uint32_t high = (second.value[c] << 1U) | second.pbit;
+      colors[k][c] = static_cast<float>((((64 - interpolation[k]) * low) + (interpolation[k] * high) + 32) >> 6U);
+    }
+  }
+  return colors;
+}
+
+static ModeFit fitMode(const Channels<4>& channels, const Color<4>& first, const Color<4>& second)
+{
+  ModeFit fit{.first = quantize(first), .second = quantize(second), .indices = {}, .error = 0.0F};
+  fit.indices = nearest(channels, palette(fit.first, fit.second), fit.error);
+  // The anchor pixel stores 3 bits, its index has to be below 8
+  if (fit.indices[0] >= 8) {
+    std::swap(fit.first, fit.second);
+    for (uint32_t& index : fit.indices) {
+      index = 15 - index;
+    }
+  }
+  return fit;
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(std::span<std::byte, 16> out) : _out(out) { std::ranges::fill(_out, std::byte{0}); }
+
+  void write(uint32_t value, uint32_t bits)
+  {
+    for (uint32_t bit = 0; bit < bits; ++bit, ++_position) {
+      if (((value >> bit) & 1U) != 0) {
+        _out[_position / 8] |= static_cast<std::byte>(1U << (_position % 8));
+      }
+    }
+  }
+
+private:
+  std::span<std::byte, 16> _out;
+  uint32_t _position = 0;
+};
+
+class BitReader {
+public:
+  explicit BitReader(std::span<const std::byte, 16> in) : _in(in) {}
+
+  uint32_t read(uint32_t bits)
+  {
+    uint32_t value = 0;
+    for (uint32_t bit = 0; bit < bits; ++bit, ++_position) {
+      value |= ((std::to_integer<uint32_t>(_in[_position / 8]) >> (_position % 8)) & 1U) << bit;
+    }
+    return value;
+  }
+
+private:
+  std::span<const std::byte, 16> _in;
+  uint32_t _position = 0;
+};
+
+void encodeBc7(const Block& block, std::span<std::byte, 16> out)
+{
+  const Channels<4> channels = {load(block.r), load(block.g), load(block.b), load(block.a)};
+  auto ends = fitEndpoints(channels);
+  inset(ends, 32.0F);
+  ModeFit best = fitMode(channels, ends.first, ends.second);
+  if (const auto refined = refineEndpoints(channels, weightsOf(best.indices, weights))) {
+    const ModeFit candidate = fitMode(channels, refined->first, refined->second);
+    best = candidate.error < best.error ? candidate : best;
+  }
+
+  BitWriter writer(out);
+  writer.write(1U << mode, mode + 1);
+  for (size_t c = 0; c < 4; ++c) {
+    writer.write(best.first.value[c], 7);
+    writer.write(best.second.value[c], 7);
+  }
+  writer.write(best.first.pbit, 1);
+  writer.write(best.second.pbit, 1);
+  writer.write(best.indices[0], 3);
+  for (size_t i = 1; i < blockPixels; ++i) {
+    writer.write(best.indices[i], 4);
+  }
+}
+
+Block decodeBc7(std::span<const std::byte, 16> in)
+{
+  BitReader reader(in);
+  uint32_t found = 0;
+  while (found < 8 && reader.read(1) == 0) {
+    ++found;
+  }
+  if (found != mode) {
+    throw std::runtime_error(std::format("BC7 mode {} is not decoded, only mode {}", found, mode));
+  }
+  Endpoint first{};
+  Endpoint second{};
+  for (size_t c = 0; c < 4; ++c) {
+    first.value[c] = reader.read(7);
+    second.value[c] = reader.read(7);
+  }
+  first.pbit = reader.read(1);
+  second.pbit = reader.read(1);
+  const auto colors = palette(first, second);
+
+  Block block{};
+  for (size_t i = 0; i < blockPixels; ++i) {
+    const Color<4>& color = colors[reader.read(i == 0 ? 3 : 4)];
+    block.r[i] = color[0];
+    block.g[i] = color[1];
+    block.b[i] = color[2];
+    block.a[i] = color[3];
+  }
+  return block;
+}
+}  // namespace texture
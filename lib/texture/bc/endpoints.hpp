@@ -0,0 +1,154 @@
+#ifndef LIB_TEXTURE_BC_ENDPOINTS
+#define LIB_TEXTURE_BC_ENDPOINTS
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "core/lanes.hpp"
+
+// Endpoint fitting shared by the BCn encoders, all in 0 to 255 per channel
+namespace texture {
+template <size_t N>
+using Color = std::array<float, N>;
+template <size_t N>
+using Channels = std::array<Lanes, N>;
+using Indices = std::array<uint32_t, blockPixels>;
+
+// Ends of the best fit line through the pixels: principal axis of the covariance by power iteration, through the mean,
+// cut where the pixels project furthest
+template <size_t N>
+std::pair<Color<N>, Color<N>> fitEndpoints(const Channels<N>& channels)
+{
+  static constexpr uint32_t iterations = 8;
+  Color<N> mean{};
+  Channels<N> centered;
+  Color<N> axis{};
+  for (size_t c = 0; c < N; ++c) {
+    mean[c] = sum(channels[c]) / static_cast<float>(blockPixels);
+    centered[c] = channels[c] - Lanes(mean[c]);
+    axis[c] = hmax(channels[c]) - hmin(channels[c]);
+  }
+  std::array<Color<N>, N> covariance{};
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = i; j < N; ++j) {
+      covariance[i][j] = sum(centered[i] * centered[j]);
+      covariance[j][i] = covariance[i][j];
+    }
+  }
+  for (uint32_t iteration = 0; iteration < iterations; ++iteration) {
+    Color<N> next{};
+    float largest = 0.0F;
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < N; ++j) {
+        next[i] += covariance[i][j] * axis[j];
+      }
+      largest = std::max(largest, std::abs(next[i]));
+    }
+    if (largest <= 0.0F) {
+      break;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      axis[i] = next[i] / largest;
+    }
+  }
+  float length = 0.0F;
+  for (const float value : axis) {
+    length += value * value;
+  }
+  if (length <= 0.0F) {
+    return {mean, mean};
+  }
+  length = std::sqrt(length);
+  Lanes projected = 0.0F;
+  for (size_t c = 0; c < N; ++c) {
+    axis[c] /= length;
+    projected = projected + (centered[c] * Lanes(axis[c]));
+  }
+  const float low = hmin(projected);
+  const float high = hmax(projected);
+  std::pair<Color<N>, Color<N>> ends;
+  for (size_t c = 0; c < N; ++c) {
+    ends.first[c] = std::clamp(mean[c] + (axis[c] * low), 0.0F, 255.0F);
+    ends.second[c] = std::clamp(mean[c] + (axis[c] * high), 0.0F, 255.0F);
+  }
+  return ends;
+}
+
+// Pulls both ends in by 1 / divisor of the line, the outermost pixels then sit between palette entries less often
+template <size_t N>
+void inset(std::pair<Color<N>, Color<N>>& ends, float divisor)
+{
+  for (size_t c = 0; c < N; ++c) {
+    const float step = (ends.second[c] - ends.first[c]) / divisor;
+    ends.first[c] += step;
+    ends.second[c] -= step;
+  }
+}
+
+// Closest palette entry of every pixel, squared error summed into error
+template <size_t N, size_t K>
+Indices nearest(const Channels<N>& channels, const std::array<Color<N>, K>& palette, float& error)
+{
+  Lanes best = std::numeric_limits<float>::max();
+  Lanes index = 0.0F;
+  for (size_t k = 0; k < K; ++k) {
+    Lanes distance = 0.0F;
+    for (size_t c = 0; c < N; ++c) {
+      const Lanes difference = channels[c] - Lanes(palette[k][c]);
+      distance = distance + (difference * difference);
+    }
+    select(distance < best, index, Lanes(static_cast<float>(k)));
+    best = min(best, distance);
+  }
+  error = sum(best);
+  const Pixels values = store(index);
+  Indices indices{};
+  for (size_t i = 0; i < blockPixels; ++i) {
+    indices[i] = static_cast<uint32_t>(values[i]);
+  }
+  return indices;
+}
+
+// Weight of the second endpoint in every pixel's palette entry
+template <size_t K>
+Lanes weightsOf(const Indices& indices, const std::array<float, K>& weights)
+{
+  Pixels values{};
+  for (size_t i = 0; i < blockPixels; ++i) {
+    values[i] = weights[indices[i]];
+  }
+  return load(values);
+}
+
+// Least squares endpoints for fixed weights, pixel = (1 - weight) * first + weight * second. Nothing when the weights
+// do not tell the endpoints apart
+template <size_t N>
+std::optional<std::pair<Color<N>, Color<N>>> refineEndpoints(const Channels<N>& channels, const Lanes& weights)
+{
+  static constexpr float singular = 1e-4F;
+  const Lanes inverse = Lanes(1.0F) - weights;
+  const float a = sum(inverse * inverse);
+  const float b = sum(inverse * weights);
+  const float c = sum(weights * weights);
+  const float determinant = (a * c) - (b * b);
+  if (std::abs(determinant) < singular) {
+    return std::nullopt;
+  }
+  std::pair<Color<N>, Color<N>> ends;
+  for (size_t channel = 0; channel < N; ++channel) {
+    const float first = sum(inverse * channels[channel]);
+    const float second = sum(weights * channels[channel]);
+    ends.first[channel] = std::clamp(((c * first) - (b * second)) / determinant, 0.0F, 255.0F);
+    ends.second[channel] = std::clamp(((a * second) - (b * first)) / determinant, 0.0F, 255.0F);
+  }
+  return ends;
+}
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_BC_ENDPOINTS */
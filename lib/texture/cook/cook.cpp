@@ -0,0 +1,221 @@
+#include "cook.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <vulkan/vulkan_core.h>
+
+#include "bc/bc.hpp"
+#include "core/image.hpp"
+#include "mips.hpp"
+
+namespace texture {
+// Multiple of every block size, bufferOffset of VkBufferImageCopy has to be a multiple of the block size
+static constexpr VkDeviceSize levelAlignment = 16;
+
+static bool hasSrgb(BlockFormat format)
+{
+  return format != BlockFormat::bc4 && format != BlockFormat::bc5;
+}
+
+static uint32_t blocks(uint32_t texels)
+{
+  return (texels + blockSize - 1) / blockSize;
+}
+
+static Block readBlock(const Image& image, uint32_t blockX, uint32_t blockY)
+{
+  Block block{};
+  for (uint32_t y = 0; y < blockSize; ++y) {
+    const uint32_t row = std::min((blockY * blockSize) + y, image.height - 1);
+    for (uint32_t x = 0; x < blockSize; ++x) {
+      const uint32_t column = std::min((blockX * blockSize) + x, image.width - 1);
+      const size_t texel = ((size_t{row} * image.width) + column) * 4;
+      const size_t pixel = (size_t{y} * blockSize) + x;
+      block.r[pixel] = static_cast<float>(image.rgba[texel]);
+      block.g[pixel] = static_cast<float>(image.rgba[texel + 1]);
+      block.b[pixel] = static_cast<float>(image.rgba[texel + 2]);
+      block.a[pixel] = static_cast<float>(image.rgba[texel + 3]);
+    }
+  }
+  return block;
+}
+
+static void writeBlock(Image& image, uint32_t blockX, uint32_t blockY, const Block& block)
+{
+  const auto toByte = [](float value) { return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0F, 255.0F))); };
+  for (uint32_t y = 0; y < blockSize && (blockY * blockSize) + y < image.height; ++y) {
+    for (uint32_t x = 0; x < blockSize && (blockX * blockSize) + x < image.width; ++x) {
+      const size_t texel = ((size_t{(blockY * blockSize) + y} * image.width) + (blockX * blockSize) + x) * 4;
+      const size_t pixel = (size_t{y} * blockSize) + x;
+      image.rgba[texel] = toByte(block.r[pixel]);
+      image.rgba[texel + 1] = toByte(block.g[pixel]);
+      image.rgba[texel + 2] = toByte(block.b[pixel]);
+      image.rgba[texel + 3] = toByte(block.a[pixel]);
+    }
+  }
+}
+
+static void encodeBlock(BlockFormat format, const Block& block, std::span<std::byte> out)
+{
+  switch (format) {
+  case BlockFormat::bc1: encodeBc1(block, out.first<8>()); break;
+  case BlockFormat::bc3: encodeBc3(block, out.first<16>()); break;
+  case BlockFormat::bc4: encodeBc4(block.r, out.first<8>()); break;
+  case BlockFormat::bc5: encodeBc5(block, out.first<16>()); break;
+  case BlockFormat::bc7: encodeBc7(block, out.first<16>()); break;
+  }
+}
+
+static Block decodeBlock(BlockFormat format, std::span<const std::byte> in)
+{
+  switch (format) {
+  case BlockFormat::bc1: return decodeBc1(in.first<8>());
+  case BlockFormat::bc3: return decodeBc3(in.first<16>());
+  case BlockFormat::bc4: {
+    Block block{};
+    block.r = decodeBc4(in.first<8>());
+    block.a.fill(255.0F);
+    return block;
+  }
+  case BlockFormat::bc5: return decodeBc5(in.first<16>());
+  case BlockFormat::bc7: return decodeBc7(in.first<16>());
+  }
+  throw std::runtime_error("Unknown block format");
+}
+
+CookedTexture encode(std::span<const Image> levels, BlockFormat format, bool srgb)
+{
+  CookedTexture texture{.format = format, .srgb = srgb && hasSrgb(format), .levels = {}, .data = {}};
+  const size_t bytes = blockBytes(format);
+  VkDeviceSize size = 0;
+  for (const Image& level : levels) {
+    if (level.width == 0 || level.height == 0 || level.rgba.size() != size_t{level.width} * level.height * 4) {
+      throw std::runtime_error("Image size does not match its pixels");
+    }
+    const VkDeviceSize offset = (size + levelAlignment - 1) / levelAlignment * levelAlignment;
+    const VkDeviceSize levelSize = VkDeviceSize{blocks(level.width)} * blocks(level.height) * bytes;
+    texture.levels.push_back({.width = level.width, .height = level.height, .offset = offset, .size = levelSize});
+    size = offset + levelSize;
+  }
+  texture.data.resize(size);
+
+  for (size_t index = 0; index < levels.size(); ++index) {
+    const Image& level = levels[index];
+    const uint32_t columns = blocks(level.width);
+    const std::span<std::byte> out = std::span(texture.data).subspan(texture.levels[index].offset, texture.levels[index].size);
+    tbb::parallel_for(uint32_t{0}, blocks(level.height), [&](uint32_t blockY) {
+      for (uint32_t blockX = 0; blockX < columns; ++blockX) {
+        encodeBlock(format, readBlock(level, blockX, blockY), out.subspan(((size_t{blockY} * columns) + blockX) * bytes, bytes));
+      }
+    });
+  }
+  return texture;
+}
+
+CookedTexture cook(const Image& image, const CookOptions& options)
+{
+  const bool srgb = options.srgb && hasSrgb(options.format);
+  if (!options.mips) {
+    return encode(std::span(&image, 1), options.format, srgb);
+  }
+  return encode(generateMips(image, srgb), options.format, srgb);
+}
+
+Image decode(const CookedTexture& texture, size_t level)
+{
+  const MipLevel& mip = texture.levels.at(level);
+  Image image{.width = mip.width, .height = mip.height, .rgba = std::vector<uint8_t>(size_t{mip.width} * mip.height * 4)};
+  const size_t bytes = blockBytes(texture.format);
+  const uint32_t columns = blocks(mip.width);
+  const std::span<const std::byte> in = std::span(texture.data).subspan(mip.offset, mip.size);
+  tbb::parallel_for(uint32_t{0}, blocks(mip.height), [&](uint32_t blockY) {
+    for (uint32_t blockX = 0; blockX < columns; ++blockX) {
+      writeBlock(image, blockX, blockY, decodeBlock(texture.format, in.subspan(((size_t{blockY} * columns) + blockX) * bytes, bytes)));
+    }
+  });
+  return image;
+}
+
+VkFormat vkFormat(BlockFormat format, bool srgb)
+{
+  switch (format) {
+  case BlockFormat::bc1: return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+  case BlockFormat::bc3: return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+  case BlockFormat::bc4: return VK_FORMAT_BC4_UNORM_BLOCK;
+  case BlockFormat::bc5: return VK_FORMAT_BC5_UNORM_BLOCK;
+  case BlockFormat::bc7: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+  }
+  return VK_FORMAT_UNDEFINED;
+}
+
+std::vector<VkBufferImageCopy> copyRegions(const CookedTexture& texture, VkDeviceSize bufferOffset)
+{
+  std::vector<VkBufferImageCopy> regions;
+  regions.reserve(texture.levels.size());
+  for (uint32_t level = 0; level < texture.levels.size(); ++level) {
+    const MipLevel& mip = texture.levels[level];
+    regions.push_back({
+        .bufferOffset = bufferOffset + mip.offset,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = level, .baseArrayLayer = 0, .layerCount = 1},
+        .imageOffset = {.x = 0, .y = 0, .z = 0},
+        .imageExtent = {.width = mip.width, .height = mip.height, .depth = 1},
+    });
+  }
+  return regions;
+}
+
+std::string_view formatName(BlockFormat format)
+{
+  switch (format) {
+  case BlockFormat::bc1: return "BC1";
+  case BlockFormat::bc3: return "BC3";
+  case BlockFormat::bc4: return "BC4";
+  case BlockFormat::bc5: return "BC5";
+  case BlockFormat::bc7: return "BC7";
+  }
+  return "unknown";
+}
+
+uint32_t channelCount(BlockFormat format)
+{
+  switch (format) {
+  case BlockFormat::bc1: return 3;
+  case BlockFormat::bc4: return 1;
+  case BlockFormat::bc5: return 2;
+  case BlockFormat::bc3:
+  case BlockFormat::bc7: return 4;
+  }
+  return 4;
+}
+
+double psnr(const Image& reference, const Image& decoded, uint32_t channels)
+{
+  if (reference.width != decoded.width || reference.height != decoded.height || reference.rgba.size() != decoded.rgba.size()) {
+    throw std::runtime_error("PSNR of images of different sizes");
+  }
+  channels = std::clamp(channels, 1U, 4U);
+  double squared = 0.0;
+  for (size_t i = 0; i < reference.rgba.size(); ++i) {
+    if (i % 4 < channels) {
+      const double difference = static_cast<double>(reference.rgba[i]) - static_cast<double>(decoded.rgba[i]);
+      squared += difference * difference;
+    }
+  }
+  const double mse = squared / (static_cast<double>(reference.rgba.size() / 4) * channels);
+  if (mse <= 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+}  // namespace texture
@@ -0,0 +1,55 @@
+#ifndef LIB_TEXTURE_COOK_COOK
+#define LIB_TEXTURE_COOK_COOK
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "core/image.hpp"
+
+namespace texture {
+struct CookOptions {
+  BlockFormat format = BlockFormat::bc7;
+  // Color is sRGB encoded, ignored by BC4 and BC5 which have no sRGB formats
+  bool srgb = true;
+  bool mips = true;
+};
+
+struct MipLevel {
+  uint32_t width;
+  uint32_t height;
+  // Into CookedTexture::data
+  VkDeviceSize offset;
+  VkDeviceSize size;
+};
+
+// Blocks of every level in row order, tightly packed and each level 16 byte aligned. A staging buffer holding data
+// copies into the mip levels with copyRegions as it is
+struct CookedTexture {
+  BlockFormat format = BlockFormat::bc7;
+  bool srgb = false;
+  std::vector<MipLevel> levels;
+  std::vector<std::byte> data;
+};
+
+// Blocks are encoded in parallel per block row on TBB, edge blocks repeat the last row and column
+[[nodiscard]] CookedTexture encode(std::span<const Image> levels, BlockFormat format, bool srgb);
+[[nodiscard]] CookedTexture cook(const Image& image, const CookOptions& options = {});
+[[nodiscard]] Image decode(const CookedTexture& texture, size_t level);
+
+[[nodiscard]] VkFormat vkFormat(BlockFormat format, bool srgb);
+// One region per level, bufferOffset is where data starts in the staging buffer
+[[nodiscard]] std::vector<VkBufferImageCopy> copyRegions(const CookedTexture& texture, VkDeviceSize bufferOffset);
+
+[[nodiscard]] std::string_view formatName(BlockFormat format);
+// Channels the format stores, the ones psnr should compare
+[[nodiscard]] uint32_t channelCount(BlockFormat format);
+// Over the first channels of RGBA, infinity for equal images
+[[nodiscard]] double psnr(const Image& reference, const Image& decoded, uint32_t channels);
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_COOK_COOK */
@@ -0,0 +1,133 @@
+#include "mips.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "core/image.hpp"
+
+namespace texture {
+static constexpr size_t channels = 4;
+
+// RGBA in [0, 1], color linear when the image is sRGB
+struct FloatImage {
+  uint32_t width;
+  uint32_t height;
+  std::vector<float> rgba;
+};
+
+static std::array<float, 256> makeDecodeTable()
+{
+  std::array<float, 256> table{};
+  for (size_t i = 0; i < table.size(); ++i) {
+    const float value = static_cast<float>(i) / 255.0F;
+    table[i] = value <= 0.04045F ? value / 12.92F : std::pow((value + 0.055F) / 1.055F, 2.4F);
+  }
+  return table;
+}
+
+static float encodeSrgb(float value)
+{
+  return value <= 0.0031308F ? value * 12.92F : (1.055F * std::pow(value, 1.0F / 2.4F)) - 0.055F;
+}
+
+static FloatImage toFloat(const Image& image, bool srgb)
+{
+  static const std::array<float, 256> decode = makeDecodeTable();
+  FloatImage result{.width = image.width, .height = image.height, .rgba = std::vector<float>(image.rgba.size())};
+  tbb::parallel_for(uint32_t{0}, image.height, [&](uint32_t y) {
+    const size_t row = size_t{y} * image.width * channels;
+    for (size_t i = row; i < row + (size_t{image.width} * channels); ++i) {
+      result.rgba[i] = srgb && i % channels != 3 ? decode[image.rgba[i]] : static_cast<float>(image.rgba[i]) / 255.0F;
+    }
+  });
+  return result;
+}
+
+static Image toImage(const FloatImage& image, bool srgb)
+{
+  Image result{.width = image.width, .height = image.height, .rgba = std::vector<uint8_t>(image.rgba.size())};
+  tbb::parallel_for(uint32_t{0}, image.height, [&](uint32_t y) {
+    const size_t row = size_t{y} * image.width * channels;
+    for (size_t i = row; i < row + (size_t{image.width} * channels); ++i) {
+      const float value = srgb && i % channels != 3 ? encodeSrgb(image.rgba[i]) : image.rgba[i];
+      result.rgba[i] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * 255.0F));
+    }
+  });
+  return result;
+}
+
+// Source texels one output texel of a level half the size (rounded down) covers along one axis. Even sizes take 2
+// texels, odd ones 3 weighted by how much of each the footprint overlaps, so the last column or row is not dropped
+struct Footprint {
+  std::array<uint32_t, 3> texels;
+  std::array<float, 3> weights;
+  uint32_t count;
+};
+
+static Footprint footprint(uint32_t size, uint32_t output, uint32_t x)
+{
+  if (size == 1) {
+    return {.texels = {0, 0, 0}, .weights = {1.0F, 0.0F, 0.0F}, .count = 1};
+  }
+  if (size % 2 == 0) {
+    return {.texels = {x * 2, (x * 2) + 1, 0}, .weights = {0.5F, 0.5F, 0.0F}, .count = 2};
+  }
+  const auto total = static_cast<float>(size);
+  return {.texels = {x * 2, (x * 2) + 1, (x * 2) + 2},
+          .weights = {static_cast<float>(output - x) / total, static_cast<float>(output) / total, static_cast<float>(x + 1) / total},
+          .count = 3};
+}
+
+static FloatImage downsample(const FloatImage& image)
+{
+  FloatImage result{.width = std::max(image.width / 2, 1U), .height = std::max(image.height / 2, 1U), .rgba = {}};
+  result.rgba.resize(size_t{result.width} * result.height * channels);
+  tbb::parallel_for(uint32_t{0}, result.height, [&](uint32_t y) {
+    const Footprint rows = footprint(image.height, result.height, y);
+    for (uint32_t x = 0; x < result.width; ++x) {
+      const Footprint columns = footprint(image.width, result.width, x);
+      for (size_t c = 0; c < channels; ++c) {
+        float total = 0.0F;
+        for (uint32_t row = 0; row < rows.count; ++row) {
+          for (uint32_t column = 0; column < columns.count; ++column) {
+            const size_t texel = (size_t{rows.texels.at(row)} * image.width) + columns.texels.at(column);
+            total += rows.weights.at(row) * columns.weights.at(column) * image.rgba[(texel * channels) + c];
+          }
+        }
+        result.rgba[(((size_t{y} * result.width) + x) * channels) + c] = total;
+      }
+    }
+  });
+  return result;
+}
+
+uint32_t mipCount(uint32_t width, uint32_t height)
+{
+  uint32_t count = 1;
+  for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+    ++count;
+  }
+  return count;
+}
+
+std::vector<Image> generateMips(const Image& image, bool srgb)
+{
+  if (image.width == 0 || image.height == 0 || image.rgba.size() != size_t{image.width} * image.height * channels) {
+    throw std::runtime_error("Image size does not match its pixels");
+  }
+  std::vector<Image> levels = {image};
+  FloatImage level = toFloat(image, srgb);
+  for (uint32_t mip = 1; mip < mipCount(image.width, image.height); ++mip) {
+    level = downsample(level);
+    levels.push_back(toImage(level, srgb));
+  }
+  return levels;
+}
+}  // namespace texture
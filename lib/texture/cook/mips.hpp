@@ -0,0 +1,19 @@
+#ifndef LIB_TEXTURE_COOK_MIPS
+#define LIB_TEXTURE_COOK_MIPS
+
+#include <cstdint>
+#include <vector>
+
+#include "core/image.hpp"
+
+namespace texture {
+[[nodiscard]] uint32_t mipCount(uint32_t width, uint32_t height);
+
+// Full chain down to 1x1, level 0 is the image itself, sizes halve rounding down like Vulkan mip levels. Every level is
+// a box filter of the one above, 2 texels wide along even sizes and 3 weighted ones along odd sizes. sRGB colors are
+// averaged in linear light, alpha and non sRGB data as they are. Levels are filtered from the float result of the
+// level above, not from its 8 bit rounding. Parallel per row on TBB
+[[nodiscard]] std::vector<Image> generateMips(const Image& image, bool srgb);
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_COOK_MIPS */
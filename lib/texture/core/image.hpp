@@ -0,0 +1,37 @@
+#ifndef LIB_TEXTURE_CORE_IMAGE
+#define LIB_TEXTURE_CORE_IMAGE
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace texture {
+// 8 bit RGBA, rows tightly packed
+struct Image {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<uint8_t> rgba;
+};
+
+enum class BlockFormat : uint8_t {
+  // RGB, 4 color mode only, alpha is dropped
+  bc1,
+  // BC1 color and BC4 alpha
+  bc3,
+  // Red only
+  bc4,
+  // Red and green, normal maps
+  bc5,
+  // Mode 6: one subset, RGBA endpoints with 4 bit indices
+  bc7,
+};
+
+inline constexpr uint32_t blockSize = 4;
+
+[[nodiscard]] constexpr size_t blockBytes(BlockFormat format)
+{
+  return format == BlockFormat::bc1 || format == BlockFormat::bc4 ? 8 : 16;
+}
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_CORE_IMAGE */
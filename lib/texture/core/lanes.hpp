@@ -0,0 +1,161 @@
+#ifndef LIB_TEXTURE_CORE_LANES
+#define LIB_TEXTURE_CORE_LANES
+
+#include <array>
+#include <cstddef>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define TEXTURE_SIMD 1
+#else
+#define TEXTURE_SIMD 0
+#endif
+
+// The 16 pixels of a 4x4 block, one per lane. std::experimental::simd maps them onto what the target has, one AVX-512
+// register or two AVX2 ones with -march=native. Without it Lanes is a plain array with the same operations
+namespace texture {
+inline constexpr size_t blockPixels = 16;
+using Pixels = std::array<float, blockPixels>;
+
+#if TEXTURE_SIMD
+namespace stdx = std::experimental;
+using Lanes = stdx::fixed_size_simd<float, blockPixels>;
+using LaneMask = Lanes::mask_type;
+
+inline Lanes load(const Pixels& values)
+{
+  return Lanes(values.data(), stdx::element_aligned);
+}
+
+inline Pixels store(const Lanes& lanes)
+{
+  Pixels values{};
+  lanes.copy_to(values.data(), stdx::element_aligned);
+  return values;
+}
+
+inline Lanes min(const Lanes& a, const Lanes& b)
+{
+  return stdx::min(a, b);
+}
+
+inline Lanes max(const Lanes& a, const Lanes& b)
+{
+  return stdx::max(a, b);
+}
+
+inline float hmin(const Lanes& lanes)
+{
+  return stdx::hmin(lanes);
+}
+
+inline float hmax(const Lanes& lanes)
+{
+  return stdx::hmax(lanes);
+}
+
+inline float sum(const Lanes& lanes)
+{
+  return stdx::reduce(lanes);
+}
+
+// target = value in the lanes of mask
+inline void select(const LaneMask& mask, Lanes& target, const Lanes& value)
+{
+  stdx::where(mask, target) = value;
+}
+#else
+struct LaneMask {
+  std::array<bool, blockPixels> bits;
+};
+
+struct Lanes {
+  Pixels values{};
+
+  Lanes() = default;
+  // Broadcast, implicit like the simd one
+  Lanes(float value) { values.fill(value); }  // NOLINT(google-explicit-constructor)
+
+  friend Lanes operator+(const Lanes& a, const Lanes& b) { return apply(a, b, [](float x, float y) { return x + y; }); }
+  friend Lanes operator-(const Lanes& a, const Lanes& b) { return apply(a, b, [](float x, float y) { return x - y; }); }
+  friend Lanes operator*(const Lanes& a, const Lanes& b) { return apply(a, b, [](float x, float y) { return x * y; }); }
+  friend Lanes operator/(const Lanes& a, const Lanes& b) { return apply(a, b, [](float x, float y) { return x / y; }); }
+  friend LaneMask operator<(const Lanes& a, const Lanes& b)
+  {
+    LaneMask mask{};
+    for (size_t i = 0; i < blockPixels; ++i) {
+      mask.bits[i] = a.values[i] < b.values[i];
+    }
+    return mask;
+  }
+
+  template <typename Op>
+  static Lanes apply(const Lanes& a, const Lanes& b, Op op)
+  {
+    Lanes result;
+    for (size_t i = 0; i < blockPixels; ++i) {
+      result.values[i] = op(a.values[i], b.values[i]);
+    }
+    return result;
+  }
+};
+
+inline Lanes load(const Pixels& values)
+{
+  Lanes lanes;
+  lanes.values = values;
+  return lanes;
+}
+
+inline Pixels store(const Lanes& lanes)
+{
+  return lanes.values;
+}
+
+inline Lanes min(const Lanes& a, const Lanes& b)
+{
+  return Lanes::apply(a, b, [](float x, float y) { return x < y ? x : y; });
+}
+
+inline Lanes max(const Lanes& a, const Lanes& b)
+{
+  return Lanes::apply(a, b, [](float x, float y) { return x < y ? y : x; });
+}
+
+inline float hmin(const Lanes& lanes)
+{
+  float result = lanes.values[0];
+  for (const float value : lanes.values) {
+    result = value < result ? value : result;
+  }
+  return result;
+}
+
+inline float hmax(const Lanes& lanes)
+{
+  float result = lanes.values[0];
+  for (const float value : lanes.values) {
+    result = result < value ? value : result;
+  }
+  return result;
+}
+
+inline float sum(const Lanes& lanes)
+{
+  float result = 0.0F;
+  for (const float value : lanes.values) {
+    result += value;
+  }
+  return result;
+}
+
+inline void select(const LaneMask& mask, Lanes& target, const Lanes& value)
+{
+  for (size_t i = 0; i < blockPixels; ++i) {
+    target.values[i] = mask.bits[i] ? value.values[i] : target.values[i];
+  }
+}
+#endif
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_CORE_LANES */
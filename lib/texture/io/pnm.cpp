@@ -0,0 +1,98 @@
+#include "pnm.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/image.hpp"
+
+namespace texture {
+static uint32_t parseSize(const std::string& text)
+{
+  uint32_t value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size() || value == 0) {
+    throw std::runtime_error(std::format("Invalid size {}", text));
+  }
+  return value;
+}
+
+// Header tokens of PPM and PAM, comments skipped
+static std::string token(std::istream& stream)
+{
+  std::string word;
+  while (stream >> word) {
+    if (word[0] != '#') {
+      return word;
+    }
+    std::string comment;
+    std::getline(stream, comment);
+  }
+  throw std::runtime_error("Unexpected end of header");
+}
+
+Image loadImage(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to open {}", path.string()));
+  }
+  Image image;
+  uint32_t channels = 3;
+  uint32_t maxValue = 0;
+  const std::string magic = token(stream);
+  if (magic == "P6") {
+    image.width = parseSize(token(stream));
+    image.height = parseSize(token(stream));
+    maxValue = parseSize(token(stream));
+  }
+  else if (magic == "P7") {
+    for (std::string key = token(stream); key != "ENDHDR"; key = token(stream)) {
+      if (key == "WIDTH") {
+        image.width = parseSize(token(stream));
+      }
+      else if (key == "HEIGHT") {
+        image.height = parseSize(token(stream));
+      }
+      else if (key == "DEPTH") {
+        channels = parseSize(token(stream));
+      }
+      else if (key == "MAXVAL") {
+        maxValue = parseSize(token(stream));
+      }
+      else if (key == "TUPLTYPE") {
+        token(stream);
+      }
+    }
+  }
+  else {
+    throw std::runtime_error(std::format("{} is neither a binary PPM nor a PAM", path.string()));
+  }
+  if (maxValue != 255 || (channels != 1 && channels != 3 && channels != 4) || image.width == 0 || image.height == 0) {
+    throw std::runtime_error(std::format("{} is not an 8 bit gray, RGB or RGBA image", path.string()));
+  }
+  stream.get();
+
+  const size_t pixels = size_t{image.width} * image.height;
+  std::vector<char> raw(pixels * channels);
+  if (!stream.read(raw.data(), static_cast<std::streamsize>(raw.size()))) {
+    throw std::runtime_error(std::format("{} is truncated", path.string()));
+  }
+  image.rgba.resize(pixels * 4);
+  for (size_t pixel = 0; pixel < pixels; ++pixel) {
+    for (size_t channel = 0; channel < 4; ++channel) {
+      const size_t source = channels == 1 ? 0 : channel;
+      image.rgba[(pixel * 4) + channel] =
+          channel == 3 && channels != 4 ? uint8_t{255} : static_cast<uint8_t>(raw[(pixel * channels) + source]);
+    }
+  }
+  return image;
+}
+}  // namespace texture
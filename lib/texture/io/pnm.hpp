@@ -0,0 +1,13 @@
+#ifndef LIB_TEXTURE_IO_PNM
+#define LIB_TEXTURE_IO_PNM
+
+#include <filesystem>
+
+#include "core/image.hpp"
+
+namespace texture {
+// Binary PPM (P6) and PAM (P7) with 8 bit channels, PAM may be GRAYSCALE, RGB or RGB_ALPHA. Missing alpha is 255
+[[nodiscard]] Image loadImage(const std::filesystem::path& path);
+}  // namespace texture
+
+#endif /* LIB_TEXTURE_IO_PNM */
@@ -140,6 +140,34 @@ std::string result(VkResult result)
   }
 }
 
+std::string layout(VkImageLayout layout)
+{
+  switch (layout) {
+  case VK_IMAGE_LAYOUT_UNDEFINED:
+    return "UNDEFINED";
+  case VK_IMAGE_LAYOUT_GENERAL:
+    return "GENERAL";
+  case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+    return "COLOR_ATTACHMENT_OPTIMAL";
+  case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+    return "DEPTH_STENCIL_ATTACHMENT_OPTIMAL";
+  case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+    return "DEPTH_STENCIL_READ_ONLY_OPTIMAL";
+  case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+    return "SHADER_READ_ONLY_OPTIMAL";
+  case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+    return "TRANSFER_SRC_OPTIMAL";
+  case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+    return "TRANSFER_DST_OPTIMAL";
+  case VK_IMAGE_LAYOUT_PREINITIALIZED:
+    return "PREINITIALIZED";
+  case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+    return "PRESENT_SRC_KHR";
+  default:
+    return std::format("VkImageLayout({})", static_cast<int>(layout));
+  }
+}
+
 std::string vendor(uint32_t vendor)
 {
   constexpr uint32_t NVIDIA = 0x10de;
@@ -26,6 +26,8 @@ std::string string(VkExtent3D data);
 
 std::string result(VkResult result);
 
+std::string layout(VkImageLayout layout);
+
 std::string vendor(uint32_t vendor);
 
 std::string version(uint32_t version);
@@ -0,0 +1,39 @@
+#ifndef LIB_UTILS_HASH_HASH
+#define LIB_UTILS_HASH_HASH
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace utils {
+template <typename T>
+constexpr void hashCombine(size_t& seed, const T& value)
+{
+  static constexpr size_t golden = 0x9e3779b97f4a7c15ULL;
+  seed ^= std::hash<T>{}(value) + golden + (seed << 6U) + (seed >> 2U);
+}
+
+template <typename... T>
+constexpr size_t hash(const T&... values)
+{
+  size_t seed = 0;
+  (hashCombine(seed, values), ...);
+  return seed;
+}
+
+// FNV-1a over raw bytes, stable between runs and builds unlike std::hash
+constexpr uint64_t fnv1a(std::span<const std::byte> bytes)
+{
+  constexpr uint64_t offset = 0xcbf29ce484222325ULL;
+  constexpr uint64_t prime = 0x100000001b3ULL;
+  uint64_t hash = offset;
+  for (const std::byte byte : bytes) {
+    hash ^= static_cast<uint64_t>(byte);
+    hash *= prime;
+  }
+  return hash;
+}
+}  // namespace utils
+
+#endif /* LIB_UTILS_HASH_HASH */
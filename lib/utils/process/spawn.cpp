@@ -0,0 +1,78 @@
+#include "spawn.hpp"
+
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <cerrno>
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;  // NOLINT(readability-redundant-declaration)
+#endif
+
+namespace utils {
+#ifdef _WIN32
+int run(std::span<const std::string> args)
+{
+  if (args.empty()) {
+    throw std::runtime_error("No program to run");
+  }
+  // The CRT joins the arguments into one command line, arguments with spaces are quoted here
+  std::vector<std::string> quoted;
+  quoted.reserve(args.size());
+  for (const std::string& arg : args) {
+    quoted.push_back(arg.find_first_of(" \t") == std::string::npos ? arg : std::format("\"{}\"", arg));
+  }
+  std::vector<const char*> argv;
+  argv.reserve(quoted.size() + 1);
+  for (const std::string& arg : quoted) {
+    argv.push_back(arg.c_str());
+  }
+  argv.push_back(nullptr);
+
+  const intptr_t status = _spawnvp(_P_WAIT, args.front().c_str(), argv.data());
+  if (status < 0) {
+    throw std::runtime_error(std::format("Failed to run {}! error: {}", args.front(), std::generic_category().message(errno)));
+  }
+  return static_cast<int>(status);
+}
+#else
+int run(std::span<const std::string> args)
+{
+  if (args.empty()) {
+    throw std::runtime_error("No program to run");
+  }
+  // posix_spawn takes non-const strings for historical reasons, it does not write to them
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid = 0;
+  if (const int error = posix_spawnp(&pid, argv.front(), nullptr, nullptr, argv.data(), environ); error != 0) {
+    throw std::runtime_error(std::format("Failed to run {}! error: {}", args.front(), std::generic_category().message(error)));
+  }
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      throw std::runtime_error(std::format("Failed to wait for {}! error: {}", args.front(), std::generic_category().message(errno)));
+    }
+  }
+  if (!WIFEXITED(status)) {
+    throw std::runtime_error(std::format("{} did not exit normally", args.front()));
+  }
+  return WEXITSTATUS(status);
+}
+#endif
+}  // namespace utils
@@ -0,0 +1,13 @@
+#ifndef LIB_UTILS_PROCESS_SPAWN
+#define LIB_UTILS_PROCESS_SPAWN
+
+#include <span>
+#include <string>
+
+namespace utils {
+// Runs args[0], searched in PATH, with the remaining arguments passed as they are, no shell parses them.
+// Returns the exit code, throws when the process can not be started or did not exit normally
+[[nodiscard]] int run(std::span<const std::string> args);
+}  // namespace utils
+
+#endif /* LIB_UTILS_PROCESS_SPAWN */
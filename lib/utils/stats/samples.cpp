@@ -0,0 +1,91 @@
+#include "samples.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+Samples::Samples(size_t window)
+{
+  assert(window > 0);
+  _window.reserve(window);
+}
+
+void Samples::add(double value)
+{
+  const std::scoped_lock lock(_mutex);
+  if (_window.size() < _window.capacity()) {
+    _window.push_back(value);
+  }
+  else {
+    _window.at(_next) = value;
+  }
+  _next = (_next + 1) % _window.capacity();
+
+  _min = _count == 0 ? value : std::min(_min, value);
+  _max = _count == 0 ? value : std::max(_max, value);
+  _total += value;
+  ++_count;
+}
+
+void Samples::reset()
+{
+  const std::scoped_lock lock(_mutex);
+  _window.clear();
+  _next = 0;
+  _count = 0;
+  _total = 0;
+  _min = 0;
+  _max = 0;
+}
+
+size_t Samples::count() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _count;
+}
+
+double Samples::total() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _total;
+}
+
+double Samples::mean() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _count == 0 ? 0 : _total / static_cast<double>(_count);
+}
+
+double Samples::min() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _min;
+}
+
+double Samples::max() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _max;
+}
+
+double Samples::percentile(double fraction) const
+{
+  std::vector<double> sorted;
+  {
+    const std::scoped_lock lock(_mutex);
+    sorted = _window;
+  }
+  if (sorted.empty()) {
+    return 0;
+  }
+
+  const auto rank = static_cast<size_t>(std::lround(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(sorted.size() - 1)));
+  auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(rank);
+  std::ranges::nth_element(sorted, nth);
+  return *nth;
+}
+}  // namespace utils
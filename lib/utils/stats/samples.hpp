@@ -0,0 +1,43 @@
+#ifndef LIB_UTILS_STATS_SAMPLES
+#define LIB_UTILS_STATS_SAMPLES
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+class Samples {
+public:
+  static constexpr size_t defaultWindow = 4096;
+
+  Samples(const Samples&) = delete;
+  Samples(Samples&&) = delete;
+  Samples& operator=(const Samples&) = delete;
+  Samples& operator=(Samples&&) = delete;
+
+  explicit Samples(size_t window = defaultWindow);
+  ~Samples() = default;
+
+  void add(double value);
+  void reset();
+
+  [[nodiscard]] size_t count() const;
+  [[nodiscard]] double total() const;
+  [[nodiscard]] double mean() const;
+  [[nodiscard]] double min() const;
+  [[nodiscard]] double max() const;
+  // Percentile over the last `window` samples, fraction in [0, 1]
+  [[nodiscard]] double percentile(double fraction) const;
+
+private:
+  mutable std::mutex _mutex;
+  std::vector<double> _window;
+  size_t _next = 0;
+  size_t _count = 0;
+  double _total = 0;
+  double _min = 0;
+  double _max = 0;
+};
+}  // namespace utils
+
+#endif /* LIB_UTILS_STATS_SAMPLES */
@@ -1,15 +1,41 @@
 #include "api.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <format>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "GLFW/glfw3.h"
+
 #include "api_info.hpp"
+#include "assets/asset_benchmark.hpp"
+#include "command/record_benchmark.hpp"
+#include "compute/async_compute.hpp"
+#include "compute/primitives_benchmark.hpp"
+#include "culling/culling_benchmark.hpp"
+#include "culling/gpu_culling.hpp"
+#include "culling/occlusion_benchmark.hpp"
 #include "debugger/debugger.hpp"
+#include "descriptor/descriptor_benchmark.hpp"
+#include "format/string.hpp"
+#include "format/table.hpp"
+#include "geometry/geometry_benchmark.hpp"
 #include "init_glfw/init.hpp"
 #include "init_vulkan/init.hpp"
 #include "init_vulkan/init_info.hpp"
+#include "pipeline/pipeline_cache.hpp"
+#include "render/render_thread.hpp"
+#include "rendering/render_path.hpp"
+#include "rendering/rendering_benchmark.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/shader_variants.hpp"
 #include "window/window.hpp"
 
 namespace vulkan {
@@ -33,13 +59,31 @@ static VulkanDebugger createDebugger(const VulkanInfo& info)
   return VulkanDebugger(info);
 }
 
+static std::string pathName(IndirectPath path)
+{
+  switch (path) {
+  case IndirectPath::indirectCount: return "indirect count";
+  case IndirectPath::multiDraw: return "multi draw";
+  case IndirectPath::singleDraws: return "single draws";
+  }
+  return "unknown";
+}
+
 VulkanApi::VulkanApi(const VulkanApiInfo& info)
     : _glfw(InitGlfw::createInit()),
       _vulkan(InitVulkan::createInit(info.vulkanInitInfo)),
 #ifdef DEBUG
       _debugger(createDebugger(info.vulkanInitInfo)),
 #endif
-      _windows(createWindows(info))
+      _windows(createWindows(info)),
+      _recordBenchmark(info.recordBenchmark),
+      _descriptorBenchmark(info.descriptorBenchmark),
+      _renderingBenchmark(info.renderingBenchmark),
+      _primitivesBenchmark(info.primitivesBenchmark),
+      _cullingBenchmark(info.cullingBenchmark),
+      _geometryBenchmark(info.geometryBenchmark),
+      _assetBenchmark(info.assetBenchmark),
+      _occlusionBenchmark(info.occlusionBenchmark)
 {
 }
 
@@ -69,4 +113,414 @@ std::shared_ptr<VulkanApi> VulkanApi::getApi()
   throw std::runtime_error("VulkanInit not initialized");
 }
 
-}  // namespace vulkan
\ No newline at end of file
+void VulkanApi::run()
+{
+  static constexpr double eventTimeout = 0.1;
+  const Window& mainWindow = _windows.front();
+  if (_recordBenchmark) {
+    showRecordScaling();
+  }
+  if (_descriptorBenchmark) {
+    showDescriptorThroughput();
+  }
+  if (_renderingBenchmark) {
+    showRendering();
+  }
+  if (_primitivesBenchmark) {
+    showPrimitives();
+    showSorts();
+  }
+  if (_cullingBenchmark) {
+    showCulling();
+  }
+  if (_geometryBenchmark) {
+    showGeometry();
+  }
+  if (_assetBenchmark) {
+    showAssets();
+  }
+  if (_occlusionBenchmark) {
+    showOcclusion();
+  }
+  while (!mainWindow.shouldClose()) {
+    glfwWaitEventsTimeout(eventTimeout);
+  }
+
+  showFrameStats();
+}
+
+void VulkanApi::showFrameStats() const
+{
+  static constexpr auto ms = [](double value) { return std::format("{:.3f}", value); };
+  static constexpr auto hitRate = [](const PipelineCacheStats& stats) {
+    const uint64_t total = stats.hits + stats.misses;
+    return total > 0 ? std::format("{:.1f}%", 100.0 * static_cast<double>(stats.hits) / static_cast<double>(total)) : std::string("-");
+  };
+  std::vector<const Window*> windows;
+  for (const auto& window : _windows) {
+    windows.push_back(&window);
+  }
+  // clang-format off
+  utils::table<const Window*>("Pipeline cache", windows, std::vector<utils::TableColumn<const Window*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const Window* ele) { return ele->getTitle(); }},
+    {.title = "Load", .align = utils::Align::left, .toString = [](const Window* ele) { return ele->getDevice().getPipelineCache().getStats().load; }},
+    {.title = "Load [ms]", .toString = [](const Window* ele) { return ms(ele->getDevice().getPipelineCache().getStats().loadMs); }},
+    {.title = "Loaded [KB]", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getPipelineCache().getStats().loadedBytes / 1024); }},
+    {.title = "Hits", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getPipelineCache().getStats().hits); }},
+    {.title = "Misses", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getPipelineCache().getStats().misses); }},
+    {.title = "Hit rate", .toString = [](const Window* ele) { return hitRate(ele->getDevice().getPipelineCache().getStats()); }},
+    {.title = "Compile [ms]", .toString = [](const Window* ele) { return ms(ele->getDevice().getPipelineCache().getStats().compileMs); }},
+    {.title = "Saves", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getPipelineCache().getStats().saves); }},
+    {.title = "Saved [KB]", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getPipelineCache().getStats().savedBytes / 1024); }},
+  }});
+  // clang-format on
+
+  // clang-format off
+  utils::table<const Window*>("Layout cache", windows, std::vector<utils::TableColumn<const Window*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const Window* ele) { return ele->getTitle(); }},
+    {.title = "Requests", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getLayoutCache().getStats().requests); }},
+    {.title = "Hits", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getLayoutCache().getStats().hits); }},
+    {.title = "Set layouts", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getLayoutCache().getStats().setLayouts); }},
+    {.title = "Pipeline layouts", .toString = [](const Window* ele) { return utils::number(ele->getDevice().getLayoutCache().getStats().pipelineLayouts); }},
+  }});
+  // clang-format on
+
+  std::vector<const RenderThread*> renderers;
+  for (const auto& window : _windows) {
+    if (const RenderThread* renderer = window.getRenderer(); renderer != nullptr) {
+      renderers.push_back(renderer);
+    }
+  }
+  if (renderers.empty()) {
+    return;
+  }
+
+  // clang-format off
+  utils::table<const RenderThread*>("Frame time per window [ms]", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Path", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return std::string(toString(ele->getRendering().getPath())); }},
+    {.title = "Passes", .toString = [](const RenderThread* ele) { return utils::number(ele->getPasses()); }},
+    {.title = "Framebuffers", .toString = [](const RenderThread* ele) { return utils::number(ele->getRendering().getFramebufferCount()); }},
+    {.title = "Frames", .toString = [](const RenderThread* ele) { return utils::number(ele->getFrameTime().count()); }},
+    {.title = "FPS", .toString = [](const RenderThread* ele) { return ms(ele->getFrameTime().mean() > 0 ? 1000.0 / ele->getFrameTime().mean() : 0.0); }},
+    {.title = "mean", .toString = [](const RenderThread* ele) { return ms(ele->getFrameTime().mean()); }},
+    {.title = "p50", .toString = [](const RenderThread* ele) { return ms(ele->getFrameTime().percentile(0.5)); }},
+    {.title = "p99", .toString = [](const RenderThread* ele) { return ms(ele->getFrameTime().percentile(0.99)); }},
+    {.title = "max", .toString = [](const RenderThread* ele) { return ms(ele->getFrameTime().max()); }},
+    {.title = "cpu mean", .toString = [](const RenderThread* ele) { return ms(ele->getCpuTime().mean()); }},
+  }});
+  // clang-format on
+
+  static constexpr double megabyte = 1024.0 * 1024.0;
+  static constexpr auto mb = [](size_t bytes) { return std::format("{:.3f}", static_cast<double>(bytes) / megabyte); };
+  // clang-format off
+  utils::table<const RenderThread*>("Render graph", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Passes", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().passes); }},
+    {.title = "Culled", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().culled); }},
+    {.title = "Barrier batches", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().barrierBatches); }},
+    {.title = "Image barriers", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().imageBarriers); }},
+    {.title = "Buffer barriers", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().bufferBarriers); }},
+    {.title = "Transient [MB]", .toString = [](const RenderThread* ele) { return mb(ele->getGraphStats().transientBytes); }},
+    {.title = "Aliased [MB]", .toString = [](const RenderThread* ele) { return mb(ele->getGraphStats().aliasedBytes); }},
+    {.title = "Cache hits", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().cacheHits); }},
+    {.title = "Compiles", .toString = [](const RenderThread* ele) { return utils::number(ele->getGraphStats().cacheMisses); }},
+  }});
+  // clang-format on
+
+  // clang-format off
+  utils::table<const RenderThread*>("Command buffers", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Frame allocated", .toString = [](const RenderThread* ele) { return utils::number(ele->getCommands().getLastFrame().allocated); }},
+    {.title = "Frame reused", .toString = [](const RenderThread* ele) { return utils::number(ele->getCommands().getLastFrame().reused); }},
+    {.title = "Allocated", .toString = [](const RenderThread* ele) { return utils::number(ele->getCommands().getTotal().allocated); }},
+    {.title = "Reused", .toString = [](const RenderThread* ele) { return utils::number(ele->getCommands().getTotal().reused); }},
+    {.title = "Draws", .toString = [](const RenderThread* ele) { return utils::number(ele->getDraws()); }},
+    {.title = "Threads", .toString = [](const RenderThread* ele) { return utils::number(ele->getRecorder().getThreads()); }},
+    {.title = "Chunks", .toString = [](const RenderThread* ele) { return utils::number(ele->getRecorder().getChunks()); }},
+    {.title = "Item [ns]", .toString = [](const RenderThread* ele) { return std::format("{:.1f}", ele->getRecorder().getItemCost()); }},
+    {.title = "record mean [ms]", .toString = [](const RenderThread* ele) { return ms(ele->getRecorder().getRecordTime().mean()); }},
+  }});
+  // clang-format on
+
+  // clang-format off
+  utils::table<const RenderThread*>("Descriptors", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Sets", .toString = [](const RenderThread* ele) { return utils::number(ele->getDescriptorStats().sets); }},
+    {.title = "Pools", .toString = [](const RenderThread* ele) { return utils::number(ele->getDescriptorStats().pools); }},
+    {.title = "Recoveries", .toString = [](const RenderThread* ele) { return utils::number(ele->getDescriptorStats().recoveries); }},
+    {.title = "Resets", .toString = [](const RenderThread* ele) { return utils::number(ele->getDescriptorStats().resets); }},
+  }});
+  // clang-format on
+
+  // clang-format off
+  utils::table<const RenderThread*>("Pipeline compiler [ms]", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Mode", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return std::string(ele->getPipelines().usesLibraries() ? "libraries" : "full"); }},
+    {.title = "Compiled", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getCompiled()); }},
+    {.title = "Pending", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getPending()); }},
+    {.title = "Libraries", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getLibraries()); }},
+    {.title = "Fallbacks", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getFallbackUses()); }},
+    {.title = "Hitches", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getHitches()); }},
+    {.title = "Failed", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getFailures()); }},
+    {.title = "usable p50", .toString = [](const RenderThread* ele) { return ms(ele->getPipelines().getUsableTime().percentile(0.5)); }},
+    {.title = "usable p99", .toString = [](const RenderThread* ele) { return ms(ele->getPipelines().getUsableTime().percentile(0.99)); }},
+    {.title = "optimized p50", .toString = [](const RenderThread* ele) { return ms(ele->getPipelines().getOptimizedTime().percentile(0.5)); }},
+    {.title = "optimized p99", .toString = [](const RenderThread* ele) { return ms(ele->getPipelines().getOptimizedTime().percentile(0.99)); }},
+  }});
+  // clang-format on
+
+  static constexpr auto tableHitRate = [](const PipelineTableStats& stats) {
+    return stats.requests > 0 ? std::format("{:.1f}%", 100.0 * static_cast<double>(stats.hits) / static_cast<double>(stats.requests)) : std::string("-");
+  };
+  // clang-format off
+  utils::table<const RenderThread*>("Pipeline table", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Requests", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getTableStats().requests); }},
+    {.title = "Unique", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getTableStats().unique); }},
+    {.title = "Hits", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getTableStats().hits); }},
+    {.title = "Hit rate", .toString = [](const RenderThread* ele) { return tableHitRate(ele->getPipelines().getTableStats()); }},
+    {.title = "Overflows", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getTableStats().overflows); }},
+    {.title = "Memory [KB]", .toString = [](const RenderThread* ele) { return utils::number(ele->getPipelines().getTableStats().bytes / 1024); }},
+  }});
+  // clang-format on
+
+  // clang-format off
+  utils::table<const RenderThread*>("Shader variants", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Precompiled", .toString = [](const RenderThread* ele) { return utils::number(ele->getVariants().getStats().precompiled); }},
+    {.title = "Specialized", .toString = [](const RenderThread* ele) { return utils::number(ele->getVariants().getStats().specialized); }},
+    {.title = "Frozen modules", .toString = [](const RenderThread* ele) { return utils::number(ele->getVariants().getStats().modules); }},
+    {.title = "Embedded", .toString = [](const RenderThread*) { return utils::number(getEmbeddedVariants().size()); }},
+  }});
+  // clang-format on
+
+  std::vector<const RenderThread*> computing = renderers;
+  std::erase_if(computing, [](const RenderThread* renderer) { return renderer->getCompute() == nullptr; });
+  if (!computing.empty()) {
+    static constexpr auto queueKind = [](const AsyncCompute* compute) {
+      if (compute->isDedicated()) {
+        return "dedicated family";
+      }
+      return compute->isParallel() ? "second graphics queue" : "graphics queue";
+    };
+    // clang-format off
+    utils::table<const RenderThread*>("Async compute [ms]", computing, std::vector<utils::TableColumn<const RenderThread*>>{{
+      {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+      {.title = "Queue", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return std::format("{}:{} {}", ele->getCompute()->getFamily(), ele->getCompute()->getQueueIndex(), queueKind(ele->getCompute())); }},
+      {.title = "Jobs", .toString = [](const RenderThread* ele) { return utils::number(ele->getCompute()->getJobs()); }},
+      {.title = "gpu mean", .toString = [](const RenderThread* ele) { return ms(ele->getCompute()->getGpuTime().mean()); }},
+      {.title = "gpu p99", .toString = [](const RenderThread* ele) { return ms(ele->getCompute()->getGpuTime().percentile(0.99)); }},
+      {.title = "latency mean", .toString = [](const RenderThread* ele) { return ms(ele->getCompute()->getLatency().mean()); }},
+      {.title = "latency p99", .toString = [](const RenderThread* ele) { return ms(ele->getCompute()->getLatency().percentile(0.99)); }},
+    }});
+    // clang-format on
+  }
+
+  std::erase_if(renderers, [](const RenderThread* renderer) { return renderer->getCapture() == nullptr; });
+  if (renderers.empty()) {
+    return;
+  }
+
+  // clang-format off
+  utils::table<const RenderThread*>("Capture throughput", renderers, std::vector<utils::TableColumn<const RenderThread*>>{{
+    {.title = "Window", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getName(); }},
+    {.title = "Target", .align = utils::Align::left, .toString = [](const RenderThread* ele) { return ele->getCapture()->getPath().string(); }},
+    {.title = "Frames", .toString = [](const RenderThread* ele) { return utils::number(ele->getCapture()->getFrames()); }},
+    {.title = "Dropped", .toString = [](const RenderThread* ele) { return utils::number(ele->getCapture()->getDropped()); }},
+    {.title = "FPS", .toString = [](const RenderThread* ele) { return ms(ele->getCapture()->getFps()); }},
+    {.title = "write mean [ms]", .toString = [](const RenderThread* ele) { return ms(ele->getCapture()->getWriteTime().mean()); }},
+    {.title = "readback p50 [ms]", .toString = [](const RenderThread* ele) { return ms(ele->getReadback()->getLatency().percentile(0.5)); }},
+    {.title = "readback [MB]", .toString = [](const RenderThread* ele) { return mb(ele->getReadback()->getBytes()); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showRecordScaling() const
+{
+  static constexpr std::array<uint32_t, 3> draws = {10'000, 100'000, 1'000'000};
+  static constexpr uint32_t repeats = 5;
+  std::vector<uint32_t> threads;
+  const uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1U);
+  for (uint32_t count = 1; count < hardware; count *= 2) {
+    threads.push_back(count);
+  }
+  threads.push_back(hardware);
+
+  const std::vector<RecordScaling> results = benchmarkRecording(_windows.front().getDevice(), draws, threads, repeats);
+  // Speedup against the single thread run of the same draw count, which comes first
+  const auto single = [&results](const RecordScaling& result) {
+    const auto found = std::ranges::find(results, result.draws, &RecordScaling::draws);
+    return result.recordMs > 0.0 ? found->recordMs / result.recordMs : 0.0;
+  };
+
+  std::vector<const RecordScaling*> rows;
+  rows.reserve(results.size());
+  for (const auto& result : results) {
+    rows.push_back(&result);
+  }
+  // Grouped by draw count, the benchmark runs them grouped by thread count
+  std::ranges::stable_sort(rows, {}, [](const RecordScaling* row) { return row->draws; });
+
+  // clang-format off
+  utils::table<const RecordScaling*>("Parallel recording", rows, std::vector<utils::TableColumn<const RecordScaling*>>{{
+    {.title = "Draws", .toString = [](const RecordScaling* ele) { return utils::number(ele->draws); }},
+    {.title = "Threads", .toString = [](const RecordScaling* ele) { return utils::number(ele->threads); }},
+    {.title = "Chunks", .toString = [](const RecordScaling* ele) { return utils::number(ele->chunks); }},
+    {.title = "record [ms]", .toString = [](const RecordScaling* ele) { return std::format("{:.3f}", ele->recordMs); }},
+    {.title = "Mdraws/s", .toString = [](const RecordScaling* ele) { return std::format("{:.2f}", ele->recordMs > 0.0 ? ele->draws / ele->recordMs / 1000.0 : 0.0); }},
+    {.title = "Speedup", .toString = [&single](const RecordScaling* ele) { return std::format("{:.2f}x", single(*ele)); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showDescriptorThroughput() const
+{
+  static constexpr uint32_t updates = 1'000'000;
+  const std::vector<DescriptorThroughput> results = benchmarkDescriptors(_windows.front().getDevice(), updates);
+
+  // clang-format off
+  utils::table<DescriptorThroughput>("Descriptor updates", results, std::vector<utils::TableColumn<DescriptorThroughput>>{{
+    {.title = "Method", .align = utils::Align::left, .toString = [](const DescriptorThroughput& ele) { return ele.method; }},
+    {.title = "Updates", .toString = [](const DescriptorThroughput& ele) { return utils::number(ele.updates); }},
+    {.title = "total [ms]", .toString = [](const DescriptorThroughput& ele) { return std::format("{:.3f}", ele.ms); }},
+    {.title = "Mupdates/s", .toString = [](const DescriptorThroughput& ele) { return std::format("{:.2f}", ele.ms > 0.0 ? ele.updates / ele.ms / 1000.0 : 0.0); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showRendering() const
+{
+  static constexpr std::array<uint32_t, 3> draws = {1, 100, 10'000};
+  static constexpr uint32_t passes = 100;
+  static constexpr uint32_t repeats = 5;
+  const std::vector<RenderingThroughput> results = benchmarkRendering(_windows.front().getDevice(), draws, passes, repeats);
+
+  // clang-format off
+  utils::table<RenderingThroughput>("Rendering paths", results, std::vector<utils::TableColumn<RenderingThroughput>>{{
+    {.title = "Path", .align = utils::Align::left, .toString = [](const RenderingThroughput& ele) { return std::string(toString(ele.path)); }},
+    {.title = "Passes", .toString = [](const RenderingThroughput& ele) { return utils::number(ele.passes); }},
+    {.title = "Draws/pass", .toString = [](const RenderingThroughput& ele) { return utils::number(ele.drawsPerPass); }},
+    {.title = "best [ms]", .toString = [](const RenderingThroughput& ele) { return std::format("{:.3f}", ele.ms); }},
+    {.title = "Mdraws/s", .toString = [](const RenderingThroughput& ele) { return std::format("{:.2f}", ele.ms > 0.0 ? static_cast<double>(ele.passes) * ele.drawsPerPass / ele.ms / 1000.0 : 0.0); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showPrimitives() const
+{
+  static constexpr std::array<uint32_t, 3> counts = {1'000, 1'000'000, 16'000'000};
+  static constexpr uint32_t repeats = 5;
+  const std::vector<PrimitiveThroughput> results = benchmarkPrimitives(_windows.front().getDevice(), counts, repeats);
+
+  // clang-format off
+  utils::table<PrimitiveThroughput>("Compute primitives", results, std::vector<utils::TableColumn<PrimitiveThroughput>>{{
+    {.title = "Primitive", .align = utils::Align::left, .toString = [](const PrimitiveThroughput& ele) { return ele.primitive; }},
+    {.title = "Elements", .toString = [](const PrimitiveThroughput& ele) { return utils::number(ele.count); }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const PrimitiveThroughput& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "best [ms]", .toString = [](const PrimitiveThroughput& ele) { return std::format("{:.3f}", ele.ms); }},
+    {.title = "Gelements/s", .toString = [](const PrimitiveThroughput& ele) { return std::format("{:.2f}", ele.ms > 0.0 ? ele.count / ele.ms / 1'000'000.0 : 0.0); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showSorts() const
+{
+  static constexpr std::array<uint32_t, 4> counts = {1'000, 100'000, 1'000'000, 16'000'000};
+  static constexpr uint32_t repeats = 3;
+  const std::vector<PrimitiveThroughput> results = benchmarkSorts(_windows.front().getDevice(), counts, repeats);
+
+  // clang-format off
+  utils::table<PrimitiveThroughput>("Radix sort", results, std::vector<utils::TableColumn<PrimitiveThroughput>>{{
+    {.title = "Sort", .align = utils::Align::left, .toString = [](const PrimitiveThroughput& ele) { return ele.primitive; }},
+    {.title = "Keys", .toString = [](const PrimitiveThroughput& ele) { return utils::number(ele.count); }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const PrimitiveThroughput& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "best [ms]", .toString = [](const PrimitiveThroughput& ele) { return std::format("{:.3f}", ele.ms); }},
+    {.title = "Mkeys/s", .toString = [](const PrimitiveThroughput& ele) { return std::format("{:.2f}", ele.ms > 0.0 ? ele.count / ele.ms / 1'000.0 : 0.0); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showCulling() const
+{
+  static constexpr std::array<uint32_t, 2> instances = {100'000, 1'000'000};
+  static constexpr uint32_t repeats = 5;
+  const std::vector<CullingThroughput> results = benchmarkCulling(_windows.front().getDevice(), instances, repeats);
+
+  // clang-format off
+  utils::table<CullingThroughput>("GPU culling", results, std::vector<utils::TableColumn<CullingThroughput>>{{
+    {.title = "Instances", .toString = [](const CullingThroughput& ele) { return utils::number(ele.instances); }},
+    {.title = "Path", .align = utils::Align::left, .toString = [](const CullingThroughput& ele) { return pathName(ele.path); }},
+    {.title = "Visible", .toString = [](const CullingThroughput& ele) { return utils::number(ele.visible); }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const CullingThroughput& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "GPU cull [ms]", .toString = [](const CullingThroughput& ele) { return std::format("{:.3f}", ele.gpuMs); }},
+    {.title = "Minstances/s", .toString = [](const CullingThroughput& ele) { return std::format("{:.2f}", ele.gpuMs > 0.0 ? ele.instances / ele.gpuMs / 1'000.0 : 0.0); }},
+    {.title = "GPU record [ms]", .toString = [](const CullingThroughput& ele) { return std::format("{:.3f}", ele.recordMs); }},
+    {.title = "CPU cull+record [ms]", .toString = [](const CullingThroughput& ele) { return std::format("{:.3f}", ele.cpuMs); }},
+    {.title = "Draw calls", .toString = [](const CullingThroughput& ele) { return utils::number(ele.drawCalls); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showGeometry() const
+{
+  const std::vector<GeometryReport> results = benchmarkGeometry(_windows.front().getDevice());
+
+  // clang-format off
+  utils::table<GeometryReport>("Geometry mega-buffer", results, std::vector<utils::TableColumn<GeometryReport>>{{
+    {.title = "Stage", .align = utils::Align::left, .toString = [](const GeometryReport& ele) { return ele.stage; }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const GeometryReport& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "Items", .toString = [](const GeometryReport& ele) { return utils::number(ele.items); }},
+    {.title = "Meshes", .toString = [](const GeometryReport& ele) { return utils::number(ele.meshes); }},
+    {.title = "Deduplicated", .toString = [](const GeometryReport& ele) { return utils::number(ele.deduplicated); }},
+    {.title = "Pages", .toString = [](const GeometryReport& ele) { return utils::number(ele.pages); }},
+    {.title = "Used [KB]", .toString = [](const GeometryReport& ele) { return std::format("{} / {}", utils::number(ele.used / 1024), utils::number(ele.capacity / 1024)); }},
+    {.title = "Free ranges", .toString = [](const GeometryReport& ele) { return utils::number(ele.freeRanges); }},
+    {.title = "Moved [KB]", .toString = [](const GeometryReport& ele) { return utils::number(ele.bytesMoved / 1024); }},
+    {.title = "Draws naive", .toString = [](const GeometryReport& ele) { return utils::number(ele.naiveDrawCalls); }},
+    {.title = "Draws", .toString = [](const GeometryReport& ele) { return utils::number(ele.drawCalls); }},
+    {.title = "Binds naive", .toString = [](const GeometryReport& ele) { return utils::number(ele.naiveBinds); }},
+    {.title = "Binds", .toString = [](const GeometryReport& ele) { return utils::number(ele.binds); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showAssets() const
+{
+  const std::vector<AssetReport> results = benchmarkAssets(_windows.front().getDevice());
+
+  // clang-format off
+  utils::table<AssetReport>("Asset loading", results, std::vector<utils::TableColumn<AssetReport>>{{
+    {.title = "Source", .align = utils::Align::left, .toString = [](const AssetReport& ele) { return ele.source; }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const AssetReport& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "Files", .toString = [](const AssetReport& ele) { return utils::number(ele.filesOpened); }},
+    {.title = "Host buffers", .toString = [](const AssetReport& ele) { return utils::number(ele.hostBuffers); }},
+    {.title = "Stored [KB]", .toString = [](const AssetReport& ele) { return utils::number(ele.storedBytes / 1024); }},
+    {.title = "Open [ms]", .toString = [](const AssetReport& ele) { return std::format("{:.3f}", ele.openMs); }},
+    {.title = "Stage [ms]", .toString = [](const AssetReport& ele) { return std::format("{:.3f}", ele.stageMs); }},
+    {.title = "GPU [ms]", .toString = [](const AssetReport& ele) { return std::format("{:.3f}", ele.gpuMs); }},
+    {.title = "Time to resident [ms]", .toString = [](const AssetReport& ele) { return std::format("{:.3f}", ele.totalMs); }},
+  }});
+  // clang-format on
+}
+
+void VulkanApi::showOcclusion() const
+{
+  static constexpr uint32_t frames = 120;
+  const std::vector<OcclusionReport> results = benchmarkOcclusion(_windows.front().getDevice(), frames);
+
+  // clang-format off
+  utils::table<OcclusionReport>("Hi-Z occlusion culling", results, std::vector<utils::TableColumn<OcclusionReport>>{{
+    {.title = "Mode", .align = utils::Align::left, .toString = [](const OcclusionReport& ele) { return ele.mode; }},
+    {.title = "Result", .align = utils::Align::left, .toString = [](const OcclusionReport& ele) { return std::string(ele.correct ? "ok" : "MISMATCH"); }},
+    {.title = "Instances", .toString = [](const OcclusionReport& ele) { return utils::number(ele.instances); }},
+    {.title = "In frustum", .toString = [](const OcclusionReport& ele) { return utils::number(ele.inFrustum); }},
+    {.title = "Drawn early", .toString = [](const OcclusionReport& ele) { return utils::number(ele.drawnEarly); }},
+    {.title = "Drawn late", .toString = [](const OcclusionReport& ele) { return utils::number(ele.drawnLate); }},
+    {.title = "Culled [%]", .toString = [](const OcclusionReport& ele) { return std::format("{:.1f}", ele.inFrustum > 0 ? 100.0 * (ele.inFrustum - std::min(ele.drawnEarly + ele.drawnLate, ele.inFrustum)) / ele.inFrustum : 0.0); }},
+    {.title = "GPU frame [ms]", .toString = [](const OcclusionReport& ele) { return std::format("{:.3f}", ele.gpuMs); }},
+    {.title = "Saved [ms]", .toString = [](const OcclusionReport& ele) { return std::format("{:.3f}", ele.savedMs); }},
+  }});
+  // clang-format on
+}
+}  // namespace vulkan
@@ -24,6 +24,28 @@ public:
   static std::shared_ptr<VulkanApi> createApi(const VulkanApiInfo& info = {});
   static std::shared_ptr<VulkanApi> getApi();
 
+  // Pumps window events on the calling (main) thread until the main window is closed
+  void run();
+  void showFrameStats() const;
+  // Scaling of parallel recording with the thread count, on the device of the main window
+  void showRecordScaling() const;
+  // Descriptor update throughput on the device of the main window
+  void showDescriptorThroughput() const;
+  // Draw recording throughput of both rendering paths on the device of the main window
+  void showRendering() const;
+  // Correctness and throughput of the compute primitives on the device of the main window
+  void showPrimitives() const;
+  // Radix sort against the host sorts on the device of the main window
+  void showSorts() const;
+  // GPU driven culling throughput on the device of the main window
+  void showCulling() const;
+  // Batching and defragmentation of the geometry mega-buffer on the device of the main window
+  void showGeometry() const;
+  // Loading and uploading a sample scene from loose files and from asset containers on the device of the main window
+  void showAssets() const;
+  // Hierarchical Z occlusion culling against frustum culling alone on the device of the main window
+  void showOcclusion() const;
+
 private:
   const std::shared_ptr<InitGlfw> _glfw;
   const std::shared_ptr<InitVulkan> _vulkan;
@@ -31,6 +53,14 @@ private:
   VulkanDebugger _debugger;
 #endif
   std::vector<Window> _windows;
+  bool _recordBenchmark;
+  bool _descriptorBenchmark;
+  bool _renderingBenchmark;
+  bool _primitivesBenchmark;
+  bool _cullingBenchmark;
+  bool _geometryBenchmark;
+  bool _assetBenchmark;
+  bool _occlusionBenchmark;
 
   explicit VulkanApi(const VulkanApiInfo& info = {});
 
@@ -14,6 +14,27 @@ struct VulkanApiInfo {
 
   WindowInfo mainWindowInfo = {};
   std::vector<WindowInfo> windowsInfo;
+
+  // Records 10k to 1M stand-in draws with growing thread counts before run() starts pumping events
+  bool recordBenchmark = false;
+  // Descriptor updates per second of per draw sets against the bindless table, before run() starts pumping events
+  bool descriptorBenchmark = false;
+  // Draws per second recorded inside dynamic rendering against cached render passes, before run() starts pumping events
+  bool renderingBenchmark = false;
+  // Checks the compute primitives and the radix sort against the std:: algorithms and measures them, before run() starts
+  // pumping events
+  bool primitivesBenchmark = false;
+  // GPU culling of 100k and more instances with every indirect draw path against host culling, before run() starts
+  // pumping events
+  bool cullingBenchmark = false;
+  // Draw calls and binds the geometry mega-buffer saves on a sample scene, before run() starts pumping events
+  bool geometryBenchmark = false;
+  // Time to first frame of a sample scene from one file per asset against the asset container, before run() starts
+  // pumping events
+  bool assetBenchmark = false;
+  // Fraction of a city scene two phase occlusion culling hides and the GPU time it saves over frustum culling alone,
+  // before run() starts pumping events
+  bool occlusionBenchmark = false;
 };
 }  // namespace vulkan
 
@@ -0,0 +1,341 @@
+#include "asset_benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <vulkan/vulkan_core.h>
+
+#include "asset_upload.hpp"
+#include "container/archive.hpp"
+#include "container/format.hpp"
+#include "container/packer.hpp"
+#include "device/device.hpp"
+#include "shader/embedded_shader.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr uint32_t meshCount = 48;
+static constexpr uint32_t gridSize = 96;
+static constexpr uint32_t textureCount = 24;
+static constexpr uint32_t textureSize = 512;
+static constexpr uint32_t texelBytes = 4;
+static constexpr uint32_t repeats = 3;
+// Position and a packed uv, the size the quantized meshes of lib/mesh have
+static constexpr uint32_t vertexStride = 16;
+static constexpr uint64_t levelAlignment = 16;
+
+// Header of a per asset file, followed by the mip regions of a texture and the data
+struct LooseHeader {
+  assets::ChunkType type;
+  uint32_t levelCount;
+  std::array<uint32_t, 14> info;
+  uint64_t size;
+};
+
+struct SceneAsset {
+  std::string name;
+  assets::ChunkType type;
+  assets::ChunkEntry entry;
+  std::vector<assets::MipRegion> levels;
+  std::vector<std::byte> data;
+};
+
+struct Timing {
+  double openMs = 0.0;
+  double stageMs = 0.0;
+  double gpuMs = 0.0;
+};
+
+template <typename T>
+static void append(std::vector<std::byte>& bytes, const T& value)
+{
+  const auto* first = reinterpret_cast<const std::byte*>(&value);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  bytes.insert(bytes.end(), first, first + sizeof(T));
+}
+
+// Grid with a wave over it, indices follow the vertices 16 byte aligned as the container keeps them
+static SceneAsset makeMesh(uint32_t index)
+{
+  std::vector<std::byte> vertices;
+  const float step = 1.0F / static_cast<float>(gridSize);
+  for (uint32_t row = 0; row <= gridSize; ++row) {
+    for (uint32_t column = 0; column <= gridSize; ++column) {
+      const float u = static_cast<float>(column) * step;
+      const float v = static_cast<float>(row) * step;
+      append(vertices, std::array<float, 3>{u, std::sin((u + v) * static_cast<float>(index + 1)), v});
+      append(vertices, std::array<uint16_t, 2>{static_cast<uint16_t>(column * 640), static_cast<uint16_t>(row * 640)});
+    }
+  }
+  std::vector<uint32_t> indices;
+  for (uint32_t row = 0; row < gridSize; ++row) {
+    for (uint32_t column = 0; column < gridSize; ++column) {
+      const uint32_t corner = (row * (gridSize + 1)) + column;
+      indices.insert(indices.end(), {corner, corner + gridSize + 1, corner + 1, corner + 1, corner + gridSize + 1, corner + gridSize + 2});
+    }
+  }
+
+  assets::MeshInfo info{
+      .vertexCount = static_cast<uint32_t>(vertices.size() / vertexStride),
+      .vertexStride = vertexStride,
+      .indexCount = static_cast<uint32_t>(indices.size()),
+      .indexOffset = static_cast<uint32_t>(((vertices.size() + levelAlignment - 1) / levelAlignment) * levelAlignment),
+      .positionOffset = {0.0F, 0.0F, 0.0F},
+      .positionScale = {1.0F, 1.0F, 1.0F},
+      .uvOffset = {0.0F, 0.0F},
+      .uvScale = {1.0F, 1.0F},
+  };
+  SceneAsset asset{.name = std::format("mesh/grid{}", index), .type = assets::ChunkType::mesh, .entry = {}, .levels = {}, .data = std::move(vertices)};
+  asset.data.resize(info.indexOffset + (indices.size() * sizeof(uint32_t)));
+  std::memcpy(asset.data.data() + info.indexOffset, indices.data(), indices.size() * sizeof(uint32_t));
+  assets::setInfo(asset.entry, info);
+  return asset;
+}
+
+// RGBA8 pattern with every mip level down to 1x1
+static SceneAsset makeTexture(uint32_t index)
+{
+  SceneAsset asset{.name = std::format("texture/pattern{}", index), .type = assets::ChunkType::texture, .entry = {}, .levels = {}, .data = {}};
+  for (uint32_t size = textureSize; size > 0; size /= 2) {
+    const uint64_t offset = ((asset.data.size() + levelAlignment - 1) / levelAlignment) * levelAlignment;
+    const uint64_t bytes = uint64_t{size} * size * texelBytes;
+    asset.levels.push_back({.width = size, .height = size, .offset = offset, .size = bytes});
+    asset.data.resize(offset);
+    for (uint32_t y = 0; y < size; ++y) {
+      for (uint32_t x = 0; x < size; ++x) {
+        append(asset.data, std::array<uint8_t, 4>{static_cast<uint8_t>(x ^ y), static_cast<uint8_t>((x * index) / 4),
+                                                 static_cast<uint8_t>(y + index), uint8_t{255}});
+      }
+    }
+  }
+  assets::setInfo(asset.entry, assets::TextureInfo{
+                                   .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                   .width = textureSize,
+                                   .height = textureSize,
+                                   .firstLevel = 0,
+                                   .levelCount = static_cast<uint32_t>(asset.levels.size()),
+                               });
+  return asset;
+}
+
+static std::vector<SceneAsset> makeScene()
+{
+  std::vector<SceneAsset> scene;
+  for (uint32_t index = 0; index < meshCount; ++index) {
+    scene.push_back(makeMesh(index));
+  }
+  for (uint32_t index = 0; index < textureCount; ++index) {
+    scene.push_back(makeTexture(index));
+  }
+  for (const EmbeddedShader& shader : getEmbeddedShaders()) {
+    SceneAsset asset{.name = std::format("shader/{}", shader.name), .type = assets::ChunkType::shader, .entry = {}, .levels = {}, .data = {}};
+    asset.data.resize(shader.code.size_bytes());
+    std::memcpy(asset.data.data(), shader.code.data(), asset.data.size());
+    scene.push_back(std::move(asset));
+  }
+  return scene;
+}
+
+static std::filesystem::path loosePath(const std::filesystem::path& directory, const SceneAsset& asset)
+{
+  std::string file = asset.name;
+  std::ranges::replace(file, '/', '_');
+  return directory / (file + ".asset");
+}
+
+static void writeLoose(const std::filesystem::path& directory, std::span<const SceneAsset> scene)
+{
+  std::filesystem::create_directories(directory);
+  for (const SceneAsset& asset : scene) {
+    std::vector<std::byte> bytes;
+    append(bytes, LooseHeader{.type = asset.type,
+                              .levelCount = static_cast<uint32_t>(asset.levels.size()),
+                              .info = asset.entry.info,
+                              .size = asset.data.size()});
+    for (const assets::MipRegion& level : asset.levels) {
+      append(bytes, level);
+    }
+    bytes.insert(bytes.end(), asset.data.begin(), asset.data.end());
+    std::ofstream file(loosePath(directory, asset), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!file) {
+      throw std::runtime_error(std::format("Failed to write {}", loosePath(directory, asset).string()));
+    }
+  }
+}
+
+static void writeContainer(const std::filesystem::path& path, std::span<const SceneAsset> scene, bool lz4)
+{
+  assets::Packer packer({.alignment = 256, .lz4 = lz4});
+  for (const SceneAsset& asset : scene) {
+    switch (asset.type) {
+    case assets::ChunkType::mesh: {
+      const auto info = assets::info<assets::MeshInfo>(asset.entry);
+      const std::span<const std::byte> data = asset.data;
+      const std::span<const std::byte> indexBytes = data.subspan(info.indexOffset);
+      std::vector<uint32_t> indices(indexBytes.size() / sizeof(uint32_t));
+      std::memcpy(indices.data(), indexBytes.data(), indexBytes.size());
+      packer.addMesh(asset.name, info, data.first(size_t{info.vertexCount} * info.vertexStride), indices);
+      break;
+    }
+    case assets::ChunkType::texture:
+      packer.addTexture(asset.name, assets::info<assets::TextureInfo>(asset.entry).format, asset.levels, asset.data);
+      break;
+    case assets::ChunkType::shader: {
+      std::vector<uint32_t> code(asset.data.size() / sizeof(uint32_t));
+      std::memcpy(code.data(), asset.data.data(), asset.data.size());
+      packer.addShader(asset.name, code);
+      break;
+    }
+    case assets::ChunkType::blob: packer.addBlob(asset.name, asset.data); break;
+    }
+  }
+  static_cast<void>(packer.write(path));
+}
+
+static bool complete(const ResidentAssets& resident)
+{
+  return resident.meshes.size() == meshCount && resident.textures.size() == textureCount &&
+         resident.shaders.size() == getEmbeddedShaders().size();
+}
+
+// What a loader of one file per asset does: open, read the header, read the data into its own buffer, copy it over.
+// Reading is serial, one file after the other, copies into staging run in parallel on TBB as uploadArchive does
+static AssetReport loadLoose(const VulkanDevice& device, const std::filesystem::path& directory, std::span<const SceneAsset> scene)
+{
+  struct Loaded {
+    LooseHeader header;
+    std::vector<assets::MipRegion> levels;
+    std::vector<std::byte> data;
+  };
+
+  AssetReport report{.source = "loose files", .filesOpened = 0, .hostBuffers = 0, .storedBytes = 0, .openMs = 0.0, .stageMs = 0.0,
+                     .gpuMs = 0.0, .totalMs = 0.0, .correct = true};
+  for (uint32_t run = 0; run < repeats; ++run) {
+    Timing timing;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Loaded> loaded;
+    for (const SceneAsset& asset : scene) {
+      std::ifstream file(loosePath(directory, asset), std::ios::binary);
+      Loaded current{.header = {}, .levels = {}, .data = {}};
+      file.read(reinterpret_cast<char*>(&current.header), sizeof(LooseHeader));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      current.levels.resize(current.header.levelCount);
+      file.read(reinterpret_cast<char*>(current.levels.data()), static_cast<std::streamsize>(current.levels.size() * sizeof(assets::MipRegion)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      current.data.resize(current.header.size);
+      file.read(reinterpret_cast<char*>(current.data.data()), static_cast<std::streamsize>(current.data.size()));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      if (!file) {
+        throw std::runtime_error(std::format("Failed to read {}", loosePath(directory, asset).string()));
+      }
+      loaded.push_back(std::move(current));
+    }
+    timing.openMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    VkDeviceSize capacity = 0;
+    for (const Loaded& asset : loaded) {
+      capacity += asset.header.size + AssetUpload::alignment(device);
+    }
+    AssetUpload upload(device, capacity);
+    std::vector<std::pair<const Loaded*, std::span<std::byte>>> staged;
+    for (const Loaded& asset : loaded) {
+      assets::ChunkEntry entry{};
+      entry.info = asset.header.info;
+      switch (asset.header.type) {
+      case assets::ChunkType::mesh: staged.emplace_back(&asset, upload.addMesh(assets::info<assets::MeshInfo>(entry), asset.header.size)); break;
+      case assets::ChunkType::texture:
+        staged.emplace_back(&asset, upload.addTexture(assets::info<assets::TextureInfo>(entry), asset.levels, asset.header.size));
+        break;
+      case assets::ChunkType::shader: {
+        std::vector<uint32_t> code(asset.data.size() / sizeof(uint32_t));
+        std::memcpy(code.data(), asset.data.data(), asset.data.size());
+        upload.addShader(code);
+        break;
+      }
+      case assets::ChunkType::blob: break;
+      }
+    }
+    tbb::parallel_for(size_t{0}, staged.size(), [&](size_t index) {
+      const auto& [asset, target] = staged[index];
+      std::ranges::copy(asset->data, target.begin());
+    });
+    timing.stageMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+    const ResidentAssets resident = upload.submit();
+    timing.gpuMs = resident.stats.gpuMs;
+
+    const double total = timing.openMs + timing.stageMs + timing.gpuMs;
+    if (run == 0 || total < report.totalMs) {
+      report.openMs = timing.openMs;
+      report.stageMs = timing.stageMs;
+      report.gpuMs = timing.gpuMs;
+      report.totalMs = total;
+    }
+    report.correct = report.correct && complete(resident);
+  }
+  for (const SceneAsset& asset : scene) {
+    report.filesOpened++;
+    report.hostBuffers += asset.levels.empty() ? 1U : 2U;
+    report.storedBytes += std::filesystem::file_size(loosePath(directory, asset));
+  }
+  return report;
+}
+
+// One mapping, chunks decompressed or copied from it straight into staging memory
+static AssetReport loadContainer(const VulkanDevice& device, const std::filesystem::path& path, std::string source)
+{
+  AssetReport report{.source = std::move(source), .filesOpened = 1, .hostBuffers = 0, .storedBytes = std::filesystem::file_size(path),
+                     .openMs = 0.0, .stageMs = 0.0, .gpuMs = 0.0, .totalMs = 0.0, .correct = true};
+  for (uint32_t run = 0; run < repeats; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    const assets::Archive archive(path);
+    const double openMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+    const ResidentAssets resident = uploadArchive(device, archive, true);
+
+    const double total = openMs + resident.stats.stageMs + resident.stats.gpuMs;
+    if (run == 0 || total < report.totalMs) {
+      report.openMs = openMs;
+      report.stageMs = resident.stats.stageMs;
+      report.gpuMs = resident.stats.gpuMs;
+      report.totalMs = total;
+    }
+    report.correct = report.correct && complete(resident);
+  }
+  return report;
+}
+
+std::vector<AssetReport> benchmarkAssets(const VulkanDevice& device)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vulkan_asset_benchmark";
+  const std::vector<SceneAsset> scene = makeScene();
+  std::vector<AssetReport> reports;
+  try {
+    writeLoose(directory / "loose", scene);
+    writeContainer(directory / "scene.pack", scene, false);
+    writeContainer(directory / "scene_lz4.pack", scene, true);
+
+    reports.push_back(loadLoose(device, directory / "loose", scene));
+    reports.push_back(loadContainer(device, directory / "scene.pack", "container"));
+    reports.push_back(loadContainer(device, directory / "scene_lz4.pack", "container lz4"));
+  }
+  catch (...) {
+    std::filesystem::remove_all(directory);
+    throw;
+  }
+  std::filesystem::remove_all(directory);
+  return reports;
+}
+}  // namespace vulkan
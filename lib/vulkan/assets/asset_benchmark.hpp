@@ -0,0 +1,37 @@
+#ifndef LIB_VULKAN_ASSETS_ASSET_BENCHMARK
+#define LIB_VULKAN_ASSETS_ASSET_BENCHMARK
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct AssetReport {
+  std::string source;
+  uint32_t filesOpened;
+  // Heap buffers the loader needs besides the staging buffer, per asset files need one per file
+  uint32_t hostBuffers;
+  uint64_t storedBytes;
+  // Opening and parsing, then filling staging memory, then the copies on the GPU, best of 3 runs. No frame is rendered,
+  // totalMs ends once the last copy is resident
+  double openMs;
+  double stageMs;
+  double gpuMs;
+  double totalMs;
+  // Every mesh, texture and shader became resident. Containers verify every chunk checksum on the way, which their
+  // stage time includes, loose files have no checksums
+  bool correct;
+};
+
+// Sample scene of procedural meshes, mipmapped textures and every embedded shader, loaded from one file per asset and
+// from an asset container stored plain and LZ4 compressed. Files are written to the temp directory and read from a
+// warm page cache, so the rows compare parsing and copying rather than the disk. Loose files are read one after the
+// other, every source fills staging memory in parallel
+[[nodiscard]] std::vector<AssetReport> benchmarkAssets(const VulkanDevice& device);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_ASSETS_ASSET_BENCHMARK */
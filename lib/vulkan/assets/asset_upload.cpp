@@ -0,0 +1,364 @@
+#include "asset_upload.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <vulkan/vulkan_core.h>
+
+#include "container/archive.hpp"
+#include "container/format.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+#include "memory/image.hpp"
+#include "shader/shader_module.hpp"
+#include "sync/timeline.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr uint64_t uploadTimeout = 10'000'000'000;  // 10s
+// Texel block size of every compressed format, bufferOffset of image copies has to be a multiple of it
+static constexpr VkDeviceSize minAlignment = 16;
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+  return ((value + alignment - 1) / alignment) * alignment;
+}
+
+// The container keeps chunks at least 16 byte aligned, so SPIR-V words can be read in place
+static std::span<const uint32_t> words(std::span<const std::byte> bytes)
+{
+  return {reinterpret_cast<const uint32_t*>(bytes.data()), bytes.size() / sizeof(uint32_t)};  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+static VkCommandPool createPool(VkDevice device, uint32_t family)
+{
+  const VkCommandPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      .queueFamilyIndex = family,
+  };
+
+  VkCommandPool pool = nullptr;
+  if (const VkResult status = vkCreateCommandPool(device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create upload command pool! status: {}", utils::result(status)));
+  }
+  return pool;
+}
+
+AssetUpload::AssetUpload(const VulkanDevice& device, VkDeviceSize capacity)
+    : _device(device),
+      _alignment(alignment(device)),
+      _staging(device,
+               {
+                   .size = std::max(capacity, _alignment),
+                   .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                   .preferred = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+               })
+{
+}
+
+VkDeviceSize AssetUpload::alignment(const VulkanDevice& device)
+{
+  return std::max(device.getData().properties.limits.optimalBufferCopyOffsetAlignment, minAlignment);
+}
+
+VkDeviceSize AssetUpload::stagingSize(const VulkanDevice& device, const assets::Archive& archive)
+{
+  const VkDeviceSize align = alignment(device);
+  VkDeviceSize size = 0;
+  for (uint32_t index = 0; index < archive.getChunkCount(); ++index) {
+    const assets::ChunkEntry entry = archive.getChunk(index);
+    if (entry.type == assets::ChunkType::mesh || entry.type == assets::ChunkType::texture) {
+      size = alignUp(size, align) + entry.rawSize;
+    }
+  }
+  return size;
+}
+
+std::span<std::byte> AssetUpload::addMesh(const assets::MeshInfo& info, VkDeviceSize size)
+{
+  const VkDeviceSize vertexBytes = VkDeviceSize{info.vertexCount} * info.vertexStride;
+  const VkDeviceSize indexBytes = VkDeviceSize{info.indexCount} * sizeof(uint32_t);
+  if (vertexBytes == 0 || indexBytes == 0 || vertexBytes > info.indexOffset || info.indexOffset + indexBytes > size) {
+    throw std::runtime_error(std::format("Mesh of {} vertices and {} indices does not fit its {} bytes", info.vertexCount, info.indexCount, size));
+  }
+  VkDeviceSize offset = 0;
+  const std::span<std::byte> target = reserve(size, offset);
+  _assets.meshes.push_back({
+      .vertices = Buffer(_device,
+                         {
+                             .size = vertexBytes,
+                             .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                             .required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             .preferred = 0,
+                         }),
+      .indices = Buffer(_device,
+                        {
+                            .size = indexBytes,
+                            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                            .required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            .preferred = 0,
+                        }),
+      .info = info,
+  });
+  _meshCopies.push_back({.vertexOffset = offset, .vertexBytes = vertexBytes, .indexOffset = offset + info.indexOffset, .indexBytes = indexBytes});
+  return target;
+}
+
+std::span<std::byte> AssetUpload::addTexture(const assets::TextureInfo& info, std::span<const assets::MipRegion> levels, VkDeviceSize size)
+{
+  if (levels.empty() || levels.size() != info.levelCount) {
+    throw std::runtime_error(std::format("Texture of {} levels was given {}", info.levelCount, levels.size()));
+  }
+  for (const assets::MipRegion& level : levels) {
+    if (level.offset % minAlignment != 0 || level.offset > size || level.size > size - level.offset) {
+      throw std::runtime_error(std::format("Level {}x{} at {} does not fit a texture of {} bytes", level.width, level.height, level.offset, size));
+    }
+  }
+  VkDeviceSize offset = 0;
+  const std::span<std::byte> target = reserve(size, offset);
+  _assets.textures.push_back({
+      .image = Image(_device,
+                     {
+                         .format = static_cast<VkFormat>(info.format),
+                         .extent = {.width = info.width, .height = info.height},
+                         .mipLevels = info.levelCount,
+                         .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                     }),
+      .info = info,
+  });
+  _textureCopies.push_back({.firstRegion = _regions.size(), .regionCount = info.levelCount});
+  for (uint32_t mip = 0; mip < levels.size(); ++mip) {
+    _regions.push_back({
+        .bufferOffset = offset + levels[mip].offset,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = mip, .baseArrayLayer = 0, .layerCount = 1},
+        .imageOffset = {.x = 0, .y = 0, .z = 0},
+        .imageExtent = {.width = levels[mip].width, .height = levels[mip].height, .depth = 1},
+    });
+  }
+  return target;
+}
+
+void AssetUpload::addShader(std::span<const uint32_t> code)
+{
+  _assets.shaders.push_back(std::make_unique<ShaderModule>(_device.get(), code));
+}
+
+ResidentAssets AssetUpload::submit()
+{
+  if (_used > 0) {
+    _staging.flush(0, _used);
+  }
+  _assets.stats.copies = static_cast<uint32_t>((_meshCopies.size() * 2) + _textureCopies.size());
+  if (_assets.stats.copies == 0) {
+    return std::move(_assets);
+  }
+
+  const VkDevice device = _device.get();
+  Queue& queue = _device.getQueue();
+  if (queue.getGraphics().empty()) {
+    throw std::runtime_error("Device has no graphics family to upload assets on");
+  }
+  // Graphics family, the resources are used there and need no ownership transfer
+  const uint32_t family = queue.getGraphics().front();
+  const VkCommandPool pool = createPool(device, family);
+  try {
+    const VkCommandBufferAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    VkCommandBuffer cmd = nullptr;
+    if (const VkResult status = vkAllocateCommandBuffers(device, &allocateInfo, &cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to allocate upload command buffer! status: {}", utils::result(status)));
+    }
+    const VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+    if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to begin upload command buffer! status: {}", utils::result(status)));
+    }
+    record(cmd);
+    if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to end upload command buffer! status: {}", utils::result(status)));
+    }
+
+    Timeline timeline(device);
+    const uint64_t value = timeline.next();
+    const VkTimelineSemaphoreSubmitInfo timelineInfo{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = nullptr,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+    const VkSemaphore semaphore = timeline.get();
+    const VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+    const auto start = std::chrono::steady_clock::now();
+    queue.submit(family, {&submitInfo, 1}, nullptr);
+    if (!timeline.wait(value, uploadTimeout)) {
+      throw std::runtime_error("Asset upload did not finish in time");
+    }
+    _assets.stats.gpuMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+  }
+  catch (...) {
+    vkDestroyCommandPool(device, pool, nullptr);
+    throw;
+  }
+  vkDestroyCommandPool(device, pool, nullptr);
+  return std::move(_assets);
+}
+
+std::span<std::byte> AssetUpload::reserve(VkDeviceSize size, VkDeviceSize& offset)
+{
+  offset = alignUp(_used, _alignment);
+  if (offset + size > _staging.getSize()) {
+    throw std::runtime_error(std::format("Chunk of {} bytes does not fit the {} bytes staging buffer", size, _staging.getSize()));
+  }
+  _used = offset + size;
+  _assets.stats.stagingBytes = _used;
+  return {_staging.getMapped() + offset, size};
+}
+
+// Host writes are visible to the copies through the submission itself
+void AssetUpload::record(VkCommandBuffer cmd) const
+{
+  const VkImageSubresourceRange everyLevel{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = VK_REMAINING_MIP_LEVELS,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+  };
+  std::vector<VkImageMemoryBarrier> toTransfer;
+  std::vector<VkImageMemoryBarrier> toShader;
+  for (const ResidentTexture& texture : _assets.textures) {
+    VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = texture.image.get(),
+        .subresourceRange = everyLevel,
+    };
+    toTransfer.push_back(barrier);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    toShader.push_back(barrier);
+  }
+  if (!toTransfer.empty()) {
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(toTransfer.size()), toTransfer.data());
+  }
+
+  const VkBuffer staging = _staging.get();
+  for (size_t mesh = 0; mesh < _meshCopies.size(); ++mesh) {
+    const MeshCopy& copy = _meshCopies[mesh];
+    const VkBufferCopy vertices{.srcOffset = copy.vertexOffset, .dstOffset = 0, .size = copy.vertexBytes};
+    const VkBufferCopy indices{.srcOffset = copy.indexOffset, .dstOffset = 0, .size = copy.indexBytes};
+    vkCmdCopyBuffer(cmd, staging, _assets.meshes[mesh].vertices.get(), 1, &vertices);
+    vkCmdCopyBuffer(cmd, staging, _assets.meshes[mesh].indices.get(), 1, &indices);
+  }
+  for (size_t texture = 0; texture < _textureCopies.size(); ++texture) {
+    const TextureCopy& copy = _textureCopies[texture];
+    vkCmdCopyBufferToImage(cmd, staging, _assets.textures[texture].image.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copy.regionCount,
+                           &_regions[copy.firstRegion]);
+  }
+
+  const VkMemoryBarrier toRead{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+  };
+  const VkPipelineStageFlags readers = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, readers, 0, 1, &toRead, 0, nullptr, static_cast<uint32_t>(toShader.size()),
+                       toShader.data());
+}
+
+ResidentAssets uploadArchive(const VulkanDevice& device, const assets::Archive& archive, bool verify)
+{
+  struct Staged {
+    assets::ChunkEntry entry;
+    std::span<std::byte> target;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  AssetUpload upload(device, AssetUpload::stagingSize(device, archive));
+  std::vector<Staged> staged;
+  std::vector<assets::MipRegion> levels;
+  for (uint32_t index = 0; index < archive.getChunkCount(); ++index) {
+    const assets::ChunkEntry entry = archive.getChunk(index);
+    switch (entry.type) {
+    case assets::ChunkType::mesh: staged.push_back({.entry = entry, .target = upload.addMesh(assets::info<assets::MeshInfo>(entry), entry.rawSize)}); break;
+    case assets::ChunkType::texture: {
+      const auto texture = assets::info<assets::TextureInfo>(entry);
+      levels.clear();
+      for (uint32_t level = 0; level < texture.levelCount; ++level) {
+        levels.push_back(archive.getLevel(texture, level));
+      }
+      staged.push_back({.entry = entry, .target = upload.addTexture(texture, levels, entry.rawSize)});
+      break;
+    }
+    case assets::ChunkType::shader:
+      if (verify && !archive.verify(entry)) {
+        throw std::runtime_error(std::format("Shader {} is corrupted", archive.getName(entry)));
+      }
+      upload.addShader(words(archive.getStored(entry)));
+      break;
+    case assets::ChunkType::blob: break;
+    }
+  }
+
+  tbb::parallel_for(size_t{0}, staged.size(), [&](size_t index) {
+    const Staged& chunk = staged[index];
+    if (verify && !archive.verify(chunk.entry)) {
+      throw std::runtime_error(std::format("Chunk {} is corrupted", archive.getName(chunk.entry)));
+    }
+    archive.read(chunk.entry, chunk.target);
+  });
+  const double stageMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+
+  ResidentAssets resident = upload.submit();
+  resident.stats.stageMs = stageMs;
+  return resident;
+}
+}  // namespace vulkan
@@ -0,0 +1,105 @@
+#ifndef LIB_VULKAN_ASSETS_ASSET_UPLOAD
+#define LIB_VULKAN_ASSETS_ASSET_UPLOAD
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "container/archive.hpp"
+#include "container/format.hpp"
+#include "device/device.hpp"
+#include "memory/buffer.hpp"
+#include "memory/image.hpp"
+#include "shader/shader_module.hpp"
+
+namespace vulkan {
+struct ResidentMesh {
+  Buffer vertices;
+  Buffer indices;
+  assets::MeshInfo info;
+};
+
+struct ResidentTexture {
+  Image image;
+  assets::TextureInfo info;
+};
+
+struct UploadStats {
+  VkDeviceSize stagingBytes = 0;
+  uint32_t copies = 0;
+  // Filling the staging buffer, in milliseconds. Set by uploadArchive, callers filling it themselves measure their own
+  double stageMs = 0.0;
+  // Submit until the copies signal, in milliseconds
+  double gpuMs = 0.0;
+};
+
+// Device local copies of a set of chunks, images are in SHADER_READ_ONLY_OPTIMAL
+struct ResidentAssets {
+  std::vector<ResidentMesh> meshes;
+  std::vector<ResidentTexture> textures;
+  std::vector<std::unique_ptr<ShaderModule>> shaders;
+  UploadStats stats;
+};
+
+// One host visible staging buffer the caller fills chunk by chunk, then a single submission on the graphics family
+// copying everything into device local buffers and images. Chunks start at multiples of optimalBufferCopyOffsetAlignment
+// so staging memory can be filled straight from a container. Single use
+class AssetUpload {
+public:
+  AssetUpload(const AssetUpload&) = delete;
+  AssetUpload(AssetUpload&&) = delete;
+  AssetUpload& operator=(const AssetUpload&) = delete;
+  AssetUpload& operator=(AssetUpload&&) = delete;
+
+  // Capacity has to hold every chunk plus alignment(), stagingSize computes it for a container
+  explicit AssetUpload(const VulkanDevice& device, VkDeviceSize capacity);
+  ~AssetUpload() = default;
+
+  [[nodiscard]] static VkDeviceSize alignment(const VulkanDevice& device);
+  [[nodiscard]] static VkDeviceSize stagingSize(const VulkanDevice& device, const assets::Archive& archive);
+
+  // Staging memory of size bytes the chunk goes to, laid out as the container stores it
+  [[nodiscard]] std::span<std::byte> addMesh(const assets::MeshInfo& info, VkDeviceSize size);
+  [[nodiscard]] std::span<std::byte> addTexture(const assets::TextureInfo& info, std::span<const assets::MipRegion> levels, VkDeviceSize size);
+  void addShader(std::span<const uint32_t> code);
+
+  // Flushes the staging buffer, records every copy with its barriers and waits for them
+  [[nodiscard]] ResidentAssets submit();
+
+private:
+  struct MeshCopy {
+    VkDeviceSize vertexOffset;
+    VkDeviceSize vertexBytes;
+    VkDeviceSize indexOffset;
+    VkDeviceSize indexBytes;
+  };
+
+  struct TextureCopy {
+    size_t firstRegion;
+    uint32_t regionCount;
+  };
+
+  const VulkanDevice& _device;
+  VkDeviceSize _alignment;
+  Buffer _staging;
+  VkDeviceSize _used = 0;
+  ResidentAssets _assets;
+  std::vector<MeshCopy> _meshCopies;
+  std::vector<TextureCopy> _textureCopies;
+  std::vector<VkBufferImageCopy> _regions;
+
+  [[nodiscard]] std::span<std::byte> reserve(VkDeviceSize size, VkDeviceSize& offset);
+  void record(VkCommandBuffer cmd) const;
+};
+
+// Maps every mesh, texture and shader chunk of the archive into device memory. Chunks are copied or decompressed into
+// staging in parallel on TBB, straight from the mapping, shaders are created from the mapping without a copy.
+// verify checks every chunk checksum on the way, a corrupted chunk throws
+[[nodiscard]] ResidentAssets uploadArchive(const VulkanDevice& device, const assets::Archive& archive, bool verify);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_ASSETS_ASSET_UPLOAD */
@@ -0,0 +1,219 @@
+#include "command_pools.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "device/queue.hpp"
+#include "format/string.hpp"
+
+namespace vulkan {
+static constexpr uint32_t noSlot = std::numeric_limits<uint32_t>::max();
+
+// Thread local lookups are keyed by an id that is never reused, so entries of destroyed managers can not be hit again.
+// Ids of live managers let every thread drop its entries of destroyed ones
+static std::atomic<uint64_t> nextId = 1;
+static std::mutex liveMutex;
+static std::unordered_set<uint64_t> liveIds;
+
+static std::vector<uint32_t> familySlots(const Queue& queue, uint32_t& count)
+{
+  std::vector<uint32_t> families = queue.getGraphics();
+  families.insert(families.end(), queue.getCompute().begin(), queue.getCompute().end());
+  families.insert(families.end(), queue.getTransfer().begin(), queue.getTransfer().end());
+  std::ranges::sort(families);
+  const auto [first, last] = std::ranges::unique(families);
+  families.erase(first, last);
+
+  std::vector<uint32_t> slots(families.empty() ? 0 : families.back() + 1, noSlot);
+  count = 0;
+  for (const uint32_t family : families) {
+    slots.at(family) = count++;
+  }
+  return slots;
+}
+
+static VkCommandPool createPool(VkDevice device, uint32_t family)
+{
+  // No RESET_COMMAND_BUFFER flag, buffers only ever go back through a reset of the whole pool
+  const VkCommandPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      .queueFamilyIndex = family,
+  };
+
+  VkCommandPool pool = nullptr;
+  if (const VkResult status = vkCreateCommandPool(device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create command pool! status: {}", utils::result(status)));
+  }
+  return pool;
+}
+
+CommandPools::CommandPools(const VulkanDevice& device, uint32_t framesInFlight)
+    : _device(device.get()),
+      _id(nextId++),
+      _framesInFlight(std::max(framesInFlight, 1U)),
+      _familySlots(familySlots(device.getQueue(), _familyCount)),
+      _sync(_framesInFlight)
+{
+  const std::scoped_lock lock(liveMutex);
+  liveIds.insert(_id);
+}
+
+CommandPools::~CommandPools()
+{
+  {
+    const std::scoped_lock lock(liveMutex);
+    liveIds.erase(_id);
+  }
+  // Destroying a pool frees its command buffers
+  for (const auto& thread : _threads) {
+    for (const auto& frame : thread->frames) {
+      for (const Pool& pool : frame) {
+        if (pool.pool != nullptr) {
+          vkDestroyCommandPool(_device, pool.pool, nullptr);
+        }
+      }
+    }
+  }
+}
+
+void CommandPools::beginFrame(uint64_t frame)
+{
+  const auto slot = static_cast<uint32_t>(frame % _framesInFlight);
+  const FrameSync& sync = _sync.at(slot);
+  if (sync.timeline != nullptr) {
+    const VkSemaphoreWaitInfo waitInfo{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .semaphoreCount = 1,
+        .pSemaphores = &sync.timeline,
+        .pValues = &sync.value,
+    };
+    if (const VkResult status = vkWaitSemaphores(_device, &waitInfo, std::numeric_limits<uint64_t>::max()); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to wait for frame timeline! status: {}", utils::result(status)));
+    }
+  }
+
+  const std::scoped_lock lock(_mutex);
+  CommandStats recorded;
+  for (const auto& thread : _threads) {
+    for (Pool& pool : thread->frames.at(slot)) {
+      if (pool.usedPrimary + pool.usedSecondary == 0) {
+        continue;
+      }
+      if (const VkResult status = vkResetCommandPool(_device, pool.pool, 0); status != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to reset command pool! status: {}", utils::result(status)));
+      }
+      pool.usedPrimary = 0;
+      pool.usedSecondary = 0;
+    }
+    recorded.allocated += std::exchange(thread->stats.allocated, 0);
+    recorded.reused += std::exchange(thread->stats.reused, 0);
+  }
+  // A frame dropped before recording (e.g. acquire timeout) keeps the numbers of the last recorded one
+  if (recorded.allocated + recorded.reused != 0) {
+    _lastFrame = recorded;
+    _total.allocated += recorded.allocated;
+    _total.reused += recorded.reused;
+  }
+  _slot = slot;
+}
+
+void CommandPools::endFrame(VkSemaphore timeline, uint64_t value)
+{
+  _sync.at(_slot) = {.timeline = timeline, .value = value};
+}
+
+VkCommandBuffer CommandPools::allocate(uint32_t family, VkCommandBufferLevel level)
+{
+  ThreadPools& thread = threadPools();
+  Pool& entry = pool(thread, family);
+  const bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  auto& buffers = primary ? entry.primary : entry.secondary;
+  size_t& used = primary ? entry.usedPrimary : entry.usedSecondary;
+
+  if (used < buffers.size()) {
+    ++thread.stats.reused;
+    return buffers.at(used++);
+  }
+
+  const VkCommandBufferAllocateInfo allocateInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .commandPool = entry.pool,
+      .level = level,
+      .commandBufferCount = 1,
+  };
+  VkCommandBuffer cmd = nullptr;
+  if (const VkResult status = vkAllocateCommandBuffers(_device, &allocateInfo, &cmd); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to allocate command buffer! status: {}", utils::result(status)));
+  }
+  buffers.push_back(cmd);
+  ++used;
+  ++thread.stats.allocated;
+  return cmd;
+}
+
+uint32_t CommandPools::getFramesInFlight() const
+{
+  return _framesInFlight;
+}
+
+CommandStats CommandPools::getLastFrame() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _lastFrame;
+}
+
+CommandStats CommandPools::getTotal() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _total;
+}
+
+CommandPools::ThreadPools& CommandPools::threadPools()
+{
+  thread_local std::unordered_map<uint64_t, ThreadPools*> local;
+  if (const auto found = local.find(_id); found != local.end()) {
+    return *found->second;
+  }
+
+  // Only the first call of every thread takes the locks, long lived threads (e.g. TBB workers) forget destroyed managers
+  {
+    const std::scoped_lock live(liveMutex);
+    std::erase_if(local, [](const auto& entry) { return !liveIds.contains(entry.first); });
+  }
+  const std::scoped_lock lock(_mutex);
+  auto& thread = _threads.emplace_back(std::make_unique<ThreadPools>());
+  thread->frames.assign(_framesInFlight, std::vector<Pool>(_familyCount));
+  local.emplace(_id, thread.get());
+  return *thread;
+}
+
+CommandPools::Pool& CommandPools::pool(ThreadPools& thread, uint32_t family)
+{
+  if (family >= _familySlots.size() || _familySlots.at(family) == noSlot) {
+    throw std::runtime_error(std::format("Queue family {} has no command pools", family));
+  }
+  Pool& pool = thread.frames.at(_slot).at(_familySlots.at(family));
+  if (pool.pool == nullptr) {
+    pool.pool = createPool(_device, family);
+  }
+  return pool;
+}
+}  // namespace vulkan
@@ -0,0 +1,83 @@
+#ifndef LIB_VULKAN_COMMAND_COMMAND_POOLS
+#define LIB_VULKAN_COMMAND_COMMAND_POOLS
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct CommandStats {
+  uint64_t allocated = 0;
+  uint64_t reused = 0;
+};
+
+// One command pool per (recording thread, frame in flight, queue family). Pools of a frame are reset in bulk once the
+// timeline value of its last submission is reached, buffers are then handed out again without per buffer resets.
+class CommandPools {
+public:
+  CommandPools(const CommandPools&) = delete;
+  CommandPools(CommandPools&&) = delete;
+  CommandPools& operator=(const CommandPools&) = delete;
+  CommandPools& operator=(CommandPools&&) = delete;
+
+  explicit CommandPools(const VulkanDevice& device, uint32_t framesInFlight);
+  ~CommandPools();
+
+  // Waits for the previous use of the frame slot and resets its pools, no thread may record into the slot meanwhile
+  void beginFrame(uint64_t frame);
+  // Buffers of the current frame become reusable once the semaphore reaches value
+  void endFrame(VkSemaphore timeline, uint64_t value);
+  // Lock free after the first call of a thread, family has to be one of the families listed by Queue
+  [[nodiscard]] VkCommandBuffer allocate(uint32_t family, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+  [[nodiscard]] uint32_t getFramesInFlight() const;
+  [[nodiscard]] CommandStats getLastFrame() const;
+  [[nodiscard]] CommandStats getTotal() const;
+
+private:
+  struct Pool {
+    VkCommandPool pool = nullptr;
+    std::vector<VkCommandBuffer> primary;
+    std::vector<VkCommandBuffer> secondary;
+    size_t usedPrimary = 0;
+    size_t usedSecondary = 0;
+  };
+
+  // Owned by one recording thread, only beginFrame touches it from outside while that thread does not record
+  struct ThreadPools {
+    std::vector<std::vector<Pool>> frames;
+    CommandStats stats;
+  };
+
+  struct FrameSync {
+    VkSemaphore timeline = nullptr;
+    uint64_t value = 0;
+  };
+
+  VkDevice _device;
+  uint64_t _id;
+  uint32_t _framesInFlight;
+  uint32_t _familyCount = 0;
+  // Family index to position in the per frame pool vector, UINT32_MAX for families Queue does not list
+  std::vector<uint32_t> _familySlots;
+
+  std::atomic<uint32_t> _slot = 0;
+  std::vector<FrameSync> _sync;
+
+  mutable std::mutex _mutex;
+  std::vector<std::unique_ptr<ThreadPools>> _threads;
+  CommandStats _lastFrame;
+  CommandStats _total;
+
+  [[nodiscard]] ThreadPools& threadPools();
+  [[nodiscard]] Pool& pool(ThreadPools& thread, uint32_t family);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMMAND_COMMAND_POOLS */
@@ -0,0 +1,151 @@
+#include "parallel_recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <vulkan/vulkan_core.h>
+
+#include "command_pools.hpp"
+#include "format/string.hpp"
+#include "rendering/rendering.hpp"
+
+namespace vulkan {
+// Weight of the newest measurement in the smoothed item cost
+static constexpr double costSmoothing = 0.25;
+
+static int arenaConcurrency(uint32_t threads)
+{
+  return threads == 0 ? static_cast<int>(tbb::task_arena::automatic) : static_cast<int>(threads);
+}
+
+ParallelRecorder::ParallelRecorder(CommandPools& pools, uint32_t family, uint32_t threads)
+    : _pools(pools),
+      _family(family),
+      _threads(0),
+      _arena(arenaConcurrency(threads))
+{
+  _arena.initialize();
+  _threads = static_cast<uint32_t>(std::max(_arena.max_concurrency(), 1));
+}
+
+void ParallelRecorder::record(VkCommandBuffer cmd, const RenderInheritance& inheritance, uint32_t count, const Record& items)
+{
+  using Nanoseconds = std::chrono::duration<double, std::nano>;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  if (count == 0) {
+    _chunks = 0;
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+
+  const uint32_t chunkSize = getChunkSize(count);
+  const uint32_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<VkCommandBuffer> secondaries(chunks, nullptr);
+  std::vector<double> costs(chunks, 0.0);
+
+  const VkCommandBufferInheritanceRenderingInfo renderingInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .viewMask = 0,
+      .colorAttachmentCount = static_cast<uint32_t>(inheritance.colors.size()),
+      .pColorAttachmentFormats = inheritance.colors.data(),
+      .depthAttachmentFormat = inheritance.depth,
+      .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+      .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+  };
+  const VkCommandBufferInheritanceInfo inheritanceInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .pNext = inheritance.rendering && inheritance.renderPass == nullptr ? &renderingInfo : nullptr,
+      .renderPass = inheritance.renderPass,
+      .subpass = 0,
+      .framebuffer = inheritance.framebuffer,
+      .occlusionQueryEnable = VK_FALSE,
+      .queryFlags = 0,
+      .pipelineStatistics = 0,
+  };
+  VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  if (inheritance.rendering) {
+    usage |= static_cast<VkCommandBufferUsageFlags>(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+  }
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = usage,
+      .pInheritanceInfo = &inheritanceInfo,
+  };
+
+  // One task per chunk, each worker allocates from its own pools
+  _arena.execute([&] {
+    tbb::parallel_for(
+        tbb::blocked_range<uint32_t>(0, chunks, 1),
+        [&](const tbb::blocked_range<uint32_t>& range) {
+          for (uint32_t chunk = range.begin(); chunk != range.end(); ++chunk) {
+            const auto chunkStart = std::chrono::steady_clock::now();
+            VkCommandBuffer secondary = _pools.allocate(_family, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            if (const VkResult status = vkBeginCommandBuffer(secondary, &beginInfo); status != VK_SUCCESS) {
+              throw std::runtime_error(std::format("Failed to begin secondary command buffer! status: {}", utils::result(status)));
+            }
+            const uint32_t first = chunk * chunkSize;
+            items(secondary, first, std::min(first + chunkSize, count));
+            if (const VkResult status = vkEndCommandBuffer(secondary); status != VK_SUCCESS) {
+              throw std::runtime_error(std::format("Failed to end secondary command buffer! status: {}", utils::result(status)));
+            }
+            secondaries.at(chunk) = secondary;
+            costs.at(chunk) = Nanoseconds(std::chrono::steady_clock::now() - chunkStart).count();
+          }
+        },
+        tbb::simple_partitioner());
+  });
+  vkCmdExecuteCommands(cmd, chunks, secondaries.data());
+
+  // Summed over chunks the cost stays per item of work, independent of how many threads shared it
+  double total = 0.0;
+  for (const double cost : costs) {
+    total += cost;
+  }
+  const double measured = total / count;
+  const double previous = _itemCost;
+  _itemCost = previous > 0.0 ? previous + ((measured - previous) * costSmoothing) : measured;
+  _chunks = chunks;
+  _recordTime.add(Milliseconds(std::chrono::steady_clock::now() - start).count());
+}
+
+uint32_t ParallelRecorder::getThreads() const
+{
+  return _threads;
+}
+
+uint32_t ParallelRecorder::getChunkSize(uint32_t count) const
+{
+  // Unmeasured items start at the smallest chunks, the first record then sizes the following ones
+  const double cost = _itemCost;
+  const double byCost = cost > 0.0 ? targetChunkNs / cost : 0.0;
+  const uint32_t spread = (count + (_threads * chunksPerThread) - 1) / (_threads * chunksPerThread);
+  const auto size = static_cast<uint32_t>(std::min(byCost, static_cast<double>(spread)));
+  return std::clamp(size, std::min(minChunk, std::max(count, 1U)), std::max(count, 1U));
+}
+
+uint32_t ParallelRecorder::getChunks() const
+{
+  return _chunks;
+}
+
+double ParallelRecorder::getItemCost() const
+{
+  return _itemCost;
+}
+
+const utils::Samples& ParallelRecorder::getRecordTime() const
+{
+  return _recordTime;
+}
+}  // namespace vulkan
@@ -0,0 +1,62 @@
+#ifndef LIB_VULKAN_COMMAND_PARALLEL_RECORDER
+#define LIB_VULKAN_COMMAND_PARALLEL_RECORDER
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include <tbb/task_arena.h>
+#include <vulkan/vulkan_core.h>
+
+#include "command_pools.hpp"
+#include "rendering/rendering.hpp"
+#include "stats/samples.hpp"
+
+namespace vulkan {
+// Splits the recording of many items over TBB workers into secondary command buffers, one per chunk, executed in chunk
+// order so the result does not depend on scheduling. Chunk sizes follow the measured cost of an item
+class ParallelRecorder {
+public:
+  // Records items [first, last) into cmd, called concurrently for different chunks
+  using Record = std::function<void(VkCommandBuffer cmd, uint32_t first, uint32_t last)>;
+
+  // A chunk should take about this long, long enough to hide the begin and end of its secondary
+  static constexpr double targetChunkNs = 100'000.0;  // 100us
+  static constexpr uint32_t minChunk = 64;
+  // Chunks per thread at least, so TBB can still balance uneven items
+  static constexpr uint32_t chunksPerThread = 4;
+
+  ParallelRecorder(const ParallelRecorder&) = delete;
+  ParallelRecorder(ParallelRecorder&&) = delete;
+  ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+  ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+  // Threads 0 uses every hardware thread
+  explicit ParallelRecorder(CommandPools& pools, uint32_t family, uint32_t threads = 0);
+  ~ParallelRecorder() = default;
+
+  // Inside rendering cmd has to be begun with secondary contents, secondaries come from the current frame of the pools
+  void record(VkCommandBuffer cmd, const RenderInheritance& inheritance, uint32_t count, const Record& items);
+
+  [[nodiscard]] uint32_t getThreads() const;
+  // Chunk size the next record of count items would use
+  [[nodiscard]] uint32_t getChunkSize(uint32_t count) const;
+  [[nodiscard]] uint32_t getChunks() const;
+  // Smoothed recording cost of one item, in nanoseconds
+  [[nodiscard]] double getItemCost() const;
+  // Wall time of record(), in milliseconds
+  [[nodiscard]] const utils::Samples& getRecordTime() const;
+
+private:
+  CommandPools& _pools;
+  uint32_t _family;
+  uint32_t _threads;
+  tbb::task_arena _arena;
+
+  std::atomic<double> _itemCost = 0.0;
+  std::atomic<uint32_t> _chunks = 0;
+  utils::Samples _recordTime;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMMAND_PARALLEL_RECORDER */
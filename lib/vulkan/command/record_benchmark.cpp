@@ -0,0 +1,93 @@
+#include "record_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command_pools.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "parallel_recorder.hpp"
+#include "rendering/rendering.hpp"
+
+namespace vulkan {
+static constexpr VkExtent2D benchmarkExtent = {.width = 1920, .height = 1080};
+
+void recordStandInDraws(VkCommandBuffer cmd, uint32_t first, uint32_t last, VkExtent2D extent)
+{
+  const uint32_t width = std::max(extent.width, 1U);
+  const uint32_t height = std::max(extent.height, 1U);
+  for (uint32_t item = first; item < last; ++item) {
+    // Varying rectangles so the driver can not skip repeated state
+    const VkRect2D scissor{
+        .offset = {.x = static_cast<int32_t>(item % width), .y = static_cast<int32_t>((item / width) % height)},
+        .extent = {.width = width - (item % width), .height = height - ((item / width) % height)},
+    };
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+  }
+}
+
+static void beginPrimary(VkCommandBuffer cmd)
+{
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = nullptr,
+  };
+  if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to begin command buffer! status: {}", utils::result(status)));
+  }
+}
+
+std::vector<RecordScaling> benchmarkRecording(const VulkanDevice& device, std::span<const uint32_t> draws,
+                                              std::span<const uint32_t> threads, uint32_t repeats)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto& graphics = device.getQueue().getGraphics();
+  if (graphics.empty()) {
+    throw std::runtime_error("Device has no queue family able to render");
+  }
+  const uint32_t family = graphics.front();
+  const auto items = [](VkCommandBuffer cmd, uint32_t first, uint32_t last) { recordStandInDraws(cmd, first, last, benchmarkExtent); };
+
+  std::vector<RecordScaling> results;
+  results.reserve(draws.size() * threads.size());
+  for (const uint32_t threadCount : threads) {
+    // Nothing is submitted, so beginFrame only resets and the same buffers are reused every run
+    CommandPools pools(device, 1);
+    ParallelRecorder recorder(pools, family, threadCount);
+    uint64_t frame = 0;
+    for (const uint32_t drawCount : draws) {
+      double total = 0.0;
+      // The first run only measures the item cost the chunk size follows
+      for (uint32_t run = 0; run <= repeats; ++run) {
+        pools.beginFrame(frame++);
+        VkCommandBuffer cmd = pools.allocate(family);
+        const auto start = std::chrono::steady_clock::now();
+        beginPrimary(cmd);
+        recorder.record(cmd, {}, drawCount, items);
+        if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+          throw std::runtime_error(std::format("Failed to end command buffer! status: {}", utils::result(status)));
+        }
+        if (run != 0) {
+          total += Milliseconds(std::chrono::steady_clock::now() - start).count();
+        }
+      }
+      results.push_back({
+          .draws = drawCount,
+          .threads = recorder.getThreads(),
+          .chunks = recorder.getChunks(),
+          .recordMs = total / std::max(repeats, 1U),
+      });
+    }
+  }
+  return results;
+}
+}  // namespace vulkan
@@ -0,0 +1,29 @@
+#ifndef LIB_VULKAN_COMMAND_RECORD_BENCHMARK
+#define LIB_VULKAN_COMMAND_RECORD_BENCHMARK
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct RecordScaling {
+  uint32_t draws;
+  uint32_t threads;
+  uint32_t chunks;
+  // Mean wall time of recording all draws into one primary, in milliseconds
+  double recordMs;
+};
+
+// Stand-in for draw calls until pipelines exist: per item dynamic state, which costs a driver call like a draw does
+void recordStandInDraws(VkCommandBuffer cmd, uint32_t first, uint32_t last, VkExtent2D extent);
+
+// Recording time of every draw count with every thread count, nothing is submitted
+[[nodiscard]] std::vector<RecordScaling> benchmarkRecording(const VulkanDevice& device, std::span<const uint32_t> draws,
+                                                            std::span<const uint32_t> threads, uint32_t repeats);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMMAND_RECORD_BENCHMARK */
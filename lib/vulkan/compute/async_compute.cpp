@@ -0,0 +1,347 @@
+#include "async_compute.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+
+namespace vulkan {
+// The worker wakes up regularly so a stop request is never missed while the device is busy
+static constexpr uint64_t pollTimeout = 100'000'000;  // 100ms
+
+struct ComputeQueue {
+  uint32_t family;
+  uint32_t index;
+  bool parallel;
+  bool dedicated;
+};
+
+static ComputeQueue chooseQueue(const VulkanDevice& device)
+{
+  // Compute families are sorted from the most dedicated one, the render threads use queue 0 of the first graphics family
+  const Queue& queue = device.getQueue();
+  if (queue.getCompute().empty()) {
+    throw std::runtime_error("Device has no queue family able to compute");
+  }
+  const uint32_t family = queue.getCompute().front();
+  const uint32_t graphics = queue.getGraphics().empty() ? family : queue.getGraphics().front();
+  if (family != graphics) {
+    return {.family = family, .index = 0, .parallel = true, .dedicated = true};
+  }
+  if (queue.count(family) > 1) {
+    return {.family = family, .index = 1, .parallel = true, .dedicated = false};
+  }
+  return {.family = family, .index = 0, .parallel = false, .dedicated = false};
+}
+
+static uint32_t timestampBits(const VulkanDevice& device, uint32_t family)
+{
+  const auto& queues = device.getData().queues;
+  const auto found = std::ranges::find(queues, family, &DeviceDataQueue::queueIndex);
+  return found != queues.end() ? found->properties.timestampValidBits : 0;
+}
+
+static VkCommandPool createPool(VkDevice device, uint32_t family)
+{
+  const VkCommandPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = static_cast<uint32_t>(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) | static_cast<uint32_t>(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+      .queueFamilyIndex = family,
+  };
+
+  VkCommandPool pool = nullptr;
+  if (const VkResult status = vkCreateCommandPool(device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create compute command pool! status: {}", utils::result(status)));
+  }
+  return pool;
+}
+
+static VkQueryPool createQueries(VkDevice device, bool enabled)
+{
+  if (!enabled) {
+    return nullptr;
+  }
+
+  // Two timestamps per job slot
+  const VkQueryPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .queryType = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = AsyncCompute::maxPending * 2,
+      .pipelineStatistics = 0,
+  };
+  VkQueryPool pool = nullptr;
+  if (const VkResult status = vkCreateQueryPool(device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create compute query pool! status: {}", utils::result(status)));
+  }
+  return pool;
+}
+
+AsyncCompute::AsyncCompute(const VulkanDevice& device) : _device(device.get()), _queue(device.getQueue()), _timeline(_device)
+{
+  const ComputeQueue chosen = chooseQueue(device);
+  _family = chosen.family;
+  _index = chosen.index;
+  _parallel = chosen.parallel;
+  _dedicated = chosen.dedicated;
+
+  const uint32_t bits = timestampBits(device, _family);
+  _timestampMask = bits >= 64 ? ~0ULL : (1ULL << bits) - 1;
+  _timestampPeriod = static_cast<double>(device.getData().properties.limits.timestampPeriod);
+
+  _pool = createPool(_device, _family);
+  try {
+    _queries = createQueries(_device, bits != 0);
+  }
+  catch (...) {
+    vkDestroyCommandPool(_device, _pool, nullptr);
+    throw;
+  }
+  for (uint32_t slot = maxPending; slot-- > 0;) {
+    _freeSlots.push_back(slot);
+  }
+
+  _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+}
+
+AsyncCompute::~AsyncCompute()
+{
+  // The worker drains every submitted job before it returns
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+  if (_queries != nullptr) {
+    vkDestroyQueryPool(_device, _queries, nullptr);
+  }
+  vkDestroyCommandPool(_device, _pool, nullptr);
+}
+
+uint64_t AsyncCompute::submit(const Record& record, std::span<const SemaphoreWait> waits)
+{
+  // Held until the submission is done, timeline values have to reach the queue in the order they are handed out
+  std::unique_lock lock(_mutex);
+  _released.wait(lock, [this] { return _failure != nullptr || !_freeSlots.empty(); });
+  if (_failure != nullptr) {
+    std::rethrow_exception(_failure);
+  }
+  const uint32_t slot = _freeSlots.back();
+
+  VkCommandBuffer cmd = acquireCommandBuffer();
+  try {
+    const VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+    if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to begin compute command buffer! status: {}", utils::result(status)));
+    }
+
+    if (_queries != nullptr) {
+      vkCmdResetQueryPool(cmd, _queries, slot * 2, 2);
+      vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queries, slot * 2);
+    }
+    record(cmd);
+    if (_queries != nullptr) {
+      vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queries, (slot * 2) + 1);
+    }
+
+    if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to end compute command buffer! status: {}", utils::result(status)));
+    }
+
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<uint64_t> waitValues;
+    std::vector<VkPipelineStageFlags> waitStages;
+    waitSemaphores.reserve(waits.size());
+    waitValues.reserve(waits.size());
+    waitStages.reserve(waits.size());
+    for (const auto& wait : waits) {
+      waitSemaphores.push_back(wait.semaphore);
+      waitValues.push_back(wait.value);
+      waitStages.push_back(wait.stage);
+    }
+
+    const uint64_t value = _timeline.next();
+    VkSemaphore signal = _timeline.get();
+    const VkTimelineSemaphoreSubmitInfo timelineInfo{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+        .pWaitSemaphoreValues = waitValues.data(),
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+    const VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+        .pWaitSemaphores = waitSemaphores.data(),
+        .pWaitDstStageMask = waitStages.data(),
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &signal,
+    };
+    _queue.submit(_family, {&submitInfo, 1}, nullptr, _index);
+
+    _freeSlots.pop_back();
+    _pending.emplace_back(value, cmd, slot, std::chrono::steady_clock::now());
+    lock.unlock();
+    _submitted.notify_one();
+    return value;
+  }
+  catch (...) {
+    // May still be recording, freed instead of going back to the free list
+    vkFreeCommandBuffers(_device, _pool, 1, &cmd);
+    throw;
+  }
+}
+
+SemaphoreWait AsyncCompute::after(uint64_t value, VkPipelineStageFlags stage) const
+{
+  return {.semaphore = _timeline.get(), .value = value, .stage = stage};
+}
+
+bool AsyncCompute::wait(uint64_t value, uint64_t timeout) const
+{
+  return _timeline.wait(value, timeout);
+}
+
+uint32_t AsyncCompute::getFamily() const
+{
+  return _family;
+}
+
+uint32_t AsyncCompute::getQueueIndex() const
+{
+  return _index;
+}
+
+bool AsyncCompute::isParallel() const
+{
+  return _parallel;
+}
+
+bool AsyncCompute::isDedicated() const
+{
+  return _dedicated;
+}
+
+uint64_t AsyncCompute::getJobs() const
+{
+  return _jobs;
+}
+
+const utils::Samples& AsyncCompute::getGpuTime() const
+{
+  return _gpuTime;
+}
+
+const utils::Samples& AsyncCompute::getLatency() const
+{
+  return _latency;
+}
+
+VkCommandBuffer AsyncCompute::acquireCommandBuffer()
+{
+  if (!_free.empty()) {
+    VkCommandBuffer cmd = _free.back();
+    _free.pop_back();
+    return cmd;
+  }
+
+  const VkCommandBufferAllocateInfo allocateInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .commandPool = _pool,
+      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .commandBufferCount = 1,
+  };
+  VkCommandBuffer cmd = nullptr;
+  if (const VkResult status = vkAllocateCommandBuffers(_device, &allocateInfo, &cmd); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to allocate compute command buffer! status: {}", utils::result(status)));
+  }
+  return cmd;
+}
+
+void AsyncCompute::loop(const std::stop_token& token)
+{
+  try {
+    while (true) {
+      Pending oldest{};
+      {
+        std::unique_lock lock(_mutex);
+        _submitted.wait(lock, token, [this] { return !_pending.empty(); });
+        if (_pending.empty()) {
+          return;  // Stop requested and everything drained
+        }
+        oldest = _pending.front();
+      }
+
+      if (_timeline.wait(oldest.value, pollTimeout)) {
+        complete(oldest);
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << std::format("Async compute thread stopped:\n\t{}\n", e.what());
+    {
+      const std::scoped_lock lock(_mutex);
+      _failure = std::current_exception();
+    }
+    _released.notify_all();
+  }
+}
+
+void AsyncCompute::complete(const Pending& pending)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  _latency.add(Milliseconds(std::chrono::steady_clock::now() - pending.submitted).count());
+  ++_jobs;
+
+  if (_queries != nullptr) {
+    std::array<uint64_t, 2> timestamps{};
+    const VkResult status = vkGetQueryPoolResults(_device, _queries, pending.slot * 2, 2, sizeof(timestamps), timestamps.data(),
+                                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (status != VK_SUCCESS && status != VK_NOT_READY) {
+      throw std::runtime_error(std::format("Failed to read compute timestamps! status: {}", utils::result(status)));
+    }
+    if (status == VK_SUCCESS) {
+      static constexpr double nanosecondsPerMillisecond = 1'000'000.0;
+      const uint64_t ticks = ((timestamps[1] & _timestampMask) - (timestamps[0] & _timestampMask)) & _timestampMask;
+      _gpuTime.add(static_cast<double>(ticks) * _timestampPeriod / nanosecondsPerMillisecond);
+    }
+  }
+
+  {
+    // The job is done, its command buffer and query slot can be reused
+    const std::scoped_lock lock(_mutex);
+    if (const VkResult status = vkResetCommandBuffer(pending.cmd, 0); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to reset compute command buffer! status: {}", utils::result(status)));
+    }
+    _free.push_back(pending.cmd);
+    _freeSlots.push_back(pending.slot);
+    _pending.pop_front();
+  }
+  _released.notify_all();
+}
+}  // namespace vulkan
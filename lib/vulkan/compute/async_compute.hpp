@@ -0,0 +1,101 @@
+#ifndef LIB_VULKAN_COMPUTE_ASYNC_COMPUTE
+#define LIB_VULKAN_COMPUTE_ASYNC_COMPUTE
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "device/queue.hpp"
+#include "stats/samples.hpp"
+#include "sync/timeline.hpp"
+
+namespace vulkan {
+// Compute jobs on the most dedicated compute family, ordered against other queues through timeline values.
+// Falls back to a second queue of the graphics family, or to the graphics queue itself, when the device has nothing better.
+class AsyncCompute {
+public:
+  using Record = std::function<void(VkCommandBuffer)>;
+
+  static constexpr uint32_t maxPending = 64;
+
+  AsyncCompute(const AsyncCompute&) = delete;
+  AsyncCompute(AsyncCompute&&) = delete;
+  AsyncCompute& operator=(const AsyncCompute&) = delete;
+  AsyncCompute& operator=(AsyncCompute&&) = delete;
+
+  explicit AsyncCompute(const VulkanDevice& device);
+  ~AsyncCompute();
+
+  // Returns the timeline value signaled once the job is done, blocks while maxPending jobs are in flight. Throws once
+  // the worker thread has stopped on an error
+  uint64_t submit(const Record& record, std::span<const SemaphoreWait> waits = {});
+  // Wait description for submissions on other queues depending on a job
+  [[nodiscard]] SemaphoreWait after(uint64_t value, VkPipelineStageFlags stage) const;
+  // Returns false on timeout
+  [[nodiscard]] bool wait(uint64_t value, uint64_t timeout) const;
+
+  [[nodiscard]] uint32_t getFamily() const;
+  [[nodiscard]] uint32_t getQueueIndex() const;
+  // True when jobs run on a queue other than the one used for rendering
+  [[nodiscard]] bool isParallel() const;
+  [[nodiscard]] bool isDedicated() const;
+  [[nodiscard]] uint64_t getJobs() const;
+  // Job execution on the device, in milliseconds, empty when the family has no timestamps
+  [[nodiscard]] const utils::Samples& getGpuTime() const;
+  // Submit to completion seen by the host, in milliseconds
+  [[nodiscard]] const utils::Samples& getLatency() const;
+
+private:
+  struct Pending {
+    uint64_t value;
+    VkCommandBuffer cmd;
+    uint32_t slot;
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  VkDevice _device;
+  Queue& _queue;
+  uint32_t _family;
+  uint32_t _index;
+  bool _parallel;
+  bool _dedicated;
+  uint64_t _timestampMask;
+  double _timestampPeriod;
+  Timeline _timeline;
+  VkCommandPool _pool = nullptr;
+  VkQueryPool _queries = nullptr;
+
+  std::mutex _mutex;
+  std::condition_variable _released;
+  std::condition_variable_any _submitted;
+  std::deque<Pending> _pending;
+  std::vector<VkCommandBuffer> _free;
+  std::vector<uint32_t> _freeSlots;
+  // Set when the worker stopped on an error, nothing releases slots anymore
+  std::exception_ptr _failure;
+
+  utils::Samples _gpuTime;
+  utils::Samples _latency;
+  std::atomic<uint64_t> _jobs = 0;
+
+  std::jthread _thread;
+
+  [[nodiscard]] VkCommandBuffer acquireCommandBuffer();
+  void loop(const std::stop_token& token);
+  void complete(const Pending& pending);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMPUTE_ASYNC_COMPUTE */
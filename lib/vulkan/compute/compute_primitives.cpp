@@ -0,0 +1,460 @@
+#include "compute_primitives.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/specialization.hpp"
+
+namespace vulkan {
+// Wide enough to hide memory latency, small enough that barriers inside the scan stay cheap
+static constexpr uint32_t preferredWorkgroup = 256;
+static constexpr uint32_t maxHistogramBins = 4096;
+static constexpr VkDeviceSize scratchBlock = 4ULL * 1024ULL * 1024ULL;  // 4MB
+static constexpr VkDeviceSize element = sizeof(uint32_t);
+// Digits of 4 bits, RADIX of shader/glsl/primitives/radix.glsl
+static constexpr uint32_t radixBits = 4;
+static constexpr uint32_t radix = 1U << radixBits;
+// Cleared by transfers, sort results are copied out of it
+static constexpr VkBufferUsageFlags scratchUsage =
+    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+// Ids match shader/glsl/primitives/primitives.glsl, bins is only declared by the histogram, keyWords and payload by
+// primitives/radix.glsl
+using PrimitiveConstants = Specialization<SpecConstant<0, "workgroupSize", uint32_t, preferredWorkgroup>,
+                                          SpecConstant<1, "items", uint32_t, ComputePrimitives::itemsPerInvocation>,
+                                          SpecConstant<2, "bins", uint32_t, 256U>,
+                                          SpecConstant<3, "keyWords", uint32_t, 1U>,
+                                          SpecConstant<4, "payload", bool, false>>;
+
+static uint32_t chooseWorkgroupSize(const VkPhysicalDeviceLimits& limits)
+{
+  // Power of two for the reduction tree, its shared array takes one element per invocation
+  uint32_t size = preferredWorkgroup;
+  while (size > 1 && (size > limits.maxComputeWorkGroupInvocations || size > limits.maxComputeWorkGroupSize[0] ||
+                      size * element > limits.maxComputeSharedMemorySize)) {
+    size /= 2;
+  }
+  return size;
+}
+
+static uint32_t chooseMaxBins(const VkPhysicalDeviceLimits& limits)
+{
+  return std::min(std::bit_floor(static_cast<uint32_t>(limits.maxComputeSharedMemorySize / element)), maxHistogramBins);
+}
+
+static uint32_t chooseSortWorkgroupSize(const VkPhysicalDeviceLimits& limits, uint32_t workgroupSize)
+{
+  // The scatter keeps a column of digit counts per invocation in shared memory
+  uint32_t size = workgroupSize;
+  while (size > 1 && (radix * size + radix) * element > limits.maxComputeSharedMemorySize) {
+    size /= 2;
+  }
+  return size;
+}
+
+static void computeBarrier(VkCommandBuffer cmd, VkPipelineStageFlags source, VkAccessFlags access)
+{
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = access,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, source, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+static void computeBarrier(VkCommandBuffer cmd)
+{
+  computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+}
+
+ComputePrimitives::ComputePrimitives(const VulkanDevice& device)
+    : _device(device),
+      _workgroupSize(chooseWorkgroupSize(device.getData().properties.limits)),
+      _maxBins(chooseMaxBins(device.getData().properties.limits)),
+      _sortWorkgroupSize(chooseSortWorkgroupSize(device.getData().properties.limits, _workgroupSize)),
+      _maxGroups(device.getData().properties.limits.maxComputeWorkGroupCount[0]),
+      _alignment(std::max<VkDeviceSize>(device.getData().properties.limits.minStorageBufferOffsetAlignment, element)),
+      _scanTile(createKernel("primitives/scanTile.comp", {})),
+      _scanAdd(createKernel("primitives/scanAdd.comp", {})),
+      _reduce(createKernel("primitives/reduce.comp", {})),
+      _compactFlags(createKernel("primitives/compactFlags.comp", {})),
+      _compactScatter(createKernel("primitives/compactScatter.comp", {})),
+      _sets(device.get())
+{
+}
+
+ComputePrimitives::~ComputePrimitives()
+{
+  // Layouts belong to the device cache
+  for (const Kernel& kernel : {_scanTile, _scanAdd, _reduce, _compactFlags, _compactScatter}) {
+    vkDestroyPipeline(_device.get(), kernel.pipeline, nullptr);
+  }
+  for (const auto& [bins, kernel] : _histograms) {
+    vkDestroyPipeline(_device.get(), kernel.pipeline, nullptr);
+  }
+  for (const auto& [variant, kernels] : _sorts) {
+    vkDestroyPipeline(_device.get(), kernels.first.pipeline, nullptr);
+    vkDestroyPipeline(_device.get(), kernels.second.pipeline, nullptr);
+  }
+}
+
+void ComputePrimitives::exclusiveScan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count)
+{
+  scan(cmd, input, output, count, false);
+}
+
+void ComputePrimitives::inclusiveScan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count)
+{
+  scan(cmd, input, output, count, true);
+}
+
+void ComputePrimitives::reduce(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output,
+                               uint32_t count, ReduceOp op)
+{
+  if (count == 0) {
+    vkCmdFillBuffer(cmd, output.buffer, output.offset, element, op == ReduceOp::min ? UINT32_MAX : 0U);
+    return;
+  }
+
+  // Every pass leaves one value per tile until a single tile is left
+  VkDescriptorBufferInfo source = input;
+  for (uint32_t remaining = count;;) {
+    const uint32_t groups = groupsFor(remaining);
+    const VkDescriptorBufferInfo target = groups == 1 ? output : scratch(groups * element);
+    const std::array<VkDescriptorBufferInfo, 2> buffers = {source, target};
+    dispatch(cmd, _reduce, buffers, {.count = remaining, .mode = static_cast<uint32_t>(op)}, groups);
+    if (groups == 1) {
+      return;
+    }
+    computeBarrier(cmd);
+    source = target;
+    remaining = groups;
+  }
+}
+
+void ComputePrimitives::compact(VkCommandBuffer cmd,
+                                const VkDescriptorBufferInfo& input,
+                                const VkDescriptorBufferInfo& output,
+                                const VkDescriptorBufferInfo& counter,
+                                uint32_t count,
+                                Compare compare,
+                                uint32_t value)
+{
+  if (count == 0) {
+    vkCmdFillBuffer(cmd, counter.buffer, counter.offset, element, 0);
+    return;
+  }
+
+  // Flags scanned exclusively are the output index of every passing element
+  const Push push{.count = count, .mode = static_cast<uint32_t>(compare), .value = value};
+  const VkDescriptorBufferInfo flags = scratch(count * element);
+  const VkDescriptorBufferInfo indices = scratch(count * element);
+  const std::array<VkDescriptorBufferInfo, 2> flagBuffers = {input, flags};
+  dispatch(cmd, _compactFlags, flagBuffers, push, groupsFor(count));
+  computeBarrier(cmd);
+  scan(cmd, flags, indices, count, false);
+  computeBarrier(cmd);
+  const std::array<VkDescriptorBufferInfo, 4> scatterBuffers = {input, indices, output, counter};
+  dispatch(cmd, _compactScatter, scatterBuffers, push, groupsFor(count));
+}
+
+void ComputePrimitives::histogram(VkCommandBuffer cmd,
+                                  const VkDescriptorBufferInfo& input,
+                                  const VkDescriptorBufferInfo& output,
+                                  uint32_t count,
+                                  uint32_t bins,
+                                  uint32_t shift)
+{
+  if (!std::has_single_bit(bins) || bins > _maxBins) {
+    throw std::runtime_error(std::format("Histogram of {} bins, a power of two up to {} is supported", bins, _maxBins));
+  }
+  if (shift >= 32) {
+    throw std::runtime_error(std::format("Histogram shift {} is wider than an element", shift));
+  }
+
+  vkCmdFillBuffer(cmd, output.buffer, output.offset, bins * element, 0);
+  if (count == 0) {
+    return;
+  }
+  computeBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+  auto found = _histograms.find(bins);
+  if (found == _histograms.end()) {
+    found = _histograms.emplace(bins, createKernel("primitives/histogram.comp", {.bins = bins})).first;
+  }
+  const std::array<VkDescriptorBufferInfo, 2> buffers = {input, output};
+  dispatch(cmd, found->second, buffers, {.count = count, .mode = shift}, groupsFor(count));
+}
+
+void ComputePrimitives::sort(VkCommandBuffer cmd, const VkDescriptorBufferInfo& keys, uint32_t count, SortKey key, uint32_t bits)
+{
+  radixSort(cmd, keys, nullptr, count, key, bits);
+}
+
+void ComputePrimitives::sortPairs(VkCommandBuffer cmd,
+                                  const VkDescriptorBufferInfo& keys,
+                                  const VkDescriptorBufferInfo& values,
+                                  uint32_t count,
+                                  SortKey key,
+                                  uint32_t bits)
+{
+  radixSort(cmd, keys, &values, count, key, bits);
+}
+
+void ComputePrimitives::reset()
+{
+  _sets.reset();
+  // Blocks are merged into one covering all of them, the next round fits without growing again
+  if (_scratch.size() > 1) {
+    VkDeviceSize total = 0;
+    for (const Buffer& buffer : _scratch) {
+      total += buffer.getSize();
+    }
+    _scratch.clear();
+    _scratch.emplace_back(_device, BufferInfo{.size = total, .usage = scratchUsage});
+  }
+  _scratchUsed = 0;
+}
+
+uint32_t ComputePrimitives::getWorkgroupSize() const
+{
+  return _workgroupSize;
+}
+
+uint32_t ComputePrimitives::getTileSize() const
+{
+  return _workgroupSize * itemsPerInvocation;
+}
+
+uint32_t ComputePrimitives::getMaxBins() const
+{
+  return _maxBins;
+}
+
+uint32_t ComputePrimitives::getSortWorkgroupSize() const
+{
+  return _sortWorkgroupSize;
+}
+
+const PrimitiveStats& ComputePrimitives::getStats() const
+{
+  return _stats;
+}
+
+ComputePrimitives::Kernel ComputePrimitives::createKernel(std::string_view shader, const KernelOptions& options) const
+{
+  // The module is only needed while the pipeline is created
+  const ShaderModule module(_device.get(), findShader(shader));
+  const std::array<const ShaderReflection*, 1> stages = {&module.getReflection()};
+  const PipelineLayout layout = _device.getLayoutCache().getPipelineLayout(combine(stages));
+
+  PrimitiveConstants constants;
+  constants.set<"workgroupSize">(options.workgroupSize != 0 ? options.workgroupSize : _workgroupSize);
+  if (options.bins != 0) {
+    constants.set<"bins">(options.bins);
+  }
+  constants.set<"keyWords">(options.keyWords);
+  constants.set<"payload">(options.payload);
+  const SpecializationView view = constants.view();
+  const VkSpecializationInfo specialization{
+      .mapEntryCount = static_cast<uint32_t>(view.entries.size()),
+      .pMapEntries = view.entries.data(),
+      .dataSize = view.data.size(),
+      .pData = view.data.data(),
+  };
+  const VkComputePipelineCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage =
+          {
+              .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+              .pNext = nullptr,
+              .flags = 0,
+              .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+              .module = module.get(),
+              .pName = module.getReflection().entry.c_str(),
+              .pSpecializationInfo = &specialization,
+          },
+      .layout = layout.layout,
+      .basePipelineHandle = nullptr,
+      .basePipelineIndex = -1,
+  };
+
+  VkPipeline pipeline = nullptr;
+  if (const VkResult status = vkCreateComputePipelines(_device.get(), _device.getPipelineCache().get(), 1, &createInfo, nullptr, &pipeline);
+      status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create compute pipeline {}! status: {}", shader, utils::result(status)));
+  }
+  return {.pipeline = pipeline, .layout = layout.layout, .set = layout.sets.front()};
+}
+
+VkDescriptorBufferInfo ComputePrimitives::scratch(VkDeviceSize size)
+{
+  const VkDeviceSize offset = (_scratchUsed + _alignment - 1) / _alignment * _alignment;
+  if (_scratch.empty() || offset + size > _scratch.back().getSize()) {
+    const VkDeviceSize blockSize = std::max(scratchBlock, size);
+    _scratch.emplace_back(_device, BufferInfo{.size = blockSize, .usage = scratchUsage});
+    _stats.scratchBytes += blockSize;
+    _scratchUsed = size;
+    return {.buffer = _scratch.back().get(), .offset = 0, .range = size};
+  }
+  _scratchUsed = offset + size;
+  return {.buffer = _scratch.back().get(), .offset = offset, .range = size};
+}
+
+void ComputePrimitives::dispatch(VkCommandBuffer cmd, const Kernel& kernel, std::span<const VkDescriptorBufferInfo> buffers,
+                                 Push push, uint32_t groups)
+{
+  VkDescriptorSet set = _sets.allocate(kernel.set);
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.reserve(buffers.size());
+  for (const VkDescriptorBufferInfo& buffer : buffers) {
+    writes.push_back({
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = set,
+        .dstBinding = static_cast<uint32_t>(writes.size()),
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo = nullptr,
+        .pBufferInfo = &buffer,
+        .pTexelBufferView = nullptr,
+    });
+  }
+  vkUpdateDescriptorSets(_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.pipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout, 0, 1, &set, 0, nullptr);
+  // Split where the group count limit is hit, the kernels add firstGroup back
+  for (uint32_t first = 0; first < groups; first += _maxGroups) {
+    push.firstGroup = first;
+    vkCmdPushConstants(cmd, kernel.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Push), &push);
+    vkCmdDispatch(cmd, std::min(groups - first, _maxGroups), 1, 1);
+    ++_stats.dispatches;
+  }
+}
+
+void ComputePrimitives::scan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output,
+                             uint32_t count, bool inclusive)
+{
+  if (count == 0) {
+    return;
+  }
+
+  // Tiles scan on their own, the tile totals are scanned recursively and added back
+  const uint32_t groups = groupsFor(count);
+  const VkDescriptorBufferInfo sums = scratch(groups * element);
+  const std::array<VkDescriptorBufferInfo, 3> buffers = {input, output, sums};
+  dispatch(cmd, _scanTile, buffers, {.count = count, .mode = inclusive ? 1U : 0U}, groups);
+  if (groups == 1) {
+    return;
+  }
+  computeBarrier(cmd);
+  scan(cmd, sums, sums, groups, false);
+  computeBarrier(cmd);
+  const std::array<VkDescriptorBufferInfo, 2> addBuffers = {output, sums};
+  dispatch(cmd, _scanAdd, addBuffers, {.count = count}, groups);
+}
+
+void ComputePrimitives::radixSort(VkCommandBuffer cmd,
+                                  const VkDescriptorBufferInfo& keys,
+                                  const VkDescriptorBufferInfo* values,
+                                  uint32_t count,
+                                  SortKey key,
+                                  uint32_t bits)
+{
+  const uint32_t keyWords = key == SortKey::uint64 ? 2 : 1;
+  const uint32_t keyBits = keyWords * 32;
+  if (bits == 0) {
+    bits = keyBits;
+  }
+  if (bits > keyBits) {
+    throw std::runtime_error(std::format("Sorting on {} bits of {} bit keys", bits, keyBits));
+  }
+  if (count < 2) {
+    return;
+  }
+
+  const uint32_t variant = (keyWords << 1U) | (values != nullptr ? 1U : 0U);
+  auto found = _sorts.find(variant);
+  if (found == _sorts.end()) {
+    const KernelOptions options{.workgroupSize = _sortWorkgroupSize, .bins = 0, .keyWords = keyWords, .payload = values != nullptr};
+    found = _sorts.emplace(variant, std::pair(createKernel("primitives/radixCount.comp", options),
+                                              createKernel("primitives/radixScatter.comp", options))).first;
+  }
+  const auto& [countKernel, scatterKernel] = found->second;
+
+  // Keys and values go back and forth between the caller's buffers and scratch, one digit per pass
+  const uint32_t groups = groupsFor(count, _sortWorkgroupSize * itemsPerInvocation);
+  const VkDescriptorBufferInfo counts = scratch(VkDeviceSize{radix} * groups * element);
+  std::array<VkDescriptorBufferInfo, 2> keyBuffers = {keys, scratch(VkDeviceSize{count} * keyWords * element)};
+  // Without payload the value bindings point at the keys, the kernel never touches them
+  std::array<VkDescriptorBufferInfo, 2> valueBuffers = keyBuffers;
+  if (values != nullptr) {
+    valueBuffers = {*values, scratch(VkDeviceSize{count} * element)};
+  }
+
+  const uint32_t passes = (bits + radixBits - 1) / radixBits;
+  for (uint32_t pass = 0; pass < passes; ++pass) {
+    const Push push{.count = count, .mode = pass * radixBits, .value = groups};
+    const std::array<VkDescriptorBufferInfo, 2> countBuffers = {keyBuffers[0], counts};
+    dispatch(cmd, countKernel, countBuffers, push, groups);
+    computeBarrier(cmd);
+    scan(cmd, counts, counts, radix * groups, false);
+    computeBarrier(cmd);
+    const std::array<VkDescriptorBufferInfo, 5> scatterBuffers = {keyBuffers[0], counts, keyBuffers[1], valueBuffers[0], valueBuffers[1]};
+    dispatch(cmd, scatterKernel, scatterBuffers, push, groups);
+    computeBarrier(cmd);
+    std::swap(keyBuffers[0], keyBuffers[1]);
+    std::swap(valueBuffers[0], valueBuffers[1]);
+  }
+  if (passes % 2 == 0) {
+    return;
+  }
+
+  // Sorted data sits in scratch after an odd number of passes
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+  const VkBufferCopy keyCopy{.srcOffset = keyBuffers[0].offset, .dstOffset = keys.offset, .size = VkDeviceSize{count} * keyWords * element};
+  vkCmdCopyBuffer(cmd, keyBuffers[0].buffer, keys.buffer, 1, &keyCopy);
+  if (values != nullptr) {
+    const VkBufferCopy valueCopy{.srcOffset = valueBuffers[0].offset, .dstOffset = values->offset, .size = VkDeviceSize{count} * element};
+    vkCmdCopyBuffer(cmd, valueBuffers[0].buffer, values->buffer, 1, &valueCopy);
+  }
+}
+
+uint32_t ComputePrimitives::groupsFor(uint32_t count, uint32_t tile) const
+{
+  return static_cast<uint32_t>((uint64_t{count} + tile - 1) / tile);
+}
+
+uint32_t ComputePrimitives::groupsFor(uint32_t count) const
+{
+  return groupsFor(count, getTileSize());
+}
+}  // namespace vulkan
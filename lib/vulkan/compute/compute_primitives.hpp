@@ -0,0 +1,167 @@
+#ifndef LIB_VULKAN_COMPUTE_COMPUTE_PRIMITIVES
+#define LIB_VULKAN_COMPUTE_COMPUTE_PRIMITIVES
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "memory/buffer.hpp"
+
+namespace vulkan {
+enum class ReduceOp : uint8_t {
+  sum,
+  min,
+  max,
+};
+
+// Element <compare> value
+enum class Compare : uint8_t {
+  equal,
+  notEqual,
+  less,
+  greaterEqual,
+};
+
+enum class SortKey : uint8_t {
+  uint32,
+  // Two words, low word first
+  uint64,
+};
+
+struct PrimitiveStats {
+  uint64_t dispatches = 0;
+  // Scratch memory held, it is kept across resets
+  VkDeviceSize scratchBytes = 0;
+};
+
+// Data parallel kernels over buffers of any number of uint32_t, recorded into the caller's command buffer. Workgroup
+// size and histogram bins are fitted to maxComputeWorkGroupInvocations and maxComputeSharedMemorySize and baked in with
+// specialization constants. Inputs have to be made visible to compute shaders before and outputs are only written by
+// them, barriers on both sides belong to the caller. Outputs cleared on the device (histogram, empty inputs) need
+// VK_BUFFER_USAGE_TRANSFER_DST_BIT. Descriptor sets and scratch buffers live until reset(), which is
+// only called once the GPU is done with everything recorded before. Not thread safe
+class ComputePrimitives {
+public:
+  static constexpr uint32_t itemsPerInvocation = 4;
+
+  ComputePrimitives(const ComputePrimitives&) = delete;
+  ComputePrimitives(ComputePrimitives&&) = delete;
+  ComputePrimitives& operator=(const ComputePrimitives&) = delete;
+  ComputePrimitives& operator=(ComputePrimitives&&) = delete;
+
+  explicit ComputePrimitives(const VulkanDevice& device);
+  ~ComputePrimitives();
+
+  // Output may be the input itself
+  void exclusiveScan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count);
+  void inclusiveScan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count);
+  // Result goes to the first element of output, an empty input gives the identity of op
+  void reduce(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count,
+              ReduceOp op = ReduceOp::sum);
+  // Elements passing the compare keep their order in output, how many passed goes to the first element of counter
+  void compact(VkCommandBuffer cmd,
+               const VkDescriptorBufferInfo& input,
+               const VkDescriptorBufferInfo& output,
+               const VkDescriptorBufferInfo& counter,
+               uint32_t count,
+               Compare compare,
+               uint32_t value);
+  // Counts of (element >> shift) & (bins - 1), bins is a power of two up to getMaxBins(). Output is cleared first
+  void histogram(VkCommandBuffer cmd,
+                 const VkDescriptorBufferInfo& input,
+                 const VkDescriptorBufferInfo& output,
+                 uint32_t count,
+                 uint32_t bins,
+                 uint32_t shift = 0);
+
+  // Ascending and stable 4 bit LSD radix sort in place. Only the low bits of the keys are sorted on, 0 is the whole key.
+  // An odd number of digits ends with a copy back, which leaves the keys written by a transfer
+  void sort(VkCommandBuffer cmd, const VkDescriptorBufferInfo& keys, uint32_t count, SortKey key = SortKey::uint32, uint32_t bits = 0);
+  // Values are uint32_t moving along with their keys, e.g. indices of what is sorted
+  void sortPairs(VkCommandBuffer cmd,
+                 const VkDescriptorBufferInfo& keys,
+                 const VkDescriptorBufferInfo& values,
+                 uint32_t count,
+                 SortKey key = SortKey::uint32,
+                 uint32_t bits = 0);
+
+  // Every descriptor set and scratch range handed out becomes invalid
+  void reset();
+
+  [[nodiscard]] uint32_t getWorkgroupSize() const;
+  // Elements one workgroup handles
+  [[nodiscard]] uint32_t getTileSize() const;
+  [[nodiscard]] uint32_t getMaxBins() const;
+  // Smaller than getWorkgroupSize() when the per digit scan of the sort does not fit shared memory
+  [[nodiscard]] uint32_t getSortWorkgroupSize() const;
+  [[nodiscard]] const PrimitiveStats& getStats() const;
+
+private:
+  // Mirrors Push of shader/glsl/primitives/primitives.glsl
+  struct Push {
+    uint32_t count = 0;
+    uint32_t firstGroup = 0;
+    uint32_t mode = 0;
+    uint32_t value = 0;
+  };
+
+  // Specialization of one kernel, workgroup size 0 is getWorkgroupSize()
+  struct KernelOptions {
+    uint32_t workgroupSize = 0;
+    uint32_t bins = 0;
+    uint32_t keyWords = 1;
+    bool payload = false;
+  };
+
+  struct Kernel {
+    VkPipeline pipeline = nullptr;
+    VkPipelineLayout layout = nullptr;
+    VkDescriptorSetLayout set = nullptr;
+  };
+
+  const VulkanDevice& _device;
+  uint32_t _workgroupSize;
+  uint32_t _maxBins;
+  uint32_t _sortWorkgroupSize;
+  uint32_t _maxGroups;
+  VkDeviceSize _alignment;
+
+  Kernel _scanTile;
+  Kernel _scanAdd;
+  Kernel _reduce;
+  Kernel _compactFlags;
+  Kernel _compactScatter;
+  // One pipeline per bin count, created on first use
+  std::unordered_map<uint32_t, Kernel> _histograms;
+  // Count and scatter pass of every key width and payload combination used so far
+  std::unordered_map<uint32_t, std::pair<Kernel, Kernel>> _sorts;
+
+  DescriptorAllocator _sets;
+  // Bump allocated, the last buffer has room left
+  std::vector<Buffer> _scratch;
+  VkDeviceSize _scratchUsed = 0;
+  PrimitiveStats _stats;
+
+  [[nodiscard]] Kernel createKernel(std::string_view shader, const KernelOptions& options) const;
+  [[nodiscard]] VkDescriptorBufferInfo scratch(VkDeviceSize size);
+  void dispatch(VkCommandBuffer cmd, const Kernel& kernel, std::span<const VkDescriptorBufferInfo> buffers, Push push, uint32_t groups);
+  void scan(VkCommandBuffer cmd, const VkDescriptorBufferInfo& input, const VkDescriptorBufferInfo& output, uint32_t count, bool inclusive);
+  void radixSort(VkCommandBuffer cmd,
+                 const VkDescriptorBufferInfo& keys,
+                 const VkDescriptorBufferInfo* values,
+                 uint32_t count,
+                 SortKey key,
+                 uint32_t bits);
+  [[nodiscard]] uint32_t groupsFor(uint32_t count, uint32_t tile) const;
+  [[nodiscard]] uint32_t groupsFor(uint32_t count) const;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMPUTE_COMPUTE_PRIMITIVES */
@@ -0,0 +1,258 @@
+#include "primitives_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_sort.h>
+#include <vulkan/vulkan_core.h>
+
+#include "async_compute.hpp"
+#include "compute_primitives.hpp"
+#include "device/device.hpp"
+#include "memory/buffer.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr uint64_t jobTimeout = 10'000'000'000;  // 10s
+// Inputs stay below 2^16, compaction keeps about half of them
+static constexpr uint32_t valueRange = 1U << 16U;
+static constexpr uint32_t compactBelow = valueRange / 2;
+static constexpr uint32_t histogramBins = 256;
+static constexpr uint32_t histogramShift = 4;
+
+// Host visible, so inputs are written and results read without staging copies
+static Buffer hostBuffer(const VulkanDevice& device, uint32_t count)
+{
+  return Buffer(device, BufferInfo{.size = std::max<VkDeviceSize>(count, 1) * sizeof(uint32_t),
+                                   .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+}
+
+static void upload(const Buffer& buffer, std::span<const uint32_t> values)
+{
+  std::memcpy(buffer.getMapped(), values.data(), values.size_bytes());
+  buffer.flush(0, VK_WHOLE_SIZE);
+}
+
+static std::vector<uint32_t> download(const Buffer& buffer, size_t count)
+{
+  buffer.invalidate(0, VK_WHOLE_SIZE);
+  std::vector<uint32_t> values(count);
+  std::memcpy(values.data(), buffer.getMapped(), count * sizeof(uint32_t));
+  return values;
+}
+
+static VkDescriptorBufferInfo whole(const Buffer& buffer)
+{
+  return {.buffer = buffer.get(), .offset = 0, .range = VK_WHOLE_SIZE};
+}
+
+static void hostBarrier(VkCommandBuffer cmd)
+{
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                       1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// Sorts work in place, every run starts from a device side copy of the unsorted input
+static void restore(VkCommandBuffer cmd, const Buffer& input, const Buffer& output)
+{
+  const VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = input.getSize()};
+  vkCmdCopyBuffer(cmd, input.get(), output.get(), 1, &region);
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                       nullptr);
+}
+
+// Fastest of the repeats, every repeat sorts a fresh copy of values
+template <typename T, typename Sort>
+static double hostSort(const std::vector<T>& values, std::vector<T>& sorted, Sort sort, uint32_t repeats)
+{
+  double best = std::numeric_limits<double>::max();
+  for (uint32_t repeat = 0; repeat < std::max(repeats, 1U); ++repeat) {
+    sorted = values;
+    const auto start = std::chrono::steady_clock::now();
+    sort(sorted.begin(), sorted.end());
+    best = std::min(best, Milliseconds(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+// Fastest of the repeats, the primitives are reset after every run
+static double run(AsyncCompute& compute, ComputePrimitives& primitives, const std::function<void(VkCommandBuffer)>& record,
+                  uint32_t repeats)
+{
+  double best = std::numeric_limits<double>::max();
+  for (uint32_t repeat = 0; repeat < std::max(repeats, 1U); ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t value = compute.submit([&record](VkCommandBuffer cmd) {
+      record(cmd);
+      hostBarrier(cmd);
+    });
+    if (!compute.wait(value, jobTimeout)) {
+      throw std::runtime_error("Compute primitive did not finish in time");
+    }
+    best = std::min(best, Milliseconds(std::chrono::steady_clock::now() - start).count());
+    primitives.reset();
+  }
+  return best;
+}
+
+std::vector<PrimitiveThroughput> benchmarkPrimitives(const VulkanDevice& device, std::span<const uint32_t> counts, uint32_t repeats)
+{
+  AsyncCompute compute(device);
+  ComputePrimitives primitives(device);
+  std::mt19937 random(42);  // NOLINT(cert-msc32-c,cert-msc51-cpp), equal input every run
+  std::uniform_int_distribution<uint32_t> distribution(0, valueRange - 1);
+
+  std::vector<PrimitiveThroughput> results;
+  for (const uint32_t count : counts) {
+    std::vector<uint32_t> values(count);
+    std::ranges::generate(values, [&] { return distribution(random); });
+    const Buffer inputBuffer = hostBuffer(device, count);
+    const Buffer outputBuffer = hostBuffer(device, std::max(count, histogramBins));
+    const Buffer counterBuffer = hostBuffer(device, 1);
+    upload(inputBuffer, values);
+    const VkDescriptorBufferInfo input = whole(inputBuffer);
+    const VkDescriptorBufferInfo output = whole(outputBuffer);
+    const VkDescriptorBufferInfo counter = whole(counterBuffer);
+
+    std::vector<uint32_t> expected(count);
+    std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0U);
+    double ms = run(compute, primitives, [&](VkCommandBuffer cmd) { primitives.exclusiveScan(cmd, input, output, count); }, repeats);
+    results.push_back({.primitive = "exclusive scan", .count = count, .ms = ms, .correct = download(outputBuffer, count) == expected});
+
+    std::inclusive_scan(values.begin(), values.end(), expected.begin());
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) { primitives.inclusiveScan(cmd, input, output, count); }, repeats);
+    results.push_back({.primitive = "inclusive scan", .count = count, .ms = ms, .correct = download(outputBuffer, count) == expected});
+
+    const uint32_t sum = std::reduce(values.begin(), values.end(), 0U);
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) { primitives.reduce(cmd, input, output, count); }, repeats);
+    results.push_back({.primitive = "reduce sum", .count = count, .ms = ms, .correct = download(outputBuffer, 1).front() == sum});
+
+    const uint32_t maximum = values.empty() ? 0 : std::ranges::max(values);
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) { primitives.reduce(cmd, input, output, count, ReduceOp::max); }, repeats);
+    results.push_back({.primitive = "reduce max", .count = count, .ms = ms, .correct = download(outputBuffer, 1).front() == maximum});
+
+    std::vector<uint32_t> kept;
+    std::ranges::copy_if(values, std::back_inserter(kept), [](uint32_t value) { return value < compactBelow; });
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) {
+      primitives.compact(cmd, input, output, counter, count, Compare::less, compactBelow);
+    }, repeats);
+    const bool compacted = download(counterBuffer, 1).front() == kept.size() && download(outputBuffer, kept.size()) == kept;
+    results.push_back({.primitive = "compact", .count = count, .ms = ms, .correct = compacted});
+
+    std::vector<uint32_t> bins(histogramBins);
+    for (const uint32_t value : values) {
+      ++bins.at((value >> histogramShift) & (histogramBins - 1));
+    }
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) {
+      primitives.histogram(cmd, input, output, count, histogramBins, histogramShift);
+    }, repeats);
+    results.push_back({.primitive = "histogram", .count = count, .ms = ms, .correct = download(outputBuffer, histogramBins) == bins});
+  }
+  return results;
+}
+
+std::vector<PrimitiveThroughput> benchmarkSorts(const VulkanDevice& device, std::span<const uint32_t> counts, uint32_t repeats)
+{
+  AsyncCompute compute(device);
+  ComputePrimitives primitives(device);
+  std::mt19937_64 random(42);  // NOLINT(cert-msc32-c,cert-msc51-cpp), equal input every run
+  std::uniform_int_distribution<uint64_t> distribution;
+
+  std::vector<PrimitiveThroughput> results;
+  for (const uint32_t count : counts) {
+    std::vector<uint64_t> wide(count);
+    std::ranges::generate(wide, [&] { return distribution(random); });
+    std::vector<uint32_t> keys(count);
+    std::ranges::transform(wide, keys.begin(), [](uint64_t key) { return static_cast<uint32_t>(key); });
+    std::vector<uint32_t> indices(count);
+    std::iota(indices.begin(), indices.end(), 0U);
+
+    std::vector<uint32_t> sorted;
+    double ms = hostSort(keys, sorted, [](auto first, auto last) { std::sort(first, last); }, repeats);
+    results.push_back({.primitive = "std::sort u32", .count = count, .ms = ms, .correct = std::ranges::is_sorted(sorted)});
+    ms = hostSort(keys, sorted, [](auto first, auto last) { tbb::parallel_sort(first, last); }, repeats);
+    results.push_back({.primitive = "tbb::parallel_sort u32", .count = count, .ms = ms, .correct = std::ranges::is_sorted(sorted)});
+
+    const Buffer keyInput = hostBuffer(device, count);
+    const Buffer valueInput = hostBuffer(device, count);
+    const Buffer keyBuffer = hostBuffer(device, count);
+    const Buffer valueBuffer = hostBuffer(device, count);
+    upload(keyInput, keys);
+    upload(valueInput, indices);
+    const VkDescriptorBufferInfo keyInfo = whole(keyBuffer);
+    const VkDescriptorBufferInfo valueInfo = whole(valueBuffer);
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) {
+      restore(cmd, keyInput, keyBuffer);
+      primitives.sort(cmd, keyInfo, count);
+    }, repeats);
+    results.push_back({.primitive = "radix sort u32", .count = count, .ms = ms, .correct = download(keyBuffer, count) == sorted});
+
+    // Stable, equal keys keep the order of their indices
+    std::vector<uint32_t> order = indices;
+    std::ranges::stable_sort(order, {}, [&keys](uint32_t index) { return keys[index]; });
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) {
+      restore(cmd, keyInput, keyBuffer);
+      restore(cmd, valueInput, valueBuffer);
+      primitives.sortPairs(cmd, keyInfo, valueInfo, count);
+    }, repeats);
+    results.push_back({.primitive = "radix sort u32 pairs", .count = count, .ms = ms, .correct = download(valueBuffer, count) == order});
+
+    std::vector<uint64_t> sortedWide;
+    ms = hostSort(wide, sortedWide, [](auto first, auto last) { std::sort(first, last); }, repeats);
+    results.push_back({.primitive = "std::sort u64", .count = count, .ms = ms, .correct = std::ranges::is_sorted(sortedWide)});
+    ms = hostSort(wide, sortedWide, [](auto first, auto last) { tbb::parallel_sort(first, last); }, repeats);
+    results.push_back({.primitive = "tbb::parallel_sort u64", .count = count, .ms = ms, .correct = std::ranges::is_sorted(sortedWide)});
+
+    // Low word first, as SortKey::uint64 expects
+    std::vector<uint32_t> words;
+    words.reserve(wide.size() * 2);
+    for (const uint64_t key : wide) {
+      words.push_back(static_cast<uint32_t>(key));
+      words.push_back(static_cast<uint32_t>(key >> 32U));
+    }
+    const Buffer wideInput = hostBuffer(device, count * 2);
+    const Buffer wideBuffer = hostBuffer(device, count * 2);
+    upload(wideInput, words);
+    const VkDescriptorBufferInfo wideInfo = whole(wideBuffer);
+    ms = run(compute, primitives, [&](VkCommandBuffer cmd) {
+      restore(cmd, wideInput, wideBuffer);
+      primitives.sort(cmd, wideInfo, count, SortKey::uint64);
+    }, repeats);
+    const std::vector<uint32_t> result = download(wideBuffer, words.size());
+    bool matched = true;
+    for (size_t i = 0; i < sortedWide.size(); ++i) {
+      matched = matched && sortedWide[i] == ((uint64_t{result[(i * 2) + 1]} << 32U) | result[i * 2]);
+    }
+    results.push_back({.primitive = "radix sort u64", .count = count, .ms = ms, .correct = matched});
+  }
+  return results;
+}
+}  // namespace vulkan
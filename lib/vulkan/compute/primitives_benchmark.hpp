@@ -0,0 +1,32 @@
+#ifndef LIB_VULKAN_COMPUTE_PRIMITIVES_BENCHMARK
+#define LIB_VULKAN_COMPUTE_PRIMITIVES_BENCHMARK
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct PrimitiveThroughput {
+  std::string primitive;
+  uint32_t count;
+  // Fastest submit to completion wall time over the repeats, in milliseconds
+  double ms;
+  // Result matched the std:: algorithm on the same input
+  bool correct;
+};
+
+// Every ComputePrimitives kernel on random input of each count, run on the async compute queue. Results are checked
+// against std::exclusive_scan, std::inclusive_scan, std::reduce, std::copy_if and a host histogram. Software devices
+// like lavapipe run it as well, there the numbers are CPU throughput
+[[nodiscard]] std::vector<PrimitiveThroughput> benchmarkPrimitives(const VulkanDevice& device, std::span<const uint32_t> counts,
+                                                                   uint32_t repeats);
+// Radix sort of random 32 bit keys, 32 bit keys with their indices and 64 bit keys next to std::sort and
+// tbb::parallel_sort of the same keys. Shows where the GPU sort starts to pay off
+[[nodiscard]] std::vector<PrimitiveThroughput> benchmarkSorts(const VulkanDevice& device, std::span<const uint32_t> counts,
+                                                              uint32_t repeats);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_COMPUTE_PRIMITIVES_BENCHMARK */
@@ -0,0 +1,515 @@
+#include "culling_benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command/command_pools.hpp"
+#include "compute/async_compute.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "gpu_culling.hpp"
+#include "memory/buffer.hpp"
+#include "memory/gpu_struct.hpp"
+#include "memory/image.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "rendering/rendering.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/specialization.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using Draws = std::function<void(VkCommandBuffer, VkPipelineLayout)>;
+
+static constexpr std::string_view vertexShader = "culling/depthOnly.vert";
+static constexpr uint64_t jobTimeout = 10'000'000'000;  // 10s
+static constexpr uint32_t buckets = 8;
+static constexpr uint32_t meshCount = 4;
+static constexpr uint32_t lodCount = 3;
+// Instances fill a cube of this half size around the eye, about a sixth of them is inside the 90 degree frustum
+static constexpr float sceneExtent = 1000.0F;
+static constexpr float nearPlane = 0.1F;
+static constexpr float lodStep = 100.0F;
+static constexpr VkExtent2D benchmarkExtent = {.width = 1920, .height = 1080};
+static constexpr VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+static constexpr VkImageUsageFlags depthUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+using VertexConstants = Specialization<SpecConstant<8, "cullingFirstInstance", bool, true>>;
+
+// What GpuCulling should have written for one instance
+struct ExpectedDraw {
+  bool visible;
+  CullLod lod;
+};
+
+static std::vector<CullMesh> makeMeshes()
+{
+  std::vector<CullMesh> meshes;
+  for (uint32_t mesh = 0; mesh < meshCount; ++mesh) {
+    CullMesh& added = meshes.emplace_back(CullMesh{.radius = static_cast<float>(mesh + 1), .lods = {}});
+    for (uint32_t lod = 0; lod < lodCount; ++lod) {
+      added.lods.push_back({.firstIndex = ((mesh * lodCount) + lod) * 1536,
+                            .indexCount = 1536U >> lod,
+                            .vertexOffset = static_cast<int32_t>(mesh * 4096),
+                            .distance = lodStep * static_cast<float>(lod + 1)});
+    }
+  }
+  return meshes;
+}
+
+// Looking down +z from the origin, 90 degrees both ways, far plane at the edge of the scene
+static CullView makeView()
+{
+  const float depth = sceneExtent / (sceneExtent - nearPlane);
+  const Mat4 projection{{{{{1.0F, 0.0F, 0.0F, 0.0F}}, {{0.0F, 1.0F, 0.0F, 0.0F}}, {{0.0F, 0.0F, depth, 1.0F}},
+                          {{0.0F, 0.0F, -nearPlane * depth, 0.0F}}}}};
+  return {.planes = frustumPlanes(projection), .eye = {{0.0F, 0.0F, 0.0F}}, .lodScale = 1.0F};
+}
+
+// Same math as shader/glsl/culling/cull.comp
+static std::vector<ExpectedDraw> cullHost(std::span<const CullMesh> meshes, std::span<const CullInstance> instances, const CullView& view)
+{
+  std::vector<ExpectedDraw> draws;
+  draws.reserve(instances.size());
+  for (const CullInstance& instance : instances) {
+    const CullMesh& mesh = meshes[instance.mesh];
+    const auto& [x, y, z] = instance.position.data;
+    const float radius = mesh.radius * instance.scale;
+    const bool inside = std::ranges::all_of(view.planes, [&](const Vec4& plane) {
+      return (plane.data[0] * x) + (plane.data[1] * y) + (plane.data[2] * z) + plane.data[3] >= -radius;
+    });
+    const float dx = x - view.eye.data[0];
+    const float dy = y - view.eye.data[1];
+    const float dz = z - view.eye.data[2];
+    const float distance = std::sqrt((dx * dx) + (dy * dy) + (dz * dz)) * view.lodScale;
+    size_t lod = 0;
+    while (lod + 1 < mesh.lods.size() && distance >= mesh.lods[lod].distance) {
+      ++lod;
+    }
+    draws.push_back({.visible = inside, .lod = mesh.lods[lod]});
+  }
+  return draws;
+}
+
+static void begin(VkCommandBuffer cmd)
+{
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = nullptr,
+  };
+  if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to begin command buffer! status: {}", utils::result(status)));
+  }
+}
+
+static uint32_t graphicsFamily(const VulkanDevice& device)
+{
+  const auto& graphics = device.getQueue().getGraphics();
+  if (graphics.empty()) {
+    throw std::runtime_error("Device has no queue family able to render");
+  }
+  return graphics.front();
+}
+
+// Depth only pass of shader/glsl/culling/depthOnly.vert that draws are recorded into. Nothing is submitted, the scene
+// buffers only have to exist for the descriptor sets to be valid
+class DrawRecorder {
+public:
+  DrawRecorder(const DrawRecorder&) = delete;
+  DrawRecorder(DrawRecorder&&) = delete;
+  DrawRecorder& operator=(const DrawRecorder&) = delete;
+  DrawRecorder& operator=(DrawRecorder&&) = delete;
+
+  // Draws of culling, or direct draws carrying the instance in firstInstance without it
+  explicit DrawRecorder(const VulkanDevice& device, const GpuCulling* culling)
+      : _device(device),
+        _depth(device, ImageInfo{.format = depthFormat, .extent = benchmarkExtent, .mipLevels = 1, .usage = depthUsage}),
+        _scene(device, BufferInfo{.size = sizeof(Vec4), .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT}),
+        _camera(device, BufferInfo{.size = sizeof(Mat4), .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT}),
+        _vertex(device.get(), findShader(vertexShader)),
+        _rendering(device),
+        _compiler(device, _rendering, 1),
+        _sets(device.get(), 2)
+  {
+    _depthView = createImageView(device.get(), _depth, VK_IMAGE_ASPECT_DEPTH_BIT);
+    try {
+      createPipeline(culling == nullptr || culling->usesFirstInstance());
+      writeSets(culling != nullptr ? culling->getVisible() : VkDescriptorBufferInfo{.buffer = _scene.get(), .offset = 0, .range = VK_WHOLE_SIZE});
+    }
+    catch (...) {
+      _rendering.releaseViews();
+      vkDestroyImageView(device.get(), _depthView, nullptr);
+      throw;
+    }
+  }
+
+  ~DrawRecorder()
+  {
+    _rendering.releaseViews();
+    vkDestroyImageView(_device.get(), _depthView, nullptr);
+  }
+
+  // Inside rendering with the pipeline, its sets and the index buffer bound
+  void record(VkCommandBuffer cmd, const Draws& draws)
+  {
+    const VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = _depth.get(),
+        .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1},
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+
+    VkClearValue far{};
+    far.depthStencil = {.depth = 0.0F, .stencil = 0};
+    const RenderTarget target{
+        .extent = benchmarkExtent,
+        .colors = {},
+        .depth = RenderAttachment{.view = _depthView,
+                                  .format = depthFormat,
+                                  .usage = depthUsage,
+                                  .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                  .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                  .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                  .clear = far},
+    };
+    [[maybe_unused]] const RenderInheritance inheritance = _rendering.begin(cmd, target);
+    const VkViewport viewport{.x = 0.0F,
+                              .y = 0.0F,
+                              .width = static_cast<float>(benchmarkExtent.width),
+                              .height = static_cast<float>(benchmarkExtent.height),
+                              .minDepth = 0.0F,
+                              .maxDepth = 1.0F};
+    const VkRect2D scissor{.offset = {.x = 0, .y = 0}, .extent = benchmarkExtent};
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+    const std::array<VkDescriptorSet, 2> sets = {_sceneSet, _cullingSet};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _layout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 0,
+                            nullptr);
+    vkCmdBindIndexBuffer(cmd, _scene.get(), 0, VK_INDEX_TYPE_UINT32);
+    draws(cmd, _layout);
+    _rendering.end(cmd);
+  }
+
+private:
+  const VulkanDevice& _device;
+  Image _depth;
+  VkImageView _depthView = nullptr;
+  // Positions, instances, indices and the visible slots of direct draws
+  Buffer _scene;
+  Buffer _camera;
+  ShaderModule _vertex;
+  Rendering _rendering;
+  PipelineCompiler _compiler;
+  VkPipeline _pipeline = nullptr;
+  VkPipelineLayout _layout = nullptr;
+  DescriptorAllocator _sets;
+  VkDescriptorSet _sceneSet = nullptr;
+  VkDescriptorSet _cullingSet = nullptr;
+
+  void createPipeline(bool firstInstance)
+  {
+    const std::array<const ShaderReflection*, 1> stages = {&_vertex.getReflection()};
+    const PipelineLayout layout = _device.getLayoutCache().getPipelineLayout(combine(stages));
+    VertexConstants constants;
+    constants.set<"cullingFirstInstance">(firstInstance);
+    const SpecializationView view = constants.view();
+    GraphicsPipelineInfo info{
+        .layout = layout.layout,
+        .stages = {{.stage = VK_SHADER_STAGE_VERTEX_BIT,
+                    .module = _vertex.get(),
+                    .entry = _vertex.getReflection().entry,
+                    .hash = _vertex.getHash(),
+                    .specialization = {view.entries.begin(), view.entries.end()},
+                    .specializationData = {view.data.begin(), view.data.end()}}},
+        .bindings = {},
+        .attributes = {},
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthTest = true,
+        .depthWrite = true,
+        .depthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL,
+        .blend = false,
+        .formats = {.colors = {}, .depth = depthFormat},
+    };
+    const PipelineHandle handle = _compiler.compile(std::move(info));
+    _compiler.wait();
+    _pipeline = _compiler.acquire(handle);
+    if (_pipeline == nullptr) {
+      throw std::runtime_error(std::format("Failed to compile the depth only pipeline of {}", vertexShader));
+    }
+    _layout = layout.layout;
+    _sceneSet = _sets.allocate(layout.sets.at(0));
+    _cullingSet = _sets.allocate(layout.sets.at(1));
+  }
+
+  void writeSets(const VkDescriptorBufferInfo& visible)
+  {
+    const VkDescriptorBufferInfo scene{.buffer = _scene.get(), .offset = 0, .range = VK_WHOLE_SIZE};
+    const std::array<VkDescriptorBufferInfo, 4> buffers = {{
+        scene,
+        scene,
+        {.buffer = _camera.get(), .offset = 0, .range = VK_WHOLE_SIZE},
+        visible,
+    }};
+    std::array<VkWriteDescriptorSet, buffers.size()> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+      const bool isVisible = i + 1 == writes.size();
+      writes.at(i) = {
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .pNext = nullptr,
+          .dstSet = isVisible ? _cullingSet : _sceneSet,
+          .dstBinding = isVisible ? 0 : i,
+          .dstArrayElement = 0,
+          .descriptorCount = 1,
+          .descriptorType = i == 2 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .pImageInfo = nullptr,
+          .pBufferInfo = &buffers.at(i),
+          .pTexelBufferView = nullptr,
+      };
+    }
+    vkUpdateDescriptorSets(_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  }
+};
+
+// Fastest of repeats recordings into one graphics command buffer, recorded but never submitted
+static double recordFrame(const VulkanDevice& device, DrawRecorder& recorder, uint32_t repeats, const std::function<Draws()>& prepare)
+{
+  const uint32_t family = graphicsFamily(device);
+  CommandPools pools(device, 1);
+  double best = std::numeric_limits<double>::max();
+  for (uint32_t repeat = 0; repeat < std::max(repeats, 1U); ++repeat) {
+    pools.beginFrame(repeat);
+    VkCommandBuffer cmd = pools.allocate(family);
+    const auto start = std::chrono::steady_clock::now();
+    const Draws draws = prepare();
+    begin(cmd);
+    recorder.record(cmd, draws);
+    if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to end command buffer! status: {}", utils::result(status)));
+    }
+    best = std::min(best, Milliseconds(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+// CPU driven frame: cull on the host, then one direct draw per visible instance with the instance in firstInstance
+static double cpuFrame(const VulkanDevice& device,
+                       std::span<const CullMesh> meshes,
+                       std::span<const CullInstance> instances,
+                       const CullView& view,
+                       uint32_t repeats)
+{
+  DrawRecorder recorder(device, nullptr);
+  return recordFrame(device, recorder, repeats, [&]() -> Draws {
+    return [draws = cullHost(meshes, instances, view)](VkCommandBuffer cmd, VkPipelineLayout) {
+      for (size_t i = 0; i < draws.size(); ++i) {
+        if (draws[i].visible) {
+          const CullLod& lod = draws[i].lod;
+          vkCmdDrawIndexed(cmd, lod.indexCount, 1, lod.firstIndex, lod.vertexOffset, static_cast<uint32_t>(i));
+        }
+      }
+    };
+  });
+}
+
+// GPU driven frame: the indirect draws of every bucket, the culling pass itself is measured on its own
+static double gpuFrame(const VulkanDevice& device, GpuCulling& culling, uint32_t repeats)
+{
+  DrawRecorder recorder(device, &culling);
+  return recordFrame(device, recorder, repeats, [&]() -> Draws {
+    return [&culling](VkCommandBuffer cmd, VkPipelineLayout layout) {
+      for (uint32_t bucket = 0; bucket < culling.getBuckets(); ++bucket) {
+        culling.draw(cmd, bucket, layout);
+      }
+    };
+  });
+}
+
+static Buffer readbackBuffer(const VulkanDevice& device, VkDeviceSize size)
+{
+  return Buffer(device, BufferInfo{.size = std::max<VkDeviceSize>(size, sizeof(uint32_t)),
+                                   .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT});
+}
+
+static void copyOut(VkCommandBuffer cmd, const VkDescriptorBufferInfo& source, const Buffer& target)
+{
+  const VkMemoryBarrier toTransfer{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                       1, &toTransfer, 0, nullptr, 0, nullptr);
+  const VkBufferCopy region{.srcOffset = source.offset, .dstOffset = 0, .size = target.getSize()};
+  vkCmdCopyBuffer(cmd, source.buffer, target.get(), 1, &region);
+  const VkMemoryBarrier toHost{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &toHost, 0, nullptr, 0, nullptr);
+}
+
+static double submit(const AsyncCompute::Record& record, AsyncCompute& compute)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if (!compute.wait(compute.submit(record), jobTimeout)) {
+    throw std::runtime_error("Culling pass did not finish in time");
+  }
+  return Milliseconds(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool sameLod(const VkDrawIndexedIndirectCommand& command, const CullLod& lod)
+{
+  return command.indexCount == lod.indexCount && command.firstIndex == lod.firstIndex && command.vertexOffset == lod.vertexOffset;
+}
+
+// Compacted draws are checked through their firstInstance, fixed slots against the slot of every instance
+static bool verify(const GpuCulling& culling,
+                   std::span<const CullInstance> instances,
+                   std::span<const ExpectedDraw> expected,
+                   std::span<const VkDrawIndexedIndirectCommand> commands,
+                   std::span<const uint32_t> counts)
+{
+  std::vector<uint32_t> offsets(culling.getBuckets());
+  for (uint32_t bucket = 1; bucket < culling.getBuckets(); ++bucket) {
+    offsets[bucket] = offsets[bucket - 1] + culling.getBucketSize(bucket - 1);
+  }
+
+  if (culling.getPath() == IndirectPath::indirectCount) {
+    std::vector<uint32_t> visible(culling.getBuckets());
+    for (size_t i = 0; i < instances.size(); ++i) {
+      visible[instances[i].bucket] += expected[i].visible ? 1U : 0U;
+    }
+    std::vector<bool> seen(instances.size());
+    for (uint32_t bucket = 0; bucket < culling.getBuckets(); ++bucket) {
+      if (counts[bucket] != visible[bucket]) {
+        return false;
+      }
+      for (uint32_t draw = 0; draw < counts[bucket]; ++draw) {
+        const VkDrawIndexedIndirectCommand& command = commands[offsets[bucket] + draw];
+        const uint32_t instance = command.firstInstance;
+        if (instance >= instances.size() || seen[instance] || instances[instance].bucket != bucket || command.instanceCount != 1 ||
+            !sameLod(command, expected[instance].lod)) {
+          return false;
+        }
+        seen[instance] = true;
+      }
+    }
+    return true;
+  }
+
+  std::vector<uint32_t> next = offsets;
+  for (size_t i = 0; i < instances.size(); ++i) {
+    const VkDrawIndexedIndirectCommand& command = commands[next[instances[i].bucket]++];
+    if (command.instanceCount != (expected[i].visible ? 1U : 0U) || !sameLod(command, expected[i].lod) ||
+        (culling.usesFirstInstance() && command.firstInstance != i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<CullingThroughput> benchmarkCulling(const VulkanDevice& device, std::span<const uint32_t> instances, uint32_t repeats)
+{
+  AsyncCompute compute(device);
+  std::mt19937 random(42);  // NOLINT(cert-msc32-c,cert-msc51-cpp), equal scene every run
+  std::uniform_real_distribution<float> position(-sceneExtent, sceneExtent);
+  std::uniform_real_distribution<float> scale(0.5F, 2.0F);
+  std::uniform_int_distribution<uint32_t> mesh(0, meshCount - 1);
+  std::uniform_int_distribution<uint32_t> bucket(0, buckets - 1);
+  const std::vector<CullMesh> meshes = makeMeshes();
+  const CullView view = makeView();
+
+  std::vector<CullingThroughput> results;
+  for (const uint32_t count : instances) {
+    std::vector<CullInstance> scene(count);
+    std::ranges::generate(scene, [&] {
+      return CullInstance{.position = {{position(random), position(random), position(random)}},
+                          .scale = scale(random),
+                          .mesh = mesh(random),
+                          .bucket = bucket(random)};
+    });
+    const std::vector<ExpectedDraw> expected = cullHost(meshes, scene, view);
+    const auto visible = static_cast<uint32_t>(std::ranges::count(expected, true, &ExpectedDraw::visible));
+    const double cpuMs = cpuFrame(device, meshes, scene, view, repeats);
+
+    for (const IndirectPath path : {IndirectPath::indirectCount, IndirectPath::multiDraw, IndirectPath::singleDraws}) {
+      if (!isSupported(device.getFeatures(), path)) {
+        continue;
+      }
+      GpuCulling culling(device, buckets, path);
+      culling.setMeshes(meshes);
+      culling.setInstances(scene);
+
+      double gpuMs = std::numeric_limits<double>::max();
+      for (uint32_t repeat = 0; repeat < std::max(repeats, 1U); ++repeat) {
+        gpuMs = std::min(gpuMs, submit([&](VkCommandBuffer cmd) { culling.cull(cmd, view); }, compute));
+      }
+
+      const Buffer commandsOut = readbackBuffer(device, VkDeviceSize{count} * sizeof(VkDrawIndexedIndirectCommand));
+      const Buffer countsOut = readbackBuffer(device, VkDeviceSize{buckets} * sizeof(uint32_t));
+      submit([&](VkCommandBuffer cmd) {
+        culling.cull(cmd, view);
+        copyOut(cmd, culling.getCommands(), commandsOut);
+        copyOut(cmd, culling.getCounts(), countsOut);
+      }, compute);
+      commandsOut.invalidate(0, VK_WHOLE_SIZE);
+      countsOut.invalidate(0, VK_WHOLE_SIZE);
+      std::vector<VkDrawIndexedIndirectCommand> commands(count);
+      std::vector<uint32_t> counts(buckets);
+      std::memcpy(commands.data(), commandsOut.getMapped(), commands.size() * sizeof(VkDrawIndexedIndirectCommand));
+      std::memcpy(counts.data(), countsOut.getMapped(), counts.size() * sizeof(uint32_t));
+
+      const uint64_t calls = culling.getStats().drawCalls;
+      const double recordMs = gpuFrame(device, culling, repeats);
+      results.push_back({
+          .instances = count,
+          .path = path,
+          .visible = visible,
+          .gpuMs = gpuMs,
+          .recordMs = recordMs,
+          .cpuMs = cpuMs,
+          .drawCalls = (culling.getStats().drawCalls - calls) / std::max(repeats, 1U),
+          .correct = verify(culling, scene, expected, commands, counts),
+      });
+    }
+  }
+  return results;
+}
+}  // namespace vulkan
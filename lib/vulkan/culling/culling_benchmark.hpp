@@ -0,0 +1,34 @@
+#ifndef LIB_VULKAN_CULLING_CULLING_BENCHMARK
+#define LIB_VULKAN_CULLING_CULLING_BENCHMARK
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "device/device.hpp"
+#include "gpu_culling.hpp"
+
+namespace vulkan {
+struct CullingThroughput {
+  uint32_t instances;
+  IndirectPath path;
+  uint32_t visible;
+  // Fastest culling pass on the async compute queue, submit to completion, in milliseconds
+  double gpuMs;
+  // Fastest recording of GpuCulling::draw for all buckets, in milliseconds
+  double recordMs;
+  // Fastest host culling of the same scene plus recording a vkCmdDrawIndexed per visible instance, in milliseconds
+  double cpuMs;
+  // Indirect draw calls one recording of all buckets took, from GpuCulling::getStats
+  uint64_t drawCalls;
+  // Commands and counts matched the host culling
+  bool correct;
+};
+
+// Random scene of every instance count in 8 material buckets, culled on the GPU with every indirect path the device
+// supports and once on the host for reference
+[[nodiscard]] std::vector<CullingThroughput> benchmarkCulling(const VulkanDevice& device, std::span<const uint32_t> instances,
+                                                              uint32_t repeats);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_CULLING_CULLING_BENCHMARK */
@@ -0,0 +1,316 @@
+#include "depth_pyramid.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+#include "memory/image.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+
+namespace vulkan {
+static constexpr std::string_view pyramidShader = "culling/depthPyramid.comp";
+// Binding of the counter in shader/glsl/culling/depthPyramid.comp, the levels sit between it and the depth
+static constexpr uint32_t counterBinding = DepthPyramid::maxLevels + 1;
+
+// Powers of two keep every texel of a level at exactly 2x2 texels of the level above
+static VkExtent2D pyramidExtent(VkExtent2D depthExtent)
+{
+  static constexpr uint32_t limit = 1U << DepthPyramid::maxLevels;
+  if (depthExtent.width == 0 || depthExtent.height == 0 || depthExtent.width >= limit || depthExtent.height >= limit) {
+    throw std::runtime_error(
+        std::format("Depth pyramid of a {}x{} depth buffer, it has to be below {} both ways", depthExtent.width, depthExtent.height, limit));
+  }
+  return {.width = std::bit_floor(depthExtent.width), .height = std::bit_floor(depthExtent.height)};
+}
+
+// Down to 1x1, the shorter side stays at 1 texel for the last levels
+static uint32_t levelCount(VkExtent2D extent)
+{
+  return static_cast<uint32_t>(std::countr_zero(std::max(extent.width, extent.height))) + 1;
+}
+
+static uint32_t tiles(uint32_t size)
+{
+  return (size + DepthPyramid::tileSize - 1) / DepthPyramid::tileSize;
+}
+
+static void computeBarrier(VkCommandBuffer cmd, VkAccessFlags source)
+{
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = source,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                       nullptr);
+}
+
+DepthPyramid::DepthPyramid(const VulkanDevice& device, VkExtent2D depthExtent)
+    : _device(device),
+      _extent(pyramidExtent(depthExtent)),
+      _levels(levelCount(_extent)),
+      _image(device, ImageInfo{.format = format,
+                               .extent = _extent,
+                               .mipLevels = _levels,
+                               .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT}),
+      _counter(device, BufferInfo{.size = sizeof(uint32_t),
+                                  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  .required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT}),
+      _sets(device.get(), 1)
+{
+  try {
+    _view = createImageView(device.get(), _image, VK_IMAGE_ASPECT_COLOR_BIT);
+    for (uint32_t level = 0; level < _levels; ++level) {
+      _levelViews.at(level) = createImageView(device.get(), _image, VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+    }
+
+    const VkSamplerCreateInfo samplerInfo{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .magFilter = VK_FILTER_NEAREST,
+        .minFilter = VK_FILTER_NEAREST,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .mipLodBias = 0.0F,
+        .anisotropyEnable = VK_FALSE,
+        .maxAnisotropy = 1.0F,
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_ALWAYS,
+        .minLod = 0.0F,
+        .maxLod = static_cast<float>(_levels),
+        .borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+    };
+    if (const VkResult status = vkCreateSampler(device.get(), &samplerInfo, nullptr, &_sampler); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to create depth pyramid sampler! status: {}", utils::result(status)));
+    }
+
+    createPipeline();
+    writeSet();
+  }
+  catch (...) {
+    destroy();
+    throw;
+  }
+}
+
+DepthPyramid::~DepthPyramid()
+{
+  destroy();
+}
+
+void DepthPyramid::prepare(VkCommandBuffer cmd)
+{
+  if (_prepared) {
+    return;
+  }
+  _prepared = true;
+
+  const VkImageSubresourceRange range{
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = _levels, .baseArrayLayer = 0, .layerCount = 1};
+  VkImageMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = 0,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = _image.get(),
+      .subresourceRange = range,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  const VkClearColorValue far{.float32 = {0.0F, 0.0F, 0.0F, 0.0F}};
+  vkCmdClearColorImage(cmd, _image.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &far, 1, &range);
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+  vkCmdFillBuffer(cmd, _counter.get(), 0, VK_WHOLE_SIZE, 0);
+  const VkMemoryBarrier counter{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &counter, 0, nullptr, 1, &barrier);
+}
+
+void DepthPyramid::build(VkCommandBuffer cmd, VkImageView depth)
+{
+  prepare(cmd);
+  if (depth != _depth) {
+    const VkDescriptorImageInfo image{
+        .sampler = _sampler, .imageView = depth, .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+    const VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = _set,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &image,
+        .pBufferInfo = nullptr,
+        .pTexelBufferView = nullptr,
+    };
+    vkUpdateDescriptorSets(_device.get(), 1, &write, 0, nullptr);
+    _depth = depth;
+  }
+  ++_stats.builds;
+
+  // Culling passes of the last frame still read the levels, the last build put the counter back to zero
+  computeBarrier(cmd, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+  Push push;
+  push.set<"size">(UVec2{{_extent.width, _extent.height}});
+  push.set<"levels">(_levels);
+  const uint32_t groupsX = tiles(_extent.width);
+  const uint32_t groupsY = tiles(_extent.height);
+  push.set<"groups">(groupsX * groupsY);
+  static constexpr uint32_t pushSize = Push::offsetOf<"groups">() + sizeof(uint32_t);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _layout, 0, 1, &_set, 0, nullptr);
+  vkCmdPushConstants(cmd, _layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushSize, push.bytes().data());
+  vkCmdDispatch(cmd, groupsX, groupsY, 1);
+  ++_stats.dispatches;
+
+  computeBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT);
+}
+
+VkImageView DepthPyramid::getView() const
+{
+  return _view;
+}
+
+VkSampler DepthPyramid::getSampler() const
+{
+  return _sampler;
+}
+
+VkImageLayout DepthPyramid::getLayout() const
+{
+  return VK_IMAGE_LAYOUT_GENERAL;
+}
+
+VkExtent2D DepthPyramid::getExtent() const
+{
+  return _extent;
+}
+
+uint32_t DepthPyramid::getLevels() const
+{
+  return _levels;
+}
+
+const DepthPyramidStats& DepthPyramid::getStats() const
+{
+  return _stats;
+}
+
+void DepthPyramid::createPipeline()
+{
+  // The module is only needed while the pipeline is created
+  const ShaderModule module(_device.get(), findShader(pyramidShader));
+  const std::array<const ShaderReflection*, 1> stages = {&module.getReflection()};
+  const PipelineLayout layout = _device.getLayoutCache().getPipelineLayout(combine(stages));
+  const VkComputePipelineCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage =
+          {
+              .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+              .pNext = nullptr,
+              .flags = 0,
+              .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+              .module = module.get(),
+              .pName = module.getReflection().entry.c_str(),
+              .pSpecializationInfo = nullptr,
+          },
+      .layout = layout.layout,
+      .basePipelineHandle = nullptr,
+      .basePipelineIndex = -1,
+  };
+  if (const VkResult status = vkCreateComputePipelines(_device.get(), _device.getPipelineCache().get(), 1, &createInfo, nullptr, &_pipeline);
+      status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create compute pipeline {}! status: {}", pyramidShader, utils::result(status)));
+  }
+  _layout = layout.layout;
+  _setLayout = layout.sets.front();
+}
+
+void DepthPyramid::writeSet()
+{
+  // The depth at binding 0 is written by build(), levels past the last one repeat it and are never stored to
+  _set = _sets.allocate(_setLayout);
+  std::array<VkDescriptorImageInfo, maxLevels> levels{};
+  for (uint32_t level = 0; level < maxLevels; ++level) {
+    levels.at(level) = {.sampler = nullptr,
+                        .imageView = _levelViews.at(std::min(level, _levels - 1)),
+                        .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
+  }
+  const VkDescriptorBufferInfo counter{.buffer = _counter.get(), .offset = 0, .range = VK_WHOLE_SIZE};
+
+  std::array<VkWriteDescriptorSet, maxLevels + 1> writes{};
+  for (uint32_t level = 0; level < maxLevels; ++level) {
+    writes.at(level) = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = _set,
+        .dstBinding = level + 1,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .pImageInfo = &levels.at(level),
+        .pBufferInfo = nullptr,
+        .pTexelBufferView = nullptr,
+    };
+  }
+  writes.back() = {
+      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+      .pNext = nullptr,
+      .dstSet = _set,
+      .dstBinding = counterBinding,
+      .dstArrayElement = 0,
+      .descriptorCount = 1,
+      .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      .pImageInfo = nullptr,
+      .pBufferInfo = &counter,
+      .pTexelBufferView = nullptr,
+  };
+  vkUpdateDescriptorSets(_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void DepthPyramid::destroy()
+{
+  vkDestroyPipeline(_device.get(), _pipeline, nullptr);
+  vkDestroySampler(_device.get(), _sampler, nullptr);
+  for (VkImageView view : _levelViews) {
+    vkDestroyImageView(_device.get(), view, nullptr);
+  }
+  vkDestroyImageView(_device.get(), _view, nullptr);
+  _pipeline = nullptr;
+  _sampler = nullptr;
+  _levelViews = {};
+  _view = nullptr;
+}
+}  // namespace vulkan
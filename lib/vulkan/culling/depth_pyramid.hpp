@@ -0,0 +1,90 @@
+#ifndef LIB_VULKAN_CULLING_DEPTH_PYRAMID
+#define LIB_VULKAN_CULLING_DEPTH_PYRAMID
+
+#include <array>
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "memory/buffer.hpp"
+#include "memory/gpu_struct.hpp"
+#include "memory/image.hpp"
+
+namespace vulkan {
+struct DepthPyramidStats {
+  uint64_t builds = 0;
+  uint64_t dispatches = 0;
+};
+
+// Hierarchical Z of a reversed depth buffer: level 0 is the depth size rounded down to powers of two and every texel
+// of every level holds the farthest depth below it, so a bounding box whose nearest depth is farther than the texels
+// around it is hidden. Built by shader/glsl/culling/depthPyramid.comp in one dispatch, every workgroup reduces a 64x64
+// tile down to level 6 and the last one finishes the levels below. The image stays in VK_IMAGE_LAYOUT_GENERAL, read by
+// compute shaders through getView() and getSampler(). Not thread safe
+class DepthPyramid {
+public:
+  static constexpr uint32_t maxLevels = 13;
+  static constexpr uint32_t tileSize = 64;
+  // Levels one workgroup reduces, the last workgroup starts from level tileLevels - 1
+  static constexpr uint32_t tileLevels = 7;
+  static constexpr VkFormat format = VK_FORMAT_R32_SFLOAT;
+
+  DepthPyramid(const DepthPyramid&) = delete;
+  DepthPyramid(DepthPyramid&&) = delete;
+  DepthPyramid& operator=(const DepthPyramid&) = delete;
+  DepthPyramid& operator=(DepthPyramid&&) = delete;
+
+  // Throws when depthExtent is 8192 or more in either direction, the levels would not fit the descriptor set
+  explicit DepthPyramid(const VulkanDevice& device, VkExtent2D depthExtent);
+  ~DepthPyramid();
+
+  // Records the clear to depth 0, the far plane, and zeroes the workgroup counter the first time it is called, so
+  // nothing is hidden by a pyramid that was never built. Later calls record nothing
+  void prepare(VkCommandBuffer cmd);
+  // Depth is a view of a depthExtent sized depth image in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, made
+  // visible to compute shaders by the caller. Finished levels are made visible to the compute shaders that test
+  // against them. A different view rewrites the descriptor set, nothing recorded against the old one may still be pending
+  void build(VkCommandBuffer cmd, VkImageView depth);
+
+  // Every level, for VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER with getSampler() in getLayout()
+  [[nodiscard]] VkImageView getView() const;
+  // Nearest, clamped to the edge, shared with the depth read by build()
+  [[nodiscard]] VkSampler getSampler() const;
+  [[nodiscard]] VkImageLayout getLayout() const;
+  // Level 0
+  [[nodiscard]] VkExtent2D getExtent() const;
+  [[nodiscard]] uint32_t getLevels() const;
+  [[nodiscard]] const DepthPyramidStats& getStats() const;
+
+private:
+  // Mirrors Push of shader/glsl/culling/depthPyramid.comp
+  using Push = GpuStruct<BlockLayout::std430, Field<"size", UVec2>, Field<"levels", uint32_t>, Field<"groups", uint32_t>>;
+
+  const VulkanDevice& _device;
+  VkExtent2D _extent;
+  uint32_t _levels;
+  Image _image;
+  VkImageView _view = nullptr;
+  std::array<VkImageView, maxLevels> _levelViews{};
+  VkSampler _sampler = nullptr;
+  // Workgroups done with their tile, zeroed by prepare() and put back to zero by the last workgroup of every build
+  Buffer _counter;
+
+  VkPipeline _pipeline = nullptr;
+  VkPipelineLayout _layout = nullptr;
+  VkDescriptorSetLayout _setLayout = nullptr;
+  DescriptorAllocator _sets;
+  VkDescriptorSet _set = nullptr;
+  VkImageView _depth = nullptr;
+  bool _prepared = false;
+  DepthPyramidStats _stats;
+
+  void createPipeline();
+  void writeSet();
+  void destroy();
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_CULLING_DEPTH_PYRAMID */
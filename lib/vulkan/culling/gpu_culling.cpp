@@ -0,0 +1,524 @@
+#include "gpu_culling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "depth_pyramid.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "device/device_data.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+#include "memory/gpu_struct.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/specialization.hpp"
+
+namespace vulkan {
+static constexpr std::string_view cullShader = "culling/cull.comp";
+static constexpr std::string_view occlusionShader = "culling/occlusion.comp";
+// Bindings of shader/glsl/culling/occlusion.comp past the ones of cull.comp
+static constexpr uint32_t occludedBinding = 7;
+static constexpr uint32_t pyramidBinding = 8;
+static constexpr VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand);
+static constexpr VkDeviceSize element = sizeof(uint32_t);
+// Cleared by a transfer when a compacted bucket is drawn in chunks
+static constexpr VkBufferUsageFlags commandUsage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+// Structs of shader/glsl/culling/cull.glsl
+using GpuInstance = GpuStruct<BlockLayout::std430,
+                              Field<"position", Vec3>,
+                              Field<"scale", float>,
+                              Field<"mesh", uint32_t>,
+                              Field<"bucket", uint32_t>,
+                              Field<"slot", uint32_t>>;
+using GpuLod = GpuStruct<BlockLayout::std430,
+                         Field<"firstIndex", uint32_t>,
+                         Field<"indexCount", uint32_t>,
+                         Field<"vertexOffset", int32_t>,
+                         Field<"distance", float>>;
+using GpuMesh = GpuStruct<BlockLayout::std430, Field<"radius", float>, Field<"firstLod", uint32_t>, Field<"lodCount", uint32_t>>;
+static_assert(GpuInstance::size == 32 && GpuLod::size == 16 && GpuMesh::size == 12);
+using CullConstants = Specialization<SpecConstant<0, "compact", bool, true>, SpecConstant<1, "firstInstance", bool, true>>;
+using OcclusionConstants = Specialization<SpecConstant<0, "compact", bool, true>,
+                                          SpecConstant<1, "firstInstance", bool, true>,
+                                          SpecConstant<2, "late", bool, false>>;
+
+static Buffer hostBuffer(const VulkanDevice& device, VkDeviceSize size)
+{
+  return Buffer(device, BufferInfo{.size = std::max(size, element),
+                                   .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+}
+
+// Read back by copies as well, the culling results are checked against the host
+static Buffer outputBuffer(const VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+  return Buffer(device, BufferInfo{.size = std::max(size, element),
+                                   .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | usage});
+}
+
+static VkDescriptorBufferInfo whole(const Buffer& buffer)
+{
+  return {.buffer = buffer.get(), .offset = 0, .range = VK_WHOLE_SIZE};
+}
+
+// One invocation per instance, split where the dispatch would pass maxComputeWorkGroupCount. Pipeline and set are bound
+template <typename P>
+static void dispatchInstances(VkCommandBuffer cmd, VkPipelineLayout layout, P& push, uint32_t count, uint32_t maxGroups)
+{
+  push.template set<"count">(count);
+  // The block ends with firstGroup, the padding up to the struct alignment is not part of the push range
+  static constexpr uint32_t pushSize = P::template offsetOf<"firstGroup">() + sizeof(uint32_t);
+  const uint32_t groups = (count + GpuCulling::workgroupSize - 1) / GpuCulling::workgroupSize;
+  for (uint32_t first = 0; first < groups; first += maxGroups) {
+    push.template set<"firstGroup">(first);
+    vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushSize, push.bytes().data());
+    vkCmdDispatch(cmd, std::min(groups - first, maxGroups), 1, 1);
+  }
+}
+
+IndirectPath chooseIndirectPath(const DeviceFeatures& features)
+{
+  for (const IndirectPath path : {IndirectPath::indirectCount, IndirectPath::multiDraw}) {
+    if (isSupported(features, path)) {
+      return path;
+    }
+  }
+  return IndirectPath::singleDraws;
+}
+
+bool isSupported(const DeviceFeatures& features, IndirectPath path)
+{
+  // Draws of one call tell their instances apart only by firstInstance, gl_DrawID would need shaderDrawParameters
+  switch (path) {
+  case IndirectPath::indirectCount:
+    return features.drawIndirectCount && features.multiDrawIndirect && features.drawIndirectFirstInstance;
+  case IndirectPath::multiDraw: return features.multiDrawIndirect && features.drawIndirectFirstInstance;
+  case IndirectPath::singleDraws: return true;
+  }
+  return false;
+}
+
+std::array<Vec4, 6> frustumPlanes(const Mat4& viewProjection)
+{
+  const auto row = [&viewProjection](size_t index) {
+    return Vec4{{viewProjection.columns[0].data.at(index), viewProjection.columns[1].data.at(index),
+                 viewProjection.columns[2].data.at(index), viewProjection.columns[3].data.at(index)}};
+  };
+  const auto combine = [](const Vec4& first, const Vec4& second, float sign) {
+    Vec4 plane{};
+    for (size_t i = 0; i < plane.data.size(); ++i) {
+      plane.data.at(i) = first.data.at(i) + (sign * second.data.at(i));
+    }
+    const float length = std::hypot(plane.data[0], plane.data[1], plane.data[2]);
+    for (float& value : plane.data) {
+      value /= length;
+    }
+    return plane;
+  };
+  const Vec4 none{};
+  return {combine(row(3), row(0), 1.0F), combine(row(3), row(0), -1.0F), combine(row(3), row(1), 1.0F),
+          combine(row(3), row(1), -1.0F), combine(row(2), none, 0.0F),   combine(row(3), row(2), -1.0F)};
+}
+
+GpuCulling::GpuCulling(const VulkanDevice& device, uint32_t buckets)
+    : GpuCulling(device, buckets, chooseIndirectPath(device.getFeatures()))
+{
+}
+
+GpuCulling::GpuCulling(const VulkanDevice& device, uint32_t buckets, IndirectPath path)
+    : _device(device),
+      _path(path),
+      _firstInstance(device.getFeatures().drawIndirectFirstInstance),
+      _buckets(std::max(buckets, 1U)),
+      _maxGroups(device.getData().properties.limits.maxComputeWorkGroupCount[0]),
+      _maxDraws(std::max(device.getData().properties.limits.maxDrawIndirectCount, 1U)),
+      _sets(device.get(), 2),
+      _meshes(std::make_unique<Buffer>(hostBuffer(device, 0))),
+      _lods(std::make_unique<Buffer>(hostBuffer(device, 0))),
+      _instances(std::make_unique<Buffer>(hostBuffer(device, 0))),
+      _bucketOffsets(std::make_unique<Buffer>(hostBuffer(device, _buckets * element))),
+      _counts(std::make_unique<Buffer>(outputBuffer(device, _buckets * element,
+                                                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT))),
+      _commands(std::make_unique<Buffer>(outputBuffer(device, commandSize, commandUsage))),
+      _visible(std::make_unique<Buffer>(outputBuffer(device, 0, 0))),
+      _occluded(std::make_unique<Buffer>(outputBuffer(device, 0, 0))),
+      _offsets(_buckets, 0),
+      _sizes(_buckets, 0)
+{
+  if (!isSupported(device.getFeatures(), path)) {
+    throw std::runtime_error("Indirect draw path needs device features that are not enabled");
+  }
+  CullConstants constants;
+  constants.set<"compact">(_path == IndirectPath::indirectCount);
+  constants.set<"firstInstance">(_firstInstance);
+  _cull = createKernel(cullShader, constants.view());
+  try {
+    OcclusionConstants occlusion;
+    occlusion.set<"compact">(_path == IndirectPath::indirectCount);
+    occlusion.set<"firstInstance">(_firstInstance);
+    _early = createKernel(occlusionShader, occlusion.view());
+    occlusion.set<"late">(true);
+    _late = createKernel(occlusionShader, occlusion.view());
+  }
+  catch (...) {
+    vkDestroyPipeline(_device.get(), _cull.pipeline, nullptr);
+    vkDestroyPipeline(_device.get(), _early.pipeline, nullptr);
+    throw;
+  }
+  writeSet();
+}
+
+GpuCulling::~GpuCulling()
+{
+  for (const Kernel* kernel : {&_cull, &_early, &_late}) {
+    vkDestroyPipeline(_device.get(), kernel->pipeline, nullptr);
+  }
+}
+
+void GpuCulling::setMeshes(std::span<const CullMesh> meshes)
+{
+  std::vector<GpuMesh> gpuMeshes(meshes.size());
+  std::vector<GpuLod> gpuLods;
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    if (meshes[i].lods.empty()) {
+      throw std::runtime_error(std::format("Culled mesh {} has no level of detail", i));
+    }
+    gpuMeshes[i].set<"radius">(meshes[i].radius);
+    gpuMeshes[i].set<"firstLod">(static_cast<uint32_t>(gpuLods.size()));
+    gpuMeshes[i].set<"lodCount">(static_cast<uint32_t>(meshes[i].lods.size()));
+    for (const CullLod& lod : meshes[i].lods) {
+      GpuLod& gpuLod = gpuLods.emplace_back();
+      gpuLod.set<"firstIndex">(lod.firstIndex);
+      gpuLod.set<"indexCount">(lod.indexCount);
+      gpuLod.set<"vertexOffset">(lod.vertexOffset);
+      gpuLod.set<"distance">(lod.distance);
+    }
+  }
+
+  if (_meshes->getSize() < gpuMeshes.size() * GpuMesh::size) {
+    _meshes = std::make_unique<Buffer>(hostBuffer(_device, gpuMeshes.size() * GpuMesh::size));
+  }
+  if (_lods->getSize() < gpuLods.size() * GpuLod::size) {
+    _lods = std::make_unique<Buffer>(hostBuffer(_device, gpuLods.size() * GpuLod::size));
+  }
+  GpuMesh::upload(gpuMeshes, _meshes->getMapped());
+  GpuLod::upload(gpuLods, _lods->getMapped());
+  _meshes->flush(0, VK_WHOLE_SIZE);
+  _lods->flush(0, VK_WHOLE_SIZE);
+  _meshCount = static_cast<uint32_t>(meshes.size());
+  writeSet();
+}
+
+void GpuCulling::setInstances(std::span<const CullInstance> instances)
+{
+  // Buckets take consecutive slot ranges, every instance owns one slot of its bucket
+  std::ranges::fill(_sizes, 0);
+  for (const CullInstance& instance : instances) {
+    if (instance.mesh >= _meshCount || instance.bucket >= _buckets) {
+      throw std::runtime_error(std::format("Culled instance of mesh {} in bucket {}, there are {} meshes and {} buckets",
+                                           instance.mesh, instance.bucket, _meshCount, _buckets));
+    }
+    ++_sizes[instance.bucket];
+  }
+  uint32_t offset = 0;
+  for (uint32_t bucket = 0; bucket < _buckets; ++bucket) {
+    _offsets[bucket] = offset;
+    offset += _sizes[bucket];
+  }
+  _chunked = std::ranges::any_of(_sizes, [this](uint32_t size) { return size > _maxDraws; });
+
+  std::vector<uint32_t> next = _offsets;
+  std::vector<GpuInstance> gpuInstances(instances.size());
+  for (size_t i = 0; i < instances.size(); ++i) {
+    gpuInstances[i].set<"position">(instances[i].position);
+    gpuInstances[i].set<"scale">(instances[i].scale);
+    gpuInstances[i].set<"mesh">(instances[i].mesh);
+    gpuInstances[i].set<"bucket">(instances[i].bucket);
+    gpuInstances[i].set<"slot">(next[instances[i].bucket]++);
+  }
+
+  const VkDeviceSize count = instances.size();
+  if (_instances->getSize() < count * GpuInstance::size) {
+    _instances = std::make_unique<Buffer>(hostBuffer(_device, count * GpuInstance::size));
+    _commands = std::make_unique<Buffer>(outputBuffer(_device, count * commandSize, commandUsage));
+    _visible = std::make_unique<Buffer>(outputBuffer(_device, count * element, 0));
+    _occluded = std::make_unique<Buffer>(outputBuffer(_device, count * element, 0));
+  }
+  GpuInstance::upload(gpuInstances, _instances->getMapped());
+  _instances->flush(0, VK_WHOLE_SIZE);
+  std::memcpy(_bucketOffsets->getMapped(), _offsets.data(), _offsets.size() * element);
+  _bucketOffsets->flush(0, VK_WHOLE_SIZE);
+  _instanceCount = static_cast<uint32_t>(count);
+  writeSet();
+}
+
+void GpuCulling::cull(VkCommandBuffer cmd, const CullView& view)
+{
+  beginPass(cmd);
+  if (_instanceCount == 0) {
+    return;
+  }
+
+  Push push;
+  push.set<"planes">(view.planes);
+  push.set<"eye">(view.eye);
+  push.set<"lodScale">(view.lodScale);
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _cull.pipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _cull.layout, 0, 1, &_set, 0, nullptr);
+  dispatchInstances(cmd, _cull.layout, push, _instanceCount, _maxGroups);
+}
+
+void GpuCulling::cullEarly(VkCommandBuffer cmd, const CullView& view, DepthPyramid& pyramid)
+{
+  pyramid.prepare(cmd);
+  writePyramid(pyramid);
+  beginPass(cmd);
+  occlusionPass(cmd, view, _early);
+}
+
+void GpuCulling::cullLate(VkCommandBuffer cmd, const CullView& view, const DepthPyramid& pyramid)
+{
+  writePyramid(pyramid);
+  // The draws of the first phase read the commands, counts and visible slots the second one writes again, its
+  // occluded instances are read back
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+  beginPass(cmd);
+  occlusionPass(cmd, view, _late);
+}
+
+void GpuCulling::draw(VkCommandBuffer cmd, uint32_t bucket, VkPipelineLayout layout)
+{
+  const uint32_t size = getBucketSize(bucket);
+  if (size == 0) {
+    return;
+  }
+  const VkDeviceSize offset = _offsets[bucket] * commandSize;
+  switch (_path) {
+  case IndirectPath::indirectCount:
+    // Every chunk reads the count of the whole bucket, the slots past it were cleared to empty draws by beginPass()
+    for (uint32_t first = 0; first < size; first += _maxDraws) {
+      vkCmdDrawIndexedIndirectCount(cmd, _commands->get(), offset + (first * commandSize), _counts->get(), bucket * element,
+                                    std::min(size - first, _maxDraws), static_cast<uint32_t>(commandSize));
+      ++_stats.drawCalls;
+    }
+    return;
+  case IndirectPath::multiDraw:
+    for (uint32_t first = 0; first < size; first += _maxDraws) {
+      vkCmdDrawIndexedIndirect(cmd, _commands->get(), offset + (first * commandSize), std::min(size - first, _maxDraws),
+                               static_cast<uint32_t>(commandSize));
+      ++_stats.drawCalls;
+    }
+    return;
+  case IndirectPath::singleDraws:
+    if (!_firstInstance && layout == nullptr) {
+      throw std::runtime_error("Indirect draws without firstInstance need the pipeline layout to push the draw slot");
+    }
+    for (uint32_t slot = _offsets[bucket]; slot < _offsets[bucket] + size; ++slot) {
+      if (!_firstInstance) {
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(slot), &slot);
+      }
+      vkCmdDrawIndexedIndirect(cmd, _commands->get(), slot * commandSize, 1, static_cast<uint32_t>(commandSize));
+      ++_stats.drawCalls;
+    }
+    return;
+  }
+}
+
+IndirectPath GpuCulling::getPath() const
+{
+  return _path;
+}
+
+bool GpuCulling::usesFirstInstance() const
+{
+  return _firstInstance;
+}
+
+uint32_t GpuCulling::getBuckets() const
+{
+  return _buckets;
+}
+
+uint32_t GpuCulling::getInstances() const
+{
+  return _instanceCount;
+}
+
+uint32_t GpuCulling::getBucketSize(uint32_t bucket) const
+{
+  if (bucket >= _buckets) {
+    throw std::runtime_error(std::format("Bucket {} of {}", bucket, _buckets));
+  }
+  return _sizes[bucket];
+}
+
+VkDescriptorBufferInfo GpuCulling::getVisible() const
+{
+  return whole(*_visible);
+}
+
+VkDescriptorBufferInfo GpuCulling::getCommands() const
+{
+  return whole(*_commands);
+}
+
+VkDescriptorBufferInfo GpuCulling::getCounts() const
+{
+  return whole(*_counts);
+}
+
+const CullingStats& GpuCulling::getStats() const
+{
+  return _stats;
+}
+
+GpuCulling::Kernel GpuCulling::createKernel(std::string_view shader, const SpecializationView& view) const
+{
+  // The module is only needed while the pipeline is created
+  const ShaderModule module(_device.get(), findShader(shader));
+  const std::array<const ShaderReflection*, 1> stages = {&module.getReflection()};
+  const PipelineLayout layout = _device.getLayoutCache().getPipelineLayout(combine(stages));
+
+  const VkSpecializationInfo specialization{
+      .mapEntryCount = static_cast<uint32_t>(view.entries.size()),
+      .pMapEntries = view.entries.data(),
+      .dataSize = view.data.size(),
+      .pData = view.data.data(),
+  };
+  const VkComputePipelineCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage =
+          {
+              .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+              .pNext = nullptr,
+              .flags = 0,
+              .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+              .module = module.get(),
+              .pName = module.getReflection().entry.c_str(),
+              .pSpecializationInfo = &specialization,
+          },
+      .layout = layout.layout,
+      .basePipelineHandle = nullptr,
+      .basePipelineIndex = -1,
+  };
+  Kernel kernel{.pipeline = nullptr, .layout = layout.layout, .setLayout = layout.sets.front()};
+  if (const VkResult status = vkCreateComputePipelines(_device.get(), _device.getPipelineCache().get(), 1, &createInfo, nullptr, &kernel.pipeline);
+      status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create compute pipeline {}! status: {}", shader, utils::result(status)));
+  }
+  return kernel;
+}
+
+void GpuCulling::beginPass(VkCommandBuffer cmd)
+{
+  ++_stats.culls;
+  if (_path != IndirectPath::indirectCount) {
+    return;
+  }
+  vkCmdFillBuffer(cmd, _counts->get(), 0, VK_WHOLE_SIZE, 0);
+  if (_chunked) {
+    vkCmdFillBuffer(cmd, _commands->get(), 0, VK_WHOLE_SIZE, 0);
+  }
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCulling::occlusionPass(VkCommandBuffer cmd, const CullView& view, const Kernel& kernel)
+{
+  if (_instanceCount == 0) {
+    return;
+  }
+  OcclusionPush push;
+  push.set<"viewProjection">(view.viewProjection);
+  push.set<"eye">(view.eye);
+  push.set<"lodScale">(view.lodScale);
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.pipeline);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel.layout, 0, 1, &_occlusionSet, 0, nullptr);
+  dispatchInstances(cmd, kernel.layout, push, _instanceCount, _maxGroups);
+}
+
+void GpuCulling::writeSet()
+{
+  // Buffers are only replaced while nothing recorded against them is pending, the old sets go with them
+  _sets.reset();
+  _set = _sets.allocate(_cull.setLayout);
+  _occlusionSet = _sets.allocate(_early.setLayout);
+  _pyramid = nullptr;
+  const std::array<VkDescriptorBufferInfo, 8> buffers = {whole(*_instances), whole(*_meshes),   whole(*_lods),    whole(*_bucketOffsets),
+                                                         whole(*_counts),    whole(*_commands), whole(*_visible), whole(*_occluded)};
+  std::array<VkWriteDescriptorSet, (buffers.size() * 2) - 1> writes{};
+  for (uint32_t binding = 0; binding < buffers.size(); ++binding) {
+    const VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = nullptr,
+        .dstSet = _occlusionSet,
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo = nullptr,
+        .pBufferInfo = &buffers.at(binding),
+        .pTexelBufferView = nullptr,
+    };
+    writes.at(binding) = write;
+    // cull.comp has every binding but the occluded instances
+    if (binding < occludedBinding) {
+      writes.at(buffers.size() + binding) = write;
+      writes.at(buffers.size() + binding).dstSet = _set;
+    }
+  }
+  vkUpdateDescriptorSets(_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void GpuCulling::writePyramid(const DepthPyramid& pyramid)
+{
+  if (pyramid.getView() == _pyramid) {
+    return;
+  }
+  const VkDescriptorImageInfo image{.sampler = pyramid.getSampler(), .imageView = pyramid.getView(), .imageLayout = pyramid.getLayout()};
+  const VkWriteDescriptorSet write{
+      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+      .pNext = nullptr,
+      .dstSet = _occlusionSet,
+      .dstBinding = pyramidBinding,
+      .dstArrayElement = 0,
+      .descriptorCount = 1,
+      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+      .pImageInfo = &image,
+      .pBufferInfo = nullptr,
+      .pTexelBufferView = nullptr,
+  };
+  vkUpdateDescriptorSets(_device.get(), 1, &write, 0, nullptr);
+  _pyramid = pyramid.getView();
+}
+}  // namespace vulkan
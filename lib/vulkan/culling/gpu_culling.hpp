@@ -0,0 +1,197 @@
+#ifndef LIB_VULKAN_CULLING_GPU_CULLING
+#define LIB_VULKAN_CULLING_GPU_CULLING
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "depth_pyramid.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "device/device_data.hpp"
+#include "memory/buffer.hpp"
+#include "memory/gpu_struct.hpp"
+#include "shader/specialization.hpp"
+
+namespace vulkan {
+// How the culled draws reach the GPU, picked from the enabled DeviceFeatures
+enum class IndirectPath : uint8_t {
+  // One vkCmdDrawIndexedIndirectCount per bucket over the visible draws packed at its front
+  indirectCount,
+  // One vkCmdDrawIndexedIndirect per bucket over a slot of every instance, culled ones draw zero instances
+  multiDraw,
+  // One vkCmdDrawIndexedIndirect per instance slot, without multiDrawIndirect
+  singleDraws,
+};
+
+// Index range of one level of detail, used while the scaled distance to the eye is below distance. The last level of a
+// mesh has no limit
+struct CullLod {
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  int32_t vertexOffset;
+  float distance;
+};
+
+struct CullMesh {
+  // Bounding sphere around the mesh origin at scale 1
+  float radius;
+  // Finest first
+  std::vector<CullLod> lods;
+};
+
+struct CullInstance {
+  Vec3 position;
+  float scale;
+  uint32_t mesh;
+  // Material bucket, every bucket is drawn with its own pipeline
+  uint32_t bucket;
+};
+
+// Planes are xyz normal pointing inside and w distance, a bounding sphere fully behind one of them is culled
+struct CullView {
+  std::array<Vec4, 6> planes;
+  Vec3 eye;
+  // Multiplies the distance LOD selection sees
+  float lodScale = 1.0F;
+  // Reversed depth, only read by occlusion culling, which derives its planes from it
+  Mat4 viewProjection{};
+};
+
+struct CullingStats {
+  uint64_t culls = 0;
+  // vkCmdDraw*Indirect* calls recorded by draw()
+  uint64_t drawCalls = 0;
+};
+
+[[nodiscard]] IndirectPath chooseIndirectPath(const DeviceFeatures& features);
+[[nodiscard]] bool isSupported(const DeviceFeatures& features, IndirectPath path);
+// Left, right, bottom, top, near and far plane of a Vulkan clip space (depth 0 to 1) view projection, normalized
+[[nodiscard]] std::array<Vec4, 6> frustumPlanes(const Mat4& viewProjection);
+
+// GPU driven draws: instances and meshes live in storage buffers, a compute pass culls the instances against the
+// frustum, picks their LOD and writes one VkDrawIndexedIndirectCommand per visible instance into the range of its
+// material bucket. Each bucket is then drawn with a single indirect call where the device allows it. firstInstance is
+// the instance index, gl_InstanceIndex in the vertex shader; without drawIndirectFirstInstance it is 0 and vertex shaders
+// read getVisible() at the slot draw() pushes (shader/glsl/culling/instance.glsl). Occlusion culling splits a frame in
+// two phases around a DepthPyramid of the same view (shader/glsl/culling/occlusion.comp). Not thread safe
+class GpuCulling {
+public:
+  static constexpr uint32_t workgroupSize = 64;
+
+  GpuCulling(const GpuCulling&) = delete;
+  GpuCulling(GpuCulling&&) = delete;
+  GpuCulling& operator=(const GpuCulling&) = delete;
+  GpuCulling& operator=(GpuCulling&&) = delete;
+
+  explicit GpuCulling(const VulkanDevice& device, uint32_t buckets);
+  // Throws when the device does not have the features of path enabled
+  explicit GpuCulling(const VulkanDevice& device, uint32_t buckets, IndirectPath path);
+  ~GpuCulling();
+
+  // Replace the scene, nothing recorded against the previous one may still be pending. Instances refer to meshes by
+  // index, meshes have to be set first
+  void setMeshes(std::span<const CullMesh> meshes);
+  void setInstances(std::span<const CullInstance> instances);
+
+  // Counts are cleared by a transfer, commands and visible slots are written by compute shaders. Making them visible to
+  // VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT and the vertex shaders belongs to the caller
+  void cull(VkCommandBuffer cmd, const CullView& view);
+  // First phase: draws what the pyramid of the last frame does not hide and remembers the rest of the frustum. Draw the
+  // result, build the pyramid from the new depth and let cullLate() draw what of the remembered instances the new one
+  // shows. The pyramid of the first frame hides nothing. Barriers as for cull(), a different pyramid rewrites the
+  // descriptor set and nothing recorded against the old one may still be pending
+  void cullEarly(VkCommandBuffer cmd, const CullView& view, DepthPyramid& pyramid);
+  // Second phase, after the pyramid was built. Waits for the draws of the first phase before it overwrites their commands
+  void cullLate(VkCommandBuffer cmd, const CullView& view, const DepthPyramid& pyramid);
+  // Inside rendering, with the pipeline, index and vertex buffers of the bucket bound. Layout is only used without
+  // drawIndirectFirstInstance, the slot goes to its vertex push constants
+  void draw(VkCommandBuffer cmd, uint32_t bucket, VkPipelineLayout layout = nullptr);
+
+  [[nodiscard]] IndirectPath getPath() const;
+  [[nodiscard]] bool usesFirstInstance() const;
+  [[nodiscard]] uint32_t getBuckets() const;
+  [[nodiscard]] uint32_t getInstances() const;
+  // Draw slots of the bucket, every instance in it
+  [[nodiscard]] uint32_t getBucketSize(uint32_t bucket) const;
+  // Instance of every draw slot, bound at binding 0 of CULLING_SET
+  [[nodiscard]] VkDescriptorBufferInfo getVisible() const;
+  [[nodiscard]] VkDescriptorBufferInfo getCommands() const;
+  // Visible draws per bucket, only written on IndirectPath::indirectCount
+  [[nodiscard]] VkDescriptorBufferInfo getCounts() const;
+  [[nodiscard]] const CullingStats& getStats() const;
+
+private:
+  // Mirrors Push of shader/glsl/culling/cull.comp
+  using Push = GpuStruct<BlockLayout::std430,
+                         Field<"planes", std::array<Vec4, 6>>,
+                         Field<"eye", Vec3>,
+                         Field<"lodScale", float>,
+                         Field<"count", uint32_t>,
+                         Field<"firstGroup", uint32_t>>;
+  // Mirrors Push of shader/glsl/culling/occlusion.comp
+  using OcclusionPush = GpuStruct<BlockLayout::std430,
+                                  Field<"viewProjection", Mat4>,
+                                  Field<"eye", Vec3>,
+                                  Field<"lodScale", float>,
+                                  Field<"count", uint32_t>,
+                                  Field<"firstGroup", uint32_t>>;
+
+  // Compute pipeline of one culling shader, the layouts come from the device cache
+  struct Kernel {
+    VkPipeline pipeline = nullptr;
+    VkPipelineLayout layout = nullptr;
+    VkDescriptorSetLayout setLayout = nullptr;
+  };
+
+  const VulkanDevice& _device;
+  IndirectPath _path;
+  bool _firstInstance;
+  uint32_t _buckets;
+  uint32_t _maxGroups;
+  uint32_t _maxDraws;
+
+  Kernel _cull;
+  Kernel _early;
+  Kernel _late;
+  DescriptorAllocator _sets;
+  VkDescriptorSet _set = nullptr;
+  // Bindings of _set plus the occluded instances and the pyramid, shared by both phases
+  VkDescriptorSet _occlusionSet = nullptr;
+  VkImageView _pyramid = nullptr;
+
+  // Host visible inputs
+  std::unique_ptr<Buffer> _meshes;
+  std::unique_ptr<Buffer> _lods;
+  std::unique_ptr<Buffer> _instances;
+  std::unique_ptr<Buffer> _bucketOffsets;
+  // Written by the culling pass
+  std::unique_ptr<Buffer> _counts;
+  std::unique_ptr<Buffer> _commands;
+  std::unique_ptr<Buffer> _visible;
+  // Instances the first phase of occlusion culling found hidden, only touched by the culling passes
+  std::unique_ptr<Buffer> _occluded;
+
+  uint32_t _meshCount = 0;
+  uint32_t _instanceCount = 0;
+  std::vector<uint32_t> _offsets;
+  std::vector<uint32_t> _sizes;
+  // A bucket holds more than maxDrawIndirectCount slots, draw() splits it and the compacting path clears the commands
+  bool _chunked = false;
+  CullingStats _stats;
+
+  [[nodiscard]] Kernel createKernel(std::string_view shader, const SpecializationView& constants) const;
+  // Counts the pass and clears the counts of the compacting path, its commands as well when buckets are drawn in chunks
+  void beginPass(VkCommandBuffer cmd);
+  void writeSet();
+  void writePyramid(const DepthPyramid& pyramid);
+  void occlusionPass(VkCommandBuffer cmd, const CullView& view, const Kernel& kernel);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_CULLING_GPU_CULLING */
@@ -0,0 +1,662 @@
+#include "occlusion_benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <numbers>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command/command_pools.hpp"
+#include "depth_pyramid.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "gpu_culling.hpp"
+#include "memory/buffer.hpp"
+#include "memory/gpu_struct.hpp"
+#include "memory/image.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "rendering/rendering.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/specialization.hpp"
+#include "sync/timeline.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+using Record = std::function<void(VkCommandBuffer)>;
+
+static constexpr std::string_view vertexShader = "culling/depthOnly.vert";
+static constexpr uint64_t frameTimeout = 10'000'000'000;  // 10s
+static constexpr VkExtent2D benchmarkExtent = {.width = 1920, .height = 1080};
+static constexpr VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+static constexpr VkImageUsageFlags depthUsage =
+    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+// Frames before the measured ones, the pyramid of the first one hides nothing
+static constexpr uint32_t warmup = 4;
+
+// Buildings stand on a grid, the camera walks down the street between the two middle columns
+static constexpr uint32_t sphereCount = 50'000;
+static constexpr uint32_t blocks = 24;
+static constexpr float pitch = 40.0F;
+static constexpr std::array<float, 3> building = {12.0F, 20.0F, 12.0F};
+static constexpr uint32_t rings = 16;
+static constexpr uint32_t segments = 32;
+static constexpr float nearPlane = 0.1F;
+static constexpr float farPlane = 2000.0F;
+static constexpr float fieldOfView = 1.0F;
+static constexpr float eyeHeight = 1.7F;
+static constexpr float walkSpeed = 0.75F;
+static constexpr float swayRate = 0.05F;
+static constexpr float sway = 0.2F;
+
+// Mirrors Camera of shader/glsl/culling/depthOnly.vert
+using CameraBlock = GpuStruct<BlockLayout::std140, Field<"viewProjection", Mat4>>;
+using VertexConstants = Specialization<SpecConstant<8, "cullingFirstInstance", bool, true>>;
+
+struct SceneMeshes {
+  std::vector<Vec4> positions;
+  std::vector<uint32_t> indices;
+  std::vector<CullMesh> meshes;
+};
+
+// What the last frame of a camera path drew and left in the depth buffer
+struct PathResult {
+  double gpuMs;
+  uint32_t drawnEarly;
+  uint32_t drawnLate;
+  std::vector<std::byte> depth;
+};
+
+// Unit sphere and one building, a single level each
+static SceneMeshes makeMeshes()
+{
+  SceneMeshes scene;
+  for (uint32_t ring = 0; ring <= rings; ++ring) {
+    const float theta = std::numbers::pi_v<float> * static_cast<float>(ring) / static_cast<float>(rings);
+    for (uint32_t segment = 0; segment <= segments; ++segment) {
+      const float phi = 2.0F * std::numbers::pi_v<float> * static_cast<float>(segment) / static_cast<float>(segments);
+      scene.positions.push_back({{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi), 1.0F}});
+    }
+  }
+  for (uint32_t ring = 0; ring < rings; ++ring) {
+    for (uint32_t segment = 0; segment < segments; ++segment) {
+      const uint32_t first = (ring * (segments + 1)) + segment;
+      const uint32_t below = first + segments + 1;
+      scene.indices.insert(scene.indices.end(), {first, below, first + 1, first + 1, below, below + 1});
+    }
+  }
+  scene.meshes.push_back({.radius = 1.0F,
+                          .lods = {{.firstIndex = 0,
+                                    .indexCount = static_cast<uint32_t>(scene.indices.size()),
+                                    .vertexOffset = 0,
+                                    .distance = 0.0F}}});
+
+  const auto vertexOffset = static_cast<int32_t>(scene.positions.size());
+  const auto firstIndex = static_cast<uint32_t>(scene.indices.size());
+  const auto& [x, y, z] = building;
+  for (uint32_t corner = 0; corner < 8; ++corner) {
+    scene.positions.push_back({{(corner & 1U) != 0 ? x : -x, (corner & 2U) != 0 ? y : -y, (corner & 4U) != 0 ? z : -z, 1.0F}});
+  }
+  scene.indices.insert(scene.indices.end(), {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+                                             2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3});
+  scene.meshes.push_back({.radius = std::hypot(x, y, z),
+                          .lods = {{.firstIndex = firstIndex,
+                                    .indexCount = static_cast<uint32_t>(scene.indices.size()) - firstIndex,
+                                    .vertexOffset = vertexOffset,
+                                    .distance = 0.0F}}});
+  return scene;
+}
+
+// Buildings first, spheres anywhere on the ground, some inside the buildings
+static std::vector<CullInstance> makeInstances()
+{
+  std::vector<CullInstance> instances;
+  for (uint32_t row = 0; row < blocks; ++row) {
+    for (uint32_t column = 0; column < blocks; ++column) {
+      instances.push_back({.position = {{static_cast<float>(column) * pitch, building[1], static_cast<float>(row) * pitch}},
+                           .scale = 1.0F,
+                           .mesh = 1,
+                           .bucket = 0});
+    }
+  }
+
+  std::mt19937 random(42);  // NOLINT(cert-msc32-c,cert-msc51-cpp), equal scene every run
+  std::uniform_real_distribution<float> ground(-pitch / 2.0F, (static_cast<float>(blocks) - 0.5F) * pitch);
+  std::uniform_real_distribution<float> height(0.5F, 4.0F);
+  std::uniform_real_distribution<float> scale(0.5F, 1.5F);
+  for (uint32_t sphere = 0; sphere < sphereCount; ++sphere) {
+    instances.push_back(
+        {.position = {{ground(random), height(random), ground(random)}}, .scale = scale(random), .mesh = 0, .bucket = 0});
+  }
+  return instances;
+}
+
+// Eye in the street looking down +z, turned by yaw. Vulkan clip space with y down and reversed depth
+static CullView makeView(uint32_t frame)
+{
+  const float eyeX = (static_cast<float>(blocks / 2) - 0.5F) * pitch;
+  const float eyeZ = -pitch + (static_cast<float>(frame) * walkSpeed);
+  const float yaw = std::sin(static_cast<float>(frame) * swayRate) * sway;
+  const float focal = 1.0F / std::tan(fieldOfView / 2.0F);
+  const float aspect = static_cast<float>(benchmarkExtent.width) / static_cast<float>(benchmarkExtent.height);
+  const float sine = std::sin(yaw);
+  const float cosine = std::cos(yaw);
+
+  const std::array<float, 4> right = {cosine, 0.0F, -sine, -((cosine * eyeX) - (sine * eyeZ))};
+  const std::array<float, 4> forward = {sine, 0.0F, cosine, -((sine * eyeX) + (cosine * eyeZ))};
+  const float depthScale = -nearPlane / (farPlane - nearPlane);
+  const float depthOffset = nearPlane * farPlane / (farPlane - nearPlane);
+  Mat4 viewProjection{};
+  for (size_t column = 0; column < 4; ++column) {
+    auto& values = viewProjection.columns.at(column).data;
+    values[0] = focal / aspect * right.at(column);
+    values[1] = column == 1 ? -focal : (column == 3 ? focal * eyeHeight : 0.0F);
+    values[2] = (depthScale * forward.at(column)) + (column == 3 ? depthOffset : 0.0F);
+    values[3] = forward.at(column);
+  }
+  return {.planes = frustumPlanes(viewProjection),
+          .eye = {{eyeX, eyeHeight, eyeZ}},
+          .lodScale = 1.0F,
+          .viewProjection = viewProjection};
+}
+
+template <typename T>
+static Buffer sceneBuffer(const VulkanDevice& device, std::span<const T> values, VkBufferUsageFlags usage)
+{
+  Buffer buffer(device, BufferInfo{.size = std::max<VkDeviceSize>(values.size_bytes(), sizeof(uint32_t)),
+                                   .usage = usage,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+  std::memcpy(buffer.getMapped(), values.data(), values.size_bytes());
+  buffer.flush(0, VK_WHOLE_SIZE);
+  return buffer;
+}
+
+static Buffer readbackBuffer(const VulkanDevice& device, VkDeviceSize size)
+{
+  return Buffer(device, BufferInfo{.size = std::max<VkDeviceSize>(size, sizeof(uint32_t)),
+                                   .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT});
+}
+
+static void memoryBarrier(VkCommandBuffer cmd,
+                          VkPipelineStageFlags srcStage,
+                          VkAccessFlags srcAccess,
+                          VkPipelineStageFlags dstStage,
+                          VkAccessFlags dstAccess)
+{
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = srcAccess,
+      .dstAccessMask = dstAccess,
+  };
+  vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// Culling results to the draws reading them
+static void drawBarrier(VkCommandBuffer cmd)
+{
+  memoryBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+}
+
+// Host visible copy of a culling output, later passes may overwrite the source once it is done
+static void copyOut(VkCommandBuffer cmd, const VkDescriptorBufferInfo& source, const Buffer& target)
+{
+  memoryBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+  const VkBufferCopy region{.srcOffset = source.offset, .dstOffset = 0, .size = target.getSize()};
+  vkCmdCopyBuffer(cmd, source.buffer, target.get(), 1, &region);
+  memoryBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+// Instances the copied commands draw, compacted buckets only up to their count
+static uint32_t drawnInstances(const GpuCulling& culling, const Buffer& commands, const Buffer& counts)
+{
+  commands.invalidate(0, commands.getSize());
+  counts.invalidate(0, counts.getSize());
+  std::vector<VkDrawIndexedIndirectCommand> draws(culling.getInstances());
+  std::vector<uint32_t> drawCounts(culling.getBuckets());
+  std::memcpy(draws.data(), commands.getMapped(), draws.size() * sizeof(VkDrawIndexedIndirectCommand));
+  std::memcpy(drawCounts.data(), counts.getMapped(), drawCounts.size() * sizeof(uint32_t));
+
+  uint32_t drawn = 0;
+  uint32_t offset = 0;
+  for (uint32_t bucket = 0; bucket < culling.getBuckets(); ++bucket) {
+    const uint32_t size = culling.getBucketSize(bucket);
+    const uint32_t used = culling.getPath() == IndirectPath::indirectCount ? std::min(drawCounts[bucket], size) : size;
+    for (uint32_t slot = offset; slot < offset + used; ++slot) {
+      drawn += draws[slot].instanceCount;
+    }
+    offset += size;
+  }
+  return drawn;
+}
+
+// Depth target, scene buffers and the depth only pipeline drawing what GpuCulling wrote
+class DepthScene {
+public:
+  DepthScene(const DepthScene&) = delete;
+  DepthScene(DepthScene&&) = delete;
+  DepthScene& operator=(const DepthScene&) = delete;
+  DepthScene& operator=(DepthScene&&) = delete;
+
+  explicit DepthScene(const VulkanDevice& device, const SceneMeshes& meshes, std::span<const CullInstance> instances, GpuCulling& culling)
+      : _device(device),
+        _culling(culling),
+        _family(graphicsFamily(device)),
+        _depth(device, ImageInfo{.format = depthFormat, .extent = benchmarkExtent, .mipLevels = 1, .usage = depthUsage}),
+        _positions(sceneBuffer<Vec4>(device, meshes.positions, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)),
+        _indices(sceneBuffer<uint32_t>(device, meshes.indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT)),
+        _instances(sceneBuffer<Vec4>(device, instanceData(instances), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)),
+        _camera(sceneBuffer<std::byte>(device, CameraBlock{}.bytes(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)),
+        _depthOut(readbackBuffer(device, VkDeviceSize{benchmarkExtent.width} * benchmarkExtent.height * sizeof(float))),
+        _vertex(device.get(), findShader(vertexShader)),
+        _rendering(device),
+        _compiler(device, _rendering, 1),
+        _sets(device.get(), 2),
+        _pools(device, 1),
+        _timeline(device.get())
+  {
+    _depthView = createImageView(device.get(), _depth, VK_IMAGE_ASPECT_DEPTH_BIT);
+    try {
+      createPipeline();
+      writeSets();
+    }
+    catch (...) {
+      _rendering.releaseViews();
+      vkDestroyImageView(device.get(), _depthView, nullptr);
+      throw;
+    }
+  }
+
+  ~DepthScene()
+  {
+    _rendering.releaseViews();
+    vkDestroyImageView(_device.get(), _depthView, nullptr);
+  }
+
+  [[nodiscard]] VkImageView getDepthView() const { return _depthView; }
+
+  // Submitted alone and waited for, returns the time from submit to completion
+  double submit(uint64_t frame, const CullView& view, const Record& record)
+  {
+    CameraBlock camera;
+    camera.set<"viewProjection">(view.viewProjection);
+    std::memcpy(_camera.getMapped(), camera.bytes().data(), CameraBlock::size);
+    _camera.flush(0, VK_WHOLE_SIZE);
+
+    _pools.beginFrame(frame);
+    VkCommandBuffer cmd = _pools.allocate(_family);
+    const VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+    if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to begin command buffer! status: {}", utils::result(status)));
+    }
+    record(cmd);
+    if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to end command buffer! status: {}", utils::result(status)));
+    }
+
+    const uint64_t value = _timeline.next();
+    const VkTimelineSemaphoreSubmitInfo timelineInfo{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = 0,
+        .pWaitSemaphoreValues = nullptr,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+    const VkSemaphore semaphore = _timeline.get();
+    const VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = nullptr,
+        .pWaitDstStageMask = nullptr,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &semaphore,
+    };
+    const auto start = std::chrono::steady_clock::now();
+    _device.getQueue().submit(_family, {&submitInfo, 1}, nullptr);
+    if (!_timeline.wait(value, frameTimeout)) {
+      throw std::runtime_error("Occlusion culling frame did not finish in time");
+    }
+    const double ms = Milliseconds(std::chrono::steady_clock::now() - start).count();
+    _pools.endFrame(semaphore, value);
+    return ms;
+  }
+
+  // Draws every bucket into the depth buffer and leaves it readable by compute shaders. The first pass of a frame
+  // clears, the second one keeps what the first one drew
+  void draw(VkCommandBuffer cmd, bool clear)
+  {
+    depthBarrier(cmd, clear ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                 VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0,
+                 VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+    VkClearValue far{};
+    far.depthStencil = {.depth = 0.0F, .stencil = 0};
+    const RenderTarget target{
+        .extent = benchmarkExtent,
+        .colors = {},
+        .depth = RenderAttachment{.view = _depthView,
+                                  .format = depthFormat,
+                                  .usage = depthUsage,
+                                  .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                                  .loadOp = clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD,
+                                  .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                                  .clear = far},
+    };
+    [[maybe_unused]] const RenderInheritance inheritance = _rendering.begin(cmd, target);
+    const VkViewport viewport{.x = 0.0F,
+                              .y = 0.0F,
+                              .width = static_cast<float>(benchmarkExtent.width),
+                              .height = static_cast<float>(benchmarkExtent.height),
+                              .minDepth = 0.0F,
+                              .maxDepth = 1.0F};
+    const VkRect2D scissor{.offset = {.x = 0, .y = 0}, .extent = benchmarkExtent};
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+    const std::array<VkDescriptorSet, 2> sets = {_sceneSet, _cullingSet};
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _layout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 0,
+                            nullptr);
+    vkCmdBindIndexBuffer(cmd, _indices.get(), 0, VK_INDEX_TYPE_UINT32);
+    for (uint32_t bucket = 0; bucket < _culling.getBuckets(); ++bucket) {
+      _culling.draw(cmd, bucket, _layout);
+    }
+    _rendering.end(cmd);
+
+    depthBarrier(cmd, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                 VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                 VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+  }
+
+  // After draw(), the depth buffer goes to the host and has to be cleared by the next frame
+  void copyDepth(VkCommandBuffer cmd)
+  {
+    depthBarrier(cmd, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    const VkBufferImageCopy region{
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
+        .imageOffset = {.x = 0, .y = 0, .z = 0},
+        .imageExtent = {.width = benchmarkExtent.width, .height = benchmarkExtent.height, .depth = 1},
+    };
+    vkCmdCopyImageToBuffer(cmd, _depth.get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _depthOut.get(), 1, &region);
+    memoryBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+  }
+
+  [[nodiscard]] std::vector<std::byte> readDepth() const
+  {
+    _depthOut.invalidate(0, _depthOut.getSize());
+    std::vector<std::byte> depth(_depthOut.getSize());
+    std::memcpy(depth.data(), _depthOut.getMapped(), depth.size());
+    return depth;
+  }
+
+private:
+  const VulkanDevice& _device;
+  GpuCulling& _culling;
+  uint32_t _family;
+  Image _depth;
+  VkImageView _depthView = nullptr;
+  Buffer _positions;
+  Buffer _indices;
+  Buffer _instances;
+  Buffer _camera;
+  Buffer _depthOut;
+  ShaderModule _vertex;
+  Rendering _rendering;
+  PipelineCompiler _compiler;
+  VkPipeline _pipeline = nullptr;
+  VkPipelineLayout _layout = nullptr;
+  DescriptorAllocator _sets;
+  VkDescriptorSet _sceneSet = nullptr;
+  VkDescriptorSet _cullingSet = nullptr;
+  CommandPools _pools;
+  Timeline _timeline;
+
+  static uint32_t graphicsFamily(const VulkanDevice& device)
+  {
+    const auto& graphics = device.getQueue().getGraphics();
+    if (graphics.empty()) {
+      throw std::runtime_error("Device has no queue family able to render");
+    }
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(device.getPhysical(), depthFormat, &properties);
+    static constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    if ((properties.optimalTilingFeatures & required) != required) {
+      throw std::runtime_error("Device can not sample a VK_FORMAT_D32_SFLOAT depth attachment");
+    }
+    return graphics.front();
+  }
+
+  static std::vector<Vec4> instanceData(std::span<const CullInstance> instances)
+  {
+    std::vector<Vec4> data;
+    data.reserve(instances.size());
+    for (const CullInstance& instance : instances) {
+      data.push_back({{instance.position.data[0], instance.position.data[1], instance.position.data[2], instance.scale}});
+    }
+    return data;
+  }
+
+  void depthBarrier(VkCommandBuffer cmd,
+                    VkImageLayout from,
+                    VkImageLayout to,
+                    VkPipelineStageFlags srcStage,
+                    VkAccessFlags srcAccess,
+                    VkPipelineStageFlags dstStage,
+                    VkAccessFlags dstAccess) const
+  {
+    const VkImageMemoryBarrier barrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = srcAccess,
+        .dstAccessMask = dstAccess,
+        .oldLayout = from,
+        .newLayout = to,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = _depth.get(),
+        .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1},
+    };
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  }
+
+  void createPipeline()
+  {
+    const std::array<const ShaderReflection*, 1> stages = {&_vertex.getReflection()};
+    const PipelineLayout layout = _device.getLayoutCache().getPipelineLayout(combine(stages));
+    VertexConstants constants;
+    constants.set<"cullingFirstInstance">(_culling.usesFirstInstance());
+    const SpecializationView view = constants.view();
+    // Depth only and closed meshes, winding does not change the depth buffer
+    GraphicsPipelineInfo info{
+        .layout = layout.layout,
+        .stages = {{.stage = VK_SHADER_STAGE_VERTEX_BIT,
+                    .module = _vertex.get(),
+                    .entry = _vertex.getReflection().entry,
+                    .hash = _vertex.getHash(),
+                    .specialization = {view.entries.begin(), view.entries.end()},
+                    .specializationData = {view.data.begin(), view.data.end()}}},
+        .bindings = {},
+        .attributes = {},
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthTest = true,
+        .depthWrite = true,
+        .depthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL,
+        .blend = false,
+        .formats = {.colors = {}, .depth = depthFormat},
+    };
+    const PipelineHandle handle = _compiler.compile(std::move(info));
+    _compiler.wait();
+    _pipeline = _compiler.acquire(handle);
+    if (_pipeline == nullptr) {
+      throw std::runtime_error(std::format("Failed to compile the depth only pipeline of {}", vertexShader));
+    }
+    _layout = layout.layout;
+    _sceneSet = _sets.allocate(layout.sets.at(0));
+    _cullingSet = _sets.allocate(layout.sets.at(1));
+  }
+
+  void writeSets()
+  {
+    const std::array<VkDescriptorBufferInfo, 4> buffers = {{
+        {.buffer = _positions.get(), .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = _instances.get(), .offset = 0, .range = VK_WHOLE_SIZE},
+        {.buffer = _camera.get(), .offset = 0, .range = VK_WHOLE_SIZE},
+        _culling.getVisible(),
+    }};
+    std::array<VkWriteDescriptorSet, buffers.size()> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+      const bool visible = i + 1 == writes.size();
+      writes.at(i) = {
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .pNext = nullptr,
+          .dstSet = visible ? _cullingSet : _sceneSet,
+          .dstBinding = visible ? 0 : i,
+          .dstArrayElement = 0,
+          .descriptorCount = 1,
+          .descriptorType = i == 2 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .pImageInfo = nullptr,
+          .pBufferInfo = &buffers.at(i),
+          .pTexelBufferView = nullptr,
+      };
+    }
+    vkUpdateDescriptorSets(_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  }
+};
+
+// Warm up frames, measured frames and a last frame with its results read back. Without a pyramid every frame is
+// frustum culled and drawn once, with one it goes through both phases of occlusion culling
+static PathResult runPath(const VulkanDevice& device,
+                          DepthScene& scene,
+                          GpuCulling& culling,
+                          DepthPyramid* pyramid,
+                          bool moving,
+                          uint32_t frames,
+                          uint64_t& frame)
+{
+  const Buffer earlyCommands = readbackBuffer(device, VkDeviceSize{culling.getInstances()} * sizeof(VkDrawIndexedIndirectCommand));
+  const Buffer earlyCounts = readbackBuffer(device, VkDeviceSize{culling.getBuckets()} * sizeof(uint32_t));
+  const Buffer lateCommands = readbackBuffer(device, earlyCommands.getSize());
+  const Buffer lateCounts = readbackBuffer(device, earlyCounts.getSize());
+
+  const auto record = [&](VkCommandBuffer cmd, const CullView& view, bool readback) {
+    if (pyramid == nullptr) {
+      culling.cull(cmd, view);
+    }
+    else {
+      culling.cullEarly(cmd, view, *pyramid);
+    }
+    if (readback) {
+      copyOut(cmd, culling.getCommands(), earlyCommands);
+      copyOut(cmd, culling.getCounts(), earlyCounts);
+    }
+    drawBarrier(cmd);
+    scene.draw(cmd, true);
+    if (pyramid != nullptr) {
+      // The pyramid the next frame starts from misses the late draws, which only makes it hide less
+      pyramid->build(cmd, scene.getDepthView());
+      culling.cullLate(cmd, view, *pyramid);
+      if (readback) {
+        copyOut(cmd, culling.getCommands(), lateCommands);
+        copyOut(cmd, culling.getCounts(), lateCounts);
+      }
+      drawBarrier(cmd);
+      scene.draw(cmd, false);
+    }
+    if (readback) {
+      scene.copyDepth(cmd);
+    }
+  };
+
+  const uint32_t total = warmup + frames;
+  double measured = 0.0;
+  for (uint32_t step = 0; step < total; ++step) {
+    const CullView view = makeView(moving ? step : 0);
+    const double ms = scene.submit(frame++, view, [&](VkCommandBuffer cmd) { record(cmd, view, false); });
+    measured += step >= warmup ? ms : 0.0;
+  }
+  const CullView last = makeView(moving ? total : 0);
+  scene.submit(frame++, last, [&](VkCommandBuffer cmd) { record(cmd, last, true); });
+
+  return {.gpuMs = measured / static_cast<double>(std::max(frames, 1U)),
+          .drawnEarly = drawnInstances(culling, earlyCommands, earlyCounts),
+          .drawnLate = pyramid != nullptr ? drawnInstances(culling, lateCommands, lateCounts) : 0,
+          .depth = scene.readDepth()};
+}
+
+std::vector<OcclusionReport> benchmarkOcclusion(const VulkanDevice& device, uint32_t frames)
+{
+  const SceneMeshes meshes = makeMeshes();
+  const std::vector<CullInstance> instances = makeInstances();
+  GpuCulling culling(device, 1);
+  culling.setMeshes(meshes.meshes);
+  culling.setInstances(instances);
+  DepthScene scene(device, meshes, instances, culling);
+  // One pyramid for every path, both start at the same camera
+  DepthPyramid pyramid(device, benchmarkExtent);
+
+  std::vector<OcclusionReport> results;
+  uint64_t frame = 0;
+  for (const bool moving : {false, true}) {
+    const PathResult frustum = runPath(device, scene, culling, nullptr, moving, frames, frame);
+    const PathResult occlusion = runPath(device, scene, culling, &pyramid, moving, frames, frame);
+    const std::string camera = moving ? "moving camera" : "static camera";
+    results.push_back({.mode = std::format("frustum only, {}", camera),
+                       .instances = culling.getInstances(),
+                       .inFrustum = frustum.drawnEarly,
+                       .drawnEarly = frustum.drawnEarly,
+                       .drawnLate = 0,
+                       .gpuMs = frustum.gpuMs,
+                       .savedMs = 0.0,
+                       .correct = true});
+    results.push_back({.mode = std::format("two phase hi-z, {}", camera),
+                       .instances = culling.getInstances(),
+                       .inFrustum = frustum.drawnEarly,
+                       .drawnEarly = occlusion.drawnEarly,
+                       .drawnLate = occlusion.drawnLate,
+                       .gpuMs = occlusion.gpuMs,
+                       .savedMs = frustum.gpuMs - occlusion.gpuMs,
+                       .correct = occlusion.depth == frustum.depth});
+  }
+  return results;
+}
+}  // namespace vulkan
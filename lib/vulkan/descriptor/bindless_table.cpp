@@ -0,0 +1,251 @@
+#include "bindless_table.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+
+namespace vulkan {
+// Sorts the queued writes by slot keeping only the latest one of each, then emits one write per run of consecutive slots
+template <typename Info>
+static void coalesce(std::vector<std::pair<uint32_t, Info>>& pending, VkDescriptorSet set, uint32_t binding,
+                     VkDescriptorType type, std::vector<Info>& infos, std::vector<VkWriteDescriptorSet>& writes)
+{
+  std::ranges::stable_sort(pending, {}, &std::pair<uint32_t, Info>::first);
+  for (size_t index = 0; index < pending.size(); ++index) {
+    if (index + 1 < pending.size() && pending[index + 1].first == pending[index].first) {
+      continue;
+    }
+    const uint32_t slot = pending[index].first;
+    if (!writes.empty() && writes.back().dstBinding == binding &&
+        writes.back().dstArrayElement + writes.back().descriptorCount == slot) {
+      ++writes.back().descriptorCount;
+    }
+    else {
+      writes.push_back({
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .pNext = nullptr,
+          .dstSet = set,
+          .dstBinding = binding,
+          .dstArrayElement = slot,
+          .descriptorCount = 1,
+          .descriptorType = type,
+          .pImageInfo = nullptr,
+          .pBufferInfo = nullptr,
+          .pTexelBufferView = nullptr,
+      });
+    }
+    infos.push_back(pending[index].second);
+  }
+  pending.clear();
+}
+
+uint32_t BindlessTable::Slots::take(const char* kind)
+{
+  if (!free.empty()) {
+    const uint32_t slot = free.back();
+    free.pop_back();
+    return slot;
+  }
+  if (next == capacity) {
+    throw std::runtime_error(std::format("Bindless table is out of {} slots, capacity: {}", kind, capacity));
+  }
+  return next++;
+}
+
+void BindlessTable::Slots::recycle(uint64_t completedValue)
+{
+  const auto done = std::ranges::partition(retired, [completedValue](const Retired& entry) { return entry.value > completedValue; });
+  for (const Retired& entry : done) {
+    free.push_back(entry.slot);
+  }
+  retired.erase(done.begin(), done.end());
+}
+
+BindlessTable::BindlessTable(const VulkanDevice& device, uint32_t textures, uint32_t buffers)
+    : _device(device.get()),
+      _textures{.capacity = textures},
+      _buffers{.capacity = buffers}
+{
+  if (!device.getFeatures().descriptorIndexing) {
+    throw std::runtime_error("Bindless table needs descriptor indexing, the device does not support it");
+  }
+
+  // Default capacities stay far below the 500000 update-after-bind descriptors every descriptor indexing device offers
+  const std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+      {.binding = textureBinding,
+       .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+       .descriptorCount = textures,
+       .stageFlags = VK_SHADER_STAGE_ALL,
+       .pImmutableSamplers = nullptr},
+      {.binding = bufferBinding,
+       .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       .descriptorCount = buffers,
+       .stageFlags = VK_SHADER_STAGE_ALL,
+       .pImmutableSamplers = nullptr},
+  }};
+  // Slots are written while frames in flight use the set, unused slots hold stale or no descriptors at all
+  static constexpr VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                           VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                           VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+  const std::array<VkDescriptorBindingFlags, 2> flags = {bindingFlags, bindingFlags};
+  const VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+      .pNext = nullptr,
+      .bindingCount = static_cast<uint32_t>(flags.size()),
+      .pBindingFlags = flags.data(),
+  };
+  const VkDescriptorSetLayoutCreateInfo layoutInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext = &flagsInfo,
+      .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+      .bindingCount = static_cast<uint32_t>(bindings.size()),
+      .pBindings = bindings.data(),
+  };
+  if (const VkResult status = vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_layout); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create bindless descriptor set layout! status: {}", utils::result(status)));
+  }
+
+  const std::array<VkDescriptorPoolSize, 2> sizes = {{
+      {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = textures},
+      {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = buffers},
+  }};
+  const VkDescriptorPoolCreateInfo poolInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+      .maxSets = 1,
+      .poolSizeCount = static_cast<uint32_t>(sizes.size()),
+      .pPoolSizes = sizes.data(),
+  };
+  if (const VkResult status = vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_pool); status != VK_SUCCESS) {
+    vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+    throw std::runtime_error(std::format("Failed to create bindless descriptor pool! status: {}", utils::result(status)));
+  }
+
+  const VkDescriptorSetAllocateInfo allocateInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .descriptorPool = _pool,
+      .descriptorSetCount = 1,
+      .pSetLayouts = &_layout,
+  };
+  if (const VkResult status = vkAllocateDescriptorSets(_device, &allocateInfo, &_set); status != VK_SUCCESS) {
+    vkDestroyDescriptorPool(_device, _pool, nullptr);
+    vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+    throw std::runtime_error(std::format("Failed to allocate bindless descriptor set! status: {}", utils::result(status)));
+  }
+}
+
+BindlessTable::~BindlessTable()
+{
+  // The set goes away with its pool
+  vkDestroyDescriptorPool(_device, _pool, nullptr);
+  vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+}
+
+uint32_t BindlessTable::addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout)
+{
+  const uint32_t slot = _textures.take("texture");
+  setTexture(slot, view, sampler, layout);
+  ++_stats.textures;
+  return slot;
+}
+
+uint32_t BindlessTable::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+  const uint32_t slot = _buffers.take("buffer");
+  setBuffer(slot, buffer, offset, range);
+  ++_stats.buffers;
+  return slot;
+}
+
+void BindlessTable::setTexture(uint32_t slot, VkImageView view, VkSampler sampler, VkImageLayout layout)
+{
+  _pendingTextures.emplace_back(slot, VkDescriptorImageInfo{.sampler = sampler, .imageView = view, .imageLayout = layout});
+}
+
+void BindlessTable::setBuffer(uint32_t slot, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+  _pendingBuffers.emplace_back(slot, VkDescriptorBufferInfo{.buffer = buffer, .offset = offset, .range = range});
+}
+
+void BindlessTable::releaseTexture(uint32_t slot, uint64_t retireValue)
+{
+  // A write queued for the slot is dropped, nobody reads it anymore
+  std::erase_if(_pendingTextures, [slot](const auto& pending) { return pending.first == slot; });
+  _textures.retired.push_back({.slot = slot, .value = retireValue});
+  --_stats.textures;
+}
+
+void BindlessTable::releaseBuffer(uint32_t slot, uint64_t retireValue)
+{
+  std::erase_if(_pendingBuffers, [slot](const auto& pending) { return pending.first == slot; });
+  _buffers.retired.push_back({.slot = slot, .value = retireValue});
+  --_stats.buffers;
+}
+
+void BindlessTable::flush(uint64_t completedValue)
+{
+  _textures.recycle(completedValue);
+  _buffers.recycle(completedValue);
+  if (_pendingTextures.empty() && _pendingBuffers.empty()) {
+    return;
+  }
+
+  // Infos are reserved up front, the writes point into them
+  std::vector<VkDescriptorImageInfo> images;
+  std::vector<VkDescriptorBufferInfo> buffers;
+  images.reserve(_pendingTextures.size());
+  buffers.reserve(_pendingBuffers.size());
+  std::vector<VkWriteDescriptorSet> writes;
+  coalesce(_pendingTextures, _set, textureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, images, writes);
+  const size_t textureWrites = writes.size();
+  coalesce(_pendingBuffers, _set, bufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffers, writes);
+
+  size_t image = 0;
+  size_t buffer = 0;
+  for (size_t index = 0; index < writes.size(); ++index) {
+    if (index < textureWrites) {
+      writes[index].pImageInfo = images.data() + image;
+      image += writes[index].descriptorCount;
+    }
+    else {
+      writes[index].pBufferInfo = buffers.data() + buffer;
+      buffer += writes[index].descriptorCount;
+    }
+  }
+  vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  _stats.writes += images.size() + buffers.size();
+  ++_stats.flushes;
+}
+
+void BindlessTable::bind(VkCommandBuffer cmd, VkPipelineBindPoint point, VkPipelineLayout layout, uint32_t set) const
+{
+  vkCmdBindDescriptorSets(cmd, point, layout, set, 1, &_set, 0, nullptr);
+}
+
+VkDescriptorSet BindlessTable::get() const
+{
+  return _set;
+}
+
+VkDescriptorSetLayout BindlessTable::getLayout() const
+{
+  return _layout;
+}
+
+const BindlessStats& BindlessTable::getStats() const
+{
+  return _stats;
+}
+}  // namespace vulkan
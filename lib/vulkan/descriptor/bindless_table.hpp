@@ -0,0 +1,89 @@
+#ifndef LIB_VULKAN_DESCRIPTOR_BINDLESS_TABLE
+#define LIB_VULKAN_DESCRIPTOR_BINDLESS_TABLE
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct BindlessStats {
+  uint32_t textures = 0;
+  uint32_t buffers = 0;
+  uint64_t writes = 0;
+  // vkUpdateDescriptorSets calls, consecutive slots written in the same flush share one VkWriteDescriptorSet
+  uint64_t flushes = 0;
+};
+
+// One global descriptor set every pipeline binds once: binding 0 is an array of combined image samplers, binding 1 an
+// array of storage buffers, shaders index them with the slots handed out here. Needs DeviceFeatures::descriptorIndexing.
+// Writes are queued and applied by flush(), slots released while the GPU may still read them are reused only once
+// the frame timeline passed the value given on release. Not thread safe
+class BindlessTable {
+public:
+  static constexpr uint32_t textureBinding = 0;
+  static constexpr uint32_t bufferBinding = 1;
+
+  BindlessTable(const BindlessTable&) = delete;
+  BindlessTable(BindlessTable&&) = delete;
+  BindlessTable& operator=(const BindlessTable&) = delete;
+  BindlessTable& operator=(BindlessTable&&) = delete;
+
+  // Throws when the device has no descriptor indexing
+  explicit BindlessTable(const VulkanDevice& device, uint32_t textures = 16384, uint32_t buffers = 16384);
+  ~BindlessTable();
+
+  // Slot of the new descriptor, throws when the table is full
+  [[nodiscard]] uint32_t addTexture(VkImageView view, VkSampler sampler,
+                                    VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  [[nodiscard]] uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+  void setTexture(uint32_t slot, VkImageView view, VkSampler sampler,
+                  VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  void setBuffer(uint32_t slot, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+  // Slot is free again once the frame timeline reaches retireValue
+  void releaseTexture(uint32_t slot, uint64_t retireValue);
+  void releaseBuffer(uint32_t slot, uint64_t retireValue);
+
+  // Writes the queued descriptors and recycles the slots retired up to completedValue, once per frame before recording
+  void flush(uint64_t completedValue);
+  void bind(VkCommandBuffer cmd, VkPipelineBindPoint point, VkPipelineLayout layout, uint32_t set = 0) const;
+
+  [[nodiscard]] VkDescriptorSet get() const;
+  // Goes into every pipeline layout that reads the table
+  [[nodiscard]] VkDescriptorSetLayout getLayout() const;
+  [[nodiscard]] const BindlessStats& getStats() const;
+
+private:
+  struct Retired {
+    uint32_t slot;
+    uint64_t value;
+  };
+
+  struct Slots {
+    uint32_t capacity;
+    // Never handed out slots start at next, released ones come back through free
+    uint32_t next = 0;
+    std::vector<uint32_t> free = {};
+    std::vector<Retired> retired = {};
+
+    [[nodiscard]] uint32_t take(const char* kind);
+    void recycle(uint64_t completedValue);
+  };
+
+  VkDevice _device;
+  VkDescriptorSetLayout _layout = nullptr;
+  VkDescriptorPool _pool = nullptr;
+  VkDescriptorSet _set = nullptr;
+  Slots _textures;
+  Slots _buffers;
+  // Queued writes by slot, the latest write of a slot wins
+  std::vector<std::pair<uint32_t, VkDescriptorImageInfo>> _pendingTextures;
+  std::vector<std::pair<uint32_t, VkDescriptorBufferInfo>> _pendingBuffers;
+  BindlessStats _stats;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_DESCRIPTOR_BINDLESS_TABLE */
@@ -0,0 +1,141 @@
+#include "descriptor_allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "format/string.hpp"
+
+namespace vulkan {
+DescriptorAllocator::DescriptorAllocator(VkDevice device, uint32_t initialSets, std::vector<PoolRatio> ratios)
+    : _device(device),
+      _ratios(std::move(ratios)),
+      _setsPerPool(std::clamp(initialSets, 1U, maxSetsPerPool))
+{
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+  for (VkDescriptorPool pool : _ready) {
+    vkDestroyDescriptorPool(_device, pool, nullptr);
+  }
+  for (VkDescriptorPool pool : _full) {
+    vkDestroyDescriptorPool(_device, pool, nullptr);
+  }
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout, uint32_t variableCount)
+{
+  const VkDescriptorSetVariableDescriptorCountAllocateInfo variableInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .descriptorSetCount = 1,
+      .pDescriptorCounts = &variableCount,
+  };
+  VkDescriptorSetAllocateInfo allocateInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext = variableCount != 0 ? &variableInfo : nullptr,
+      .descriptorPool = takePool(),
+      .descriptorSetCount = 1,
+      .pSetLayouts = &layout,
+  };
+
+  VkDescriptorSet set = nullptr;
+  VkResult status = vkAllocateDescriptorSets(_device, &allocateInfo, &set);
+  if (status == VK_ERROR_OUT_OF_POOL_MEMORY || status == VK_ERROR_FRAGMENTED_POOL) {
+    // The pool is done for this frame. The other ready pools are no larger, the retry goes to a new pool that holds
+    // variableCount descriptors of every type on top of its regular share
+    _full.push_back(allocateInfo.descriptorPool);
+    _ready.pop_back();
+    _ready.push_back(createPool(_setsPerPool, variableCount));
+    {
+      const std::scoped_lock lock(_mutex);
+      ++_stats.recoveries;
+    }
+    allocateInfo.descriptorPool = _ready.back();
+    status = vkAllocateDescriptorSets(_device, &allocateInfo, &set);
+  }
+  if (status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to allocate descriptor set! status: {}", utils::result(status)));
+  }
+  const std::scoped_lock lock(_mutex);
+  ++_stats.sets;
+  return set;
+}
+
+void DescriptorAllocator::reset()
+{
+  _ready.insert(_ready.end(), _full.begin(), _full.end());
+  _full.clear();
+  for (VkDescriptorPool pool : _ready) {
+    if (const VkResult status = vkResetDescriptorPool(_device, pool, 0); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to reset descriptor pool! status: {}", utils::result(status)));
+    }
+  }
+  const std::scoped_lock lock(_mutex);
+  ++_stats.resets;
+}
+
+DescriptorStats DescriptorAllocator::getStats() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _stats;
+}
+
+std::vector<PoolRatio> DescriptorAllocator::defaultRatios()
+{
+  return {
+      {.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .ratio = 2.0F},
+      {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .ratio = 2.0F},
+      {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .ratio = 4.0F},
+      {.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .ratio = 1.0F},
+      {.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .ratio = 1.0F},
+      {.type = VK_DESCRIPTOR_TYPE_SAMPLER, .ratio = 1.0F},
+      {.type = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, .ratio = 0.5F},
+      {.type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, .ratio = 0.5F},
+      {.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, .ratio = 0.5F},
+  };
+}
+
+VkDescriptorPool DescriptorAllocator::takePool()
+{
+  if (_ready.empty()) {
+    _ready.push_back(createPool(_setsPerPool, 0));
+    // Each new pool is larger, a frame that needs many sets settles on a few big pools
+    _setsPerPool = std::min(static_cast<uint32_t>(static_cast<float>(_setsPerPool) * growth), maxSetsPerPool);
+  }
+  return _ready.back();
+}
+
+VkDescriptorPool DescriptorAllocator::createPool(uint32_t sets, uint32_t extra)
+{
+  std::vector<VkDescriptorPoolSize> sizes;
+  sizes.reserve(_ratios.size());
+  for (const PoolRatio& ratio : _ratios) {
+    sizes.push_back({.type = ratio.type,
+                     .descriptorCount = std::max(static_cast<uint32_t>(ratio.ratio * static_cast<float>(sets)), 1U) + extra});
+  }
+  const VkDescriptorPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .maxSets = sets,
+      .poolSizeCount = static_cast<uint32_t>(sizes.size()),
+      .pPoolSizes = sizes.data(),
+  };
+
+  VkDescriptorPool pool = nullptr;
+  if (const VkResult status = vkCreateDescriptorPool(_device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create descriptor pool! status: {}", utils::result(status)));
+  }
+  const std::scoped_lock lock(_mutex);
+  ++_stats.pools;
+  return pool;
+}
+}  // namespace vulkan
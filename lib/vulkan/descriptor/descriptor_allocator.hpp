@@ -0,0 +1,68 @@
+#ifndef LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_ALLOCATOR
+#define LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_ALLOCATOR
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+// Descriptors of one type per set a pool is sized for
+struct PoolRatio {
+  VkDescriptorType type;
+  float ratio;
+};
+
+struct DescriptorStats {
+  uint64_t sets = 0;
+  uint64_t pools = 0;
+  // Allocations that hit VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL and moved on to a new pool
+  uint64_t recoveries = 0;
+  uint64_t resets = 0;
+};
+
+// Pool of descriptor pools for sets living one frame. Full pools are set aside, every pool is reset at once and reused.
+// Not thread safe, one allocator per frame slot (and thread) that is only reset once the GPU is done with the slot.
+// Only getStats() may be called from other threads
+class DescriptorAllocator {
+public:
+  static constexpr uint32_t maxSetsPerPool = 4096;
+  static constexpr float growth = 1.5F;
+
+  DescriptorAllocator(const DescriptorAllocator&) = delete;
+  DescriptorAllocator(DescriptorAllocator&&) = delete;
+  DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+  DescriptorAllocator& operator=(DescriptorAllocator&&) = delete;
+
+  explicit DescriptorAllocator(VkDevice device, uint32_t initialSets = 64, std::vector<PoolRatio> ratios = defaultRatios());
+  ~DescriptorAllocator();
+
+  // Variable count applies to a last binding created with VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT. A set that
+  // does not fit the current pool goes to a new one with variableCount more descriptors of every type, fixed bindings
+  // beyond the share of a pool need larger ratios
+  [[nodiscard]] VkDescriptorSet allocate(VkDescriptorSetLayout layout, uint32_t variableCount = 0);
+  // Every set handed out becomes invalid
+  void reset();
+
+  [[nodiscard]] DescriptorStats getStats() const;
+  // Every descriptor type reflection produces except acceleration structures, which need their extension enabled
+  [[nodiscard]] static std::vector<PoolRatio> defaultRatios();
+
+private:
+  VkDevice _device;
+  std::vector<PoolRatio> _ratios;
+  uint32_t _setsPerPool;
+  // Pools with room left, the last one is allocated from
+  std::vector<VkDescriptorPool> _ready;
+  std::vector<VkDescriptorPool> _full;
+  mutable std::mutex _mutex;
+  DescriptorStats _stats;
+
+  [[nodiscard]] VkDescriptorPool takePool();
+  // Extra descriptors of every type on top of the ratios, for the variable binding of a set that did not fit
+  [[nodiscard]] VkDescriptorPool createPool(uint32_t sets, uint32_t extra);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_ALLOCATOR */
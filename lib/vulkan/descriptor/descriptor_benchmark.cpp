@@ -0,0 +1,107 @@
+#include "descriptor_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "bindless_table.hpp"
+#include "descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// Every update points at its own 256 byte range, the driver can not skip repeated descriptors
+static constexpr VkDeviceSize rangeSize = 256;
+
+static double perDrawSets(const VulkanDevice& device, const Buffer& buffer, uint32_t updates)
+{
+  const VkDescriptorSetLayoutBinding binding{
+      .binding = 0,
+      .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      .descriptorCount = 1,
+      .stageFlags = VK_SHADER_STAGE_ALL,
+      .pImmutableSamplers = nullptr,
+  };
+  const VkDescriptorSetLayoutCreateInfo layoutInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .bindingCount = 1,
+      .pBindings = &binding,
+  };
+  VkDescriptorSetLayout layout = nullptr;
+  if (const VkResult status = vkCreateDescriptorSetLayout(device.get(), &layoutInfo, nullptr, &layout); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create descriptor set layout! status: {}", utils::result(status)));
+  }
+
+  const uint64_t ranges = buffer.getSize() / rangeSize;
+  double ms = 0.0;
+  {
+    DescriptorAllocator allocator(device.get());
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t update = 0; update < updates; ++update) {
+      const VkDescriptorBufferInfo info{.buffer = buffer.get(), .offset = (update % ranges) * rangeSize, .range = rangeSize};
+      const VkWriteDescriptorSet write{
+          .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+          .pNext = nullptr,
+          .dstSet = allocator.allocate(layout),
+          .dstBinding = 0,
+          .dstArrayElement = 0,
+          .descriptorCount = 1,
+          .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+          .pImageInfo = nullptr,
+          .pBufferInfo = &info,
+          .pTexelBufferView = nullptr,
+      };
+      vkUpdateDescriptorSets(device.get(), 1, &write, 0, nullptr);
+    }
+    allocator.reset();
+    ms = Milliseconds(std::chrono::steady_clock::now() - start).count();
+  }
+  vkDestroyDescriptorSetLayout(device.get(), layout, nullptr);
+  return ms;
+}
+
+static double bindlessBatched(const VulkanDevice& device, const Buffer& buffer, uint32_t updates)
+{
+  const uint64_t ranges = buffer.getSize() / rangeSize;
+  const uint32_t slots = std::min(updates, 16384U);
+  BindlessTable table(device, 1, slots);
+  for (uint32_t slot = 0; slot < slots; ++slot) {
+    static_cast<void>(table.addBuffer(buffer.get(), 0, rangeSize));
+  }
+  table.flush(0);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (uint32_t update = 0; update < updates; ++update) {
+    table.setBuffer(update % slots, buffer.get(), (update % ranges) * rangeSize, rangeSize);
+    // One batch per table capacity, like one frame rewriting every slot
+    if ((update + 1) % slots == 0) {
+      table.flush(0);
+    }
+  }
+  table.flush(0);
+  return Milliseconds(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<DescriptorThroughput> benchmarkDescriptors(const VulkanDevice& device, uint32_t updates)
+{
+  static constexpr VkDeviceSize bufferSize = 1024ULL * 1024ULL;  // 1MB
+  const Buffer buffer(device, BufferInfo{.size = bufferSize, .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT});
+
+  std::vector<DescriptorThroughput> results;
+  results.push_back({.method = "set per draw", .updates = updates, .ms = perDrawSets(device, buffer, updates)});
+  if (device.getFeatures().descriptorIndexing) {
+    results.push_back({.method = "bindless batched", .updates = updates, .ms = bindlessBatched(device, buffer, updates)});
+  }
+  return results;
+}
+}  // namespace vulkan
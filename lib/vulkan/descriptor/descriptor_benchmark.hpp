@@ -0,0 +1,23 @@
+#ifndef LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_BENCHMARK
+#define LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_BENCHMARK
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct DescriptorThroughput {
+  std::string method;
+  uint32_t updates;
+  // Wall time of all updates, in milliseconds
+  double ms;
+};
+
+// Descriptor updates the way a frame would issue them: a freshly allocated set written per draw against slots of the
+// bindless table written in one batch. Nothing is submitted. The bindless run is skipped without descriptor indexing
+[[nodiscard]] std::vector<DescriptorThroughput> benchmarkDescriptors(const VulkanDevice& device, uint32_t updates);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_DESCRIPTOR_DESCRIPTOR_BENCHMARK */
@@ -26,6 +26,8 @@
 #include "format/string.hpp"
 #include "format/table.hpp"
 #include "init_vulkan/init.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_cache.hpp"
 #include "window/window_info.hpp"
 
 namespace vulkan {
@@ -367,6 +369,17 @@ static void show(const std::vector<DeviceData>& devices)
   showQueue(devices);
 }
 
+static bool hasExtension(VkPhysicalDevice device, std::string_view name)
+{
+  uint32_t count = 0;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+  std::vector<VkExtensionProperties> extensions(count);
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &count, extensions.data());
+  return std::ranges::any_of(extensions, [name](const VkExtensionProperties& ext) {
+    return std::string_view(static_cast<const char*>(ext.extensionName)) == name;
+  });
+}
+
 static std::vector<DeviceData> getDevicesData(const VkSurfaceKHR& surface)
 {
   auto instance = InitVulkan::getInit();
@@ -388,6 +401,26 @@ static std::vector<DeviceData> getDevicesData(const VkSurfaceKHR& surface)
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(device, &features);
 
+    // Only chained when the extension exists, otherwise the struct stays zeroed
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibrary{};
+    pipelineLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    const bool libraryExtensions = hasExtension(device, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+                                   hasExtension(device, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    VkPhysicalDeviceVulkan13Features features13{};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.pNext = libraryExtensions ? &pipelineLibrary : nullptr;
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = properties.apiVersion >= VK_API_VERSION_1_3 ? static_cast<void*>(&features13) : features13.pNext;
+    if (properties.apiVersion >= VK_API_VERSION_1_2) {
+      VkPhysicalDeviceFeatures2 features2{};
+      features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+      features2.pNext = &features12;
+      vkGetPhysicalDeviceFeatures2(device, &features2);
+    }
+    features12.pNext = nullptr;
+    features13.pNext = nullptr;
+
     uint32_t queueCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueCount, nullptr);
     std::vector<VkQueueFamilyProperties> queues(queueCount);
@@ -405,7 +438,7 @@ static std::vector<DeviceData> getDevicesData(const VkSurfaceKHR& surface)
       queuesData.emplace_back(queues[i], supportKHR, i);
     }
 
-    devicesData.emplace_back(device, properties, features, memProperties, std::move(queuesData));
+    devicesData.emplace_back(device, properties, features, memProperties, std::move(queuesData), features12, features13, pipelineLibrary);
   }
 
   if constexpr (Debug) {
@@ -417,8 +450,9 @@ static std::vector<DeviceData> getDevicesData(const VkSurfaceKHR& surface)
 
 static bool checkMinimalRequirements(const DeviceData& device)
 {
-  auto [id, properties, features, memory, queues] = device;
-  if (properties.apiVersion < VK_API_VERSION_1_0) {
+  auto [id, properties, features, memory, queues, features12, features13, pipelineLibrary] = device;
+  // Timeline semaphores track every asynchronous submission
+  if (properties.apiVersion < VK_API_VERSION_1_2 || features12.timelineSemaphore == VK_FALSE) {
     return false;
   }
 
@@ -562,10 +596,31 @@ static void showDeviceInfo(std::string_view name,
   // clang-format on
 }
 
-static VkDevice createLogicalDevice(const WindowInfo& info, const DeviceData& bestDevice)
+static DeviceFeatures chooseFeatures(const DeviceData& device)
+{
+  return {
+      .dynamicRendering = device.properties.apiVersion >= VK_API_VERSION_1_3 && device.features13.dynamicRendering == VK_TRUE,
+      .imagelessFramebuffer = device.features12.imagelessFramebuffer == VK_TRUE,
+      .synchronization2 = device.properties.apiVersion >= VK_API_VERSION_1_3 && device.features13.synchronization2 == VK_TRUE,
+      .creationFeedback = device.properties.apiVersion >= VK_API_VERSION_1_3,
+      .graphicsPipelineLibrary = device.pipelineLibrary.graphicsPipelineLibrary == VK_TRUE,
+      .descriptorIndexing = device.features12.runtimeDescriptorArray == VK_TRUE && device.features12.descriptorBindingPartiallyBound == VK_TRUE &&
+                            device.features12.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+                            device.features12.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                            device.features12.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+                            device.features12.shaderSampledImageArrayNonUniformIndexing == VK_TRUE &&
+                            device.features12.shaderStorageBufferArrayNonUniformIndexing == VK_TRUE,
+      .scalarBlockLayout = device.features12.scalarBlockLayout == VK_TRUE,
+      .multiDrawIndirect = device.features.multiDrawIndirect == VK_TRUE,
+      .drawIndirectFirstInstance = device.features.drawIndirectFirstInstance == VK_TRUE,
+      .drawIndirectCount = device.features12.drawIndirectCount == VK_TRUE,
+  };
+}
+
+static VkDevice createLogicalDevice(const WindowInfo& info, const DeviceData& bestDevice, const DeviceFeatures& enabled)
 {
   auto time = utils::LogTime("Device construct");
-  auto [device, properties, features, memory, queues] = bestDevice;
+  auto [device, properties, features, memory, queues, features12, features13, pipelineLibrary] = bestDevice;
   auto extensions = info.extensions |                                                            //
                     std::views::transform([](const std::string& str) { return str.c_str(); }) |  //
                     std::ranges::to<std::vector<const char*>>();
@@ -606,10 +661,46 @@ static VkDevice createLogicalDevice(const WindowInfo& info, const DeviceData& be
     });
   }
 
-  const VkPhysicalDeviceFeatures deviceFeatures{};
+  VkPhysicalDeviceFeatures deviceFeatures{};
+  deviceFeatures.multiDrawIndirect = enabled.multiDrawIndirect ? VK_TRUE : VK_FALSE;
+  deviceFeatures.drawIndirectFirstInstance = enabled.drawIndirectFirstInstance ? VK_TRUE : VK_FALSE;
+  VkPhysicalDeviceVulkan12Features enabled12{};
+  enabled12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  enabled12.timelineSemaphore = VK_TRUE;
+  enabled12.imagelessFramebuffer = enabled.imagelessFramebuffer ? VK_TRUE : VK_FALSE;
+  if (enabled.descriptorIndexing) {
+    enabled12.runtimeDescriptorArray = VK_TRUE;
+    enabled12.descriptorBindingPartiallyBound = VK_TRUE;
+    enabled12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    enabled12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    enabled12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    enabled12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    enabled12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+  }
+  enabled12.scalarBlockLayout = enabled.scalarBlockLayout ? VK_TRUE : VK_FALSE;
+  enabled12.drawIndirectCount = enabled.drawIndirectCount ? VK_TRUE : VK_FALSE;
+
+  // The 1.3 struct is only valid in the chain when the device reports 1.3
+  VkPhysicalDeviceVulkan13Features enabled13{};
+  enabled13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  enabled13.dynamicRendering = enabled.dynamicRendering ? VK_TRUE : VK_FALSE;
+  enabled13.synchronization2 = enabled.synchronization2 ? VK_TRUE : VK_FALSE;
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT enabledLibrary{};
+  enabledLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+  enabledLibrary.graphicsPipelineLibrary = VK_TRUE;
+  enabled13.pNext = enabled.graphicsPipelineLibrary ? &enabledLibrary : nullptr;
+  enabled12.pNext = properties.apiVersion >= VK_API_VERSION_1_3 ? static_cast<void*>(&enabled13) : enabled13.pNext;
+  if (enabled.graphicsPipelineLibrary) {
+    for (const char* name : {VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME}) {
+      if (std::ranges::none_of(extensions, [name](const char* ext) { return std::string_view(ext) == name; })) {
+        extensions.push_back(name);
+      }
+    }
+  }
+
   const VkDeviceCreateInfo createInfo{
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-      .pNext = nullptr,
+      .pNext = &enabled12,
       .flags = 0,
       .queueCreateInfoCount = static_cast<uint32_t>(queuesInfo.size()),
       .pQueueCreateInfos = queuesInfo.data(),
@@ -637,7 +728,46 @@ VulkanDevice::VulkanDevice(const WindowInfo& info, const VkSurfaceKHR& surface)
 {
   auto bestDevice = std::ranges::max(getDevicesData(surface) | std::views::filter(checkMinimalRequirements), compare);
 
-  _device.reset(createLogicalDevice(info, bestDevice));
+  _features = chooseFeatures(bestDevice);
+  _device.reset(createLogicalDevice(info, bestDevice, _features));
   _queue = std::make_unique<Queue>(_device.get(), bestDevice.queues);
+  _data = std::move(bestDevice);
+  _pipelineCache = std::make_unique<PipelineCache>(_device.get(), _data, info.pipelineCache);
+  _layoutCache = std::make_unique<LayoutCache>(_device.get());
+}
+
+VkDevice VulkanDevice::get() const
+{
+  return _device.get();
+}
+
+VkPhysicalDevice VulkanDevice::getPhysical() const
+{
+  return _data.device;
+}
+
+const DeviceData& VulkanDevice::getData() const
+{
+  return _data;
+}
+
+Queue& VulkanDevice::getQueue() const
+{
+  return *_queue;
+}
+
+const DeviceFeatures& VulkanDevice::getFeatures() const
+{
+  return _features;
+}
+
+PipelineCache& VulkanDevice::getPipelineCache() const
+{
+  return *_pipelineCache;
+}
+
+LayoutCache& VulkanDevice::getLayoutCache() const
+{
+  return *_layoutCache;
 }
 }  // namespace vulkan
\ No newline at end of file
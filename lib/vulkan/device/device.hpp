@@ -5,6 +5,9 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include "device_data.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_cache.hpp"
 #include "queue.hpp"
 #include "window/window_info.hpp"
 
@@ -19,9 +22,23 @@ public:
   explicit VulkanDevice(const WindowInfo& info, const VkSurfaceKHR& surface);
   ~VulkanDevice() = default;
 
+  [[nodiscard]] VkDevice get() const;
+  [[nodiscard]] VkPhysicalDevice getPhysical() const;
+  [[nodiscard]] const DeviceData& getData() const;
+  [[nodiscard]] Queue& getQueue() const;
+  [[nodiscard]] const DeviceFeatures& getFeatures() const;
+  [[nodiscard]] PipelineCache& getPipelineCache() const;
+  // Shared by every pipeline of the device, equal layouts are one object
+  [[nodiscard]] LayoutCache& getLayoutCache() const;
+
 private:
   std::unique_ptr<VkDevice_T, void (*)(VkDevice)> _device;
   std::unique_ptr<Queue> _queue = nullptr;
+  DeviceData _data{};
+  DeviceFeatures _features{};
+  // Declared last so they are saved and destroyed before the device goes away
+  std::unique_ptr<PipelineCache> _pipelineCache = nullptr;
+  std::unique_ptr<LayoutCache> _layoutCache = nullptr;
 };
 }  // namespace vulkan
 
@@ -19,6 +19,33 @@ struct DeviceData {
   VkPhysicalDeviceFeatures features;
   VkPhysicalDeviceMemoryProperties memory;
   std::vector<DeviceDataQueue> queues;
+  // Zeroed when the device does not report the matching API version, pNext is cleared after the query
+  VkPhysicalDeviceVulkan12Features features12;
+  VkPhysicalDeviceVulkan13Features features13;
+  // Zeroed when VK_EXT_graphics_pipeline_library is not available
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibrary;
+};
+
+// Optional features enabled on the logical device, code paths check these instead of the raw feature structs
+struct DeviceFeatures {
+  bool dynamicRendering = false;
+  bool imagelessFramebuffer = false;
+  bool synchronization2 = false;
+  // Core in 1.3, pipeline creations report cache hits and their duration
+  bool creationFeedback = false;
+  // VK_EXT_graphics_pipeline_library with VK_KHR_pipeline_library, enabled on top of the requested extensions
+  bool graphicsPipelineLibrary = false;
+  // Core 1.2 descriptor indexing subset the bindless table needs: runtime arrays, partially bound and update-after-bind
+  // sampled images and storage buffers, non uniform indexing
+  bool descriptorIndexing = false;
+  // Core 1.2, blocks declared with layout(scalar) and GpuStruct<BlockLayout::scalar>
+  bool scalarBlockLayout = false;
+  // More than one draw per vkCmdDraw*Indirect call
+  bool multiDrawIndirect = false;
+  // firstInstance of indirect commands may be other than 0
+  bool drawIndirectFirstInstance = false;
+  // Core 1.2, vkCmdDrawIndexedIndirectCount reads the draw count from a buffer
+  bool drawIndirectCount = false;
 };
 }  // namespace vulkan
 
@@ -3,26 +3,33 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 #include <vulkan/vulkan_core.h>
 
 #include "device_data.hpp"
+#include "format/string.hpp"
 
 namespace vulkan {
-static std::vector<std::vector<VkQueue>> createQueues(VkDevice device, const std::vector<DeviceDataQueue>& queues)
+static std::vector<std::vector<Queue::QueueEntry>> createQueues(VkDevice device, const std::vector<DeviceDataQueue>& queues)
 {
-  std::vector<std::vector<VkQueue>> result;
+  std::vector<std::vector<Queue::QueueEntry>> result;
   result.reserve(queues.size());
   for (const auto& queue : queues) {
-    result.emplace_back(queue.properties.queueCount);
-    auto& elements = result.back();
-    uint32_t seq = 0;
+    auto& elements = result.emplace_back();
+    elements.reserve(queue.properties.queueCount);
 
-    for (auto& ele : elements) {
-      vkGetDeviceQueue(device, queue.queueIndex, seq++, &ele);
+    for (uint32_t seq = 0; seq < queue.properties.queueCount; ++seq) {
+      VkQueue ele = nullptr;
+      vkGetDeviceQueue(device, queue.queueIndex, seq, &ele);
+      elements.emplace_back(ele, std::make_unique<std::mutex>());
     }
   }
   return result;
@@ -87,4 +94,59 @@ Queue::Queue(VkDevice device, const std::vector<DeviceDataQueue>& queues)  //
   _transfer = std::move(queueData.transfer);
   _sparse = std::move(queueData.sparse);
 }
+
+const std::vector<uint32_t>& Queue::getGraphics() const
+{
+  return _graphics;
+}
+
+const std::vector<uint32_t>& Queue::getCompute() const
+{
+  return _compute;
+}
+
+const std::vector<uint32_t>& Queue::getTransfer() const
+{
+  return _transfer;
+}
+
+const std::vector<uint32_t>& Queue::getSparse() const
+{
+  return _sparse;
+}
+
+uint32_t Queue::count(uint32_t family) const
+{
+  return static_cast<uint32_t>(_queues.at(family).size());
+}
+
+VkQueue Queue::get(uint32_t family, uint32_t index) const
+{
+  return _queues.at(family).at(index).queue;
+}
+
+void Queue::submit(uint32_t family, std::span<const VkSubmitInfo> submits, VkFence fence, uint32_t index)
+{
+  auto& entry = _queues.at(family).at(index);
+  const std::scoped_lock lock(*entry.lock);
+  if (const VkResult status = vkQueueSubmit(entry.queue, static_cast<uint32_t>(submits.size()), submits.data(), fence); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to submit to queue {}:{}! status: {}", family, index, utils::result(status)));
+  }
+}
+
+VkResult Queue::present(uint32_t family, const VkPresentInfoKHR& info, uint32_t index)
+{
+  auto& entry = _queues.at(family).at(index);
+  const std::scoped_lock lock(*entry.lock);
+  return vkQueuePresentKHR(entry.queue, &info);
+}
+
+void Queue::waitIdle(uint32_t family, uint32_t index)
+{
+  auto& entry = _queues.at(family).at(index);
+  const std::scoped_lock lock(*entry.lock);
+  if (const VkResult status = vkQueueWaitIdle(entry.queue); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to wait for queue {}:{}! status: {}", family, index, utils::result(status)));
+  }
+}
 }  // namespace vulkan
\ No newline at end of file
@@ -1,6 +1,10 @@
 #ifndef LIB_VULKAN_DEVICE_QUEUE
 #define LIB_VULKAN_DEVICE_QUEUE
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <vector>
 
 #include "device/device_data.hpp"
@@ -9,6 +13,11 @@
 namespace vulkan {
 class Queue {
 public:
+  struct QueueEntry {
+    VkQueue queue;
+    std::unique_ptr<std::mutex> lock;
+  };
+
   Queue(const Queue&) = delete;
   Queue(Queue&&) = default;
   Queue& operator=(const Queue&) = delete;
@@ -17,8 +26,21 @@ public:
   explicit Queue(VkDevice device, const std::vector<DeviceDataQueue>& queues);
   ~Queue() = default;
 
+  [[nodiscard]] const std::vector<uint32_t>& getGraphics() const;
+  [[nodiscard]] const std::vector<uint32_t>& getCompute() const;
+  [[nodiscard]] const std::vector<uint32_t>& getTransfer() const;
+  [[nodiscard]] const std::vector<uint32_t>& getSparse() const;
+
+  [[nodiscard]] uint32_t count(uint32_t family) const;
+  [[nodiscard]] VkQueue get(uint32_t family, uint32_t index = 0) const;
+
+  // VkQueue access must be externally synchronized, every submission goes through the queue lock
+  void submit(uint32_t family, std::span<const VkSubmitInfo> submits, VkFence fence, uint32_t index = 0);
+  [[nodiscard]] VkResult present(uint32_t family, const VkPresentInfoKHR& info, uint32_t index = 0);
+  void waitIdle(uint32_t family, uint32_t index = 0);
+
 private:
-  std::vector<std::vector<VkQueue>> _queues;
+  std::vector<std::vector<QueueEntry>> _queues;
 
   std::vector<uint32_t> _graphics;
   std::vector<uint32_t> _compute;
@@ -0,0 +1,177 @@
+#include "geometry_benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "geometry_buffer.hpp"
+
+namespace vulkan {
+static constexpr uint32_t uniqueMeshes = 64;
+static constexpr uint32_t loadsPerMesh = 4;
+static constexpr uint32_t itemCount = 10'000;
+static constexpr uint32_t replacements = 16;
+// Position and uv
+static constexpr uint32_t vertexFloats = 5;
+static constexpr uint32_t vertexStride = vertexFloats * sizeof(float);
+// Small pages so the sample scene spans a few of them
+static constexpr VkDeviceSize pageSize = 256ULL * 1024ULL;
+
+struct SourceMesh {
+  std::vector<std::byte> vertices;
+  std::vector<uint32_t> indices;
+};
+
+// A loaded model, loads of one source are what a loader without deduplication would keep apart
+struct Load {
+  uint32_t source;
+  MeshId mesh;
+  bool loaded;
+};
+
+// Grid of size x size quads, the height tells apart grids of one size
+static SourceMesh makeGrid(uint32_t size, float height)
+{
+  std::vector<float> vertices;
+  vertices.reserve(static_cast<size_t>(size + 1) * (size + 1) * vertexFloats);
+  const float step = 1.0F / static_cast<float>(size);
+  for (uint32_t row = 0; row <= size; ++row) {
+    for (uint32_t column = 0; column <= size; ++column) {
+      const float u = static_cast<float>(column) * step;
+      const float v = static_cast<float>(row) * step;
+      vertices.insert(vertices.end(), {u, height * std::sin(u * v * 6.0F), v, u, v});
+    }
+  }
+  SourceMesh mesh{.vertices = std::vector<std::byte>(vertices.size() * sizeof(float)), .indices = {}};
+  std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+  mesh.indices.reserve(static_cast<size_t>(size) * size * 6);
+  for (uint32_t row = 0; row < size; ++row) {
+    for (uint32_t column = 0; column < size; ++column) {
+      const uint32_t corner = (row * (size + 1)) + column;
+      mesh.indices.insert(mesh.indices.end(), {corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2});
+    }
+  }
+  return mesh;
+}
+
+static MeshId load(GeometryBuffer& geometry, const SourceMesh& source)
+{
+  return geometry.addMesh(source.vertices, source.indices);
+}
+
+// Random items over the loaded loads, instance is the position in the scene
+static std::vector<uint32_t> placeItems(std::span<const Load> loads, std::mt19937& random)
+{
+  std::vector<uint32_t> live;
+  for (uint32_t index = 0; index < loads.size(); ++index) {
+    if (loads[index].loaded) {
+      live.push_back(index);
+    }
+  }
+  std::vector<uint32_t> items(itemCount);
+  std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+  std::ranges::generate(items, [&] { return live[pick(random)]; });
+  return items;
+}
+
+// A mesh with other bytes than it was loaded with would not be found again and get added instead. Every check counts
+// as deduplicated, checks keeps them out of the later reports
+static bool check(GeometryBuffer& geometry, std::span<const SourceMesh> sources, std::span<const Load> loads, uint64_t& checks)
+{
+  bool correct = true;
+  for (const Load& entry : loads) {
+    if (!entry.loaded) {
+      continue;
+    }
+    const MeshId again = load(geometry, sources[entry.source]);
+    if (again == entry.mesh) {
+      ++checks;
+    }
+    correct = correct && again == entry.mesh;
+    geometry.removeMesh(again);
+  }
+  return correct;
+}
+
+static GeometryReport report(std::string stage,
+                             GeometryBuffer& geometry,
+                             std::span<const SourceMesh> sources,
+                             std::span<const Load> loads,
+                             std::span<const uint32_t> items,
+                             uint64_t& checks)
+{
+  std::vector<GeometryItem> drawn;
+  drawn.reserve(items.size());
+  uint32_t naiveBinds = 0;
+  for (uint32_t index = 0; index < items.size(); ++index) {
+    drawn.push_back({.mesh = loads[items[index]].mesh, .instance = index});
+    if (index == 0 || items[index] != items[index - 1]) {
+      naiveBinds += 2;
+    }
+  }
+  const GeometryBatches batches = geometry.batch(drawn);
+  const GeometryStats stats = geometry.getStats();
+  return {
+      .stage = std::move(stage),
+      .items = batches.items,
+      .meshes = stats.meshes,
+      .deduplicated = stats.deduplicated - checks,
+      .pages = stats.pages,
+      .used = stats.used,
+      .capacity = stats.capacity,
+      .freeRanges = stats.freeRanges,
+      .bytesMoved = stats.bytesMoved,
+      .naiveDrawCalls = static_cast<uint32_t>(items.size()),
+      .naiveBinds = naiveBinds,
+      .drawCalls = batches.drawCalls,
+      .binds = batches.binds,
+      .correct = check(geometry, sources, loads, checks),
+  };
+}
+
+std::vector<GeometryReport> benchmarkGeometry(const VulkanDevice& device)
+{
+  std::mt19937 random(45);
+  std::vector<SourceMesh> sources;
+  for (uint32_t mesh = 0; mesh < uniqueMeshes + replacements; ++mesh) {
+    sources.push_back(makeGrid(4 + (mesh % 32), 1.0F + static_cast<float>(mesh)));
+  }
+
+  GeometryBuffer geometry(device, vertexStride, pageSize);
+  std::vector<Load> loads;
+  for (uint32_t index = 0; index < uniqueMeshes * loadsPerMesh; ++index) {
+    const uint32_t source = index % uniqueMeshes;
+    loads.push_back({.source = source, .mesh = load(geometry, sources[source]), .loaded = true});
+  }
+  uint64_t checks = 0;
+  std::vector<GeometryReport> reports;
+  reports.push_back(report("loaded", geometry, sources, loads, placeItems(loads, random), checks));
+
+  // Unloading every third mesh leaves holes between the rest, the new meshes only partly fill them
+  for (Load& entry : loads) {
+    if (entry.source % 3 == 0) {
+      geometry.removeMesh(entry.mesh);
+      entry.loaded = false;
+    }
+  }
+  for (uint32_t source = uniqueMeshes; source < sources.size(); ++source) {
+    loads.push_back({.source = source, .mesh = load(geometry, sources[source]), .loaded = true});
+  }
+  const std::vector<uint32_t> items = placeItems(loads, random);
+  reports.push_back(report("streamed", geometry, sources, loads, items, checks));
+
+  static_cast<void>(geometry.defragment());
+  reports.push_back(report("defragmented", geometry, sources, loads, items, checks));
+  return reports;
+}
+}  // namespace vulkan
@@ -0,0 +1,38 @@
+#ifndef LIB_VULKAN_GEOMETRY_GEOMETRY_BENCHMARK
+#define LIB_VULKAN_GEOMETRY_GEOMETRY_BENCHMARK
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct GeometryReport {
+  std::string stage;
+  uint32_t items;
+  // Meshes stored in the mega-buffer, equal loads count once
+  uint32_t meshes;
+  uint64_t deduplicated;
+  uint32_t pages;
+  VkDeviceSize used;
+  VkDeviceSize capacity;
+  uint64_t freeRanges;
+  VkDeviceSize bytesMoved;
+  // One buffer pair per load, one draw per item, rebinding whenever the load changes between items
+  uint32_t naiveDrawCalls;
+  uint32_t naiveBinds;
+  uint32_t drawCalls;
+  uint32_t binds;
+  // Every stored mesh still holds the bytes it was loaded with
+  bool correct;
+};
+
+// Sample scene of 64 procedural grids loaded 4 times each and drawn 10k times, then a third of the meshes unloaded and
+// new ones loaded into the holes, then defragmented. One row per stage
+[[nodiscard]] std::vector<GeometryReport> benchmarkGeometry(const VulkanDevice& device);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_GEOMETRY_GEOMETRY_BENCHMARK */
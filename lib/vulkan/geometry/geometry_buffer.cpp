@@ -0,0 +1,301 @@
+#include "geometry_buffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "hash/hash.hpp"
+#include "memory/buffer.hpp"
+#include "memory/range_allocator.hpp"
+
+namespace vulkan {
+static constexpr VkDeviceSize indexSize = sizeof(uint32_t);
+
+static Buffer pageBuffer(const VulkanDevice& device, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+  return Buffer(device, BufferInfo{.size = size,
+                                   .usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                   .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                   .preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT});
+}
+
+GeometryBuffer::GeometryBuffer(const VulkanDevice& device, uint32_t vertexStride, VkDeviceSize pageSize)
+    : _device(device), _stride(vertexStride), _pageSize(pageSize)
+{
+  if (vertexStride == 0) {
+    throw std::runtime_error("Geometry buffer needs a vertex stride");
+  }
+}
+
+MeshId GeometryBuffer::addMesh(std::span<const std::byte> vertices, std::span<const uint32_t> indices)
+{
+  if (vertices.empty() || indices.empty() || vertices.size() % _stride != 0) {
+    throw std::runtime_error(std::format("Mesh of {} vertex bytes and {} indices does not fit stride {}", vertices.size(),
+                                         indices.size(), _stride));
+  }
+  const auto vertexCount = static_cast<uint32_t>(vertices.size() / _stride);
+  if (std::ranges::any_of(indices, [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+    throw std::runtime_error(std::format("Mesh indices go past its {} vertices", vertexCount));
+  }
+
+  const uint64_t vertexHash = utils::fnv1a(vertices);
+  const uint64_t indexHash = utils::fnv1a(std::as_bytes(indices));
+  const uint64_t hash = utils::hash(vertexHash, indexHash);
+  const auto [first, last] = _byHash.equal_range(hash);
+  for (auto it = first; it != last; ++it) {
+    Mesh& stored = _meshes[it->second];
+    if (stored.vertexHash == vertexHash && stored.indexHash == indexHash && equal(stored, vertices, indices)) {
+      ++stored.references;
+      ++_stats.deduplicated;
+      return it->second;
+    }
+  }
+
+  Mesh mesh{.hash = hash,
+            .vertexHash = vertexHash,
+            .indexHash = indexHash,
+            .vertexCount = vertexCount,
+            .indexCount = static_cast<uint32_t>(indices.size()),
+            .references = 1};
+  if (!place(mesh)) {
+    addPage(mesh.vertexCount, mesh.indexCount);
+    if (!place(mesh)) {
+      throw std::runtime_error("Mesh does not fit a fresh geometry page");
+    }
+  }
+  const Page& page = _pages[mesh.page];
+  const VkDeviceSize vertexOffset = VkDeviceSize{mesh.firstVertex} * _stride;
+  const VkDeviceSize indexOffset = VkDeviceSize{mesh.firstIndex} * indexSize;
+  std::memcpy(page.vertices.getMapped() + vertexOffset, vertices.data(), vertices.size_bytes());
+  std::memcpy(page.indices.getMapped() + indexOffset, indices.data(), indices.size_bytes());
+  page.vertices.flush(vertexOffset, vertices.size_bytes());
+  page.indices.flush(indexOffset, indices.size_bytes());
+
+  MeshId id = static_cast<MeshId>(_meshes.size());
+  if (_freeIds.empty()) {
+    _meshes.push_back(mesh);
+  }
+  else {
+    id = _freeIds.back();
+    _freeIds.pop_back();
+    _meshes[id] = mesh;
+  }
+  _byHash.emplace(hash, id);
+  return id;
+}
+
+void GeometryBuffer::removeMesh(MeshId mesh)
+{
+  static_cast<void>(find(mesh));
+  Mesh& stored = _meshes[mesh];
+  if (--stored.references != 0) {
+    return;
+  }
+
+  Page& page = _pages[stored.page];
+  page.vertexRanges.free(stored.firstVertex, stored.vertexCount);
+  page.indexRanges.free(stored.firstIndex, stored.indexCount);
+  const auto [first, last] = _byHash.equal_range(stored.hash);
+  _byHash.erase(std::find_if(first, last, [mesh](const auto& entry) { return entry.second == mesh; }));
+  _freeIds.push_back(mesh);
+}
+
+VkDeviceSize GeometryBuffer::defragment()
+{
+  VkDeviceSize moved = 0;
+  for (uint32_t index = 0; index < _pages.size(); ++index) {
+    Page& page = _pages[index];
+    if (page.vertexRanges.getFreeRanges() <= 1 && page.indexRanges.getFreeRanges() <= 1) {
+      continue;
+    }
+    std::vector<MeshId> live;
+    for (MeshId id = 0; id < _meshes.size(); ++id) {
+      if (_meshes[id].references != 0 && _meshes[id].page == index) {
+        live.push_back(id);
+      }
+    }
+
+    // Ranges only move towards the front, in offset order nothing is overwritten before it is moved
+    std::ranges::sort(live, {}, [this](MeshId id) { return _meshes[id].firstVertex; });
+    uint32_t vertexEnd = 0;
+    for (const MeshId id : live) {
+      Mesh& mesh = _meshes[id];
+      if (mesh.firstVertex != vertexEnd) {
+        std::memmove(page.vertices.getMapped() + (VkDeviceSize{vertexEnd} * _stride),
+                     page.vertices.getMapped() + (VkDeviceSize{mesh.firstVertex} * _stride), VkDeviceSize{mesh.vertexCount} * _stride);
+        moved += VkDeviceSize{mesh.vertexCount} * _stride;
+        mesh.firstVertex = vertexEnd;
+      }
+      vertexEnd += mesh.vertexCount;
+    }
+    std::ranges::sort(live, {}, [this](MeshId id) { return _meshes[id].firstIndex; });
+    uint32_t indexEnd = 0;
+    for (const MeshId id : live) {
+      Mesh& mesh = _meshes[id];
+      if (mesh.firstIndex != indexEnd) {
+        std::memmove(page.indices.getMapped() + (VkDeviceSize{indexEnd} * indexSize),
+                     page.indices.getMapped() + (VkDeviceSize{mesh.firstIndex} * indexSize), VkDeviceSize{mesh.indexCount} * indexSize);
+        moved += VkDeviceSize{mesh.indexCount} * indexSize;
+        mesh.firstIndex = indexEnd;
+      }
+      indexEnd += mesh.indexCount;
+    }
+
+    page.vertexRanges.reset(vertexEnd);
+    page.indexRanges.reset(indexEnd);
+    page.vertices.flush(0, page.vertices.getSize());
+    page.indices.flush(0, page.indices.getSize());
+  }
+  ++_stats.defragmentations;
+  _stats.bytesMoved += moved;
+  return moved;
+}
+
+GeometryBatches GeometryBuffer::batch(std::span<const GeometryItem> items) const
+{
+  std::vector<uint32_t> order(items.size());
+  std::iota(order.begin(), order.end(), 0U);
+  std::ranges::stable_sort(order, {}, [&](uint32_t item) {
+    const MeshId mesh = items[item].mesh;
+    return std::pair(find(mesh).page, mesh);
+  });
+
+  GeometryBatches result;
+  result.items = static_cast<uint32_t>(items.size());
+  result.instances.reserve(items.size());
+  MeshId previous = invalidMesh;
+  for (const uint32_t item : order) {
+    const MeshId id = items[item].mesh;
+    if (id == previous) {
+      ++result.batches.back().command.instanceCount;
+    }
+    else {
+      const Mesh& mesh = _meshes[id];
+      if (result.batches.empty() || result.batches.back().page != mesh.page) {
+        result.binds += 2;
+      }
+      result.batches.push_back({
+          .page = mesh.page,
+          .command = {.indexCount = mesh.indexCount,
+                      .instanceCount = 1,
+                      .firstIndex = mesh.firstIndex,
+                      .vertexOffset = static_cast<int32_t>(mesh.firstVertex),
+                      .firstInstance = static_cast<uint32_t>(result.instances.size())},
+      });
+      previous = id;
+    }
+    result.instances.push_back(items[item].instance);
+  }
+  result.drawCalls = static_cast<uint32_t>(result.batches.size());
+  return result;
+}
+
+void GeometryBuffer::record(VkCommandBuffer cmd, const GeometryBatches& batches) const
+{
+  std::optional<uint32_t> bound;
+  for (const GeometryBatch& batch : batches.batches) {
+    if (bound != batch.page) {
+      const VkBuffer vertices = getVertexBuffer(batch.page);
+      const VkDeviceSize offset = 0;
+      vkCmdBindVertexBuffers(cmd, 0, 1, &vertices, &offset);
+      vkCmdBindIndexBuffer(cmd, getIndexBuffer(batch.page), 0, VK_INDEX_TYPE_UINT32);
+      bound = batch.page;
+    }
+    const VkDrawIndexedIndirectCommand& command = batch.command;
+    vkCmdDrawIndexed(cmd, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+  }
+}
+
+VkBuffer GeometryBuffer::getVertexBuffer(uint32_t page) const
+{
+  return _pages.at(page).vertices.get();
+}
+
+VkBuffer GeometryBuffer::getIndexBuffer(uint32_t page) const
+{
+  return _pages.at(page).indices.get();
+}
+
+uint32_t GeometryBuffer::getVertexStride() const
+{
+  return _stride;
+}
+
+GeometryStats GeometryBuffer::getStats() const
+{
+  GeometryStats stats = _stats;
+  stats.meshes = static_cast<uint32_t>(_meshes.size() - _freeIds.size());
+  stats.pages = static_cast<uint32_t>(_pages.size());
+  for (const Page& page : _pages) {
+    const VkDeviceSize vertexCapacity = page.vertexRanges.getCapacity() * _stride;
+    const VkDeviceSize indexCapacity = page.indexRanges.getCapacity() * indexSize;
+    stats.capacity += vertexCapacity + indexCapacity;
+    stats.used += vertexCapacity - (page.vertexRanges.getFree() * _stride) + indexCapacity - (page.indexRanges.getFree() * indexSize);
+    stats.freeRanges += page.vertexRanges.getFreeRanges() + page.indexRanges.getFreeRanges();
+  }
+  return stats;
+}
+
+bool GeometryBuffer::equal(const Mesh& mesh, std::span<const std::byte> vertices, std::span<const uint32_t> indices) const
+{
+  if (mesh.vertexCount * VkDeviceSize{_stride} != vertices.size() || mesh.indexCount != indices.size()) {
+    return false;
+  }
+  const Page& page = _pages[mesh.page];
+  // Only the host writes pages, nothing to invalidate
+  return std::memcmp(page.vertices.getMapped() + (VkDeviceSize{mesh.firstVertex} * _stride), vertices.data(), vertices.size()) == 0 &&
+         std::memcmp(page.indices.getMapped() + (VkDeviceSize{mesh.firstIndex} * indexSize), indices.data(), indices.size_bytes()) == 0;
+}
+
+bool GeometryBuffer::place(Mesh& mesh)
+{
+  for (uint32_t index = 0; index < _pages.size(); ++index) {
+    Page& page = _pages[index];
+    const std::optional<uint64_t> vertex = page.vertexRanges.allocate(mesh.vertexCount);
+    if (!vertex) {
+      continue;
+    }
+    const std::optional<uint64_t> first = page.indexRanges.allocate(mesh.indexCount);
+    if (!first) {
+      page.vertexRanges.free(*vertex, mesh.vertexCount);
+      continue;
+    }
+    mesh.page = index;
+    mesh.firstVertex = static_cast<uint32_t>(*vertex);
+    mesh.firstIndex = static_cast<uint32_t>(*first);
+    return true;
+  }
+  return false;
+}
+
+void GeometryBuffer::addPage(uint32_t vertices, uint32_t indices)
+{
+  // vertexOffset of the draws is signed
+  const uint64_t vertexCapacity = std::min<uint64_t>(std::max<uint64_t>(_pageSize / _stride, vertices), INT32_MAX);
+  const uint64_t indexCapacity = std::max<uint64_t>(_pageSize / indexSize, indices);
+  _pages.push_back({
+      .vertices = pageBuffer(_device, vertexCapacity * _stride, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+      .indices = pageBuffer(_device, indexCapacity * indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+      .vertexRanges = RangeAllocator(vertexCapacity),
+      .indexRanges = RangeAllocator(indexCapacity),
+  });
+}
+
+const GeometryBuffer::Mesh& GeometryBuffer::find(MeshId mesh) const
+{
+  if (mesh >= _meshes.size() || _meshes[mesh].references == 0) {
+    throw std::runtime_error(std::format("Mesh {} is not in the geometry buffer", mesh));
+  }
+  return _meshes[mesh];
+}
+}  // namespace vulkan
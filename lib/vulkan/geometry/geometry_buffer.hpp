@@ -0,0 +1,131 @@
+#ifndef LIB_VULKAN_GEOMETRY_GEOMETRY_BUFFER
+#define LIB_VULKAN_GEOMETRY_GEOMETRY_BUFFER
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "memory/buffer.hpp"
+#include "memory/range_allocator.hpp"
+
+namespace vulkan {
+using MeshId = uint32_t;
+
+struct GeometryStats {
+  // Meshes with at least one reference
+  uint32_t meshes = 0;
+  // addMesh calls answered with a mesh already stored
+  uint64_t deduplicated = 0;
+  uint32_t pages = 0;
+  VkDeviceSize capacity = 0;
+  VkDeviceSize used = 0;
+  // Free ranges over all vertex and index ranges, 2 per page when nothing is fragmented
+  uint64_t freeRanges = 0;
+  uint64_t defragmentations = 0;
+  VkDeviceSize bytesMoved = 0;
+};
+
+// One draw of a mesh, instance is what the caller's shaders look up per instance
+struct GeometryItem {
+  MeshId mesh;
+  uint32_t instance;
+};
+
+// Draws of equal meshes merged into one instanced draw, firstInstance indexes GeometryBatches::instances
+struct GeometryBatch {
+  uint32_t page;
+  VkDrawIndexedIndirectCommand command;
+};
+
+struct GeometryBatches {
+  // Grouped by page, a page switch is the only vertex and index buffer bind
+  std::vector<GeometryBatch> batches;
+  // Instance of every item in draw order, shaders read instances[gl_InstanceIndex]
+  std::vector<uint32_t> instances;
+  uint32_t items = 0;
+  uint32_t drawCalls = 0;
+  uint32_t binds = 0;
+};
+
+// Static meshes packed into a few large vertex and index buffers (pages). Vertices of one stride, indices are uint32_t
+// relative to the mesh and placed with vertexOffset and firstIndex, so one bind serves every mesh of a page and
+// batches can go to vkCmdDrawIndexedIndirect as they are. Meshes with equal bytes are stored once and counted.
+// Pages are host visible, device local where the device has such memory. Adding, removing and defragmenting meshes
+// may only happen while no recorded draw is pending. Not thread safe
+class GeometryBuffer {
+public:
+  static constexpr VkDeviceSize defaultPageSize = 64ULL * 1024ULL * 1024ULL;  // 64MB
+  static constexpr MeshId invalidMesh = UINT32_MAX;
+
+  GeometryBuffer(const GeometryBuffer&) = delete;
+  GeometryBuffer(GeometryBuffer&&) = delete;
+  GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+  GeometryBuffer& operator=(GeometryBuffer&&) = delete;
+
+  // Page size is per vertex and per index buffer, larger meshes get a page of their own
+  explicit GeometryBuffer(const VulkanDevice& device, uint32_t vertexStride, VkDeviceSize pageSize = defaultPageSize);
+  ~GeometryBuffer() = default;
+
+  // Indices refer to the vertices given here. Adding a mesh equal to a stored one returns its id again
+  [[nodiscard]] MeshId addMesh(std::span<const std::byte> vertices, std::span<const uint32_t> indices);
+  // Drops one reference, the ranges are freed with the last one
+  void removeMesh(MeshId mesh);
+  // Moves the meshes of every page to its front, so the free space is one range again. Returns the bytes moved
+  VkDeviceSize defragment();
+
+  // Sorted by page and mesh, items of one mesh become one instanced draw
+  [[nodiscard]] GeometryBatches batch(std::span<const GeometryItem> items) const;
+  // Binds vertex binding 0 and the index buffer once per page, one vkCmdDrawIndexed per batch
+  void record(VkCommandBuffer cmd, const GeometryBatches& batches) const;
+
+  [[nodiscard]] VkBuffer getVertexBuffer(uint32_t page) const;
+  [[nodiscard]] VkBuffer getIndexBuffer(uint32_t page) const;
+  [[nodiscard]] uint32_t getVertexStride() const;
+  [[nodiscard]] GeometryStats getStats() const;
+
+private:
+  struct Mesh {
+    // Lookup key combined from the content hashes
+    uint64_t hash = 0;
+    // FNV-1a of the vertex and index bytes. Deduplication compares these first, pages may be write combined memory that
+    // is slow to read back and only get compared when both hashes match
+    uint64_t vertexHash = 0;
+    uint64_t indexHash = 0;
+    uint32_t page = 0;
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    // 0 for ids waiting to be reused
+    uint32_t references = 0;
+  };
+
+  struct Page {
+    Buffer vertices;
+    Buffer indices;
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+  };
+
+  const VulkanDevice& _device;
+  uint32_t _stride;
+  VkDeviceSize _pageSize;
+  std::vector<Page> _pages;
+  std::vector<Mesh> _meshes;
+  std::vector<MeshId> _freeIds;
+  std::unordered_multimap<uint64_t, MeshId> _byHash;
+  GeometryStats _stats;
+
+  [[nodiscard]] bool equal(const Mesh& mesh, std::span<const std::byte> vertices, std::span<const uint32_t> indices) const;
+  [[nodiscard]] bool place(Mesh& mesh);
+  void addPage(uint32_t vertices, uint32_t indices);
+  [[nodiscard]] const Mesh& find(MeshId mesh) const;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_GEOMETRY_GEOMETRY_BUFFER */
@@ -0,0 +1,92 @@
+#include "access.hpp"
+
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+static constexpr VkPipelineStageFlags2 shaderStages =
+    VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+static constexpr VkPipelineStageFlags2 depthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+static constexpr VkAccessFlags2 colorAccess = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+static constexpr VkAccessFlags2 depthAccess = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+AccessInfo accessInfo(Access access)
+{
+  static constexpr VkImageUsageFlags noImage = 0;
+  static constexpr VkBufferUsageFlags noBuffer = 0;
+
+  // clang-format off
+  switch (access) {
+  case Access::colorWrite:
+    return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, colorAccess, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, noBuffer, false, true};
+  case Access::colorReadWrite:
+    return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, colorAccess, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, noBuffer, true, true};
+  case Access::depthWrite:
+    return {depthStages, depthAccess, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, noBuffer, false, true};
+  case Access::depthReadWrite:
+    return {depthStages, depthAccess, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, noBuffer, true, true};
+  case Access::depthRead:
+    return {depthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, noBuffer, true, false};
+  case Access::sampled:
+    return {shaderStages, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, noBuffer, true, false};
+  case Access::storageRead:
+    return {shaderStages, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, false};
+  case Access::storageWrite:
+    return {shaderStages, VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false, true};
+  case Access::storageReadWrite:
+    return {shaderStages, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true, true};
+  case Access::uniform:
+    return {shaderStages, VK_ACCESS_2_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, noImage, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, true, false};
+  case Access::vertex:
+    return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, noImage, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, true, false};
+  case Access::index:
+    return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, noImage, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, true, false};
+  case Access::indirect:
+    return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, noImage, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false};
+  case Access::transferSrc:
+    return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true, false};
+  case Access::transferDst:
+    return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_BUFFER_USAGE_TRANSFER_DST_BIT, false, true};
+  }
+  // clang-format on
+  return {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, noImage, noBuffer, true, true};
+}
+
+std::string_view toString(Access access)
+{
+  switch (access) {
+  case Access::colorWrite:
+    return "color write";
+  case Access::colorReadWrite:
+    return "color read/write";
+  case Access::depthWrite:
+    return "depth write";
+  case Access::depthReadWrite:
+    return "depth read/write";
+  case Access::depthRead:
+    return "depth read";
+  case Access::sampled:
+    return "sampled";
+  case Access::storageRead:
+    return "storage read";
+  case Access::storageWrite:
+    return "storage write";
+  case Access::storageReadWrite:
+    return "storage read/write";
+  case Access::uniform:
+    return "uniform";
+  case Access::vertex:
+    return "vertex";
+  case Access::index:
+    return "index";
+  case Access::indirect:
+    return "indirect";
+  case Access::transferSrc:
+    return "transfer src";
+  case Access::transferDst:
+    return "transfer dst";
+  }
+  return "unknown";
+}
+}  // namespace vulkan
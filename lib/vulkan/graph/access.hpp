@@ -0,0 +1,44 @@
+#ifndef LIB_VULKAN_GRAPH_ACCESS
+#define LIB_VULKAN_GRAPH_ACCESS
+
+#include <cstdint>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+// How a pass uses a resource, *Write accesses discard the previous contents, *ReadWrite ones keep them
+enum class Access : uint8_t {
+  colorWrite,
+  colorReadWrite,
+  depthWrite,
+  depthReadWrite,
+  depthRead,
+  sampled,
+  storageRead,
+  storageWrite,
+  storageReadWrite,
+  uniform,
+  vertex,
+  index,
+  indirect,
+  transferSrc,
+  transferDst,
+};
+
+struct AccessInfo {
+  VkPipelineStageFlags2 stages;
+  // Only masks that also exist in VkAccessFlags, so barriers fall back to vkCmdPipelineBarrier unchanged
+  VkAccessFlags2 access;
+  VkImageLayout layout;
+  VkImageUsageFlags imageUsage;
+  VkBufferUsageFlags bufferUsage;
+  bool reads;
+  bool writes;
+};
+
+[[nodiscard]] AccessInfo accessInfo(Access access);
+[[nodiscard]] std::string_view toString(Access access);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_GRAPH_ACCESS */
@@ -0,0 +1,835 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "access.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "format/table.hpp"
+#include "hash/hash.hpp"
+#include "memory/memory_type.hpp"
+
+namespace vulkan {
+static constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool overlaps(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB)
+{
+  return firstA <= lastB && firstB <= lastA;
+}
+
+static VkImageSubresourceRange fullRange(VkImageAspectFlags aspect)
+{
+  return {.aspectMask = aspect, .baseMipLevel = 0, .levelCount = VK_REMAINING_MIP_LEVELS, .baseArrayLayer = 0, .layerCount = VK_REMAINING_ARRAY_LAYERS};
+}
+
+RenderGraph::RenderGraph(const VulkanDevice& device, uint32_t retireAfter)
+    : _device(device.get()), _owner(device), _synchronization2(device.getFeatures().synchronization2), _retireAfter(retireAfter)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+  for (auto& [topology, compiled] : _cache) {
+    destroy(*compiled);
+  }
+}
+
+void RenderGraph::reset()
+{
+  _resources.clear();
+  _passes.clear();
+  _outputs.clear();
+  _current = nullptr;
+}
+
+ResourceId RenderGraph::createImage(std::string name, const GraphImageInfo& info)
+{
+  return add({std::move(name), true, false, info, 0, {}, nullptr, nullptr, nullptr});
+}
+
+ResourceId RenderGraph::createBuffer(std::string name, VkDeviceSize size)
+{
+  return add({std::move(name), false, false, {}, size, {}, nullptr, nullptr, nullptr});
+}
+
+ResourceId RenderGraph::importImage(std::string name, VkImage image, VkImageView view, const GraphImageInfo& info, const GraphImport& state)
+{
+  return add({std::move(name), true, true, info, 0, state, image, view, nullptr});
+}
+
+ResourceId RenderGraph::importBuffer(std::string name, VkBuffer buffer, VkDeviceSize size, const GraphImport& state)
+{
+  return add({std::move(name), false, true, {}, size, state, nullptr, nullptr, buffer});
+}
+
+void RenderGraph::addPass(std::string name, std::vector<PassAccess> accesses, Execute execute)
+{
+  for (const auto& access : accesses) {
+    if (access.resource >= _resources.size()) {
+      throw std::runtime_error(std::format("Pass \"{}\" uses unknown resource {}", name, access.resource));
+    }
+  }
+  _passes.emplace_back(std::move(name), std::move(accesses), std::move(execute));
+}
+
+void RenderGraph::output(ResourceId resource)
+{
+  _outputs.push_back(resource);
+}
+
+bool RenderGraph::compile()
+{
+  ++_frame;
+  auto key = topology();
+  bool built = false;
+  if (auto found = _cache.find(key); found != _cache.end()) {
+    _current = found->second.get();
+  }
+  else {
+    auto compiled = build();
+    _current = compiled.get();
+    _cache.emplace(std::move(key), std::move(compiled));
+    built = true;
+  }
+  _current->lastUse = _frame;
+  retire();
+
+  const std::scoped_lock lock(_mutex);
+  const size_t hits = _stats.cacheHits + (built ? 0 : 1);
+  const size_t misses = _stats.cacheMisses + (built ? 1 : 0);
+  _stats = _current->stats;
+  _stats.cacheHits = hits;
+  _stats.cacheMisses = misses;
+  return built;
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd) const
+{
+  if (_current == nullptr) {
+    throw std::runtime_error("Render graph executed before compile");
+  }
+
+  for (const auto& step : _current->steps) {
+    emit(cmd, step.barriers);
+    for (uint32_t pass : step.passes) {
+      if (const auto& execute = _passes.at(pass).execute) {
+        execute(cmd, *this);
+      }
+    }
+  }
+  emit(cmd, _current->final);
+}
+
+void RenderGraph::show() const
+{
+  if (_current == nullptr) {
+    return;
+  }
+
+  struct Row {
+    std::string step;
+    std::string pass;
+    std::string accesses;
+    std::string barriers;
+  };
+  const auto barrierText = [this](const std::vector<Barrier>& barriers) {
+    std::string text;
+    for (const auto& barrier : barriers) {
+      text += std::format("{}{}", text.empty() ? "" : ", ", _resources.at(barrier.resource).name);
+      if (barrier.oldLayout != barrier.newLayout) {
+        text += std::format(" {} -> {}", utils::layout(barrier.oldLayout), utils::layout(barrier.newLayout));
+      }
+    }
+    return text;
+  };
+  const auto accessText = [this](uint32_t pass) {
+    std::string text;
+    for (const auto& access : _passes.at(pass).accesses) {
+      text += std::format("{}{}: {}", text.empty() ? "" : ", ", _resources.at(access.resource).name, toString(access.access));
+    }
+    return text;
+  };
+
+  std::vector<Row> rows;
+  for (size_t index = 0; index < _current->steps.size(); ++index) {
+    const auto& step = _current->steps.at(index);
+    for (size_t i = 0; i < step.passes.size(); ++i) {
+      const uint32_t pass = step.passes.at(i);
+      rows.emplace_back(std::to_string(index), _passes.at(pass).name, accessText(pass), i == 0 ? barrierText(step.barriers) : "");
+    }
+  }
+  if (!_current->final.empty()) {
+    rows.emplace_back("end", "", "", barrierText(_current->final));
+  }
+  for (uint32_t pass : _current->culled) {
+    rows.emplace_back("culled", _passes.at(pass).name, accessText(pass), "");
+  }
+  if (rows.empty()) {
+    return;
+  }
+
+  // clang-format off
+  utils::table<Row>("Render graph schedule", rows, std::vector<utils::TableColumn<Row>>{{
+    {.title = "Step", .toString = [](const Row& row) { return row.step; }},
+    {.title = "Pass", .align = utils::Align::left, .toString = [](const Row& row) { return row.pass; }},
+    {.title = "Accesses", .align = utils::Align::left, .toString = [](const Row& row) { return row.accesses; }},
+    {.title = "Barriers before", .align = utils::Align::left, .toString = [](const Row& row) { return row.barriers; }},
+  }});
+  // clang-format on
+
+  std::vector<ResourceId> transients;
+  for (ResourceId id = 0; id < _current->transients.size(); ++id) {
+    if (_current->transients.at(id).size != 0) {
+      transients.push_back(id);
+    }
+  }
+  if (transients.empty()) {
+    return;
+  }
+
+  // clang-format off
+  utils::table<ResourceId>("Render graph transients", transients, std::vector<utils::TableColumn<ResourceId>>{{
+    {.title = "Resource", .align = utils::Align::left, .toString = [this](ResourceId id) { return _resources.at(id).name; }},
+    {.title = "Memory", .toString = [this](ResourceId id) { return utils::number(_current->transients.at(id).memory); }},
+    {.title = "Offset", .toString = [this](ResourceId id) { return utils::number(_current->transients.at(id).offset); }},
+    {.title = "Size", .toString = [this](ResourceId id) { return utils::number(_current->transients.at(id).size); }},
+    {.title = "Steps", .toString = [this](ResourceId id) { return std::format("{}-{}", _current->transients.at(id).first, _current->transients.at(id).last); }},
+  }});
+  // clang-format on
+}
+
+VkImage RenderGraph::getImage(ResourceId resource) const
+{
+  const auto& data = _resources.at(resource);
+  return data.imported ? data.image : _current->transients.at(resource).image;
+}
+
+VkImageView RenderGraph::getView(ResourceId resource) const
+{
+  const auto& data = _resources.at(resource);
+  return data.imported ? data.view : _current->transients.at(resource).view;
+}
+
+VkBuffer RenderGraph::getBuffer(ResourceId resource) const
+{
+  const auto& data = _resources.at(resource);
+  return data.imported ? data.buffer : _current->transients.at(resource).buffer;
+}
+
+GraphStats RenderGraph::getStats() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _stats;
+}
+
+size_t RenderGraph::TopologyHash::operator()(const std::vector<uint64_t>& topology) const
+{
+  size_t seed = topology.size();
+  for (uint64_t value : topology) {
+    utils::hashCombine(seed, value);
+  }
+  return seed;
+}
+
+ResourceId RenderGraph::add(Resource resource)
+{
+  _resources.push_back(std::move(resource));
+  return static_cast<ResourceId>(_resources.size() - 1);
+}
+
+std::vector<uint64_t> RenderGraph::topology() const
+{
+  // Everything the compiled result depends on, handles and callbacks are resolved at execute time
+  std::vector<uint64_t> key;
+  key.push_back(_resources.size());
+  for (const auto& resource : _resources) {
+    key.insert(key.end(), {
+                              static_cast<uint64_t>(resource.isImage),
+                              static_cast<uint64_t>(resource.imported),
+                              static_cast<uint64_t>(resource.info.format),
+                              resource.info.extent.width,
+                              resource.info.extent.height,
+                              resource.info.aspect,
+                              resource.size,
+                              static_cast<uint64_t>(resource.state.initialLayout),
+                              resource.state.initialStage,
+                              resource.state.initialAccess,
+                              static_cast<uint64_t>(resource.state.finalLayout),
+                              resource.state.finalStage,
+                              resource.state.finalAccess,
+                          });
+  }
+  key.push_back(_passes.size());
+  for (const auto& pass : _passes) {
+    key.push_back(pass.accesses.size());
+    for (const auto& access : pass.accesses) {
+      key.push_back((static_cast<uint64_t>(access.resource) << 8U) | static_cast<uint64_t>(access.access));
+    }
+  }
+  key.push_back(_outputs.size());
+  key.insert(key.end(), _outputs.begin(), _outputs.end());
+  return key;
+}
+
+std::unique_ptr<RenderGraph::Compiled> RenderGraph::build() const
+{
+  auto compiled = std::make_unique<Compiled>();
+  schedule(*compiled);
+  try {
+    allocate(*compiled);
+  }
+  catch (...) {
+    destroy(*compiled);
+    throw;
+  }
+  placeBarriers(*compiled);
+  return compiled;
+}
+
+void RenderGraph::schedule(Compiled& compiled) const
+{
+  // Walk backwards from the outputs, a pass lives when it writes something a later pass or an output still needs
+  std::vector<bool> needed(_resources.size(), false);
+  for (ResourceId output : _outputs) {
+    needed.at(output) = true;
+  }
+  std::vector<bool> alive(_passes.size(), false);
+  for (size_t index = _passes.size(); index-- > 0;) {
+    const auto& accesses = _passes.at(index).accesses;
+    alive.at(index) = std::ranges::any_of(accesses, [&needed](const PassAccess& access) {
+      return accessInfo(access.access).writes && needed.at(access.resource);
+    });
+    if (!alive.at(index)) {
+      continue;
+    }
+    for (const auto& access : accesses) {
+      if (!accessInfo(access.access).reads) {
+        needed.at(access.resource) = false;
+      }
+    }
+    for (const auto& access : accesses) {
+      if (accessInfo(access.access).reads) {
+        needed.at(access.resource) = true;
+      }
+    }
+  }
+
+  // Each pass goes one step after the last pass it depends on, passes sharing a step need no barrier between them
+  struct LevelState {
+    int writer = -1;
+    int reader = -1;
+    VkImageLayout readLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  };
+  std::vector<LevelState> states(_resources.size());
+  std::vector<int> levels(_passes.size(), -1);
+  int maxLevel = -1;
+  for (size_t index = 0; index < _passes.size(); ++index) {
+    const auto& pass = _passes.at(index);
+    if (!alive.at(index)) {
+      compiled.culled.push_back(static_cast<uint32_t>(index));
+      continue;
+    }
+
+    int level = 0;
+    for (const auto& access : pass.accesses) {
+      const AccessInfo info = accessInfo(access.access);
+      const LevelState& state = states.at(access.resource);
+      const bool isImage = _resources.at(access.resource).isImage;
+      if (info.writes) {
+        level = std::max({level, state.writer + 1, state.reader + 1});
+      }
+      else {
+        level = std::max(level, state.writer + 1);
+        if (isImage && state.reader >= 0 && state.readLayout != info.layout) {
+          level = std::max(level, state.reader + 1);
+        }
+      }
+      for (const auto& other : pass.accesses) {
+        if (&other != &access && other.resource == access.resource && isImage && accessInfo(other.access).layout != info.layout) {
+          throw std::runtime_error(std::format("Pass \"{}\" uses \"{}\" in two layouts", pass.name, _resources.at(access.resource).name));
+        }
+      }
+    }
+
+    for (const auto& access : pass.accesses) {
+      const AccessInfo info = accessInfo(access.access);
+      LevelState& state = states.at(access.resource);
+      if (info.writes) {
+        state.writer = level;
+        state.reader = -1;
+      }
+      else {
+        state.reader = std::max(state.reader, level);
+        state.readLayout = info.layout;
+      }
+    }
+    levels.at(index) = level;
+    maxLevel = std::max(maxLevel, level);
+  }
+
+  compiled.steps.resize(static_cast<size_t>(maxLevel + 1));
+  for (size_t index = 0; index < _passes.size(); ++index) {
+    if (levels.at(index) >= 0) {
+      compiled.steps.at(static_cast<size_t>(levels.at(index))).passes.push_back(static_cast<uint32_t>(index));
+    }
+  }
+  compiled.stats.passes = _passes.size() - compiled.culled.size();
+  compiled.stats.culled = compiled.culled.size();
+}
+
+void RenderGraph::allocate(Compiled& compiled) const
+{
+  compiled.transients.resize(_resources.size());
+
+  // Lifetime in steps and the union of usages over every live access
+  std::vector<bool> used(_resources.size(), false);
+  std::vector<VkImageUsageFlags> imageUsage(_resources.size(), 0);
+  std::vector<VkBufferUsageFlags> bufferUsage(_resources.size(), 0);
+  for (uint32_t step = 0; step < compiled.steps.size(); ++step) {
+    for (uint32_t pass : compiled.steps.at(step).passes) {
+      for (const auto& access : _passes.at(pass).accesses) {
+        if (_resources.at(access.resource).imported) {
+          continue;
+        }
+        Transient& transient = compiled.transients.at(access.resource);
+        transient.first = used.at(access.resource) ? std::min(transient.first, step) : step;
+        transient.last = used.at(access.resource) ? std::max(transient.last, step) : step;
+        used.at(access.resource) = true;
+        const AccessInfo info = accessInfo(access.access);
+        imageUsage.at(access.resource) |= info.imageUsage;
+        bufferUsage.at(access.resource) |= info.bufferUsage;
+      }
+    }
+  }
+
+  const auto& data = _owner.getData();
+  const VkDeviceSize granularity = data.properties.limits.bufferImageGranularity;
+  // Resources are packed per memory type, each type becomes one allocation
+  std::map<uint32_t, std::vector<std::pair<ResourceId, VkMemoryRequirements>>> groups;
+  for (ResourceId id = 0; id < _resources.size(); ++id) {
+    if (!used.at(id)) {
+      continue;
+    }
+    const Resource& resource = _resources.at(id);
+    Transient& transient = compiled.transients.at(id);
+    VkMemoryRequirements requirements{};
+    if (resource.isImage) {
+      const VkImageCreateInfo createInfo{
+          .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .imageType = VK_IMAGE_TYPE_2D,
+          .format = resource.info.format,
+          .extent = {.width = resource.info.extent.width, .height = resource.info.extent.height, .depth = 1},
+          .mipLevels = 1,
+          .arrayLayers = 1,
+          .samples = VK_SAMPLE_COUNT_1_BIT,
+          .tiling = VK_IMAGE_TILING_OPTIMAL,
+          .usage = imageUsage.at(id),
+          .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+          .queueFamilyIndexCount = 0,
+          .pQueueFamilyIndices = nullptr,
+          .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      };
+      if (const VkResult status = vkCreateImage(_device, &createInfo, nullptr, &transient.image); status != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to create transient image \"{}\"! status: {}", resource.name, utils::result(status)));
+      }
+      vkGetImageMemoryRequirements(_device, transient.image, &requirements);
+    }
+    else {
+      const VkBufferCreateInfo createInfo{
+          .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .size = resource.size,
+          .usage = bufferUsage.at(id),
+          .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+          .queueFamilyIndexCount = 0,
+          .pQueueFamilyIndices = nullptr,
+      };
+      if (const VkResult status = vkCreateBuffer(_device, &createInfo, nullptr, &transient.buffer); status != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to create transient buffer \"{}\"! status: {}", resource.name, utils::result(status)));
+      }
+      vkGetBufferMemoryRequirements(_device, transient.buffer, &requirements);
+    }
+    // Granularity alignment keeps linear and optimal resources apart when they share a range over time
+    requirements.alignment = std::max(requirements.alignment, granularity);
+    transient.size = requirements.size;
+    compiled.stats.transientBytes += requirements.size;
+    groups[findMemoryType(data.memory, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)].emplace_back(id, requirements);
+  }
+
+  VkDeviceSize allocated = 0;
+  for (auto& [type, resources] : groups) {
+    // Largest first, each one takes the lowest offset free of every resource alive in an overlapping step range
+    std::ranges::sort(resources, [](const auto& lhs, const auto& rhs) { return lhs.second.size > rhs.second.size; });
+    std::vector<ResourceId> placed;
+    VkDeviceSize heapSize = 0;
+    for (const auto& [id, requirements] : resources) {
+      Transient& transient = compiled.transients.at(id);
+      std::vector<VkDeviceSize> candidates{0};
+      for (ResourceId other : placed) {
+        const Transient& next = compiled.transients.at(other);
+        if (overlaps(transient.first, transient.last, next.first, next.last)) {
+          candidates.push_back(alignUp(next.offset + next.size, requirements.alignment));
+        }
+      }
+      std::ranges::sort(candidates);
+      const auto fits = [&](VkDeviceSize offset) {
+        return std::ranges::none_of(placed, [&](ResourceId other) {
+          const Transient& next = compiled.transients.at(other);
+          return overlaps(transient.first, transient.last, next.first, next.last) && offset < next.offset + next.size &&
+                 next.offset < offset + requirements.size;
+        });
+      };
+      transient.offset = *std::ranges::find_if(candidates, fits);
+      transient.memory = static_cast<uint32_t>(compiled.memories.size());
+      heapSize = std::max(heapSize, transient.offset + requirements.size);
+      placed.push_back(id);
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .allocationSize = heapSize,
+        .memoryTypeIndex = type,
+    };
+    VkDeviceMemory memory = nullptr;
+    if (const VkResult status = vkAllocateMemory(_device, &allocateInfo, nullptr, &memory); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to allocate transient memory! status: {}", utils::result(status)));
+    }
+    compiled.memories.push_back(memory);
+    allocated += heapSize;
+
+    for (const auto& [id, requirements] : resources) {
+      Transient& transient = compiled.transients.at(id);
+      const VkResult status = transient.image != nullptr ? vkBindImageMemory(_device, transient.image, memory, transient.offset)
+                                                         : vkBindBufferMemory(_device, transient.buffer, memory, transient.offset);
+      if (status != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to bind transient memory! status: {}", utils::result(status)));
+      }
+      if (transient.image == nullptr) {
+        continue;
+      }
+
+      const Resource& resource = _resources.at(id);
+      const VkImageViewCreateInfo createInfo{
+          .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .image = transient.image,
+          .viewType = VK_IMAGE_VIEW_TYPE_2D,
+          .format = resource.info.format,
+          .components = {.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                         .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                         .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                         .a = VK_COMPONENT_SWIZZLE_IDENTITY},
+          .subresourceRange = fullRange(resource.info.aspect),
+      };
+      if (const VkResult viewStatus = vkCreateImageView(_device, &createInfo, nullptr, &transient.view); viewStatus != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to create transient image view! status: {}", utils::result(viewStatus)));
+      }
+    }
+  }
+  compiled.stats.aliasedBytes = compiled.stats.transientBytes - allocated;
+}
+
+void RenderGraph::placeBarriers(Compiled& compiled) const
+{
+  struct State {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+    VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+    // Stages the last write is already visible to
+    VkPipelineStageFlags2 synced = VK_PIPELINE_STAGE_2_NONE;
+    bool touched = false;
+  };
+  std::vector<State> states(_resources.size());
+  for (size_t id = 0; id < _resources.size(); ++id) {
+    const Resource& resource = _resources.at(id);
+    if (resource.imported) {
+      states.at(id) = {resource.state.initialLayout, resource.state.initialStage, resource.state.initialAccess, VK_PIPELINE_STAGE_2_NONE,
+                       VK_PIPELINE_STAGE_2_NONE, false};
+    }
+  }
+
+  // Earlier transients in the same memory range have to finish before an aliasing one starts
+  const auto aliasPredecessors = [&compiled](ResourceId id) {
+    std::vector<ResourceId> result;
+    const Transient& transient = compiled.transients.at(id);
+    for (ResourceId other = 0; other < compiled.transients.size(); ++other) {
+      const Transient& previous = compiled.transients.at(other);
+      if (other != id && previous.size != 0 && previous.memory == transient.memory && previous.last < transient.first &&
+          previous.offset < transient.offset + transient.size && transient.offset < previous.offset + previous.size) {
+        result.push_back(other);
+      }
+    }
+    return result;
+  };
+
+  for (auto& step : compiled.steps) {
+    for (uint32_t pass : step.passes) {
+      for (const auto& access : _passes.at(pass).accesses) {
+        const AccessInfo info = accessInfo(access.access);
+        const Resource& resource = _resources.at(access.resource);
+        const State& state = states.at(access.resource);
+        const VkImageLayout newLayout = resource.isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        const bool transition = resource.isImage && newLayout != state.layout;
+
+        Barrier barrier{access.resource, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, info.stages, info.access, newLayout, newLayout};
+        bool needed = transition;
+        if (transition) {
+          barrier.srcStage |= state.writeStages | state.readStages;
+          barrier.srcAccess |= state.writeAccess;
+          barrier.oldLayout = info.reads ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        if (info.reads && state.writeStages != VK_PIPELINE_STAGE_2_NONE && (info.stages & ~state.synced) != 0) {
+          needed = true;
+          barrier.srcStage |= state.writeStages;
+          barrier.srcAccess |= state.writeAccess;
+        }
+        if (info.writes && (state.writeStages | state.readStages) != VK_PIPELINE_STAGE_2_NONE) {
+          needed = true;
+          barrier.srcStage |= state.writeStages | state.readStages;
+          barrier.srcAccess |= state.writeAccess;
+        }
+        if (!resource.imported && !state.touched) {
+          for (ResourceId previous : aliasPredecessors(access.resource)) {
+            const State& last = states.at(previous);
+            barrier.srcStage |= last.writeStages | last.readStages;
+            barrier.srcAccess |= last.writeAccess;
+            needed = needed || (last.writeStages | last.readStages) != VK_PIPELINE_STAGE_2_NONE;
+          }
+        }
+        if (!needed) {
+          continue;
+        }
+
+        auto merged = std::ranges::find(step.barriers, access.resource, &Barrier::resource);
+        if (merged == step.barriers.end()) {
+          step.barriers.push_back(barrier);
+          continue;
+        }
+        merged->srcStage |= barrier.srcStage;
+        merged->srcAccess |= barrier.srcAccess;
+        merged->dstStage |= barrier.dstStage;
+        merged->dstAccess |= barrier.dstAccess;
+      }
+    }
+
+    // States change only after the whole step, passes of one step see the same state
+    for (const auto& barrier : step.barriers) {
+      State& state = states.at(barrier.resource);
+      if (barrier.oldLayout != barrier.newLayout || state.layout != barrier.newLayout) {
+        state.layout = barrier.newLayout;
+        state.writeStages = barrier.dstStage;
+        state.writeAccess = VK_ACCESS_2_NONE;
+        state.readStages = VK_PIPELINE_STAGE_2_NONE;
+        state.synced = barrier.dstStage;
+      }
+      else {
+        state.synced |= barrier.dstStage;
+      }
+    }
+    for (uint32_t pass : step.passes) {
+      for (const auto& access : _passes.at(pass).accesses) {
+        const AccessInfo info = accessInfo(access.access);
+        State& state = states.at(access.resource);
+        state.touched = true;
+        if (info.writes) {
+          state.writeStages = info.stages;
+          state.writeAccess = info.access;
+          state.readStages = VK_PIPELINE_STAGE_2_NONE;
+          state.synced = VK_PIPELINE_STAGE_2_NONE;
+        }
+        else {
+          state.readStages |= info.stages;
+        }
+      }
+    }
+  }
+
+  for (ResourceId id = 0; id < _resources.size(); ++id) {
+    const Resource& resource = _resources.at(id);
+    const State& state = states.at(id);
+    if (!resource.imported) {
+      continue;
+    }
+    const VkImageLayout finalLayout = resource.state.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ? state.layout : resource.state.finalLayout;
+    const VkPipelineStageFlags2 pending = state.writeStages | state.readStages;
+    const bool transition = resource.isImage && finalLayout != state.layout;
+    if (!transition && (resource.state.finalStage == VK_PIPELINE_STAGE_2_NONE || pending == VK_PIPELINE_STAGE_2_NONE)) {
+      continue;
+    }
+    compiled.final.push_back(
+        {id, pending, state.writeAccess, resource.state.finalStage, resource.state.finalAccess, state.layout, finalLayout});
+  }
+
+  const auto count = [this, &compiled](const std::vector<Barrier>& barriers) {
+    if (!barriers.empty()) {
+      ++compiled.stats.barrierBatches;
+    }
+    for (const auto& barrier : barriers) {
+      ++(_resources.at(barrier.resource).isImage ? compiled.stats.imageBarriers : compiled.stats.bufferBarriers);
+    }
+  };
+  for (const auto& step : compiled.steps) {
+    count(step.barriers);
+  }
+  count(compiled.final);
+}
+
+void RenderGraph::emit(VkCommandBuffer cmd, const std::vector<Barrier>& barriers) const
+{
+  if (barriers.empty()) {
+    return;
+  }
+
+  if (_synchronization2) {
+    std::vector<VkImageMemoryBarrier2> images;
+    std::vector<VkBufferMemoryBarrier2> buffers;
+    for (const auto& barrier : barriers) {
+      const Resource& resource = _resources.at(barrier.resource);
+      if (resource.isImage) {
+        images.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = barrier.srcStage,
+            .srcAccessMask = barrier.srcAccess,
+            .dstStageMask = barrier.dstStage,
+            .dstAccessMask = barrier.dstAccess,
+            .oldLayout = barrier.oldLayout,
+            .newLayout = barrier.newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = getImage(barrier.resource),
+            .subresourceRange = fullRange(resource.info.aspect),
+        });
+      }
+      else {
+        buffers.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask = barrier.srcStage,
+            .srcAccessMask = barrier.srcAccess,
+            .dstStageMask = barrier.dstStage,
+            .dstAccessMask = barrier.dstAccess,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = getBuffer(barrier.resource),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        });
+      }
+    }
+    const VkDependencyInfo dependency{
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = nullptr,
+        .dependencyFlags = 0,
+        .memoryBarrierCount = 0,
+        .pMemoryBarriers = nullptr,
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(buffers.size()),
+        .pBufferMemoryBarriers = buffers.data(),
+        .imageMemoryBarrierCount = static_cast<uint32_t>(images.size()),
+        .pImageMemoryBarriers = images.data(),
+    };
+    vkCmdPipelineBarrier2(cmd, &dependency);
+    return;
+  }
+
+  // Without synchronization2 stages are merged into one call, the masks used by the graph all fit the 32 bit flags
+  VkPipelineStageFlags srcStages = 0;
+  VkPipelineStageFlags dstStages = 0;
+  std::vector<VkImageMemoryBarrier> images;
+  std::vector<VkBufferMemoryBarrier> buffers;
+  for (const auto& barrier : barriers) {
+    const Resource& resource = _resources.at(barrier.resource);
+    srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStage);
+    dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStage);
+    const auto srcAccess = static_cast<VkAccessFlags>(barrier.srcAccess);
+    const auto dstAccess = static_cast<VkAccessFlags>(barrier.dstAccess);
+    if (resource.isImage) {
+      images.push_back({
+          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .pNext = nullptr,
+          .srcAccessMask = srcAccess,
+          .dstAccessMask = dstAccess,
+          .oldLayout = barrier.oldLayout,
+          .newLayout = barrier.newLayout,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image = getImage(barrier.resource),
+          .subresourceRange = fullRange(resource.info.aspect),
+      });
+    }
+    else {
+      buffers.push_back({
+          .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          .pNext = nullptr,
+          .srcAccessMask = srcAccess,
+          .dstAccessMask = dstAccess,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .buffer = getBuffer(barrier.resource),
+          .offset = 0,
+          .size = VK_WHOLE_SIZE,
+      });
+    }
+  }
+  if (srcStages == 0) {
+    srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  }
+  if (dstStages == 0) {
+    dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  }
+  vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, nullptr,
+                       static_cast<uint32_t>(buffers.size()), buffers.data(), static_cast<uint32_t>(images.size()), images.data());
+}
+
+void RenderGraph::destroy(Compiled& compiled) const
+{
+  for (auto& transient : compiled.transients) {
+    if (transient.view != nullptr) {
+      vkDestroyImageView(_device, transient.view, nullptr);
+    }
+    if (transient.image != nullptr) {
+      vkDestroyImage(_device, transient.image, nullptr);
+    }
+    if (transient.buffer != nullptr) {
+      vkDestroyBuffer(_device, transient.buffer, nullptr);
+    }
+    transient = {};
+  }
+  for (VkDeviceMemory memory : compiled.memories) {
+    vkFreeMemory(_device, memory, nullptr);
+  }
+  compiled.memories.clear();
+}
+
+void RenderGraph::retire()
+{
+  std::erase_if(_cache, [this](auto& entry) {
+    if (entry.second.get() == _current || entry.second->lastUse + _retireAfter >= _frame) {
+      return false;
+    }
+    destroy(*entry.second);
+    return true;
+  });
+}
+}  // namespace vulkan
@@ -0,0 +1,179 @@
+#ifndef LIB_VULKAN_GRAPH_RENDER_GRAPH
+#define LIB_VULKAN_GRAPH_RENDER_GRAPH
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "access.hpp"
+#include "device/device.hpp"
+
+namespace vulkan {
+using ResourceId = uint32_t;
+
+struct GraphImageInfo {
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  VkExtent2D extent = {.width = 0, .height = 0};
+  VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+// State of an imported resource when the graph starts and the state it has to be left in, UNDEFINED final layout keeps the last one
+struct GraphImport {
+  VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkPipelineStageFlags2 initialStage = VK_PIPELINE_STAGE_2_NONE;
+  VkAccessFlags2 initialAccess = VK_ACCESS_2_NONE;
+  VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkPipelineStageFlags2 finalStage = VK_PIPELINE_STAGE_2_NONE;
+  VkAccessFlags2 finalAccess = VK_ACCESS_2_NONE;
+};
+
+struct PassAccess {
+  ResourceId resource;
+  Access access;
+};
+
+struct GraphStats {
+  size_t passes = 0;
+  size_t culled = 0;
+  size_t barrierBatches = 0;
+  size_t imageBarriers = 0;
+  size_t bufferBarriers = 0;
+  size_t transientBytes = 0;
+  // Bytes saved by transient resources sharing memory
+  size_t aliasedBytes = 0;
+  size_t cacheHits = 0;
+  size_t cacheMisses = 0;
+};
+
+// Frame graph: passes declare their accesses each frame, compile culls, orders, places barriers and aliases transients.
+// Compiled results are cached by topology, handles of imported resources and pass callbacks may change every frame.
+class RenderGraph {
+public:
+  using Execute = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+
+  RenderGraph(const RenderGraph&) = delete;
+  RenderGraph(RenderGraph&&) = delete;
+  RenderGraph& operator=(const RenderGraph&) = delete;
+  RenderGraph& operator=(RenderGraph&&) = delete;
+
+  // Compiled graphs unused for retireAfter compiles are destroyed, it has to exceed the frames in flight
+  explicit RenderGraph(const VulkanDevice& device, uint32_t retireAfter = 4);
+  ~RenderGraph();
+
+  // Drops the previous frame description, compiled graphs stay cached
+  void reset();
+  [[nodiscard]] ResourceId createImage(std::string name, const GraphImageInfo& info);
+  [[nodiscard]] ResourceId createBuffer(std::string name, VkDeviceSize size);
+  [[nodiscard]] ResourceId importImage(std::string name, VkImage image, VkImageView view, const GraphImageInfo& info, const GraphImport& state);
+  [[nodiscard]] ResourceId importBuffer(std::string name, VkBuffer buffer, VkDeviceSize size, const GraphImport& state);
+  void addPass(std::string name, std::vector<PassAccess> accesses, Execute execute);
+  // Passes that do not contribute to any output are culled
+  void output(ResourceId resource);
+
+  // Returns true when the topology was not cached and got compiled now
+  bool compile();
+  void execute(VkCommandBuffer cmd) const;
+  // Prints the compiled schedule with its barriers and the transient memory layout
+  void show() const;
+
+  [[nodiscard]] VkImage getImage(ResourceId resource) const;
+  [[nodiscard]] VkImageView getView(ResourceId resource) const;
+  [[nodiscard]] VkBuffer getBuffer(ResourceId resource) const;
+  [[nodiscard]] GraphStats getStats() const;
+
+private:
+  struct Resource {
+    std::string name;
+    bool isImage;
+    bool imported;
+    GraphImageInfo info;
+    VkDeviceSize size;
+    GraphImport state;
+    VkImage image;
+    VkImageView view;
+    VkBuffer buffer;
+  };
+
+  struct Pass {
+    std::string name;
+    std::vector<PassAccess> accesses;
+    Execute execute;
+  };
+
+  struct Barrier {
+    ResourceId resource;
+    VkPipelineStageFlags2 srcStage;
+    VkAccessFlags2 srcAccess;
+    VkPipelineStageFlags2 dstStage;
+    VkAccessFlags2 dstAccess;
+    VkImageLayout oldLayout;
+    VkImageLayout newLayout;
+  };
+
+  // Passes of one step do not depend on each other, so all their barriers go out as one batch
+  struct Step {
+    std::vector<Barrier> barriers;
+    std::vector<uint32_t> passes;
+  };
+
+  struct Transient {
+    VkImage image = nullptr;
+    VkImageView view = nullptr;
+    VkBuffer buffer = nullptr;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t memory = 0;
+    uint32_t first = 0;
+    uint32_t last = 0;
+  };
+
+  struct Compiled {
+    std::vector<Step> steps;
+    std::vector<Barrier> final;
+    std::vector<uint32_t> culled;
+    std::vector<Transient> transients;
+    std::vector<VkDeviceMemory> memories;
+    GraphStats stats;
+    uint64_t lastUse = 0;
+  };
+
+  struct TopologyHash {
+    size_t operator()(const std::vector<uint64_t>& topology) const;
+  };
+
+  VkDevice _device;
+  const VulkanDevice& _owner;
+  bool _synchronization2;
+  uint32_t _retireAfter;
+
+  std::vector<Resource> _resources;
+  std::vector<Pass> _passes;
+  std::vector<ResourceId> _outputs;
+
+  std::unordered_map<std::vector<uint64_t>, std::unique_ptr<Compiled>, TopologyHash> _cache;
+  Compiled* _current = nullptr;
+  uint64_t _frame = 0;
+
+  mutable std::mutex _mutex;
+  GraphStats _stats;
+
+  [[nodiscard]] ResourceId add(Resource resource);
+  [[nodiscard]] std::vector<uint64_t> topology() const;
+  [[nodiscard]] std::unique_ptr<Compiled> build() const;
+  void schedule(Compiled& compiled) const;
+  void allocate(Compiled& compiled) const;
+  void placeBarriers(Compiled& compiled) const;
+  void emit(VkCommandBuffer cmd, const std::vector<Barrier>& barriers) const;
+  void destroy(Compiled& compiled) const;
+  void retire();
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_GRAPH_RENDER_GRAPH */
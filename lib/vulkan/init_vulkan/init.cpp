@@ -139,7 +139,7 @@ static VkInstance createInstance(const VulkanInfo& def)
       .applicationVersion = def.appVersion,
       .pEngineName = def.engineName.data(),
       .engineVersion = def.engineVersion,
-      .apiVersion = VK_API_VERSION_1_0,
+      .apiVersion = def.apiVersion,
   };
 
   const VkInstanceCreateInfo instanceInfo{
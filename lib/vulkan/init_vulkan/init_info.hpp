@@ -13,6 +13,8 @@ struct VulkanInfo {
 
   uint32_t appVersion = VK_MAKE_VERSION(1, 0, 1);
   uint32_t engineVersion = VK_MAKE_VERSION(1, 0, 0);
+  // Highest version the application uses, devices are still filtered by their own version
+  uint32_t apiVersion = VK_API_VERSION_1_3;
 
   std::vector<std::string> layers = {
 #ifdef DEBUG
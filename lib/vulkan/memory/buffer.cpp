@@ -0,0 +1,195 @@
+#include "buffer.hpp"
+
+#include <cstddef>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory_type.hpp"
+
+namespace vulkan {
+struct AlignedRange {
+  VkDeviceSize offset;
+  VkDeviceSize size;
+};
+
+// Non coherent ranges have to be aligned to nonCoherentAtomSize, the mapping always starts at 0. VK_WHOLE_SIZE and
+// anything past the end are clamped to the buffer first, rounding them up would wrap around
+static constexpr AlignedRange alignRange(VkDeviceSize offset, VkDeviceSize size, VkDeviceSize bufferSize, VkDeviceSize atomSize)
+{
+  const VkDeviceSize clamped = size == VK_WHOLE_SIZE || size > bufferSize - offset ? bufferSize - offset : size;
+  const VkDeviceSize begin = offset - (offset % atomSize);
+  const VkDeviceSize end = ((offset + clamped + atomSize - 1) / atomSize) * atomSize;
+  return {.offset = begin, .size = end >= bufferSize ? VK_WHOLE_SIZE : end - begin};
+}
+
+static constexpr bool sameRange(AlignedRange range, VkDeviceSize offset, VkDeviceSize size)
+{
+  return range.offset == offset && range.size == size;
+}
+
+static_assert(sameRange(alignRange(0, VK_WHOLE_SIZE, 1000, 64), 0, VK_WHOLE_SIZE));
+static_assert(sameRange(alignRange(100, VK_WHOLE_SIZE, 1000, 64), 64, VK_WHOLE_SIZE));
+static_assert(sameRange(alignRange(100, 10, 1000, 64), 64, 64));
+static_assert(sameRange(alignRange(60, 10, 1000, 64), 0, 128));
+static_assert(sameRange(alignRange(0, 1000, 1000, 64), 0, VK_WHOLE_SIZE));
+static_assert(sameRange(alignRange(900, 500, 1000, 64), 896, VK_WHOLE_SIZE));
+static_assert(sameRange(alignRange(8, 4, 16, 1), 8, 4));
+
+Buffer::Buffer(const VulkanDevice& device, const BufferInfo& info)
+    : _device(device.get()), _size(info.size), _atomSize(device.getData().properties.limits.nonCoherentAtomSize)
+{
+  const VkBufferCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .size = info.size,
+      .usage = info.usage,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+  };
+  if (const VkResult status = vkCreateBuffer(_device, &createInfo, nullptr, &_buffer); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create buffer! status: {}", utils::result(status)));
+  }
+
+  try {
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(_device, _buffer, &requirements);
+
+    const auto& memory = device.getData().memory;
+    const uint32_t type = findMemoryType(memory, requirements.memoryTypeBits, info.required, info.preferred);
+    _flags = memory.memoryTypes[type].propertyFlags;  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+
+    const VkMemoryAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = type,
+    };
+    if (const VkResult status = vkAllocateMemory(_device, &allocateInfo, nullptr, &_memory); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to allocate buffer memory! status: {}", utils::result(status)));
+    }
+    if (const VkResult status = vkBindBufferMemory(_device, _buffer, _memory, 0); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to bind buffer memory! status: {}", utils::result(status)));
+    }
+
+    if ((_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+      void* mapped = nullptr;
+      if (const VkResult status = vkMapMemory(_device, _memory, 0, VK_WHOLE_SIZE, 0, &mapped); status != VK_SUCCESS) {
+        throw std::runtime_error(std::format("Failed to map buffer memory! status: {}", utils::result(status)));
+      }
+      _mapped = static_cast<std::byte*>(mapped);
+    }
+  }
+  catch (...) {
+    destroy();
+    throw;
+  }
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : _device(std::exchange(other._device, nullptr)),
+      _buffer(std::exchange(other._buffer, nullptr)),
+      _memory(std::exchange(other._memory, nullptr)),
+      _size(std::exchange(other._size, 0)),
+      _atomSize(other._atomSize),
+      _flags(std::exchange(other._flags, 0)),
+      _mapped(std::exchange(other._mapped, nullptr))
+{
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept
+{
+  if (this != &other) {
+    destroy();
+    _device = std::exchange(other._device, nullptr);
+    _buffer = std::exchange(other._buffer, nullptr);
+    _memory = std::exchange(other._memory, nullptr);
+    _size = std::exchange(other._size, 0);
+    _atomSize = other._atomSize;
+    _flags = std::exchange(other._flags, 0);
+    _mapped = std::exchange(other._mapped, nullptr);
+  }
+  return *this;
+}
+
+Buffer::~Buffer()
+{
+  destroy();
+}
+
+void Buffer::flush(VkDeviceSize offset, VkDeviceSize size) const
+{
+  if ((_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) {
+    return;
+  }
+  const VkMappedMemoryRange memoryRange = range(offset, size);
+  if (const VkResult status = vkFlushMappedMemoryRanges(_device, 1, &memoryRange); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to flush buffer memory! status: {}", utils::result(status)));
+  }
+}
+
+void Buffer::invalidate(VkDeviceSize offset, VkDeviceSize size) const
+{
+  if ((_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0) {
+    return;
+  }
+  const VkMappedMemoryRange memoryRange = range(offset, size);
+  if (const VkResult status = vkInvalidateMappedMemoryRanges(_device, 1, &memoryRange); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to invalidate buffer memory! status: {}", utils::result(status)));
+  }
+}
+
+VkBuffer Buffer::get() const
+{
+  return _buffer;
+}
+
+VkDeviceSize Buffer::getSize() const
+{
+  return _size;
+}
+
+VkMemoryPropertyFlags Buffer::getFlags() const
+{
+  return _flags;
+}
+
+std::byte* Buffer::getMapped() const
+{
+  return _mapped;
+}
+
+VkMappedMemoryRange Buffer::range(VkDeviceSize offset, VkDeviceSize size) const
+{
+  if (offset > _size) {
+    throw std::runtime_error(std::format("Mapped range at {} of a {} byte buffer", offset, _size));
+  }
+  const AlignedRange aligned = alignRange(offset, size, _size, _atomSize);
+  return {
+      .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+      .pNext = nullptr,
+      .memory = _memory,
+      .offset = aligned.offset,
+      .size = aligned.size,
+  };
+}
+
+void Buffer::destroy()
+{
+  if (_memory != nullptr) {
+    vkFreeMemory(_device, _memory, nullptr);  // Implicitly unmaps
+    _memory = nullptr;
+    _mapped = nullptr;
+  }
+  if (_buffer != nullptr) {
+    vkDestroyBuffer(_device, _buffer, nullptr);
+    _buffer = nullptr;
+  }
+}
+}  // namespace vulkan
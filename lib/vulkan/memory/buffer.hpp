@@ -0,0 +1,52 @@
+#ifndef LIB_VULKAN_MEMORY_BUFFER
+#define LIB_VULKAN_MEMORY_BUFFER
+
+#include <cstddef>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct BufferInfo {
+  VkDeviceSize size = 0;
+  VkBufferUsageFlags usage = 0;
+  VkMemoryPropertyFlags required = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  VkMemoryPropertyFlags preferred = 0;
+};
+
+// Buffer with its own dedicated allocation, host visible memory stays mapped for the whole lifetime
+class Buffer {
+public:
+  Buffer(const Buffer&) = delete;
+  Buffer(Buffer&& other) noexcept;
+  Buffer& operator=(const Buffer&) = delete;
+  Buffer& operator=(Buffer&& other) noexcept;
+
+  explicit Buffer(const VulkanDevice& device, const BufferInfo& info);
+  ~Buffer();
+
+  // Make host writes visible to the device / device writes visible to the host, no-op on coherent memory
+  void flush(VkDeviceSize offset, VkDeviceSize size) const;
+  void invalidate(VkDeviceSize offset, VkDeviceSize size) const;
+
+  [[nodiscard]] VkBuffer get() const;
+  [[nodiscard]] VkDeviceSize getSize() const;
+  [[nodiscard]] VkMemoryPropertyFlags getFlags() const;
+  [[nodiscard]] std::byte* getMapped() const;
+
+private:
+  VkDevice _device = nullptr;
+  VkBuffer _buffer = nullptr;
+  VkDeviceMemory _memory = nullptr;
+  VkDeviceSize _size = 0;
+  VkDeviceSize _atomSize = 1;
+  VkMemoryPropertyFlags _flags = 0;
+  std::byte* _mapped = nullptr;
+
+  [[nodiscard]] VkMappedMemoryRange range(VkDeviceSize offset, VkDeviceSize size) const;
+  void destroy();
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_MEMORY_BUFFER */
@@ -0,0 +1,370 @@
+#ifndef LIB_VULKAN_MEMORY_GPU_STRUCT
+#define LIB_VULKAN_MEMORY_GPU_STRUCT
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace vulkan {
+// Block layouts of GLSL: std140 for uniform blocks, std430 for storage blocks and push constants, scalar with
+// DeviceFeatures::scalarBlockLayout
+enum class BlockLayout : std::uint8_t {
+  std140,
+  std430,
+  scalar,
+};
+
+// Host values of GLSL vectors and column major matrices, tightly packed. GpuStruct moves them to the block layout
+template <typename T, size_t N>
+struct Vector {
+  std::array<T, N> data;
+};
+
+template <typename T, size_t Columns, size_t Rows>
+struct Matrix {
+  std::array<Vector<T, Rows>, Columns> columns;
+};
+
+using Vec2 = Vector<float, 2>;
+using Vec3 = Vector<float, 3>;
+using Vec4 = Vector<float, 4>;
+using IVec2 = Vector<int32_t, 2>;
+using IVec3 = Vector<int32_t, 3>;
+using IVec4 = Vector<int32_t, 4>;
+using UVec2 = Vector<uint32_t, 2>;
+using UVec3 = Vector<uint32_t, 3>;
+using UVec4 = Vector<uint32_t, 4>;
+using Mat3 = Matrix<float, 3, 3>;
+using Mat4 = Matrix<float, 4, 4>;
+
+template <size_t N>
+struct FieldName {
+  std::array<char, N - 1> chars{};
+
+  // Implicit, so names are written as plain literals: block.set<"time">(value)
+  consteval FieldName(const char (&text)[N])  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions,*-avoid-c-arrays)
+  {
+    std::copy_n(text, N - 1, chars.begin());
+  }
+
+  [[nodiscard]] constexpr std::string_view view() const { return {chars.data(), chars.size()}; }
+};
+
+template <FieldName Name, typename T>
+struct Field {
+  using Type = T;
+  static constexpr std::string_view name = Name.view();
+};
+
+template <BlockLayout L, typename... Fields>
+class GpuStruct;
+
+struct TypeLayout {
+  size_t alignment;
+  size_t size;
+  // Bytes carrying data, the rest of size is padding
+  size_t payload;
+};
+
+namespace layout {
+template <typename T>
+inline constexpr bool isScalar = std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int32_t> ||
+                                 std::is_same_v<T, uint32_t> || std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>;
+
+template <typename T>
+struct VectorTraits : std::false_type {};
+template <typename T, size_t N>
+struct VectorTraits<Vector<T, N>> : std::true_type {
+  using Component = T;
+  static constexpr size_t count = N;
+};
+
+template <typename T>
+struct MatrixTraits : std::false_type {};
+template <typename T, size_t Columns, size_t Rows>
+struct MatrixTraits<Matrix<T, Columns, Rows>> : std::true_type {
+  using Column = Vector<T, Rows>;
+  static constexpr size_t columns = Columns;
+};
+
+template <typename T>
+struct ArrayTraits : std::false_type {};
+template <typename T, size_t N>
+struct ArrayTraits<std::array<T, N>> : std::true_type {
+  using Element = T;
+  static constexpr size_t count = N;
+};
+
+template <typename T>
+struct StructTraits : std::false_type {};
+template <BlockLayout L, typename... Fields>
+struct StructTraits<GpuStruct<L, Fields...>> : std::true_type {};
+
+template <typename>
+inline constexpr bool unsupported = false;
+
+consteval size_t alignUp(size_t value, size_t alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// std140 rounds the alignment of arrays and structs up to the one of a vec4
+consteval size_t aggregateAlignment(size_t alignment, BlockLayout block)
+{
+  return block == BlockLayout::std140 ? alignUp(alignment, 16) : alignment;
+}
+
+template <typename T, BlockLayout L>
+consteval TypeLayout typeLayout();
+
+// Distance between two elements, matrices are arrays of their columns
+template <typename T, BlockLayout L>
+consteval size_t arrayStride()
+{
+  constexpr TypeLayout element = typeLayout<T, L>();
+  return alignUp(element.size, aggregateAlignment(element.alignment, L));
+}
+
+template <typename T, size_t N, BlockLayout L>
+consteval TypeLayout arrayLayout()
+{
+  constexpr TypeLayout element = typeLayout<T, L>();
+  return {.alignment = aggregateAlignment(element.alignment, L), .size = arrayStride<T, L>() * N, .payload = element.payload * N};
+}
+
+template <typename T, BlockLayout L>
+consteval TypeLayout typeLayout()
+{
+  if constexpr (isScalar<T>) {
+    return {.alignment = sizeof(T), .size = sizeof(T), .payload = sizeof(T)};
+  }
+  else if constexpr (VectorTraits<T>::value) {
+    constexpr size_t component = sizeof(typename VectorTraits<T>::Component);
+    constexpr size_t count = VectorTraits<T>::count;
+    static_assert(isScalar<typename VectorTraits<T>::Component> && count >= 2 && count <= 4, "GLSL vectors have 2 to 4 scalar components");
+    // vec3 is aligned like a vec4 but only takes 3 components, a following scalar fills the gap
+    constexpr size_t alignment = L == BlockLayout::scalar ? component : component * (count == 3 ? 4 : count);
+    return {.alignment = alignment, .size = component * count, .payload = component * count};
+  }
+  else if constexpr (MatrixTraits<T>::value) {
+    return arrayLayout<typename MatrixTraits<T>::Column, MatrixTraits<T>::columns, L>();
+  }
+  else if constexpr (ArrayTraits<T>::value) {
+    return arrayLayout<typename ArrayTraits<T>::Element, ArrayTraits<T>::count, L>();
+  }
+  else if constexpr (StructTraits<T>::value) {
+    static_assert(T::layout == L, "Nested GpuStruct has to use the layout of the block it is part of");
+    return {.alignment = T::alignment, .size = T::size, .payload = T::payload};
+  }
+  else {
+    static_assert(unsupported<T>, "Not a GPU type, bool is 4 bytes in GLSL, use uint32_t");
+    return {};
+  }
+}
+
+// True when the host representation already has the bytes of the block layout, copied in one go
+template <typename T, BlockLayout L>
+consteval bool hostMatches()
+{
+  if constexpr (MatrixTraits<T>::value) {
+    using Column = typename MatrixTraits<T>::Column;
+    return arrayStride<Column, L>() == sizeof(Column);
+  }
+  else if constexpr (ArrayTraits<T>::value) {
+    using Element = typename ArrayTraits<T>::Element;
+    return hostMatches<Element, L>() && arrayStride<Element, L>() == sizeof(Element);
+  }
+  else {
+    return sizeof(T) == typeLayout<T, L>().size;
+  }
+}
+
+template <typename T, BlockLayout L>
+void store(std::byte* target, const T& value)
+{
+  if constexpr (hostMatches<T, L>()) {
+    std::memcpy(target, &value, sizeof(T));
+  }
+  else if constexpr (MatrixTraits<T>::value) {
+    for (size_t column = 0; column < value.columns.size(); ++column) {
+      store<typename MatrixTraits<T>::Column, L>(target + (column * arrayStride<typename MatrixTraits<T>::Column, L>()), value.columns.at(column));
+    }
+  }
+  else {
+    for (size_t element = 0; element < value.size(); ++element) {
+      store<typename ArrayTraits<T>::Element, L>(target + (element * arrayStride<typename ArrayTraits<T>::Element, L>()), value.at(element));
+    }
+  }
+}
+
+template <typename T, BlockLayout L>
+void load(const std::byte* source, T& value)
+{
+  if constexpr (hostMatches<T, L>()) {
+    std::memcpy(&value, source, sizeof(T));
+  }
+  else if constexpr (MatrixTraits<T>::value) {
+    for (size_t column = 0; column < value.columns.size(); ++column) {
+      load<typename MatrixTraits<T>::Column, L>(source + (column * arrayStride<typename MatrixTraits<T>::Column, L>()), value.columns.at(column));
+    }
+  }
+  else {
+    for (size_t element = 0; element < value.size(); ++element) {
+      load<typename ArrayTraits<T>::Element, L>(source + (element * arrayStride<typename ArrayTraits<T>::Element, L>()), value.at(element));
+    }
+  }
+}
+
+template <size_t N>
+consteval std::array<size_t, N> offsets(const std::array<TypeLayout, N>& fields)
+{
+  std::array<size_t, N> result{};
+  size_t end = 0;
+  for (size_t field = 0; field < N; ++field) {
+    result.at(field) = alignUp(end, fields.at(field).alignment);
+    end = result.at(field) + fields.at(field).size;
+  }
+  return result;
+}
+
+template <size_t N>
+consteval size_t structAlignment(const std::array<TypeLayout, N>& fields, BlockLayout block)
+{
+  size_t result = 1;
+  for (const TypeLayout& field : fields) {
+    result = std::max(result, field.alignment);
+  }
+  return aggregateAlignment(result, block);
+}
+
+template <size_t N>
+consteval size_t structSize(const std::array<TypeLayout, N>& fields, BlockLayout block)
+{
+  size_t end = 0;
+  for (const TypeLayout& field : fields) {
+    end = alignUp(end, field.alignment) + field.size;
+  }
+  return alignUp(end, structAlignment(fields, block));
+}
+
+// Size the same fields take ordered by falling alignment, the usual fix for padding heavy blocks
+template <size_t N>
+consteval size_t sortedSize(std::array<TypeLayout, N> fields, BlockLayout block)
+{
+  std::ranges::sort(fields, std::ranges::greater{}, &TypeLayout::alignment);
+  return structSize(fields, block);
+}
+
+template <size_t N>
+consteval size_t payload(const std::array<TypeLayout, N>& fields)
+{
+  size_t result = 0;
+  for (const TypeLayout& field : fields) {
+    result += field.payload;
+  }
+  return result;
+}
+
+template <size_t N>
+consteval bool uniqueNames(const std::array<std::string_view, N>& names)
+{
+  for (size_t first = 0; first < N; ++first) {
+    for (size_t second = first + 1; second < N; ++second) {
+      if (names.at(first) == names.at(second)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+consteval size_t indexOf(const std::array<std::string_view, N>& names, std::string_view name)
+{
+  const auto found = std::ranges::find(names, name);
+  if (found == names.end()) {
+    throw "GpuStruct has no field of this name";  // NOLINT(hicpp-exception-baseclass), only ever evaluated at compile time
+  }
+  return static_cast<size_t>(found - names.begin());
+}
+}  // namespace layout
+
+// GPU visible struct whose bytes are the block layout itself. Offsets are computed at compile time, a mismatch against
+// the shader shows up as a failed static_assert on offsetOf / size instead of garbage on screen. Fields are packed on
+// set, an array of blocks goes to the GPU with a single copy (upload). Nested structs are GpuStructs of the same layout
+//
+//   using Camera = GpuStruct<BlockLayout::std140, Field<"viewProjection", Mat4>, Field<"position", Vec3>, Field<"time", float>>;
+//   static_assert(Camera::offsetOf<"time">() == 76 && Camera::size == 80);
+//   static_assert(!Camera::paddingHeavy);
+template <BlockLayout L, typename... Fields>
+class GpuStruct {
+public:
+  static constexpr BlockLayout layout = L;
+  static constexpr size_t count = sizeof...(Fields);
+  static_assert(count > 0, "GLSL blocks need at least one member");
+
+private:
+  static constexpr std::array<TypeLayout, count> fieldLayouts = {layout::typeLayout<typename Fields::Type, L>()...};
+  static constexpr std::array<std::string_view, count> names = {Fields::name...};
+  static_assert(layout::uniqueNames(names), "GpuStruct field names have to be unique");
+
+public:
+  static constexpr std::array<size_t, count> offsets = layout::offsets(fieldLayouts);
+  static constexpr size_t alignment = layout::structAlignment(fieldLayouts, L);
+  // Rounded up to the alignment, which makes it the array stride of the block as well
+  static constexpr size_t size = layout::structSize(fieldLayouts, L);
+  static constexpr size_t payload = layout::payload(fieldLayouts);
+  static constexpr size_t padding = size - payload;
+  static constexpr size_t sortedSize = layout::sortedSize(fieldLayouts, L);
+  // More than a quarter of the block is padding, or reordering the fields would make it smaller
+  static constexpr bool paddingHeavy = padding * 4 > size || sortedSize < size;
+
+  template <FieldName Name>
+  using TypeOf = std::tuple_element_t<layout::indexOf(names, Name.view()), std::tuple<typename Fields::Type...>>;
+
+  template <FieldName Name>
+  static consteval size_t offsetOf()
+  {
+    return offsets.at(layout::indexOf(names, Name.view()));
+  }
+
+  template <FieldName Name>
+  void set(const TypeOf<Name>& value)
+  {
+    layout::store<TypeOf<Name>, L>(_bytes.data() + offsetOf<Name>(), value);
+  }
+
+  template <FieldName Name>
+  [[nodiscard]] TypeOf<Name> get() const
+  {
+    TypeOf<Name> value{};
+    layout::load<TypeOf<Name>, L>(_bytes.data() + offsetOf<Name>(), value);
+    return value;
+  }
+
+  [[nodiscard]] std::span<const std::byte, size> bytes() const { return _bytes; }
+
+  // Blocks sit at their array stride already, a whole array is one copy into mapped memory
+  static void upload(std::span<const GpuStruct> blocks, std::byte* target)
+  {
+    static_assert(sizeof(GpuStruct) == size);
+    std::memcpy(target, blocks.data(), blocks.size_bytes());
+  }
+
+private:
+  alignas(alignment) std::array<std::byte, size> _bytes{};
+};
+
+template <BlockLayout L, typename T>
+inline constexpr size_t gpuSize = layout::typeLayout<T, L>().size;
+template <BlockLayout L, typename T>
+inline constexpr size_t gpuAlignment = layout::typeLayout<T, L>().alignment;
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_MEMORY_GPU_STRUCT */
@@ -0,0 +1,144 @@
+#include "image.hpp"
+
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory_type.hpp"
+
+namespace vulkan {
+Image::Image(const VulkanDevice& device, const ImageInfo& info)
+    : _device(device.get()), _format(info.format), _extent(info.extent), _mipLevels(info.mipLevels)
+{
+  const VkImageCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .imageType = VK_IMAGE_TYPE_2D,
+      .format = info.format,
+      .extent = {.width = info.extent.width, .height = info.extent.height, .depth = 1},
+      .mipLevels = info.mipLevels,
+      .arrayLayers = 1,
+      .samples = VK_SAMPLE_COUNT_1_BIT,
+      .tiling = VK_IMAGE_TILING_OPTIMAL,
+      .usage = info.usage,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  if (const VkResult status = vkCreateImage(_device, &createInfo, nullptr, &_image); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create image! status: {}", utils::result(status)));
+  }
+
+  try {
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(_device, _image, &requirements);
+    const VkMemoryAllocateInfo allocateInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = findMemoryType(device.getData().memory, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    };
+    if (const VkResult status = vkAllocateMemory(_device, &allocateInfo, nullptr, &_memory); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to allocate image memory! status: {}", utils::result(status)));
+    }
+    if (const VkResult status = vkBindImageMemory(_device, _image, _memory, 0); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to bind image memory! status: {}", utils::result(status)));
+    }
+  }
+  catch (...) {
+    destroy();
+    throw;
+  }
+}
+
+Image::Image(Image&& other) noexcept
+    : _device(std::exchange(other._device, nullptr)),
+      _image(std::exchange(other._image, nullptr)),
+      _memory(std::exchange(other._memory, nullptr)),
+      _format(std::exchange(other._format, VK_FORMAT_UNDEFINED)),
+      _extent(std::exchange(other._extent, {})),
+      _mipLevels(std::exchange(other._mipLevels, 0))
+{
+}
+
+Image& Image::operator=(Image&& other) noexcept
+{
+  if (this != &other) {
+    destroy();
+    _device = std::exchange(other._device, nullptr);
+    _image = std::exchange(other._image, nullptr);
+    _memory = std::exchange(other._memory, nullptr);
+    _format = std::exchange(other._format, VK_FORMAT_UNDEFINED);
+    _extent = std::exchange(other._extent, {});
+    _mipLevels = std::exchange(other._mipLevels, 0);
+  }
+  return *this;
+}
+
+Image::~Image()
+{
+  destroy();
+}
+
+VkImage Image::get() const
+{
+  return _image;
+}
+
+VkFormat Image::getFormat() const
+{
+  return _format;
+}
+
+VkExtent2D Image::getExtent() const
+{
+  return _extent;
+}
+
+uint32_t Image::getMipLevels() const
+{
+  return _mipLevels;
+}
+
+void Image::destroy()
+{
+  if (_memory != nullptr) {
+    vkFreeMemory(_device, _memory, nullptr);
+    _memory = nullptr;
+  }
+  if (_image != nullptr) {
+    vkDestroyImage(_device, _image, nullptr);
+    _image = nullptr;
+  }
+}
+
+VkImageView createImageView(VkDevice device, const Image& image, VkImageAspectFlags aspect, uint32_t baseLevel, uint32_t levels)
+{
+  const VkImageViewCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .image = image.get(),
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format = image.getFormat(),
+      .components = {.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .a = VK_COMPONENT_SWIZZLE_IDENTITY},
+      .subresourceRange = {.aspectMask = aspect, .baseMipLevel = baseLevel, .levelCount = levels, .baseArrayLayer = 0, .layerCount = 1},
+  };
+
+  VkImageView view = nullptr;
+  if (const VkResult status = vkCreateImageView(device, &createInfo, nullptr, &view); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create image view! status: {}", utils::result(status)));
+  }
+  return view;
+}
+}  // namespace vulkan
@@ -0,0 +1,53 @@
+#ifndef LIB_VULKAN_MEMORY_IMAGE
+#define LIB_VULKAN_MEMORY_IMAGE
+
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+
+namespace vulkan {
+struct ImageInfo {
+  VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+  VkExtent2D extent = {.width = 0, .height = 0};
+  uint32_t mipLevels = 1;
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+};
+
+// 2D optimally tiled image in device local memory with its own dedicated allocation, created in UNDEFINED layout
+class Image {
+public:
+  Image(const Image&) = delete;
+  Image(Image&& other) noexcept;
+  Image& operator=(const Image&) = delete;
+  Image& operator=(Image&& other) noexcept;
+
+  explicit Image(const VulkanDevice& device, const ImageInfo& info);
+  ~Image();
+
+  [[nodiscard]] VkImage get() const;
+  [[nodiscard]] VkFormat getFormat() const;
+  [[nodiscard]] VkExtent2D getExtent() const;
+  [[nodiscard]] uint32_t getMipLevels() const;
+
+private:
+  VkDevice _device = nullptr;
+  VkImage _image = nullptr;
+  VkDeviceMemory _memory = nullptr;
+  VkFormat _format = VK_FORMAT_UNDEFINED;
+  VkExtent2D _extent = {.width = 0, .height = 0};
+  uint32_t _mipLevels = 0;
+
+  void destroy();
+};
+
+// 2D view of levels baseLevel up to baseLevel + levels, destroyed by the caller before the image
+[[nodiscard]] VkImageView createImageView(VkDevice device,
+                                          const Image& image,
+                                          VkImageAspectFlags aspect,
+                                          uint32_t baseLevel = 0,
+                                          uint32_t levels = VK_REMAINING_MIP_LEVELS);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_MEMORY_IMAGE */
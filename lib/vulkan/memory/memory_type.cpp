@@ -0,0 +1,37 @@
+#include "memory_type.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <stdexcept>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+uint32_t findMemoryType(const VkPhysicalDeviceMemoryProperties& memory,
+                        uint32_t typeBits,
+                        VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred)
+{
+  std::optional<uint32_t> best;
+  int bestScore = -1;
+  for (uint32_t i = 0; i < memory.memoryTypeCount; ++i) {
+    const VkMemoryPropertyFlags flags = memory.memoryTypes[i].propertyFlags;  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    if ((typeBits & (1U << i)) == 0 || (flags & required) != required) {
+      continue;
+    }
+
+    const int score = std::popcount(flags & preferred);
+    if (score > bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+
+  if (!best) {
+    throw std::runtime_error(std::format("No memory type with flags {:#x} in mask {:#x}", required, typeBits));
+  }
+  return *best;
+}
+}  // namespace vulkan
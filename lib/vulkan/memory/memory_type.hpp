@@ -0,0 +1,16 @@
+#ifndef LIB_VULKAN_MEMORY_MEMORY_TYPE
+#define LIB_VULKAN_MEMORY_MEMORY_TYPE
+
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+// Picks a memory type allowed by typeBits with all required flags, the one matching most preferred flags wins
+[[nodiscard]] uint32_t findMemoryType(const VkPhysicalDeviceMemoryProperties& memory,
+                                      uint32_t typeBits,
+                                      VkMemoryPropertyFlags required,
+                                      VkMemoryPropertyFlags preferred = 0);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_MEMORY_MEMORY_TYPE */
@@ -0,0 +1,103 @@
+#include "range_allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+
+namespace vulkan {
+RangeAllocator::RangeAllocator(uint64_t capacity) : _capacity(capacity), _free(capacity)
+{
+  if (capacity != 0) {
+    _ranges.emplace(0, capacity);
+  }
+}
+
+std::optional<uint64_t> RangeAllocator::allocate(uint64_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  const auto found = std::ranges::find_if(_ranges, [size](const auto& range) { return range.second >= size; });
+  if (found == _ranges.end()) {
+    return std::nullopt;
+  }
+
+  const auto [offset, available] = *found;
+  _ranges.erase(found);
+  if (available > size) {
+    _ranges.emplace(offset + size, available - size);
+  }
+  _free -= size;
+  return offset;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size)
+{
+  if (size == 0) {
+    return;
+  }
+  if (offset + size > _capacity) {
+    throw std::runtime_error(std::format("Freed range {}+{} is outside of {}", offset, size, _capacity));
+  }
+
+  auto next = _ranges.lower_bound(offset);
+  if (next != _ranges.end() && next->first < offset + size) {
+    throw std::runtime_error(std::format("Range {}+{} is freed twice", offset, size));
+  }
+  uint64_t start = offset;
+  uint64_t end = offset + size;
+  if (next != _ranges.begin()) {
+    const auto previous = std::prev(next);
+    if (previous->first + previous->second > offset) {
+      throw std::runtime_error(std::format("Range {}+{} is freed twice", offset, size));
+    }
+    if (previous->first + previous->second == offset) {
+      start = previous->first;
+      _ranges.erase(previous);
+    }
+  }
+  if (next != _ranges.end() && next->first == end) {
+    end += next->second;
+    _ranges.erase(next);
+  }
+  _ranges.emplace(start, end - start);
+  _free += size;
+}
+
+void RangeAllocator::reset(uint64_t used)
+{
+  used = std::min(used, _capacity);
+  _ranges.clear();
+  if (used < _capacity) {
+    _ranges.emplace(used, _capacity - used);
+  }
+  _free = _capacity - used;
+}
+
+uint64_t RangeAllocator::getCapacity() const
+{
+  return _capacity;
+}
+
+uint64_t RangeAllocator::getFree() const
+{
+  return _free;
+}
+
+uint64_t RangeAllocator::getLargestFree() const
+{
+  uint64_t largest = 0;
+  for (const auto& [offset, size] : _ranges) {
+    largest = std::max(largest, size);
+  }
+  return largest;
+}
+
+uint64_t RangeAllocator::getFreeRanges() const
+{
+  return _ranges.size();
+}
+}  // namespace vulkan
@@ -0,0 +1,34 @@
+#ifndef LIB_VULKAN_MEMORY_RANGE_ALLOCATOR
+#define LIB_VULKAN_MEMORY_RANGE_ALLOCATOR
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace vulkan {
+// First fit sub-allocation of [0, capacity) in abstract units (bytes, vertices, indices). Freed ranges merge with free
+// neighbours right away, so fragmentation is only what live ranges leave between them
+class RangeAllocator {
+public:
+  explicit RangeAllocator(uint64_t capacity);
+
+  // Offset of the range, nothing when no free range is large enough
+  [[nodiscard]] std::optional<uint64_t> allocate(uint64_t size);
+  void free(uint64_t offset, uint64_t size);
+  // Everything below used is allocated, the rest is one free range. Used after live ranges were moved to the front
+  void reset(uint64_t used);
+
+  [[nodiscard]] uint64_t getCapacity() const;
+  [[nodiscard]] uint64_t getFree() const;
+  [[nodiscard]] uint64_t getLargestFree() const;
+  [[nodiscard]] uint64_t getFreeRanges() const;
+
+private:
+  uint64_t _capacity;
+  uint64_t _free;
+  // Offset to size, never two adjacent entries
+  std::map<uint64_t, uint64_t> _ranges;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_MEMORY_RANGE_ALLOCATOR */
@@ -0,0 +1,164 @@
+#include "layout_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "format/string.hpp"
+#include "hash/hash.hpp"
+#include "shader/reflection.hpp"
+
+namespace vulkan {
+static constexpr VkShaderStageFlags widenedStages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+static constexpr VkShaderStageFlags inputAttachmentStages = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+LayoutCache::LayoutCache(VkDevice device) : _device(device)
+{
+}
+
+LayoutCache::~LayoutCache()
+{
+  for (const auto& [key, layout] : _layouts) {
+    vkDestroyPipelineLayout(_device, layout, nullptr);
+  }
+  for (const auto& [key, layout] : _sets) {
+    vkDestroyDescriptorSetLayout(_device, layout, nullptr);
+  }
+}
+
+VkDescriptorSetLayout LayoutCache::getSetLayout(std::span<const DescriptorBinding> bindings)
+{
+  // Canonical form, the same bindings declared in another order or set hash to the same key. Stage visibility is
+  // widened to every stage, a set one pipeline reads in the vertex stage and another one in the fragment stage has to
+  // be the same layout for sets to stay bound across both. Input attachments can only be fragment visible
+  SetKey key{.bindings = {bindings.begin(), bindings.end()}};
+  for (DescriptorBinding& binding : key.bindings) {
+    if (binding.count == 0) {
+      throw std::runtime_error(std::format("Binding {} is a runtime sized array, it needs a bindless layout", binding.binding));
+    }
+    binding.set = 0;
+    binding.stages = binding.type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT ? inputAttachmentStages : widenedStages;
+  }
+  std::ranges::sort(key.bindings, {}, &DescriptorBinding::binding);
+
+  const std::scoped_lock lock(_mutex);
+  ++_requests;
+  if (auto found = _sets.find(key); found != _sets.end()) {
+    ++_hits;
+    return found->second;
+  }
+
+  std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+  layoutBindings.reserve(key.bindings.size());
+  for (const DescriptorBinding& binding : key.bindings) {
+    layoutBindings.push_back({
+        .binding = binding.binding,
+        .descriptorType = binding.type,
+        .descriptorCount = binding.count,
+        .stageFlags = binding.stages,
+        .pImmutableSamplers = nullptr,
+    });
+  }
+  const VkDescriptorSetLayoutCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .bindingCount = static_cast<uint32_t>(layoutBindings.size()),
+      .pBindings = layoutBindings.data(),
+  };
+
+  VkDescriptorSetLayout layout = nullptr;
+  if (const VkResult status = vkCreateDescriptorSetLayout(_device, &createInfo, nullptr, &layout); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create descriptor set layout! status: {}", utils::result(status)));
+  }
+  _sets.emplace(std::move(key), layout);
+  return layout;
+}
+
+VkPipelineLayout LayoutCache::getPipelineLayout(std::span<const VkDescriptorSetLayout> sets,
+                                                std::span<const VkPushConstantRange> pushConstants)
+{
+  // Set layouts are hash-consed already, comparing their handles compares their content
+  PipelineKey key{.sets = {sets.begin(), sets.end()}, .pushConstants = {}};
+  for (const VkPushConstantRange& range : pushConstants) {
+    key.pushConstants.insert(key.pushConstants.end(), {range.stageFlags, range.offset, range.size});
+  }
+
+  const std::scoped_lock lock(_mutex);
+  ++_requests;
+  if (auto found = _layouts.find(key); found != _layouts.end()) {
+    ++_hits;
+    return found->second;
+  }
+
+  const VkPipelineLayoutCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .setLayoutCount = static_cast<uint32_t>(sets.size()),
+      .pSetLayouts = sets.data(),
+      .pushConstantRangeCount = static_cast<uint32_t>(pushConstants.size()),
+      .pPushConstantRanges = pushConstants.data(),
+  };
+
+  VkPipelineLayout layout = nullptr;
+  if (const VkResult status = vkCreatePipelineLayout(_device, &createInfo, nullptr, &layout); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create pipeline layout! status: {}", utils::result(status)));
+  }
+  _layouts.emplace(std::move(key), layout);
+  return layout;
+}
+
+PipelineLayout LayoutCache::getPipelineLayout(const PipelineReflection& reflection)
+{
+  // Bindings are sorted by set, each set is one contiguous run
+  PipelineLayout result;
+  auto first = reflection.bindings.begin();
+  while (first != reflection.bindings.end()) {
+    const uint32_t set = first->set;
+    const auto last = std::find_if(first, reflection.bindings.end(), [set](const DescriptorBinding& binding) { return binding.set != set; });
+    while (result.sets.size() < set) {
+      result.sets.push_back(getSetLayout({}));
+    }
+    result.sets.push_back(getSetLayout({first, last}));
+    first = last;
+  }
+  result.layout = getPipelineLayout(result.sets, reflection.pushConstants);
+  return result;
+}
+
+LayoutCacheStats LayoutCache::getStats() const
+{
+  const std::scoped_lock lock(_mutex);
+  return {.requests = _requests, .hits = _hits, .setLayouts = _sets.size(), .pipelineLayouts = _layouts.size()};
+}
+
+size_t LayoutCache::KeyHash::operator()(const SetKey& key) const
+{
+  size_t seed = key.bindings.size();
+  for (const DescriptorBinding& binding : key.bindings) {
+    utils::hashCombine(seed, utils::hash(binding.binding, binding.type, binding.count, binding.stages));
+  }
+  return seed;
+}
+
+size_t LayoutCache::KeyHash::operator()(const PipelineKey& key) const
+{
+  size_t seed = key.sets.size();
+  for (VkDescriptorSetLayout set : key.sets) {
+    utils::hashCombine(seed, set);
+  }
+  for (const uint32_t value : key.pushConstants) {
+    utils::hashCombine(seed, value);
+  }
+  return seed;
+}
+}  // namespace vulkan
@@ -0,0 +1,81 @@
+#ifndef LIB_VULKAN_PIPELINE_LAYOUT_CACHE
+#define LIB_VULKAN_PIPELINE_LAYOUT_CACHE
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "shader/reflection.hpp"
+
+namespace vulkan {
+struct LayoutCacheStats {
+  uint64_t requests = 0;
+  uint64_t hits = 0;
+  size_t setLayouts = 0;
+  size_t pipelineLayouts = 0;
+};
+
+// Pipeline layout with the set layouts it was made of, index is the set number
+struct PipelineLayout {
+  VkPipelineLayout layout = nullptr;
+  std::vector<VkDescriptorSetLayout> sets;
+};
+
+// Hash-consed layouts: equal descriptions always return the same handle. Pipelines made from one layout are compatible,
+// descriptor sets bound for one stay bound when the other is bound. Handles live as long as the cache
+class LayoutCache {
+public:
+  LayoutCache(const LayoutCache&) = delete;
+  LayoutCache(LayoutCache&&) = delete;
+  LayoutCache& operator=(const LayoutCache&) = delete;
+  LayoutCache& operator=(LayoutCache&&) = delete;
+
+  explicit LayoutCache(VkDevice device);
+  ~LayoutCache();
+
+  // Bindings of one set, their set number and stages are ignored, every binding is visible to all graphics and compute
+  // stages. Runtime sized arrays are not supported
+  [[nodiscard]] VkDescriptorSetLayout getSetLayout(std::span<const DescriptorBinding> bindings);
+  [[nodiscard]] VkPipelineLayout getPipelineLayout(std::span<const VkDescriptorSetLayout> sets,
+                                                   std::span<const VkPushConstantRange> pushConstants);
+  // Sets without bindings below the highest used one get the empty set layout
+  [[nodiscard]] PipelineLayout getPipelineLayout(const PipelineReflection& reflection);
+
+  [[nodiscard]] LayoutCacheStats getStats() const;
+
+private:
+  struct SetKey {
+    std::vector<DescriptorBinding> bindings;
+
+    bool operator==(const SetKey&) const = default;
+  };
+
+  struct PipelineKey {
+    std::vector<VkDescriptorSetLayout> sets;
+    // Stage flags, offset and size of each range
+    std::vector<uint32_t> pushConstants;
+
+    bool operator==(const PipelineKey&) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const SetKey& key) const;
+    size_t operator()(const PipelineKey& key) const;
+  };
+
+  VkDevice _device;
+
+  mutable std::mutex _mutex;
+  std::unordered_map<SetKey, VkDescriptorSetLayout, KeyHash> _sets;
+  std::unordered_map<PipelineKey, VkPipelineLayout, KeyHash> _layouts;
+  uint64_t _requests = 0;
+  uint64_t _hits = 0;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_PIPELINE_LAYOUT_CACHE */
@@ -0,0 +1,263 @@
+#include "pipeline_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device_data.hpp"
+#include "format/string.hpp"
+#include "hash/hash.hpp"
+
+namespace vulkan {
+static constexpr uint32_t fileMagic = 0x4350'4B56;  // "VKPC"
+static constexpr uint32_t fileVersion = 1;
+
+// Windows of one process share the file, every save needs its own temporary
+static std::atomic<uint64_t> tempCounter = 0;
+
+static std::vector<char> readFile(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return {};
+  }
+  return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+static uint64_t checksum(std::span<const char> data)
+{
+  return utils::fnv1a(std::as_bytes(data));
+}
+
+static VkPipelineCache createCache(VkDevice device, std::span<const char> initial)
+{
+  const VkPipelineCacheCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .initialDataSize = initial.size(),
+      .pInitialData = initial.empty() ? nullptr : initial.data(),
+  };
+
+  VkPipelineCache cache = nullptr;
+  if (const VkResult status = vkCreatePipelineCache(device, &createInfo, nullptr, &cache); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create pipeline cache! status: {}", utils::result(status)));
+  }
+  return cache;
+}
+
+PipelineCache::PipelineCache(VkDevice device, const DeviceData& data, const std::filesystem::path& directory)
+    : _device(device),
+      _header{
+          .magic = fileMagic,
+          .version = fileVersion,
+          .vendorID = data.properties.vendorID,
+          .deviceID = data.properties.deviceID,
+          .driverVersion = data.properties.driverVersion,
+          .uuid = {},
+          .reserved = 0,
+          .size = 0,
+          .checksum = 0,
+      }
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto start = std::chrono::steady_clock::now();
+  std::ranges::copy(data.properties.pipelineCacheUUID, _header.uuid.begin());
+
+  std::vector<char> file;
+  std::span<const char> initial;
+  _stats.load = "memory only";
+  if (!directory.empty()) {
+    _path = directory / std::format("{:08x}_{:08x}.bin", _header.vendorID, _header.deviceID);
+    file = readFile(_path);
+    _stats.load = file.empty() ? "cold" : "warm";
+  }
+  if (!file.empty()) {
+    FileHeader header{};
+    if (file.size() >= sizeof(FileHeader)) {
+      std::memcpy(&header, file.data(), sizeof(FileHeader));
+    }
+    const std::span<const char> payload = std::span<const char>(file).subspan(std::min(file.size(), sizeof(FileHeader)));
+    if (file.size() < sizeof(FileHeader) || header.magic != fileMagic || header.version != fileVersion) {
+      _stats.load = "rejected: unknown format";
+    }
+    else if (header.vendorID != _header.vendorID || header.deviceID != _header.deviceID) {
+      _stats.load = "rejected: other device";
+    }
+    else if (header.driverVersion != _header.driverVersion) {
+      _stats.load = "rejected: driver version";
+    }
+    else if (header.uuid != _header.uuid) {
+      _stats.load = "rejected: cache UUID";
+    }
+    else if (header.size != payload.size() || header.checksum != checksum(payload)) {
+      _stats.load = "rejected: corrupted";
+    }
+    else {
+      initial = payload;
+    }
+  }
+
+  _cache = createCache(_device, initial);
+  _stats.loadedBytes = initial.size();
+  _stats.loadMs = Milliseconds(std::chrono::steady_clock::now() - start).count();
+  _savedSize = initial.size();
+
+  if (!_path.empty()) {
+    _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+  }
+}
+
+PipelineCache::~PipelineCache()
+{
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+
+  try {
+    save();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Failed to save pipeline cache:\n\t" << e.what() << "\n";
+  }
+  vkDestroyPipelineCache(_device, _cache, nullptr);
+}
+
+VkPipelineCache PipelineCache::get() const
+{
+  return _cache;
+}
+
+VkPipelineCache PipelineCache::createWorker() const
+{
+  return createCache(_device, {});
+}
+
+void PipelineCache::merge(VkPipelineCache worker)
+{
+  {
+    // The destination of a merge has to be externally synchronized, pipeline creation with it does not
+    const std::scoped_lock lock(_mutex);
+    if (const VkResult status = vkMergePipelineCaches(_device, _cache, 1, &worker); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to merge pipeline caches! status: {}", utils::result(status)));
+    }
+    _merged = true;
+  }
+  vkDestroyPipelineCache(_device, worker, nullptr);
+}
+
+bool PipelineCache::save()
+{
+  if (_path.empty()) {
+    return false;
+  }
+
+  const std::scoped_lock lock(_mutex);
+  size_t size = 0;
+  if (const VkResult status = vkGetPipelineCacheData(_device, _cache, &size, nullptr); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get pipeline cache size! status: {}", utils::result(status)));
+  }
+  if (size == _savedSize && !_merged) {
+    return false;
+  }
+
+  std::vector<char> data(sizeof(FileHeader) + size);
+  // The cache may have grown since the size query, VK_INCOMPLETE then still leaves a valid prefix
+  if (const VkResult status = vkGetPipelineCacheData(_device, _cache, &size, data.data() + sizeof(FileHeader));
+      status != VK_SUCCESS && status != VK_INCOMPLETE) {
+    throw std::runtime_error(std::format("Failed to get pipeline cache data! status: {}", utils::result(status)));
+  }
+  data.resize(sizeof(FileHeader) + size);
+
+  FileHeader header = _header;
+  header.size = size;
+  header.checksum = checksum(std::span<const char>(data).subspan(sizeof(FileHeader)));
+  std::memcpy(data.data(), &header, sizeof(FileHeader));
+
+  // Rename replaces the file atomically, a crash mid write leaves the previous cache intact
+  std::filesystem::create_directories(_path.parent_path());
+  std::filesystem::path temporary = _path;
+  temporary += std::format(".{}.tmp", tempCounter++);
+  {
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!stream) {
+      throw std::runtime_error(std::format("Failed to write pipeline cache to {}", temporary.string()));
+    }
+  }
+  std::filesystem::rename(temporary, _path);
+
+  _savedSize = size;
+  _merged = false;
+  ++_stats.saves;
+  _stats.savedBytes = size;
+  return true;
+}
+
+void PipelineCache::record(const VkPipelineCreationFeedback& feedback)
+{
+  if ((feedback.flags & static_cast<VkPipelineCreationFeedbackFlags>(VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)) == 0) {
+    return;
+  }
+
+  static constexpr double nsPerMs = 1'000'000.0;
+  const bool hit =
+      (feedback.flags & static_cast<VkPipelineCreationFeedbackFlags>(VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)) != 0;
+  const std::scoped_lock lock(_mutex);
+  ++(hit ? _stats.hits : _stats.misses);
+  _stats.compileMs += static_cast<double>(feedback.duration) / nsPerMs;
+}
+
+const std::filesystem::path& PipelineCache::getPath() const
+{
+  return _path;
+}
+
+PipelineCacheStats PipelineCache::getStats() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _stats;
+}
+
+void PipelineCache::loop(const std::stop_token& token)
+{
+  std::mutex mutex;
+  std::condition_variable_any wake;
+  while (!token.stop_requested()) {
+    {
+      // Nothing notifies, the wait ends on timeout or stop request
+      std::unique_lock lock(mutex);
+      [[maybe_unused]] const bool woken = wake.wait_for(lock, token, saveInterval, [] { return false; });
+    }
+    if (token.stop_requested()) {
+      break;
+    }
+    try {
+      save();
+    }
+    catch (const std::exception& e) {
+      std::cerr << "Failed to save pipeline cache:\n\t" << e.what() << "\n";
+    }
+  }
+}
+}  // namespace vulkan
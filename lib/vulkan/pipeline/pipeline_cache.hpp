@@ -0,0 +1,90 @@
+#ifndef LIB_VULKAN_PIPELINE_PIPELINE_CACHE
+#define LIB_VULKAN_PIPELINE_PIPELINE_CACHE
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device_data.hpp"
+
+namespace vulkan {
+struct PipelineCacheStats {
+  // "cold", "warm" or why the file on disk was rejected
+  std::string load;
+  double loadMs = 0.0;
+  size_t loadedBytes = 0;
+  uint32_t saves = 0;
+  size_t savedBytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Creation time reported by pipeline creation feedback
+  double compileMs = 0.0;
+};
+
+// VkPipelineCache persisted per physical device. The file is only used when vendor, device, driver version and
+// pipelineCacheUUID match the running device, writes go to a temporary file renamed over the old one
+class PipelineCache {
+public:
+  static constexpr auto saveInterval = std::chrono::seconds(30);
+
+  PipelineCache(const PipelineCache&) = delete;
+  PipelineCache(PipelineCache&&) = delete;
+  PipelineCache& operator=(const PipelineCache&) = delete;
+  PipelineCache& operator=(PipelineCache&&) = delete;
+
+  // Empty directory keeps the cache in memory only
+  explicit PipelineCache(VkDevice device, const DeviceData& data, const std::filesystem::path& directory);
+  ~PipelineCache();
+
+  [[nodiscard]] VkPipelineCache get() const;
+  // Private cache for one compile thread, merge() hands its content to the shared cache and destroys it
+  [[nodiscard]] VkPipelineCache createWorker() const;
+  void merge(VkPipelineCache worker);
+
+  // Returns false when persistence is disabled or nothing changed since the last save
+  bool save();
+  // Counts one creation, feedback has to come from a create info this cache was passed to
+  void record(const VkPipelineCreationFeedback& feedback);
+
+  [[nodiscard]] const std::filesystem::path& getPath() const;
+  [[nodiscard]] PipelineCacheStats getStats() const;
+
+private:
+  // Prepended to the driver data, the driver header alone does not cover the driver version
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    std::array<uint8_t, VK_UUID_SIZE> uuid;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t checksum;
+  };
+
+  VkDevice _device;
+  FileHeader _header;
+  std::filesystem::path _path;
+  VkPipelineCache _cache = nullptr;
+
+  mutable std::mutex _mutex;
+  PipelineCacheStats _stats;
+  size_t _savedSize = 0;
+  bool _merged = false;
+
+  std::jthread _thread;
+
+  void loop(const std::stop_token& token);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_PIPELINE_PIPELINE_CACHE */
@@ -0,0 +1,710 @@
+#include "pipeline_compiler.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "hash/hash.hpp"
+#include "pipeline_cache.hpp"
+#include "rendering/rendering.hpp"
+
+namespace vulkan {
+static constexpr std::array<VkGraphicsPipelineLibraryFlagBitsEXT, 4> libraryParts = {
+    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+    VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+};
+
+struct PipelineCompiler::Job {
+  GraphicsPipelineInfo info;
+  std::shared_ptr<CompiledPipeline> handle;
+  std::chrono::steady_clock::time_point requested;
+};
+
+// Create info state of one pipeline, every pointer handed out points into the object itself
+struct PipelineState {
+  // One per stage, reserved up front so the stages can point into it
+  std::vector<VkSpecializationInfo> specializations;
+  std::vector<VkPipelineShaderStageCreateInfo> preRasterStages;
+  std::vector<VkPipelineShaderStageCreateInfo> fragmentStages;
+  std::vector<VkPipelineShaderStageCreateInfo> stages;
+  VkPipelineVertexInputStateCreateInfo vertexInput;
+  VkPipelineInputAssemblyStateCreateInfo inputAssembly;
+  VkPipelineViewportStateCreateInfo viewport;
+  VkPipelineRasterizationStateCreateInfo rasterization;
+  VkPipelineMultisampleStateCreateInfo multisample;
+  VkPipelineDepthStencilStateCreateInfo depthStencil;
+  std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+  VkPipelineColorBlendStateCreateInfo colorBlend;
+  std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+  VkPipelineDynamicStateCreateInfo dynamic;
+  PipelineRendering rendering;
+
+  PipelineState(const PipelineState&) = delete;
+  PipelineState(PipelineState&&) = delete;
+  PipelineState& operator=(const PipelineState&) = delete;
+  PipelineState& operator=(PipelineState&&) = delete;
+
+  PipelineState(const GraphicsPipelineInfo& info, Rendering& renderer)
+      : vertexInput{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .vertexBindingDescriptionCount = static_cast<uint32_t>(info.bindings.size()),
+            .pVertexBindingDescriptions = info.bindings.data(),
+            .vertexAttributeDescriptionCount = static_cast<uint32_t>(info.attributes.size()),
+            .pVertexAttributeDescriptions = info.attributes.data(),
+        },
+        inputAssembly{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .topology = info.topology,
+            .primitiveRestartEnable = VK_FALSE,
+        },
+        viewport{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .viewportCount = 1,
+            .pViewports = nullptr,
+            .scissorCount = 1,
+            .pScissors = nullptr,
+        },
+        rasterization{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .depthClampEnable = VK_FALSE,
+            .rasterizerDiscardEnable = VK_FALSE,
+            .polygonMode = info.polygonMode,
+            .cullMode = info.cullMode,
+            .frontFace = info.frontFace,
+            .depthBiasEnable = VK_FALSE,
+            .depthBiasConstantFactor = 0.0F,
+            .depthBiasClamp = 0.0F,
+            .depthBiasSlopeFactor = 0.0F,
+            .lineWidth = 1.0F,
+        },
+        multisample{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+            .sampleShadingEnable = VK_FALSE,
+            .minSampleShading = 0.0F,
+            .pSampleMask = nullptr,
+            .alphaToCoverageEnable = VK_FALSE,
+            .alphaToOneEnable = VK_FALSE,
+        },
+        depthStencil{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .depthTestEnable = info.depthTest ? VK_TRUE : VK_FALSE,
+            .depthWriteEnable = info.depthWrite ? VK_TRUE : VK_FALSE,
+            .depthCompareOp = info.depthCompare,
+            .depthBoundsTestEnable = VK_FALSE,
+            .stencilTestEnable = VK_FALSE,
+            .front = {},
+            .back = {},
+            .minDepthBounds = 0.0F,
+            .maxDepthBounds = 1.0F,
+        },
+        colorBlend{},
+        dynamic{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+            .pDynamicStates = dynamicStates.data(),
+        },
+        rendering(renderer.pipelineRendering(info.formats))
+  {
+    specializations.reserve(info.stages.size());
+    for (const auto& stage : info.stages) {
+      const VkSpecializationInfo& specialization = specializations.emplace_back(VkSpecializationInfo{
+          .mapEntryCount = static_cast<uint32_t>(stage.specialization.size()),
+          .pMapEntries = stage.specialization.data(),
+          .dataSize = stage.specializationData.size(),
+          .pData = stage.specializationData.data(),
+      });
+      const VkPipelineShaderStageCreateInfo stageInfo{
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+          .pNext = nullptr,
+          .flags = 0,
+          .stage = stage.stage,
+          .module = stage.module,
+          .pName = stage.entry.c_str(),
+          .pSpecializationInfo = stage.specialization.empty() ? nullptr : &specialization,
+      };
+      (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT ? fragmentStages : preRasterStages).push_back(stageInfo);
+      stages.push_back(stageInfo);
+    }
+
+    // Straight alpha blending when enabled
+    const VkPipelineColorBlendAttachmentState attachment{
+        .blendEnable = info.blend ? VK_TRUE : VK_FALSE,
+        .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+        .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask = static_cast<uint32_t>(VK_COLOR_COMPONENT_R_BIT) | static_cast<uint32_t>(VK_COLOR_COMPONENT_G_BIT) |
+                          static_cast<uint32_t>(VK_COLOR_COMPONENT_B_BIT) | static_cast<uint32_t>(VK_COLOR_COMPONENT_A_BIT),
+    };
+    blendAttachments.assign(info.formats.colors.size(), attachment);
+    colorBlend = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_COPY,
+        .attachmentCount = static_cast<uint32_t>(blendAttachments.size()),
+        .pAttachments = blendAttachments.data(),
+        .blendConstants = {0.0F, 0.0F, 0.0F, 0.0F},
+    };
+  }
+
+  ~PipelineState() = default;
+
+  // Rendering info on the dynamic path, chained behind whatever the caller puts first
+  [[nodiscard]] const void* renderingChain() const
+  {
+    return rendering.renderPass == nullptr ? &rendering.rendering : nullptr;
+  }
+
+  // Only the state of the given library parts, everything when parts is 0
+  [[nodiscard]] VkGraphicsPipelineCreateInfo createInfo(const void* next, VkPipelineCreateFlags flags, VkGraphicsPipelineLibraryFlagsEXT parts,
+                                                        VkPipelineLayout layout) const
+  {
+    const auto has = [parts](VkGraphicsPipelineLibraryFlagBitsEXT part) {
+      return parts == 0 || (parts & static_cast<VkGraphicsPipelineLibraryFlagsEXT>(part)) != 0;
+    };
+    const bool vertex = has(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT);
+    const bool preRaster = has(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT);
+    const bool fragment = has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT);
+    const bool output = has(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+    const std::vector<VkPipelineShaderStageCreateInfo>& partStages = parts == 0 ? stages : (preRaster ? preRasterStages : fragmentStages);
+    const bool withStages = preRaster || fragment;
+
+    return {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = next,
+        .flags = flags,
+        .stageCount = withStages ? static_cast<uint32_t>(partStages.size()) : 0U,
+        .pStages = withStages ? partStages.data() : nullptr,
+        .pVertexInputState = vertex ? &vertexInput : nullptr,
+        .pInputAssemblyState = vertex ? &inputAssembly : nullptr,
+        .pTessellationState = nullptr,
+        .pViewportState = preRaster ? &viewport : nullptr,
+        .pRasterizationState = preRaster ? &rasterization : nullptr,
+        .pMultisampleState = fragment || output ? &multisample : nullptr,
+        .pDepthStencilState = fragment ? &depthStencil : nullptr,
+        .pColorBlendState = output ? &colorBlend : nullptr,
+        .pDynamicState = preRaster ? &dynamic : nullptr,
+        .layout = preRaster || fragment ? layout : nullptr,
+        .renderPass = rendering.renderPass,
+        .subpass = 0,
+        .basePipelineHandle = nullptr,
+        .basePipelineIndex = -1,
+    };
+  }
+};
+
+// Fields are appended one at a time so struct padding never reaches the hash
+class StateHasher {
+public:
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  void add(const T& value)
+  {
+    add(std::as_bytes(std::span(&value, 1)));
+  }
+
+  void add(std::span<const std::byte> bytes) { _bytes.insert(_bytes.end(), bytes.begin(), bytes.end()); }
+
+  void add(std::string_view text)
+  {
+    add(text.size());
+    add(std::as_bytes(std::span(text)));
+  }
+
+  [[nodiscard]] uint64_t get() const { return utils::fnv1a(_bytes); }
+
+private:
+  std::vector<std::byte> _bytes;
+};
+
+uint64_t pipelineHash(const GraphicsPipelineInfo& info)
+{
+  StateHasher hasher;
+  // Layouts are hash consed by the LayoutCache, the handle stands for the whole layout
+  hasher.add(info.layout);
+  hasher.add(info.stages.size());
+  for (const auto& stage : info.stages) {
+    hasher.add(stage.stage);
+    if (stage.hash != 0) {
+      hasher.add(stage.hash);
+    }
+    else {
+      hasher.add(stage.module);
+    }
+    hasher.add(std::string_view(stage.entry));
+    hasher.add(stage.specialization.size());
+    for (const auto& entry : stage.specialization) {
+      hasher.add(entry.constantID);
+      hasher.add(entry.offset);
+      hasher.add(entry.size);
+    }
+    hasher.add(stage.specializationData.size());
+    hasher.add(std::span<const std::byte>(stage.specializationData));
+  }
+  hasher.add(info.bindings.size());
+  for (const auto& binding : info.bindings) {
+    hasher.add(binding.binding);
+    hasher.add(binding.stride);
+    hasher.add(binding.inputRate);
+  }
+  hasher.add(info.attributes.size());
+  for (const auto& attribute : info.attributes) {
+    hasher.add(attribute.location);
+    hasher.add(attribute.binding);
+    hasher.add(attribute.format);
+    hasher.add(attribute.offset);
+  }
+  hasher.add(info.topology);
+  hasher.add(info.polygonMode);
+  hasher.add(info.cullMode);
+  hasher.add(info.frontFace);
+  hasher.add(info.depthTest);
+  hasher.add(info.depthWrite);
+  hasher.add(info.depthCompare);
+  hasher.add(info.blend);
+  hasher.add(info.formats.colors.size());
+  for (const VkFormat format : info.formats.colors) {
+    hasher.add(format);
+  }
+  hasher.add(info.formats.depth);
+  return hasher.get();
+}
+
+static size_t formatsHash(const RenderFormats& formats)
+{
+  size_t seed = utils::hash(formats.depth, formats.colors.size());
+  for (const VkFormat format : formats.colors) {
+    utils::hashCombine(seed, format);
+  }
+  return seed;
+}
+
+static uint64_t stageSpecialization(const ShaderStage& stage)
+{
+  StateHasher hasher;
+  for (const auto& entry : stage.specialization) {
+    hasher.add(entry.constantID);
+    hasher.add(entry.offset);
+    hasher.add(entry.size);
+  }
+  hasher.add(std::span<const std::byte>(stage.specializationData));
+  return hasher.get();
+}
+
+// Content hash when the stage carries one, so a module reloaded with the same code shares the libraries built before
+static size_t stageCode(const ShaderStage& stage)
+{
+  return stage.hash != 0 ? utils::hash(stage.hash) : utils::hash(stage.module);
+}
+
+// Libraries are shared between pipelines by the state of their own part only
+static uint64_t partKey(const GraphicsPipelineInfo& info, VkGraphicsPipelineLibraryFlagBitsEXT part)
+{
+  size_t seed = utils::hash(part);
+  switch (part) {
+  case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+    utils::hashCombine(seed, info.topology);
+    for (const auto& binding : info.bindings) {
+      utils::hashCombine(seed, utils::hash(binding.binding, binding.stride, binding.inputRate));
+    }
+    for (const auto& attribute : info.attributes) {
+      utils::hashCombine(seed, utils::hash(attribute.location, attribute.binding, attribute.format, attribute.offset));
+    }
+    break;
+  case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+    utils::hashCombine(seed, utils::hash(info.layout, info.polygonMode, info.cullMode, info.frontFace, formatsHash(info.formats)));
+    for (const auto& stage : info.stages) {
+      if (stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT) {
+        utils::hashCombine(seed, utils::hash(stage.stage, stageCode(stage), stage.entry, stageSpecialization(stage)));
+      }
+    }
+    break;
+  case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+    utils::hashCombine(seed, utils::hash(info.layout, info.depthTest, info.depthWrite, info.depthCompare, formatsHash(info.formats)));
+    for (const auto& stage : info.stages) {
+      if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+        utils::hashCombine(seed, utils::hash(stageCode(stage), stage.entry, stageSpecialization(stage)));
+      }
+    }
+    break;
+  default:
+    utils::hashCombine(seed, utils::hash(info.blend, formatsHash(info.formats)));
+    break;
+  }
+  return seed;
+}
+
+CompiledPipeline::CompiledPipeline(std::shared_ptr<const CompiledPipeline> fallback) : _fallback(std::move(fallback)) {}
+
+VkPipeline CompiledPipeline::get() const
+{
+  if (VkPipeline pipeline = _pipeline; pipeline != nullptr) {
+    return pipeline;
+  }
+  return _fallback != nullptr ? _fallback->get() : nullptr;
+}
+
+bool CompiledPipeline::isUsable() const
+{
+  return _pipeline != nullptr;
+}
+
+bool CompiledPipeline::isOptimized() const
+{
+  return _optimized;
+}
+
+bool CompiledPipeline::isFailed() const
+{
+  return _failed;
+}
+
+PipelineCompiler::PipelineCompiler(const VulkanDevice& device, Rendering& rendering, uint32_t threads)
+    : _device(device.get()),
+      _rendering(rendering),
+      _cache(device.getPipelineCache()),
+      _libraries(device.getFeatures().graphicsPipelineLibrary),
+      _feedback(device.getFeatures().creationFeedback),
+      _table(tableCapacity),
+      _arena(threads == 0 ? static_cast<int>(tbb::task_arena::automatic) : static_cast<int>(threads))
+{}
+
+PipelineCompiler::~PipelineCompiler()
+{
+  try {
+    wait();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Failed to wait for pipeline compiles:\n\t" << e.what() << "\n";
+  }
+
+  // Linked pipelines go before the libraries they were linked from
+  for (VkPipeline pipeline : _owned) {
+    vkDestroyPipeline(_device, pipeline, nullptr);
+  }
+  for (const Retired& retired : _retired) {
+    vkDestroyPipeline(_device, retired.pipeline, nullptr);
+  }
+  for (const auto& [key, library] : _parts) {
+    vkDestroyPipeline(_device, library, nullptr);
+  }
+}
+
+PipelineHandle PipelineCompiler::compile(GraphicsPipelineInfo info, PipelineHandle fallback)
+{
+  const uint64_t key = pipelineHash(info);
+  ++_tableRequests;
+  if (PipelineHandle found = find(key); found != nullptr && !found->isFailed()) {
+    ++_tableHits;
+    return found;
+  }
+
+  auto handle = std::make_shared<CompiledPipeline>(std::move(fallback));
+  // Another thread may have requested the same description meanwhile, its compile is the one that runs
+  if (PipelineHandle published = publish(key, handle); published != nullptr && published != handle) {
+    ++_tableHits;
+    return published;
+  }
+  auto job = std::make_shared<Job>(Job{.info = std::move(info), .handle = handle, .requested = std::chrono::steady_clock::now()});
+  ++_pending;
+  _arena.execute([this, &job] {
+    _tasks.run([this, job] {
+      try {
+        run(*job);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "Pipeline compile failed:\n\t" << e.what() << "\n";
+        job->handle->_failed = true;
+        ++_failures;
+      }
+      --_pending;
+    });
+  });
+  return handle;
+}
+
+VkPipeline PipelineCompiler::acquire(const PipelineHandle& handle)
+{
+  if (VkPipeline pipeline = handle->_pipeline; pipeline != nullptr) {
+    return pipeline;
+  }
+  if (VkPipeline fallback = handle->get(); fallback != nullptr) {
+    ++_fallbackUses;
+    return fallback;
+  }
+  ++_hitches;
+  return nullptr;
+}
+
+void PipelineCompiler::collect(uint64_t frame, uint32_t framesInFlight)
+{
+  _frame = frame;
+  const std::scoped_lock lock(_mutex);
+  std::erase_if(_retired, [&](const Retired& retired) {
+    if (retired.frame + framesInFlight > frame) {
+      return false;
+    }
+    vkDestroyPipeline(_device, retired.pipeline, nullptr);
+    return true;
+  });
+}
+
+void PipelineCompiler::wait()
+{
+  _arena.execute([this] { _tasks.wait(); });
+}
+
+bool PipelineCompiler::usesLibraries() const
+{
+  return _libraries;
+}
+
+uint64_t PipelineCompiler::getPending() const
+{
+  return _pending;
+}
+
+uint64_t PipelineCompiler::getCompiled() const
+{
+  return _compiled;
+}
+
+uint64_t PipelineCompiler::getLibraries() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _parts.size();
+}
+
+uint64_t PipelineCompiler::getFallbackUses() const
+{
+  return _fallbackUses;
+}
+
+uint64_t PipelineCompiler::getHitches() const
+{
+  return _hitches;
+}
+
+uint64_t PipelineCompiler::getFailures() const
+{
+  return _failures;
+}
+
+const utils::Samples& PipelineCompiler::getUsableTime() const
+{
+  return _usableTime;
+}
+
+const utils::Samples& PipelineCompiler::getOptimizedTime() const
+{
+  return _optimizedTime;
+}
+
+PipelineTableStats PipelineCompiler::getTableStats() const
+{
+  const uint64_t unique = _tableUnique;
+  return {
+      .requests = _tableRequests,
+      .hits = _tableHits,
+      .unique = unique,
+      .overflows = _tableOverflows,
+      .bytes = (_table.size() * sizeof(std::atomic<const TableEntry*>)) + (unique * (sizeof(TableEntry) + sizeof(CompiledPipeline))),
+  };
+}
+
+void PipelineCompiler::run(Job& job)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto elapsed = [&job] { return Milliseconds(std::chrono::steady_clock::now() - job.requested).count(); };
+  const PipelineState state(job.info, _rendering);
+  CompiledPipeline& handle = *job.handle;
+
+  if (!_libraries) {
+    VkPipeline pipeline = create(state.createInfo(state.renderingChain(), 0, 0, job.info.layout));
+    own(pipeline);
+    handle._pipeline = pipeline;
+    handle._optimized = true;
+    const double time = elapsed();
+    _usableTime.add(time);
+    _optimizedTime.add(time);
+    ++_compiled;
+    return;
+  }
+
+  std::array<VkPipeline, libraryParts.size()> libraries{};
+  for (size_t i = 0; i < libraryParts.size(); ++i) {
+    const VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = state.renderingChain(),
+        .flags = static_cast<VkGraphicsPipelineLibraryFlagsEXT>(libraryParts.at(i)),
+    };
+    const VkPipelineCreateFlags flags = static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) |
+                                        static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT);
+    libraries.at(i) = part(partKey(job.info, libraryParts.at(i)), state.createInfo(&libraryInfo, flags, libraryInfo.flags, job.info.layout));
+  }
+
+  // All state comes from the libraries, the link only names them
+  const VkPipelineLibraryCreateInfoKHR linkInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+      .pNext = nullptr,
+      .libraryCount = static_cast<uint32_t>(libraries.size()),
+      .pLibraries = libraries.data(),
+  };
+  VkGraphicsPipelineCreateInfo link{};
+  link.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  link.pNext = &linkInfo;
+  link.layout = job.info.layout;
+  link.basePipelineIndex = -1;
+
+  VkPipeline linked = create(link);
+  own(linked);
+  handle._pipeline = linked;
+  _usableTime.add(elapsed());
+
+  link.flags = static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT);
+  VkPipeline optimized = create(link);
+  own(optimized);
+  handle._pipeline = optimized;
+  handle._optimized = true;
+  retire(linked);
+  _optimizedTime.add(elapsed());
+  ++_compiled;
+}
+
+VkPipeline PipelineCompiler::create(const VkGraphicsPipelineCreateInfo& createInfo)
+{
+  VkPipelineCreationFeedback feedback{};
+  const VkPipelineCreationFeedbackCreateInfo feedbackInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+      .pNext = createInfo.pNext,
+      .pPipelineCreationFeedback = &feedback,
+      .pipelineStageCreationFeedbackCount = 0,
+      .pPipelineStageCreationFeedbacks = nullptr,
+  };
+  VkGraphicsPipelineCreateInfo info = createInfo;
+  if (_feedback) {
+    info.pNext = &feedbackInfo;
+  }
+
+  VkPipeline pipeline = nullptr;
+  if (const VkResult status = vkCreateGraphicsPipelines(_device, _cache.get(), 1, &info, nullptr, &pipeline); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create graphics pipeline! status: {}", utils::result(status)));
+  }
+  if (_feedback) {
+    _cache.record(feedback);
+  }
+  return pipeline;
+}
+
+VkPipeline PipelineCompiler::part(uint64_t key, const VkGraphicsPipelineCreateInfo& createInfo)
+{
+  {
+    const std::scoped_lock lock(_mutex);
+    if (const auto found = _parts.find(key); found != _parts.end()) {
+      return found->second;
+    }
+  }
+
+  // Two compiles may build the same part at once, the first one to finish is kept
+  VkPipeline library = create(createInfo);
+  const std::scoped_lock lock(_mutex);
+  const auto [found, inserted] = _parts.try_emplace(key, library);
+  if (!inserted) {
+    vkDestroyPipeline(_device, library, nullptr);
+  }
+  return found->second;
+}
+
+void PipelineCompiler::own(VkPipeline pipeline)
+{
+  const std::scoped_lock lock(_mutex);
+  _owned.push_back(pipeline);
+}
+
+void PipelineCompiler::retire(VkPipeline pipeline)
+{
+  // Frames starting after the swap above bind the replacement, the frame being recorded may still bind this one
+  const uint64_t frame = _frame;
+  const std::scoped_lock lock(_mutex);
+  std::erase(_owned, pipeline);
+  _retired.push_back({.pipeline = pipeline, .frame = frame});
+}
+
+PipelineHandle PipelineCompiler::publish(uint64_t key, const PipelineHandle& handle)
+{
+  auto entry = std::make_unique<TableEntry>(TableEntry{.key = key, .handle = handle});
+  for (size_t probe = 0; probe < _table.size(); ++probe) {
+    std::atomic<const TableEntry*>& slot = _table.at((key + probe) & (_table.size() - 1));
+    const TableEntry* current = slot.load(std::memory_order_acquire);
+    while (current == nullptr || (current->key == key && current->handle->isFailed())) {
+      const bool replaces = current != nullptr;
+      if (slot.compare_exchange_weak(current, entry.get(), std::memory_order_release, std::memory_order_acquire)) {
+        if (!replaces) {
+          ++_tableUnique;
+        }
+        const std::scoped_lock lock(_mutex);
+        return _entries.emplace_back(std::move(entry))->handle;
+      }
+    }
+    if (current->key == key) {
+      return current->handle;
+    }
+  }
+  ++_tableOverflows;
+  return nullptr;
+}
+
+PipelineHandle PipelineCompiler::find(uint64_t key) const
+{
+  for (size_t probe = 0; probe < _table.size(); ++probe) {
+    const TableEntry* entry = _table.at((key + probe) & (_table.size() - 1)).load(std::memory_order_acquire);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    if (entry->key == key) {
+      return entry->handle;
+    }
+  }
+  return nullptr;
+}
+}  // namespace vulkan
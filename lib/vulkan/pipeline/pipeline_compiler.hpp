@@ -0,0 +1,199 @@
+#ifndef LIB_VULKAN_PIPELINE_PIPELINE_COMPILER
+#define LIB_VULKAN_PIPELINE_PIPELINE_COMPILER
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "pipeline_cache.hpp"
+#include "rendering/rendering.hpp"
+#include "stats/samples.hpp"
+
+namespace vulkan {
+struct ShaderStage {
+  VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+  VkShaderModule module = nullptr;
+  std::string entry = "main";
+  // Content hash of the code (ShaderModule::getHash), 0 identifies the stage by its module handle instead
+  uint64_t hash = 0;
+  // Specialization constants, entries point into data
+  std::vector<VkSpecializationMapEntry> specialization = {};
+  std::vector<std::byte> specializationData = {};
+};
+
+// Owned description of a graphics pipeline, compiles outlive the caller. Viewport and scissor are always dynamic
+struct GraphicsPipelineInfo {
+  VkPipelineLayout layout = nullptr;
+  // Vertex and optionally fragment stage, modules have to live until the compile is done
+  std::vector<ShaderStage> stages;
+  std::vector<VkVertexInputBindingDescription> bindings;
+  std::vector<VkVertexInputAttributeDescription> attributes;
+  VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+  VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+  VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  bool depthTest = false;
+  bool depthWrite = false;
+  VkCompareOp depthCompare = VK_COMPARE_OP_GREATER_OR_EQUAL;
+  bool blend = false;
+  RenderFormats formats;
+};
+
+struct PipelineTableStats {
+  uint64_t requests = 0;
+  uint64_t hits = 0;
+  uint64_t unique = 0;
+  // Requests compiled without an entry because the table was full
+  uint64_t overflows = 0;
+  // Table, entries and handles, the driver side of the pipelines is not included
+  size_t bytes = 0;
+};
+
+// 64 bit FNV-1a of every field that ends up in the pipeline. The layout goes in by handle, equal descriptions only hash
+// the same within one process whose layouts come from the LayoutCache, the value must not be persisted
+[[nodiscard]] uint64_t pipelineHash(const GraphicsPipelineInfo& info);
+
+// Result of an asynchronous compile, resolves to the fallback until the compiled pipeline exists
+class CompiledPipeline {
+public:
+  CompiledPipeline(const CompiledPipeline&) = delete;
+  CompiledPipeline(CompiledPipeline&&) = delete;
+  CompiledPipeline& operator=(const CompiledPipeline&) = delete;
+  CompiledPipeline& operator=(CompiledPipeline&&) = delete;
+
+  explicit CompiledPipeline(std::shared_ptr<const CompiledPipeline> fallback);
+  ~CompiledPipeline() = default;
+
+  // Best pipeline available now, null when neither this one nor its fallback is usable yet
+  [[nodiscard]] VkPipeline get() const;
+  // True once a pipeline of its own is usable, linked from libraries or fully compiled
+  [[nodiscard]] bool isUsable() const;
+  // True once the final, optimized pipeline replaced everything else
+  [[nodiscard]] bool isOptimized() const;
+  // True when the compile threw, the handle never gets optimized and compiling the description again replaces it
+  [[nodiscard]] bool isFailed() const;
+
+private:
+  friend class PipelineCompiler;
+
+  std::shared_ptr<const CompiledPipeline> _fallback;
+  std::atomic<VkPipeline> _pipeline = nullptr;
+  std::atomic<bool> _optimized = false;
+  std::atomic<bool> _failed = false;
+};
+
+using PipelineHandle = std::shared_ptr<const CompiledPipeline>;
+
+// Compiles graphics pipelines on TBB workers. With VK_EXT_graphics_pipeline_library the four stages are built as
+// libraries cached by their own state, a fast link makes the pipeline usable and a link time optimized one replaces it
+class PipelineCompiler {
+public:
+  PipelineCompiler(const PipelineCompiler&) = delete;
+  PipelineCompiler(PipelineCompiler&&) = delete;
+  PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+  PipelineCompiler& operator=(PipelineCompiler&&) = delete;
+
+  // Threads 0 uses every hardware thread
+  explicit PipelineCompiler(const VulkanDevice& device, Rendering& rendering, uint32_t threads = 0);
+  // Waits for running compiles, replaced pipelines are only destroyed here as frames in flight may still use them
+  ~PipelineCompiler();
+
+  // Returns at once, the fallback (e.g. a simpler pipeline compiled earlier) stands in until the result is usable.
+  // A description hashing the same as an earlier one returns the earlier handle without compiling, fallback unused.
+  // An earlier handle whose compile failed is replaced by a new compile instead
+  [[nodiscard]] PipelineHandle compile(GraphicsPipelineInfo info, PipelineHandle fallback = nullptr);
+  // Pipeline to bind for this frame, counts fallback uses and frames where nothing can be drawn
+  [[nodiscard]] VkPipeline acquire(const PipelineHandle& handle);
+  // Called before acquiring the pipelines of a frame, once frame - framesInFlight is done on the device. Destroys the
+  // pipelines superseded while older frames were recorded, e.g. fast linked ones replaced by their optimized pipeline
+  void collect(uint64_t frame, uint32_t framesInFlight);
+  void wait();
+
+  [[nodiscard]] bool usesLibraries() const;
+  [[nodiscard]] uint64_t getPending() const;
+  [[nodiscard]] uint64_t getCompiled() const;
+  [[nodiscard]] uint64_t getLibraries() const;
+  [[nodiscard]] uint64_t getFallbackUses() const;
+  // Acquires that found no usable pipeline, each one is a draw the frame had to skip
+  [[nodiscard]] uint64_t getHitches() const;
+  // Compiles that threw, their handles are marked failed
+  [[nodiscard]] uint64_t getFailures() const;
+  // Request until usable and until optimized, in milliseconds
+  [[nodiscard]] const utils::Samples& getUsableTime() const;
+  [[nodiscard]] const utils::Samples& getOptimizedTime() const;
+  [[nodiscard]] PipelineTableStats getTableStats() const;
+
+private:
+  struct Job;
+
+  // Never changed once published, the handle stays valid as long as the compiler. A slot only moves on to another entry
+  // when the compile of its handle failed, the replaced entry stays owned for lookups still holding it
+  struct TableEntry {
+    uint64_t key;
+    PipelineHandle handle;
+  };
+
+  struct Retired {
+    VkPipeline pipeline;
+    // Last frame that may still bind it
+    uint64_t frame;
+  };
+
+  // Open addressing over the description hash, lookups only load atomics. Power of two
+  static constexpr size_t tableCapacity = 4096;
+
+  VkDevice _device;
+  Rendering& _rendering;
+  PipelineCache& _cache;
+  bool _libraries;
+  bool _feedback;
+
+  mutable std::mutex _mutex;
+  std::unordered_map<uint64_t, VkPipeline> _parts;
+  std::vector<VkPipeline> _owned;
+  std::vector<Retired> _retired;
+  std::atomic<uint64_t> _frame = 0;
+
+  std::vector<std::atomic<const TableEntry*>> _table;
+  // Owns what the table points to, only touched on publish
+  std::vector<std::unique_ptr<TableEntry>> _entries;
+  std::atomic<uint64_t> _tableRequests = 0;
+  std::atomic<uint64_t> _tableHits = 0;
+  std::atomic<uint64_t> _tableUnique = 0;
+  std::atomic<uint64_t> _tableOverflows = 0;
+
+  std::atomic<uint64_t> _pending = 0;
+  std::atomic<uint64_t> _compiled = 0;
+  std::atomic<uint64_t> _fallbackUses = 0;
+  std::atomic<uint64_t> _hitches = 0;
+  std::atomic<uint64_t> _failures = 0;
+  utils::Samples _usableTime;
+  utils::Samples _optimizedTime;
+
+  // Declared last, tasks still running use everything above
+  tbb::task_arena _arena;
+  tbb::task_group _tasks;
+
+  void run(Job& job);
+  [[nodiscard]] VkPipeline create(const VkGraphicsPipelineCreateInfo& createInfo);
+  [[nodiscard]] VkPipeline part(uint64_t key, const VkGraphicsPipelineCreateInfo& createInfo);
+  void own(VkPipeline pipeline);
+  void retire(VkPipeline pipeline);
+  // Handle stored under key, the given one unless another thread published first or only a failed one was stored.
+  // Null when the table is full
+  [[nodiscard]] PipelineHandle publish(uint64_t key, const PipelineHandle& handle);
+  [[nodiscard]] PipelineHandle find(uint64_t key) const;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_PIPELINE_PIPELINE_COMPILER */
@@ -0,0 +1,203 @@
+#include "capture.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vulkan {
+struct Rgb {
+  int red;
+  int green;
+  int blue;
+};
+
+static Rgb pixel(const CaptureFrame& frame, size_t index)
+{
+  const auto channel = [&](size_t offset) { return std::to_integer<int>(frame.pixels[(index * 4) + offset]); };
+  return frame.bgra ? Rgb{.red = channel(2), .green = channel(1), .blue = channel(0)}
+                    : Rgb{.red = channel(0), .green = channel(1), .blue = channel(2)};
+}
+
+static char toChar(int value)
+{
+  return static_cast<char>(static_cast<unsigned char>(value));
+}
+
+Capture::Capture(std::filesystem::path path, uint32_t fps) : _path(std::move(path)), _fps(fps), _y4m(_path.extension() == ".y4m")
+{
+  if (_path.has_parent_path()) {
+    std::filesystem::create_directories(_path.parent_path());
+  }
+  if (_y4m) {
+    _stream.open(_path, std::ios::binary | std::ios::trunc);
+    if (!_stream) {
+      throw std::runtime_error(std::format("Failed to open capture stream {}", _path.string()));
+    }
+  }
+
+  _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+}
+
+Capture::~Capture()
+{
+  // Frames already queued are still written
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+void Capture::push(CaptureFrame frame)
+{
+  {
+    std::unique_lock lock(_mutex);
+    _taken.wait(lock, [this] { return _queue.size() < queueLimit; });
+    _queue.push_back(std::move(frame));
+  }
+  _queued.notify_one();
+}
+
+const std::filesystem::path& Capture::getPath() const
+{
+  return _path;
+}
+
+uint64_t Capture::getFrames() const
+{
+  return _frames;
+}
+
+uint64_t Capture::getDropped() const
+{
+  return _dropped;
+}
+
+double Capture::getFps() const
+{
+  using Seconds = std::chrono::duration<double>;
+  const auto elapsed = Seconds(std::chrono::steady_clock::duration(_last - _first)).count();
+  return elapsed > 0 && _frames > 1 ? static_cast<double>(_frames - 1) / elapsed : 0.0;
+}
+
+const utils::Samples& Capture::getWriteTime() const
+{
+  return _writeTime;
+}
+
+void Capture::loop(const std::stop_token& token)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  try {
+    while (true) {
+      CaptureFrame frame;
+      {
+        std::unique_lock lock(_mutex);
+        _queued.wait(lock, token, [this] { return !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        frame = std::move(_queue.front());
+        _queue.pop_front();
+      }
+      _taken.notify_one();
+
+      const auto start = std::chrono::steady_clock::now();
+      write(frame);
+      const auto end = std::chrono::steady_clock::now();
+      _writeTime.add(Milliseconds(end - start).count());
+
+      if (_frames++ == 0) {
+        _first = end.time_since_epoch().count();
+      }
+      _last = end.time_since_epoch().count();
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << std::format("Capture to {} stopped:\n\t{}\n", _path.string(), e.what());
+  }
+
+  // Nobody drains the queue anymore, producers must not block forever
+  const std::scoped_lock lock(_mutex);
+  _dropped += _queue.size();
+  _queue.clear();
+  _taken.notify_all();
+}
+
+void Capture::write(const CaptureFrame& frame)
+{
+  if (frame.pixels.size() < static_cast<size_t>(frame.width) * frame.height * 4) {
+    throw std::runtime_error(std::format("Capture frame {}x{} has only {} bytes", frame.width, frame.height, frame.pixels.size()));
+  }
+  if (_y4m) {
+    writeY4m(frame);
+  }
+  else {
+    writePpm(frame);
+  }
+}
+
+void Capture::writeY4m(const CaptureFrame& frame)
+{
+  if (_width == 0) {
+    _width = frame.width;
+    _height = frame.height;
+    _stream << std::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", _width, _height, _fps);
+  }
+  if (frame.width != _width || frame.height != _height) {
+    // A Y4M stream has a single resolution, resized frames are skipped
+    ++_dropped;
+    return;
+  }
+
+  // BT.601 limited range, all three planes at full resolution
+  const size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+  std::string planes(pixels * 3, '\0');
+  for (size_t i = 0; i < pixels; ++i) {
+    const auto [red, green, blue] = pixel(frame, i);
+    planes[i] = toChar((((66 * red) + (129 * green) + (25 * blue) + 128) >> 8) + 16);
+    planes[pixels + i] = toChar((((-38 * red) - (74 * green) + (112 * blue) + 128) >> 8) + 128);
+    planes[(2 * pixels) + i] = toChar((((112 * red) - (94 * green) - (18 * blue) + 128) >> 8) + 128);
+  }
+
+  _stream << "FRAME\n";
+  _stream.write(planes.data(), static_cast<std::streamsize>(planes.size()));
+  if (!_stream) {
+    throw std::runtime_error(std::format("Failed to write capture stream {}", _path.string()));
+  }
+}
+
+void Capture::writePpm(const CaptureFrame& frame)
+{
+  const auto name = std::format("{}_{:06}.ppm", _path.stem().string(), _frames.load());
+  const auto file = _path.parent_path() / name;
+
+  const size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+  std::string data = std::format("P6\n{} {}\n255\n", frame.width, frame.height);
+  const size_t header = data.size();
+  data.resize(header + (pixels * 3));
+  for (size_t i = 0; i < pixels; ++i) {
+    const auto [red, green, blue] = pixel(frame, i);
+    data[header + (i * 3)] = toChar(red);
+    data[header + (i * 3) + 1] = toChar(green);
+    data[header + (i * 3) + 2] = toChar(blue);
+  }
+
+  std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+  stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to write capture frame {}", file.string()));
+  }
+}
+}  // namespace vulkan
@@ -0,0 +1,79 @@
+#ifndef LIB_VULKAN_READBACK_CAPTURE
+#define LIB_VULKAN_READBACK_CAPTURE
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "stats/samples.hpp"
+
+namespace vulkan {
+struct CaptureFrame {
+  std::vector<std::byte> pixels;  // Tightly packed 4 bytes per pixel
+  uint32_t width = 0;
+  uint32_t height = 0;
+  bool bgra = false;
+};
+
+// Streams frames to disk from its own thread: *.y4m appends every frame to one 4:4:4 stream, any other path writes numbered PPM files
+class Capture {
+public:
+  static constexpr size_t queueLimit = 8;
+
+  Capture(const Capture&) = delete;
+  Capture(Capture&&) = delete;
+  Capture& operator=(const Capture&) = delete;
+  Capture& operator=(Capture&&) = delete;
+
+  explicit Capture(std::filesystem::path path, uint32_t fps = 60);
+  ~Capture();
+
+  // Blocks while queueLimit frames wait for the writer, back pressure reaches the readback ring
+  void push(CaptureFrame frame);
+
+  [[nodiscard]] const std::filesystem::path& getPath() const;
+  [[nodiscard]] uint64_t getFrames() const;
+  [[nodiscard]] uint64_t getDropped() const;
+  // Frames written per second of wall time since the first frame
+  [[nodiscard]] double getFps() const;
+  // Conversion and write time of one frame, in milliseconds
+  [[nodiscard]] const utils::Samples& getWriteTime() const;
+
+private:
+  std::filesystem::path _path;
+  uint32_t _fps;
+  bool _y4m;
+  std::ofstream _stream;
+  uint32_t _width = 0;
+  uint32_t _height = 0;
+
+  std::mutex _mutex;
+  std::condition_variable_any _queued;
+  std::condition_variable _taken;
+  std::deque<CaptureFrame> _queue;
+
+  std::atomic<uint64_t> _frames = 0;
+  std::atomic<uint64_t> _dropped = 0;
+  std::atomic<std::chrono::steady_clock::rep> _first = 0;
+  std::atomic<std::chrono::steady_clock::rep> _last = 0;
+  utils::Samples _writeTime;
+
+  std::jthread _thread;
+
+  void loop(const std::stop_token& token);
+  void write(const CaptureFrame& frame);
+  void writeY4m(const CaptureFrame& frame);
+  void writePpm(const CaptureFrame& frame);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_READBACK_CAPTURE */
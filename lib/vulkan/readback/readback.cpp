@@ -0,0 +1,414 @@
+#include "readback.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/buffer.hpp"
+
+namespace vulkan {
+// The worker wakes up regularly so a stop request is never missed while the device is busy
+static constexpr uint64_t pollTimeout = 100'000'000;  // 100ms
+
+static VkDeviceSize stagingAlignment(const VulkanDevice& device)
+{
+  // Copy offsets must be a multiple of 4 and of the texel size, invalidation works on whole atoms
+  const auto& limits = device.getData().properties.limits;
+  static constexpr VkDeviceSize minAlignment = 16;
+  return std::max({minAlignment, limits.nonCoherentAtomSize, limits.optimalBufferCopyOffsetAlignment});
+}
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+  return ((value + alignment - 1) / alignment) * alignment;
+}
+
+static BufferInfo stagingInfo(VkDeviceSize capacity, VkDeviceSize alignment)
+{
+  return {.size = alignUp(capacity, alignment),
+          .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          .required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+          .preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT};
+}
+
+static VkCommandPool createPool(VkDevice device, uint32_t family)
+{
+  const VkCommandPoolCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = static_cast<uint32_t>(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) | static_cast<uint32_t>(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+      .queueFamilyIndex = family,
+  };
+
+  VkCommandPool pool = nullptr;
+  if (const VkResult status = vkCreateCommandPool(device, &createInfo, nullptr, &pool); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create readback command pool! status: {}", utils::result(status)));
+  }
+  return pool;
+}
+
+Readback::Readback(const VulkanDevice& device, uint32_t family, VkDeviceSize capacity)
+    : _owner(device),
+      _device(device.get()),
+      _queue(device.getQueue()),
+      _family(family),
+      _alignment(stagingAlignment(device)),
+      _staging(device, stagingInfo(capacity, _alignment)),
+      _timeline(_device),
+      _pool(createPool(_device, _family))
+{
+  _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+}
+
+Readback::~Readback()
+{
+  // The worker drains every submitted request before it returns
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+  vkDestroyCommandPool(_device, _pool, nullptr);
+}
+
+uint32_t Readback::transferFamily(const VulkanDevice& device)
+{
+  // Sorted from the most dedicated family, graphics families can always copy even without the transfer bit
+  const auto& queue = device.getQueue();
+  if (!queue.getTransfer().empty()) {
+    return queue.getTransfer().front();
+  }
+  if (!queue.getGraphics().empty()) {
+    return queue.getGraphics().front();
+  }
+  throw std::runtime_error("Device has no queue family able to copy");
+}
+
+std::future<Readback::Data> Readback::read(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const ReadbackSync& sync, Callback callback)
+{
+  return submit(size, sync, std::move(callback), [buffer, offset, size](VkCommandBuffer cmd, VkBuffer staging, VkDeviceSize stagingOffset) {
+    // Writes ordered before this submission on the same queue become visible to the copy
+    const VkMemoryBarrier before{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &before, 0, nullptr, 0, nullptr);
+
+    const VkBufferCopy region{.srcOffset = offset, .dstOffset = stagingOffset, .size = size};
+    vkCmdCopyBuffer(cmd, buffer, staging, 1, &region);
+  });
+}
+
+std::future<Readback::Data> Readback::read(const ReadbackImage& image, const ReadbackSync& sync, Callback callback)
+{
+  const VkDeviceSize size = static_cast<VkDeviceSize>(image.extent.width) * image.extent.height * image.texelSize;
+  return submit(size, sync, std::move(callback), [image](VkCommandBuffer cmd, VkBuffer staging, VkDeviceSize stagingOffset) {
+    const VkImageSubresourceRange range{.aspectMask = image.aspect, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1};
+    const bool transition = image.layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && image.layout != VK_IMAGE_LAYOUT_GENERAL;
+    const VkImageLayout copyLayout = transition ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : image.layout;
+
+    const VkImageMemoryBarrier before{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout = image.layout,
+        .newLayout = copyLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image.image,
+        .subresourceRange = range,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &before);
+
+    const VkBufferImageCopy region{
+        .bufferOffset = stagingOffset,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = image.aspect, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1},
+        .imageOffset = {.x = image.offset.x, .y = image.offset.y, .z = 0},
+        .imageExtent = {.width = image.extent.width, .height = image.extent.height, .depth = 1},
+    };
+    vkCmdCopyImageToBuffer(cmd, image.image, copyLayout, staging, 1, &region);
+
+    if (image.finalLayout != copyLayout) {
+      const VkImageMemoryBarrier after{
+          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .pNext = nullptr,
+          .srcAccessMask = 0,
+          .dstAccessMask = 0,
+          .oldLayout = copyLayout,
+          .newLayout = image.finalLayout,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image = image.image,
+          .subresourceRange = range,
+      };
+      vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &after);
+    }
+  });
+}
+
+void Readback::resize(VkDeviceSize capacity)
+{
+  std::unique_lock lock(_mutex);
+  _released.wait(lock, [this] { return _failure != nullptr || _pending.empty(); });
+  if (_failure != nullptr) {
+    std::rethrow_exception(_failure);
+  }
+  if (alignUp(capacity, _alignment) != _staging.getSize()) {
+    _staging = Buffer(_owner, stagingInfo(capacity, _alignment));
+    _head = 0;
+  }
+}
+
+VkDeviceSize Readback::getCapacity() const
+{
+  return _staging.getSize();
+}
+
+const utils::Samples& Readback::getLatency() const
+{
+  return _latency;
+}
+
+uint64_t Readback::getBytes() const
+{
+  return _bytes;
+}
+
+std::future<Readback::Data> Readback::submit(VkDeviceSize size,
+                                             const ReadbackSync& sync,
+                                             Callback callback,
+                                             const std::function<void(VkCommandBuffer, VkBuffer, VkDeviceSize)>& record)
+{
+  const VkDeviceSize reserved = alignUp(size, _alignment);
+
+  // Held until the submission is done, timeline values have to reach the queue in the order they are handed out
+  std::unique_lock lock(_mutex);
+  if (size == 0 || reserved > _staging.getSize()) {
+    throw std::runtime_error(std::format("Readback of {} bytes does not fit the {} bytes staging ring", size, _staging.getSize()));
+  }
+  std::optional<VkDeviceSize> offset;
+  _released.wait(lock, [&] {
+    if (_failure != nullptr) {
+      return true;
+    }
+    offset = reserve(reserved);
+    return offset.has_value();
+  });
+  if (_failure != nullptr) {
+    std::rethrow_exception(_failure);
+  }
+
+  VkCommandBuffer cmd = acquireCommandBuffer();
+  try {
+    const VkCommandBufferBeginInfo beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = nullptr,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr,
+    };
+    if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to begin readback command buffer! status: {}", utils::result(status)));
+    }
+
+    record(cmd, _staging.get(), *offset);
+
+    const VkMemoryBarrier toHost{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = nullptr,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &toHost, 0, nullptr, 0, nullptr);
+
+    if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to end readback command buffer! status: {}", utils::result(status)));
+    }
+
+    const uint64_t value = _timeline.next();
+    const std::array<VkSemaphore, 2> signals = {_timeline.get(), sync.signal};
+    const std::array<uint64_t, 2> signalValues = {value, 0};  // Ignored for the binary semaphore
+    const uint32_t signalCount = sync.signal != nullptr ? 2 : 1;
+    const uint64_t waitValue = 0;
+
+    const VkTimelineSemaphoreSubmitInfo timelineInfo{
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = nullptr,
+        .waitSemaphoreValueCount = sync.wait != nullptr ? 1U : 0U,
+        .pWaitSemaphoreValues = &waitValue,
+        .signalSemaphoreValueCount = signalCount,
+        .pSignalSemaphoreValues = signalValues.data(),
+    };
+    const VkSubmitInfo submitInfo{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = sync.wait != nullptr ? 1U : 0U,
+        .pWaitSemaphores = &sync.wait,
+        .pWaitDstStageMask = &sync.waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &cmd,
+        .signalSemaphoreCount = signalCount,
+        .pSignalSemaphores = signals.data(),
+    };
+    _queue.submit(_family, {&submitInfo, 1}, nullptr);
+
+    _head = *offset + reserved;
+    auto& pending = _pending.emplace_back(value, *offset, size, cmd, std::promise<Data>(), std::move(callback), std::chrono::steady_clock::now());
+    auto future = pending.promise.get_future();
+
+    lock.unlock();
+    _submitted.notify_one();
+    return future;
+  }
+  catch (...) {
+    // May still be recording, freed instead of going back to the free list
+    vkFreeCommandBuffers(_device, _pool, 1, &cmd);
+    throw;
+  }
+}
+
+std::optional<VkDeviceSize> Readback::reserve(VkDeviceSize size) const
+{
+  // Requests retire in submission order, so the live region is always [tail, head) possibly wrapped around the end
+  const VkDeviceSize capacity = _staging.getSize();
+  if (_pending.empty()) {
+    return size <= capacity ? std::optional<VkDeviceSize>(0) : std::nullopt;
+  }
+
+  const VkDeviceSize tail = _pending.front().offset;
+  if (_head > tail) {
+    if (_head + size <= capacity) {
+      return _head;
+    }
+    // Strict compare keeps head != tail, which would be ambiguous with an empty ring
+    return size < tail ? std::optional<VkDeviceSize>(0) : std::nullopt;
+  }
+  return _head + size < tail ? std::optional<VkDeviceSize>(_head) : std::nullopt;
+}
+
+VkCommandBuffer Readback::acquireCommandBuffer()
+{
+  if (!_free.empty()) {
+    VkCommandBuffer cmd = _free.back();
+    _free.pop_back();
+    return cmd;
+  }
+
+  const VkCommandBufferAllocateInfo allocateInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .commandPool = _pool,
+      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .commandBufferCount = 1,
+  };
+  VkCommandBuffer cmd = nullptr;
+  if (const VkResult status = vkAllocateCommandBuffers(_device, &allocateInfo, &cmd); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to allocate readback command buffer! status: {}", utils::result(status)));
+  }
+  return cmd;
+}
+
+void Readback::loop(const std::stop_token& token)
+{
+  try {
+    while (true) {
+      Pending* oldest = nullptr;
+      {
+        std::unique_lock lock(_mutex);
+        _submitted.wait(lock, token, [this] { return !_pending.empty(); });
+        if (_pending.empty()) {
+          return;  // Stop requested and everything drained
+        }
+        // Only this thread pops, references into a deque survive push_back
+        oldest = &_pending.front();
+      }
+
+      if (_timeline.wait(oldest->value, pollTimeout)) {
+        complete(*oldest);
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << std::format("Readback thread stopped:\n\t{}\n", e.what());
+    fail(std::current_exception());
+  }
+}
+
+void Readback::complete(Pending& pending)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+
+  _staging.invalidate(pending.offset, pending.size);
+  Data data(pending.size);
+  std::memcpy(data.data(), _staging.getMapped() + pending.offset, pending.size);
+
+  _latency.add(Milliseconds(std::chrono::steady_clock::now() - pending.submitted).count());
+  _bytes += pending.size;
+
+  std::promise<Data> promise;
+  Callback callback;
+  {
+    // The copy is out of the ring, the slot and command buffer can be reused. A failed reset leaves the request
+    // pending, fail() still owns its promise
+    const std::scoped_lock lock(_mutex);
+    if (const VkResult status = vkResetCommandBuffer(pending.cmd, 0); status != VK_SUCCESS) {
+      throw std::runtime_error(std::format("Failed to reset readback command buffer! status: {}", utils::result(status)));
+    }
+    promise = std::move(pending.promise);
+    callback = std::move(pending.callback);
+    _free.push_back(pending.cmd);
+    _pending.pop_front();
+  }
+  _released.notify_all();
+
+  if (callback) {
+    try {
+      callback(std::move(data));
+    }
+    catch (...) {
+      promise.set_exception(std::current_exception());
+      return;
+    }
+    promise.set_value({});
+  }
+  else {
+    promise.set_value(std::move(data));
+  }
+}
+
+void Readback::fail(std::exception_ptr failure)
+{
+  // Nobody retires requests anymore, waiting producers and futures get the error instead of blocking forever
+  std::deque<Pending> pending;
+  {
+    const std::scoped_lock lock(_mutex);
+    _failure = failure;
+    pending.swap(_pending);
+  }
+  _released.notify_all();
+  for (auto& request : pending) {
+    request.promise.set_exception(failure);
+  }
+}
+}  // namespace vulkan
@@ -0,0 +1,125 @@
+#ifndef LIB_VULKAN_READBACK_READBACK
+#define LIB_VULKAN_READBACK_READBACK
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "device/queue.hpp"
+#include "memory/buffer.hpp"
+#include "stats/samples.hpp"
+#include "sync/timeline.hpp"
+
+namespace vulkan {
+struct ReadbackImage {
+  VkImage image = nullptr;
+  // Current layout (never UNDEFINED) and the layout the image is left in after the copy
+  VkImageLayout layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  VkImageLayout finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+  VkOffset2D offset = {.x = 0, .y = 0};
+  VkExtent2D extent = {.width = 0, .height = 0};
+  uint32_t texelSize = 4;
+};
+
+// Binary semaphores chaining the copy into other submissions, e.g. between rendering and present
+struct ReadbackSync {
+  VkSemaphore wait = nullptr;
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkSemaphore signal = nullptr;
+};
+
+// Copies device data into a persistently mapped staging ring and hands it to the host once the timeline passes.
+// Resources have to be owned by (or shared with) the queue family the readback submits to.
+class Readback {
+public:
+  using Data = std::vector<std::byte>;
+  // Runs on the readback thread, the future of a request with callback resolves to an empty vector
+  using Callback = std::function<void(Data&&)>;
+
+  static constexpr VkDeviceSize defaultCapacity = 64ULL * 1024ULL * 1024ULL;  // 64MB
+
+  Readback(const Readback&) = delete;
+  Readback(Readback&&) = delete;
+  Readback& operator=(const Readback&) = delete;
+  Readback& operator=(Readback&&) = delete;
+
+  explicit Readback(const VulkanDevice& device, uint32_t family, VkDeviceSize capacity = defaultCapacity);
+  ~Readback();
+
+  // Most dedicated family able to copy, a transfer only family when the device has one
+  [[nodiscard]] static uint32_t transferFamily(const VulkanDevice& device);
+
+  // Both block while the staging ring has no room for the request, throw once the readback thread has stopped
+  std::future<Data> read(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const ReadbackSync& sync = {}, Callback callback = {});
+  std::future<Data> read(const ReadbackImage& image, const ReadbackSync& sync = {}, Callback callback = {});
+
+  // Waits for every request in flight and reallocates the staging ring, e.g. once a captured swapchain grew
+  void resize(VkDeviceSize capacity);
+
+  [[nodiscard]] VkDeviceSize getCapacity() const;
+  // Submit to host visible, in milliseconds
+  [[nodiscard]] const utils::Samples& getLatency() const;
+  [[nodiscard]] uint64_t getBytes() const;
+
+private:
+  struct Pending {
+    uint64_t value;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    VkCommandBuffer cmd;
+    std::promise<Data> promise;
+    Callback callback;
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  const VulkanDevice& _owner;
+  VkDevice _device;
+  Queue& _queue;
+  uint32_t _family;
+  VkDeviceSize _alignment;
+  Buffer _staging;
+  Timeline _timeline;
+  VkCommandPool _pool = nullptr;
+
+  std::mutex _mutex;
+  std::condition_variable _released;
+  std::condition_variable_any _submitted;
+  std::deque<Pending> _pending;
+  std::vector<VkCommandBuffer> _free;
+  VkDeviceSize _head = 0;
+  // Set when the readback thread stopped on an error, every later request fails with it
+  std::exception_ptr _failure;
+
+  utils::Samples _latency;
+  std::atomic<uint64_t> _bytes = 0;
+
+  std::jthread _thread;
+
+  std::future<Data> submit(VkDeviceSize size,
+                           const ReadbackSync& sync,
+                           Callback callback,
+                           const std::function<void(VkCommandBuffer, VkBuffer, VkDeviceSize)>& record);
+  [[nodiscard]] std::optional<VkDeviceSize> reserve(VkDeviceSize size) const;
+  [[nodiscard]] VkCommandBuffer acquireCommandBuffer();
+  void loop(const std::stop_token& token);
+  void complete(Pending& pending);
+  void fail(std::exception_ptr failure);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_READBACK_READBACK */
@@ -0,0 +1,677 @@
+#include "render_thread.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command/command_pools.hpp"
+#include "command/parallel_recorder.hpp"
+#include "command/record_benchmark.hpp"
+#include "compute/async_compute.hpp"
+#include "compute/compute_primitives.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "debug.hpp"
+#include "format/logtime.hpp"
+#include "format/string.hpp"
+#include "graph/render_graph.hpp"
+#include "memory/buffer.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "readback/capture.hpp"
+#include "readback/readback.hpp"
+#include "rendering/rendering.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/shader_variants.hpp"
+#include "shader/shader_watcher.hpp"
+#include "shader/specialization.hpp"
+#include "sync/timeline.hpp"
+#include "window/window_info.hpp"
+
+namespace vulkan {
+// Acquire must not block forever, otherwise a minimized window could never be joined
+static constexpr uint64_t acquireTimeout = 100'000'000;  // 100ms
+static constexpr auto minimizedSleep = std::chrono::milliseconds(50);
+// Async compute workload, one reduction over this many bytes per frame
+static constexpr VkDeviceSize computeScratchSize = 16ULL * 1024ULL * 1024ULL;  // 16MB
+static constexpr uint64_t computeTimeout = 10'000'000'000;                     // 10s
+static constexpr std::string_view triangleVertex = "triangle.vert";
+static constexpr std::string_view triangleFragment = "triangle.frag";
+// ENCODE_SRGB_ID of shader/glsl/common.glsl
+using TriangleConstants = Specialization<SpecConstant<0, "encodeSrgb", bool>>;
+
+// Room for every frame in flight plus the one being copied out
+static VkDeviceSize captureCapacity(VkExtent2D extent)
+{
+  return static_cast<VkDeviceSize>(extent.width) * extent.height * 4 * (RenderThread::framesInFlight + 1);
+}
+
+static uint32_t presentFamily(const VulkanDevice& device)
+{
+  const auto& graphics = device.getQueue().getGraphics();
+  if (graphics.empty()) {
+    throw std::runtime_error("Device has no queue family able to render and present");
+  }
+  return graphics.front();
+}
+
+static VkSemaphore createSemaphore(VkDevice device)
+{
+  const VkSemaphoreCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = nullptr, .flags = 0};
+
+  VkSemaphore semaphore = nullptr;
+  if (const VkResult status = vkCreateSemaphore(device, &createInfo, nullptr, &semaphore); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create semaphore! status: {}", utils::result(status)));
+  }
+  return semaphore;
+}
+
+RenderThread::RenderThread(const VulkanDevice& device, VkSurfaceKHR surface, const WindowInfo& info)
+    : _device(device.get()),
+      _queue(device.getQueue()),
+      _layouts(device.getLayoutCache()),
+      _family(presentFamily(device)),
+      _name(info.title),
+      _clearColor(info.clearColor),
+      _passes(std::max(info.passes, 1U)),
+      _draws(info.draws),
+      _swapchain(device, surface, info),
+      _rendering(device, info.renderPath),
+      _graph(device, framesInFlight + 2),
+      _frameTimeline(_device),
+      _commands(device, framesInFlight),
+      _recorder(_commands, _family, info.recordThreads),
+      _pipelines(device, _rendering),
+      _variants(_device)
+{
+  for (auto& acquired : _acquired) {
+    acquired = createSemaphore(_device);
+  }
+  for (uint32_t i = 0; i < framesInFlight; ++i) {
+    _descriptors.push_back(std::make_unique<DescriptorAllocator>(_device));
+  }
+  if (!info.capture.empty()) {
+    if (canCapture()) {
+      _capture = std::make_unique<Capture>(info.capture);
+      _readback = std::make_unique<Readback>(device, _family, captureCapacity(_swapchain.getExtent()));
+    }
+    else {
+      std::cerr << std::format("Capture of \"{}\" disabled, swapchain images can not be copied as 8 bit RGBA\n", _name);
+    }
+  }
+  if (info.asyncCompute) {
+    _compute = std::make_unique<AsyncCompute>(device);
+    static constexpr VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+      _primitives.push_back(std::make_unique<ComputePrimitives>(device));
+      _scratch.emplace_back(device, BufferInfo{.size = computeScratchSize, .usage = usage});
+      _computeResults.emplace_back(device, BufferInfo{.size = sizeof(uint32_t), .usage = usage});
+    }
+  }
+  if (info.triangle) {
+    // Modules come from SPIR-V embedded at build time, startup reads no shader files
+    _vertexShader = std::make_unique<ShaderModule>(_device, findShader(triangleVertex));
+    _fragmentShader = std::make_unique<ShaderModule>(_device, findShader(triangleFragment));
+    compileTriangle();
+  }
+  if (info.hotReload) {
+    _watcher = ShaderWatcher::acquire();
+  }
+  createRendered();
+  _outdated = _swapchain.get() == nullptr;
+
+  _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+}
+
+RenderThread::~RenderThread()
+{
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+
+  try {
+    _queue.waitIdle(_family);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Failed to wait for render queue:\n\t" << e.what() << "\n";
+  }
+
+  // Readback flushes its last copies into the capture before both go away, compute drains its last jobs
+  _readback.reset();
+  _capture.reset();
+  _compute.reset();
+
+  try {
+    // Running compiles still use the shader modules
+    _pipelines.wait();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Failed to wait for pipeline compiles:\n\t" << e.what() << "\n";
+  }
+
+  destroyRendered();
+  for (VkSemaphore acquired : _acquired) {
+    vkDestroySemaphore(_device, acquired, nullptr);
+  }
+}
+
+const std::string& RenderThread::getName() const
+{
+  return _name;
+}
+
+const utils::Samples& RenderThread::getFrameTime() const
+{
+  return _frameTime;
+}
+
+const utils::Samples& RenderThread::getCpuTime() const
+{
+  return _cpuTime;
+}
+
+const Capture* RenderThread::getCapture() const
+{
+  return _capture.get();
+}
+
+const Readback* RenderThread::getReadback() const
+{
+  return _readback.get();
+}
+
+const Rendering& RenderThread::getRendering() const
+{
+  return _rendering;
+}
+
+uint32_t RenderThread::getPasses() const
+{
+  return _passes;
+}
+
+GraphStats RenderThread::getGraphStats() const
+{
+  return _graph.getStats();
+}
+
+const AsyncCompute* RenderThread::getCompute() const
+{
+  return _compute.get();
+}
+
+const CommandPools& RenderThread::getCommands() const
+{
+  return _commands;
+}
+
+const ParallelRecorder& RenderThread::getRecorder() const
+{
+  return _recorder;
+}
+
+uint32_t RenderThread::getDraws() const
+{
+  return _draws;
+}
+
+const PipelineCompiler& RenderThread::getPipelines() const
+{
+  return _pipelines;
+}
+
+DescriptorStats RenderThread::getDescriptorStats() const
+{
+  DescriptorStats total;
+  for (const auto& allocator : _descriptors) {
+    const DescriptorStats stats = allocator->getStats();
+    total.sets += stats.sets;
+    total.pools += stats.pools;
+    total.recoveries += stats.recoveries;
+    total.resets += stats.resets;
+  }
+  return total;
+}
+
+const ShaderVariants& RenderThread::getVariants() const
+{
+  return _variants;
+}
+
+void RenderThread::loop(const std::stop_token& token)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  auto lastPresent = std::chrono::steady_clock::now();
+
+  try {
+    while (!token.stop_requested()) {
+      if (_outdated && !rebuild()) {
+        std::this_thread::sleep_for(minimizedSleep);
+        continue;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      if (!draw()) {
+        continue;
+      }
+      const auto end = std::chrono::steady_clock::now();
+
+      _cpuTime.add(Milliseconds(end - start).count());
+      _frameTime.add(Milliseconds(end - lastPresent).count());
+      lastPresent = end;
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << std::format("Render thread of \"{}\" stopped:\n\t{}\n", _name, e.what());
+  }
+}
+
+bool RenderThread::draw()
+{
+  reloadShaders();
+  // Waits until the last submission of this frame slot is done, its acquire semaphore is free again as well
+  _commands.beginFrame(_frame);
+  _pipelines.collect(_frame, framesInFlight);
+  _descriptors.at(_frame % framesInFlight)->reset();
+  VkSemaphore acquiredSemaphore = _acquired.at(_frame % framesInFlight);
+
+  uint32_t image = 0;
+  const VkResult acquired = _swapchain.acquire(acquiredSemaphore, image, acquireTimeout);
+  if (acquired == VK_TIMEOUT || acquired == VK_NOT_READY) {
+    return false;
+  }
+  if (acquired == VK_ERROR_OUT_OF_DATE_KHR) {
+    _outdated = true;
+    return false;
+  }
+  if (acquired != VK_SUCCESS && acquired != VK_SUBOPTIMAL_KHR) {
+    throw std::runtime_error(std::format("Failed to acquire swapchain image! status: {}", utils::result(acquired)));
+  }
+
+  // The staging ring follows the swapchain extent, see rebuild()
+  const bool capturing = _readback != nullptr;
+  VkCommandBuffer cmd = _commands.allocate(_family);
+  record(cmd, image, capturing);
+
+  // Binary semaphores go first, their timeline values are ignored
+  std::array<VkSemaphore, 2> waits = {acquiredSemaphore, nullptr};
+  std::array<VkPipelineStageFlags, 2> waitStages = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0};
+  std::array<uint64_t, 2> waitValues = {0, 0};
+  const uint64_t frameValue = _frameTimeline.next();
+  const std::array<VkSemaphore, 2> signals = {capturing ? _cleared.at(image) : _rendered.at(image), _frameTimeline.get()};
+  const std::array<uint64_t, 2> signalValues = {0, frameValue};
+  uint32_t waitCount = 1;
+  if (_compute != nullptr && _computeValue != 0) {
+    // Fragment shading is where the job result of the previous frame would be read
+    const SemaphoreWait wait = _compute->after(_computeValue, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    waits.at(waitCount) = wait.semaphore;
+    waitStages.at(waitCount) = wait.stage;
+    waitValues.at(waitCount++) = wait.value;
+  }
+
+  const VkTimelineSemaphoreSubmitInfo timelineInfo{
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+      .pNext = nullptr,
+      .waitSemaphoreValueCount = waitCount,
+      .pWaitSemaphoreValues = waitValues.data(),
+      .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+      .pSignalSemaphoreValues = signalValues.data(),
+  };
+  const VkSubmitInfo submitInfo{
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = &timelineInfo,
+      .waitSemaphoreCount = waitCount,
+      .pWaitSemaphores = waits.data(),
+      .pWaitDstStageMask = waitStages.data(),
+      .commandBufferCount = 1,
+      .pCommandBuffers = &cmd,
+      .signalSemaphoreCount = static_cast<uint32_t>(signals.size()),
+      .pSignalSemaphores = signals.data(),
+  };
+  _queue.submit(_family, {&submitInfo, 1}, nullptr);
+  _commands.endFrame(_frameTimeline.get(), frameValue);
+  if (capturing) {
+    captureImage(image);
+  }
+  if (_compute != nullptr) {
+    dispatchCompute(frameValue);
+  }
+
+  VkSwapchainKHR swapchain = _swapchain.get();
+  VkSemaphore rendered = _rendered.at(image);
+  const VkPresentInfoKHR presentInfo{
+      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+      .pNext = nullptr,
+      .waitSemaphoreCount = 1,
+      .pWaitSemaphores = &rendered,
+      .swapchainCount = 1,
+      .pSwapchains = &swapchain,
+      .pImageIndices = &image,
+      .pResults = nullptr,
+  };
+  const VkResult presented = _queue.present(_family, presentInfo);
+  ++_frame;
+
+  if (presented == VK_ERROR_OUT_OF_DATE_KHR || presented == VK_SUBOPTIMAL_KHR || acquired == VK_SUBOPTIMAL_KHR) {
+    _outdated = true;
+  }
+  else if (presented != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to present swapchain image! status: {}", utils::result(presented)));
+  }
+  return true;
+}
+
+bool RenderThread::rebuild()
+{
+  // Only this window's queue work has to drain, vkDeviceWaitIdle would race other submitting threads
+  _queue.waitIdle(_family);
+  _rendering.releaseViews();
+  if (!_swapchain.recreate()) {
+    return false;
+  }
+
+  destroyRendered();
+  createRendered();
+  if (_readback != nullptr) {
+    // The queue is idle, the last copies drain into the capture before the ring is reallocated for the new extent
+    _readback->resize(captureCapacity(_swapchain.getExtent()));
+  }
+  if (_triangle != nullptr && _swapchain.getFormat() != _triangleFormat) {
+    compileTriangle();
+  }
+  _outdated = false;
+  return true;
+}
+
+void RenderThread::record(VkCommandBuffer cmd, uint32_t image, bool capturing)
+{
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = nullptr,
+  };
+  if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to begin command buffer! status: {}", utils::result(status)));
+  }
+
+  // Initial stage matches the acquire semaphore wait stage, so the first transition waits for the image.
+  // While capturing the readback submission moves the image to present after its copy
+  const GraphImport swapchainState{
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      .initialStage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+      .initialAccess = VK_ACCESS_2_NONE,
+      .finalLayout = capturing ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      .finalStage = capturing ? VK_PIPELINE_STAGE_2_TRANSFER_BIT : VK_PIPELINE_STAGE_2_NONE,
+      .finalAccess = capturing ? VK_ACCESS_2_TRANSFER_READ_BIT : VK_ACCESS_2_NONE,
+  };
+  const VkExtent2D extent = _swapchain.getExtent();
+
+  _graph.reset();
+  const ResourceId target = _graph.importImage("swapchain", _swapchain.getImages().at(image), _swapchain.getViews().at(image),
+                                               {.format = _swapchain.getFormat(), .extent = extent}, swapchainState);
+  for (uint32_t pass = 0; pass < _passes; ++pass) {
+    // The first pass clears, the rest load what the previous one stored
+    const Access access = pass == 0 ? Access::colorWrite : Access::colorReadWrite;
+    _graph.addPass(pass == 0 ? "clear" : std::format("load {}", pass), {{.resource = target, .access = access}},
+                   [this, target, extent, pass](VkCommandBuffer passCmd, const RenderGraph& graph) {
+                     const std::array<RenderAttachment, 1> colors{{{
+                         .view = graph.getView(target),
+                         .format = _swapchain.getFormat(),
+                         .usage = _swapchain.getUsage(),
+                         .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         .loadOp = pass == 0 ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD,
+                         .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                         .clear = {.color = _clearColor},
+                     }}};
+                     // Draws go into the clear pass, recorded in parallel into secondaries
+                     const bool parallel = pass == 0 && _draws > 0;
+                     const RenderInheritance inheritance =
+                         _rendering.begin(passCmd, {.extent = extent, .colors = colors},
+                                          parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+                     if (parallel) {
+                       _recorder.record(passCmd, inheritance, _draws, [extent](VkCommandBuffer drawCmd, uint32_t first, uint32_t last) {
+                         recordStandInDraws(drawCmd, first, last, extent);
+                       });
+                     }
+                     _rendering.end(passCmd);
+                   });
+  }
+  if (_triangle != nullptr) {
+    _graph.addPass("triangle", {{.resource = target, .access = Access::colorReadWrite}},
+                   [this, target, extent](VkCommandBuffer passCmd, const RenderGraph& graph) {
+                     const std::array<RenderAttachment, 1> colors{{{
+                         .view = graph.getView(target),
+                         .format = _swapchain.getFormat(),
+                         .usage = _swapchain.getUsage(),
+                         .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                         .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+                         .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                         .clear = {},
+                     }}};
+                     [[maybe_unused]] const RenderInheritance inheritance = _rendering.begin(passCmd, {.extent = extent, .colors = colors});
+                     drawTriangle(passCmd, extent);
+                     _rendering.end(passCmd);
+                   });
+  }
+  _graph.output(target);
+
+  if (_graph.compile() && Debug) {
+    _graph.show();
+  }
+  _graph.execute(cmd);
+
+  if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to end command buffer! status: {}", utils::result(status)));
+  }
+}
+
+bool RenderThread::canCapture() const
+{
+  const VkFormat format = _swapchain.getFormat();
+  const bool rgba8 = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_R8G8B8A8_UNORM ||
+                     format == VK_FORMAT_R8G8B8A8_SRGB;
+  return rgba8 && (_swapchain.getUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+}
+
+void RenderThread::captureImage(uint32_t image)
+{
+  const VkExtent2D extent = _swapchain.getExtent();
+  const VkFormat format = _swapchain.getFormat();
+  const bool bgra = format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+
+  const ReadbackImage source{
+      .image = _swapchain.getImages().at(image),
+      .layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      .extent = extent,
+  };
+  const ReadbackSync sync{.wait = _cleared.at(image), .waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT, .signal = _rendered.at(image)};
+
+  // Completion is observed through the callback, the future is not needed
+  [[maybe_unused]] auto done =
+      _readback->read(source, sync, [capture = _capture.get(), extent, bgra](Readback::Data&& data) {
+        capture->push({.pixels = std::move(data), .width = extent.width, .height = extent.height, .bgra = bgra});
+      });
+}
+
+void RenderThread::dispatchCompute(uint64_t frameValue)
+{
+  static constexpr uint32_t pattern = 0x3F800000;  // 1.0F
+  const size_t slot = _frame % framesInFlight;
+  ComputePrimitives& primitives = *_primitives.at(slot);
+  uint64_t& slotValue = _computeValues.at(slot);
+  // Frame slots only wait for the job of the frame before, descriptor sets of the last job of this slot are only
+  // recycled once it is done
+  const bool first = slotValue == 0;
+  if (!first) {
+    if (!_compute->wait(slotValue, computeTimeout)) {
+      throw std::runtime_error(std::format("Async compute job of \"{}\" did not finish", _name));
+    }
+    primitives.reset();
+  }
+
+  // Waiting for the previous frame stands for reading its results, e.g. last frame depth for culling
+  const VkDescriptorBufferInfo input{.buffer = _scratch.at(slot).get(), .offset = 0, .range = computeScratchSize};
+  const VkDescriptorBufferInfo output{.buffer = _computeResults.at(slot).get(), .offset = 0, .range = sizeof(uint32_t)};
+  const std::array<SemaphoreWait, 1> waits{{
+      {.semaphore = _frameTimeline.get(), .value = frameValue - 1, .stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT},
+  }};
+  slotValue = _compute->submit(
+      [&](VkCommandBuffer cmd) {
+        if (first) {
+          vkCmdFillBuffer(cmd, input.buffer, 0, VK_WHOLE_SIZE, pattern);
+          const VkMemoryBarrier filled{
+              .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+              .pNext = nullptr,
+              .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+              .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+          };
+          vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &filled, 0, nullptr, 0,
+                               nullptr);
+        }
+        primitives.reduce(cmd, input, output, static_cast<uint32_t>(computeScratchSize / sizeof(uint32_t)), ReduceOp::max);
+      },
+      waits);
+  _computeValue = slotValue;
+}
+
+void RenderThread::compileTriangle(PipelineHandle fallback)
+{
+  // Layout and vertex input come from reflecting both stages, the device cache shares the layout between pipelines
+  const std::array<const ShaderReflection*, 2> stages = {&_vertexShader->getReflection(), &_fragmentShader->getReflection()};
+  _triangleFormat = _swapchain.getFormat();
+  // UNORM swapchains get the sRGB encode in the shader, both variants are usually frozen at build time
+  TriangleConstants constants;
+  constants.set<"encodeSrgb">(_triangleFormat != VK_FORMAT_B8G8R8A8_SRGB && _triangleFormat != VK_FORMAT_R8G8B8A8_SRGB);
+  VertexInput input = vertexInput(_vertexShader->getReflection());
+  GraphicsPipelineInfo info{
+      .layout = _layouts.getPipelineLayout(combine(stages)).layout,
+      .stages = {_variants.stage(*_vertexShader, triangleVertex),
+                 _variants.stage(*_fragmentShader, triangleFragment, constants.view())},
+      .bindings = std::move(input.bindings),
+      .attributes = std::move(input.attributes),
+      .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+      .polygonMode = VK_POLYGON_MODE_FILL,
+      .cullMode = VK_CULL_MODE_NONE,
+      .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+      .depthTest = false,
+      .depthWrite = false,
+      .depthCompare = VK_COMPARE_OP_ALWAYS,
+      .blend = false,
+      .formats = {.colors = {_triangleFormat}, .depth = VK_FORMAT_UNDEFINED},
+  };
+  _triangle = _pipelines.compile(std::move(info), std::move(fallback));
+}
+
+void RenderThread::reloadShaders()
+{
+  if (_reloadTime != nullptr && _triangle->isUsable()) {
+    _reloadTime.reset();
+  }
+  // Modules are only read while pipelines are created, once no compile runs and the frames recorded with their
+  // pipelines are done nothing refers to them anymore
+  if (!_retiredShaders.empty() && _pipelines.getPending() == 0) {
+    std::erase_if(_retiredShaders, [this](const RetiredShader& retired) { return retired.frame + framesInFlight <= _frame; });
+  }
+  if (_watcher == nullptr || _triangle == nullptr || _watcher->getVersion() == _shaderVersion) {
+    return;
+  }
+
+  const uint64_t since = std::exchange(_shaderVersion, _watcher->getVersion());
+  bool changed = false;
+  const auto reload = [this, since, &changed](std::unique_ptr<ShaderModule>& module, std::string_view name) {
+    if (const auto code = _watcher->getReloaded(name, since); code != nullptr) {
+      auto replacement = std::make_unique<ShaderModule>(_device, *code);
+      _retiredShaders.push_back({.module = std::exchange(module, std::move(replacement)), .frame = _frame});
+      changed = true;
+    }
+  };
+  try {
+    reload(_vertexShader, triangleVertex);
+    reload(_fragmentShader, triangleFragment);
+  }
+  catch (const std::exception& e) {
+    std::cerr << std::format("Shader reload of \"{}\" failed:\n\t{}\n", _name, e.what());
+  }
+  if (changed) {
+    // Only the pipelines using a changed module are rebuilt, unchanged library parts come from the compiler cache
+    _reloadTime = std::make_unique<utils::LogTime>(std::format("Pipeline swap \"{}\"", _name));
+    try {
+      compileTriangle(_triangle);
+    }
+    catch (const std::exception& e) {
+      // An edit dropping a specialization constant, the previous pipeline stays
+      std::cerr << std::format("Pipeline swap of \"{}\" failed:\n\t{}\n", _name, e.what());
+      _reloadTime.reset();
+    }
+  }
+}
+
+void RenderThread::drawTriangle(VkCommandBuffer cmd, VkExtent2D extent)
+{
+  VkPipeline pipeline = _pipelines.acquire(_triangle);
+  if (pipeline == nullptr) {
+    return;
+  }
+
+  const VkViewport viewport{
+      .x = 0.0F,
+      .y = 0.0F,
+      .width = static_cast<float>(extent.width),
+      .height = static_cast<float>(extent.height),
+      .minDepth = 0.0F,
+      .maxDepth = 1.0F,
+  };
+  const VkRect2D scissor{.offset = {.x = 0, .y = 0}, .extent = extent};
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+  vkCmdSetViewport(cmd, 0, 1, &viewport);
+  vkCmdSetScissor(cmd, 0, 1, &scissor);
+  vkCmdDraw(cmd, 3, 1, 0, 0);
+}
+
+void RenderThread::createRendered()
+{
+  // One semaphore per swapchain image, presentation may still hold the previous one of the same frame slot
+  const size_t count = _swapchain.getImages().size();
+  _rendered.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    _rendered.push_back(createSemaphore(_device));
+  }
+  if (_readback != nullptr) {
+    _cleared.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      _cleared.push_back(createSemaphore(_device));
+    }
+  }
+}
+
+void RenderThread::destroyRendered()
+{
+  for (VkSemaphore semaphore : _rendered) {
+    vkDestroySemaphore(_device, semaphore, nullptr);
+  }
+  for (VkSemaphore semaphore : _cleared) {
+    vkDestroySemaphore(_device, semaphore, nullptr);
+  }
+  _rendered.clear();
+  _cleared.clear();
+}
+}  // namespace vulkan
@@ -0,0 +1,152 @@
+#ifndef LIB_VULKAN_RENDER_RENDER_THREAD
+#define LIB_VULKAN_RENDER_RENDER_THREAD
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command/command_pools.hpp"
+#include "command/parallel_recorder.hpp"
+#include "compute/async_compute.hpp"
+#include "compute/compute_primitives.hpp"
+#include "descriptor/descriptor_allocator.hpp"
+#include "device/device.hpp"
+#include "device/queue.hpp"
+#include "format/logtime.hpp"
+#include "graph/render_graph.hpp"
+#include "memory/buffer.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "readback/capture.hpp"
+#include "readback/readback.hpp"
+#include "rendering/rendering.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/shader_variants.hpp"
+#include "shader/shader_watcher.hpp"
+#include "stats/samples.hpp"
+#include "swapchain/swapchain.hpp"
+#include "sync/timeline.hpp"
+#include "window/window_info.hpp"
+
+namespace vulkan {
+class RenderThread {
+public:
+  static constexpr uint32_t framesInFlight = 2;
+
+  RenderThread(const RenderThread&) = delete;
+  RenderThread(RenderThread&&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+  RenderThread& operator=(RenderThread&&) = delete;
+
+  explicit RenderThread(const VulkanDevice& device, VkSurfaceKHR surface, const WindowInfo& info);
+  ~RenderThread();
+
+  [[nodiscard]] const std::string& getName() const;
+  // Wall time between two presents of this window, in milliseconds
+  [[nodiscard]] const utils::Samples& getFrameTime() const;
+  // Time spent recording and submitting one frame, in milliseconds
+  [[nodiscard]] const utils::Samples& getCpuTime() const;
+  // Null while capture is disabled
+  [[nodiscard]] const Capture* getCapture() const;
+  [[nodiscard]] const Readback* getReadback() const;
+  [[nodiscard]] const Rendering& getRendering() const;
+  [[nodiscard]] uint32_t getPasses() const;
+  [[nodiscard]] GraphStats getGraphStats() const;
+  // Null while async compute is disabled
+  [[nodiscard]] const AsyncCompute* getCompute() const;
+  [[nodiscard]] const CommandPools& getCommands() const;
+  [[nodiscard]] const ParallelRecorder& getRecorder() const;
+  [[nodiscard]] uint32_t getDraws() const;
+  [[nodiscard]] const PipelineCompiler& getPipelines() const;
+  // Summed over the allocators of every frame slot
+  [[nodiscard]] DescriptorStats getDescriptorStats() const;
+  [[nodiscard]] const ShaderVariants& getVariants() const;
+
+private:
+  struct RetiredShader {
+    std::unique_ptr<ShaderModule> module;
+    // Frame that replaced it
+    uint64_t frame;
+  };
+
+  VkDevice _device;
+  Queue& _queue;
+  LayoutCache& _layouts;
+  uint32_t _family;
+  std::string _name;
+  VkClearColorValue _clearColor;
+  uint32_t _passes;
+  uint32_t _draws;
+
+  Swapchain _swapchain;
+  Rendering _rendering;
+  RenderGraph _graph;
+  // Every submission signals the next value, frame slots and their command pools are recycled once it is reached
+  Timeline _frameTimeline;
+  CommandPools _commands;
+  ParallelRecorder _recorder;
+  PipelineCompiler _pipelines;
+  // Per frame sets come from the allocator of the frame slot, its pools are reset once the slot is free again
+  std::vector<std::unique_ptr<DescriptorAllocator>> _descriptors;
+  // Embedded triangle, compiled again whenever the swapchain format changes. The layout belongs to the device cache
+  std::unique_ptr<ShaderModule> _vertexShader;
+  std::unique_ptr<ShaderModule> _fragmentShader;
+  ShaderVariants _variants;
+  VkFormat _triangleFormat = VK_FORMAT_UNDEFINED;
+  PipelineHandle _triangle;
+
+  // Development mode, edited shaders are picked up at the start of a frame
+  std::shared_ptr<ShaderWatcher> _watcher;
+  uint64_t _shaderVersion = 0;
+  // Replaced modules, the compile of the previous pipeline may still read them
+  std::vector<RetiredShader> _retiredShaders;
+  // Logs the reload latency once the rebuilt pipeline is usable
+  std::unique_ptr<utils::LogTime> _reloadTime;
+  std::array<VkSemaphore, framesInFlight> _acquired{};
+  std::vector<VkSemaphore> _rendered;
+  bool _outdated = false;
+  uint64_t _frame = 0;
+
+  utils::Samples _frameTime;
+  utils::Samples _cpuTime;
+
+  // Capture copies run as their own submission between rendering and present
+  std::unique_ptr<Capture> _capture;
+  std::unique_ptr<Readback> _readback;
+  std::vector<VkSemaphore> _cleared;
+
+  // Frame N waits for the job of frame N - 1, the job of frame N waits for frame N - 1 and runs next to frame N.
+  // Every frame slot reduces its own scratch buffer with its own kernels and descriptor sets
+  std::unique_ptr<AsyncCompute> _compute;
+  std::vector<std::unique_ptr<ComputePrimitives>> _primitives;
+  std::vector<Buffer> _scratch;
+  std::vector<Buffer> _computeResults;
+  std::array<uint64_t, framesInFlight> _computeValues{};
+  uint64_t _computeValue = 0;
+
+  std::jthread _thread;
+
+  void loop(const std::stop_token& token);
+  [[nodiscard]] bool draw();
+  [[nodiscard]] bool rebuild();
+  void record(VkCommandBuffer cmd, uint32_t image, bool capturing);
+  [[nodiscard]] bool canCapture() const;
+  void captureImage(uint32_t image);
+  void dispatchCompute(uint64_t frameValue);
+  // The fallback stays bound until the new pipeline is usable, a reload then swaps at a frame boundary
+  void compileTriangle(PipelineHandle fallback = nullptr);
+  void reloadShaders();
+  void drawTriangle(VkCommandBuffer cmd, VkExtent2D extent);
+
+  void createRendered();
+  void destroyRendered();
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_RENDER_RENDER_THREAD */
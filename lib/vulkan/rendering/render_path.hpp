@@ -0,0 +1,25 @@
+#ifndef LIB_VULKAN_RENDERING_RENDER_PATH
+#define LIB_VULKAN_RENDERING_RENDER_PATH
+
+#include <cstdint>
+#include <string_view>
+
+namespace vulkan {
+// Automatic picks dynamic rendering when the device enables it and falls back to cached render passes otherwise
+enum class RenderPath : std::uint8_t { automatic, dynamic, renderPass };
+
+[[nodiscard]] constexpr std::string_view toString(RenderPath path)
+{
+  switch (path) {
+  case RenderPath::automatic:
+    return "automatic";
+  case RenderPath::dynamic:
+    return "dynamic";
+  case RenderPath::renderPass:
+    return "render pass";
+  }
+  return "unknown";
+}
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_RENDERING_RENDER_PATH */
@@ -0,0 +1,383 @@
+#include "rendering.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "hash/hash.hpp"
+
+namespace vulkan {
+static RenderPath choosePath(const VulkanDevice& device, RenderPath wanted)
+{
+  const bool dynamic = device.getFeatures().dynamicRendering;
+  if (wanted == RenderPath::dynamic && !dynamic) {
+    throw std::runtime_error("Dynamic rendering requested but the device does not support it");
+  }
+  if (wanted == RenderPath::automatic) {
+    return dynamic ? RenderPath::dynamic : RenderPath::renderPass;
+  }
+  return wanted;
+}
+
+static VkRenderingAttachmentInfo attachmentInfo(const RenderAttachment& attachment)
+{
+  return {
+      .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+      .pNext = nullptr,
+      .imageView = attachment.view,
+      .imageLayout = attachment.layout,
+      .resolveMode = VK_RESOLVE_MODE_NONE,
+      .resolveImageView = nullptr,
+      .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      .loadOp = attachment.loadOp,
+      .storeOp = attachment.storeOp,
+      .clearValue = attachment.clear,
+  };
+}
+
+static VkAttachmentDescription attachmentDescription(VkFormat format, VkImageLayout layout, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp)
+{
+  // Layout stays the same through the pass so one render pass serves every frame and both paths behave alike
+  return {
+      .flags = 0,
+      .format = format,
+      .samples = VK_SAMPLE_COUNT_1_BIT,
+      .loadOp = loadOp,
+      .storeOp = storeOp,
+      .stencilLoadOp = loadOp,
+      .stencilStoreOp = storeOp,
+      .initialLayout = layout,
+      .finalLayout = layout,
+  };
+}
+
+Rendering::Rendering(const VulkanDevice& device, RenderPath path)
+    : _device(device.get()),
+      _path(choosePath(device, path)),
+      _imageless(device.getFeatures().imagelessFramebuffer)
+{
+}
+
+Rendering::~Rendering()
+{
+  for (const auto& [key, framebuffer] : _framebuffers) {
+    vkDestroyFramebuffer(_device, framebuffer, nullptr);
+  }
+  for (const auto& [key, pass] : _passes) {
+    vkDestroyRenderPass(_device, pass, nullptr);
+  }
+}
+
+RenderInheritance Rendering::begin(VkCommandBuffer cmd, const RenderTarget& target, VkSubpassContents contents)
+{
+  const VkRect2D area{.offset = {.x = 0, .y = 0}, .extent = target.extent};
+  RenderInheritance inheritance;
+  inheritance.rendering = true;
+  inheritance.colors.reserve(target.colors.size());
+  for (const auto& color : target.colors) {
+    inheritance.colors.push_back(color.format);
+  }
+  if (target.depth.has_value()) {
+    inheritance.depth = target.depth->format;
+  }
+
+  if (_path == RenderPath::dynamic) {
+    std::vector<VkRenderingAttachmentInfo> colors;
+    colors.reserve(target.colors.size());
+    for (const auto& color : target.colors) {
+      colors.push_back(attachmentInfo(color));
+    }
+    const std::optional<VkRenderingAttachmentInfo> depth =
+        target.depth.has_value() ? std::optional(attachmentInfo(*target.depth)) : std::nullopt;
+
+    const VkRenderingFlags flags = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                       ? static_cast<VkRenderingFlags>(VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT)
+                                       : 0U;
+    const VkRenderingInfo renderingInfo{
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .pNext = nullptr,
+        .flags = flags,
+        .renderArea = area,
+        .layerCount = 1,
+        .viewMask = 0,
+        .colorAttachmentCount = static_cast<uint32_t>(colors.size()),
+        .pColorAttachments = colors.data(),
+        .pDepthAttachment = depth.has_value() ? &*depth : nullptr,
+        .pStencilAttachment = nullptr,
+    };
+    vkCmdBeginRendering(cmd, &renderingInfo);
+    return inheritance;
+  }
+
+  PassKey key;
+  key.colors.reserve(target.colors.size());
+  std::vector<VkClearValue> clears;
+  std::vector<VkImageView> views;
+  clears.reserve(target.colors.size() + 1);
+  views.reserve(target.colors.size() + 1);
+  for (const auto& color : target.colors) {
+    key.colors.push_back({color.format, color.layout, color.loadOp, color.storeOp});
+    clears.push_back(color.clear);
+    views.push_back(color.view);
+  }
+  if (target.depth.has_value()) {
+    const auto& depth = *target.depth;
+    key.depth = AttachmentKey{depth.format, depth.layout, depth.loadOp, depth.storeOp};
+    clears.push_back(depth.clear);
+    views.push_back(depth.view);
+  }
+
+  const VkRenderPass pass = getPass(key);
+  inheritance.renderPass = pass;
+  inheritance.framebuffer = getFramebuffer(pass, target);
+  const VkRenderPassAttachmentBeginInfo attachments{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO,
+      .pNext = nullptr,
+      .attachmentCount = static_cast<uint32_t>(views.size()),
+      .pAttachments = views.data(),
+  };
+  const VkRenderPassBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+      .pNext = _imageless ? &attachments : nullptr,
+      .renderPass = pass,
+      .framebuffer = inheritance.framebuffer,
+      .renderArea = area,
+      .clearValueCount = static_cast<uint32_t>(clears.size()),
+      .pClearValues = clears.data(),
+  };
+  vkCmdBeginRenderPass(cmd, &beginInfo, contents);
+  return inheritance;
+}
+
+void Rendering::end(VkCommandBuffer cmd) const
+{
+  if (_path == RenderPath::dynamic) {
+    vkCmdEndRendering(cmd);
+  }
+  else {
+    vkCmdEndRenderPass(cmd);
+  }
+}
+
+void Rendering::releaseViews()
+{
+  if (_imageless) {
+    return;
+  }
+
+  const std::scoped_lock lock(_mutex);
+  for (const auto& [key, framebuffer] : _framebuffers) {
+    vkDestroyFramebuffer(_device, framebuffer, nullptr);
+  }
+  _framebuffers.clear();
+}
+
+PipelineRendering Rendering::pipelineRendering(const RenderFormats& formats)
+{
+  PipelineRendering result{
+      .rendering =
+          {
+              .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+              .pNext = nullptr,
+              .viewMask = 0,
+              .colorAttachmentCount = static_cast<uint32_t>(formats.colors.size()),
+              .pColorAttachmentFormats = formats.colors.data(),
+              .depthAttachmentFormat = formats.depth,
+              .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+          },
+      .renderPass = nullptr,
+  };
+  if (_path == RenderPath::dynamic) {
+    return result;
+  }
+
+  // Pipelines only need a compatible pass, load/store ops and layouts do not take part in compatibility
+  PassKey key;
+  key.colors.reserve(formats.colors.size());
+  for (VkFormat format : formats.colors) {
+    key.colors.push_back({format, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE});
+  }
+  if (formats.depth != VK_FORMAT_UNDEFINED) {
+    key.depth = AttachmentKey{formats.depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_ATTACHMENT_LOAD_OP_LOAD,
+                              VK_ATTACHMENT_STORE_OP_STORE};
+  }
+  result.renderPass = getPass(key);
+  return result;
+}
+
+RenderPath Rendering::getPath() const
+{
+  return _path;
+}
+
+size_t Rendering::getPassCount() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _passes.size();
+}
+
+size_t Rendering::getFramebufferCount() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _framebuffers.size();
+}
+
+bool Rendering::FramebufferKey::operator==(const FramebufferKey& other) const
+{
+  return pass == other.pass && extent.width == other.extent.width && extent.height == other.extent.height && usages == other.usages &&
+         views == other.views;
+}
+
+size_t Rendering::KeyHash::operator()(const PassKey& key) const
+{
+  size_t seed = key.colors.size();
+  const auto combine = [&seed](const AttachmentKey& attachment) {
+    utils::hashCombine(seed, utils::hash(attachment.format, attachment.layout, attachment.loadOp, attachment.storeOp));
+  };
+  for (const auto& color : key.colors) {
+    combine(color);
+  }
+  if (key.depth.has_value()) {
+    combine(*key.depth);
+  }
+  return seed;
+}
+
+size_t Rendering::KeyHash::operator()(const FramebufferKey& key) const
+{
+  size_t seed = utils::hash(key.pass, key.extent.width, key.extent.height);
+  for (VkImageUsageFlags usage : key.usages) {
+    utils::hashCombine(seed, usage);
+  }
+  for (VkImageView view : key.views) {
+    utils::hashCombine(seed, view);
+  }
+  return seed;
+}
+
+VkRenderPass Rendering::getPass(const PassKey& key)
+{
+  const std::scoped_lock lock(_mutex);
+  if (auto found = _passes.find(key); found != _passes.end()) {
+    return found->second;
+  }
+
+  std::vector<VkAttachmentDescription> descriptions;
+  std::vector<VkAttachmentReference> colors;
+  descriptions.reserve(key.colors.size() + 1);
+  colors.reserve(key.colors.size());
+  for (const auto& color : key.colors) {
+    colors.push_back({.attachment = static_cast<uint32_t>(descriptions.size()), .layout = color.layout});
+    descriptions.push_back(attachmentDescription(color.format, color.layout, color.loadOp, color.storeOp));
+  }
+  std::optional<VkAttachmentReference> depth = std::nullopt;
+  if (key.depth.has_value()) {
+    depth = VkAttachmentReference{.attachment = static_cast<uint32_t>(descriptions.size()), .layout = key.depth->layout};
+    descriptions.push_back(attachmentDescription(key.depth->format, key.depth->layout, key.depth->loadOp, key.depth->storeOp));
+  }
+
+  const VkSubpassDescription subpass{
+      .flags = 0,
+      .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+      .inputAttachmentCount = 0,
+      .pInputAttachments = nullptr,
+      .colorAttachmentCount = static_cast<uint32_t>(colors.size()),
+      .pColorAttachments = colors.data(),
+      .pResolveAttachments = nullptr,
+      .pDepthStencilAttachment = depth.has_value() ? &*depth : nullptr,
+      .preserveAttachmentCount = 0,
+      .pPreserveAttachments = nullptr,
+  };
+  const VkRenderPassCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .attachmentCount = static_cast<uint32_t>(descriptions.size()),
+      .pAttachments = descriptions.data(),
+      .subpassCount = 1,
+      .pSubpasses = &subpass,
+      .dependencyCount = 0,
+      .pDependencies = nullptr,
+  };
+
+  VkRenderPass pass = nullptr;
+  if (const VkResult status = vkCreateRenderPass(_device, &createInfo, nullptr, &pass); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create render pass! status: {}", utils::result(status)));
+  }
+  _passes.emplace(key, pass);
+  return pass;
+}
+
+VkFramebuffer Rendering::getFramebuffer(VkRenderPass pass, const RenderTarget& target)
+{
+  std::vector<RenderAttachment> attachments(target.colors.begin(), target.colors.end());
+  if (target.depth.has_value()) {
+    attachments.push_back(*target.depth);
+  }
+
+  // Imageless framebuffers only depend on the pass and extent, so swapchain images and resizes to a seen size reuse them
+  FramebufferKey key{.pass = pass, .extent = target.extent, .usages = {}, .views = {}};
+  for (const auto& attachment : attachments) {
+    if (_imageless) {
+      key.usages.push_back(attachment.usage);
+    }
+    else {
+      key.views.push_back(attachment.view);
+    }
+  }
+
+  const std::scoped_lock lock(_mutex);
+  if (auto found = _framebuffers.find(key); found != _framebuffers.end()) {
+    return found->second;
+  }
+
+  std::vector<VkFramebufferAttachmentImageInfo> images;
+  images.reserve(attachments.size());
+  for (const auto& attachment : attachments) {
+    images.push_back({
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENT_IMAGE_INFO,
+        .pNext = nullptr,
+        .flags = 0,
+        .usage = attachment.usage,
+        .width = target.extent.width,
+        .height = target.extent.height,
+        .layerCount = 1,
+        .viewFormatCount = 1,
+        .pViewFormats = &attachment.format,
+    });
+  }
+  const VkFramebufferAttachmentsCreateInfo imagesInfo{
+      .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENTS_CREATE_INFO,
+      .pNext = nullptr,
+      .attachmentImageInfoCount = static_cast<uint32_t>(images.size()),
+      .pAttachmentImageInfos = images.data(),
+  };
+  const VkFramebufferCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+      .pNext = _imageless ? &imagesInfo : nullptr,
+      .flags = _imageless ? static_cast<VkFramebufferCreateFlags>(VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT) : 0U,
+      .renderPass = pass,
+      .attachmentCount = static_cast<uint32_t>(attachments.size()),
+      .pAttachments = _imageless ? nullptr : key.views.data(),
+      .width = target.extent.width,
+      .height = target.extent.height,
+      .layers = 1,
+  };
+
+  VkFramebuffer framebuffer = nullptr;
+  if (const VkResult status = vkCreateFramebuffer(_device, &createInfo, nullptr, &framebuffer); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create framebuffer! status: {}", utils::result(status)));
+  }
+  _framebuffers.emplace(std::move(key), framebuffer);
+  return framebuffer;
+}
+}  // namespace vulkan
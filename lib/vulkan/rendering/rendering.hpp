@@ -0,0 +1,125 @@
+#ifndef LIB_VULKAN_RENDERING_RENDERING
+#define LIB_VULKAN_RENDERING_RENDERING
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "render_path.hpp"
+
+namespace vulkan {
+struct RenderAttachment {
+  VkImageView view = nullptr;
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  // Exact usage the image was created with, imageless framebuffers are matched against it
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  // Layout before, during and after rendering, transitions stay with the caller on both paths
+  VkImageLayout layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+  VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  VkClearValue clear = {};
+};
+
+struct RenderTarget {
+  VkExtent2D extent = {.width = 0, .height = 0};
+  std::span<const RenderAttachment> colors;
+  std::optional<RenderAttachment> depth = std::nullopt;
+};
+
+struct RenderFormats {
+  std::vector<VkFormat> colors;
+  VkFormat depth = VK_FORMAT_UNDEFINED;
+};
+
+// What secondary command buffers executed inside begin() inherit, default constructed outside of rendering
+struct RenderInheritance {
+  bool rendering = false;
+  // Null on the dynamic path, the formats are inherited instead
+  VkRenderPass renderPass = nullptr;
+  VkFramebuffer framebuffer = nullptr;
+  std::vector<VkFormat> colors;
+  VkFormat depth = VK_FORMAT_UNDEFINED;
+};
+
+// Pipeline side of the path: chain rendering into pNext when renderPass is null. Points into the RenderFormats
+struct PipelineRendering {
+  VkPipelineRenderingCreateInfo rendering;
+  VkRenderPass renderPass;
+};
+
+// Begins and ends rendering with VK_KHR_dynamic_rendering, or with render passes and framebuffers cached by attachment description
+class Rendering {
+public:
+  Rendering(const Rendering&) = delete;
+  Rendering(Rendering&&) = delete;
+  Rendering& operator=(const Rendering&) = delete;
+  Rendering& operator=(Rendering&&) = delete;
+
+  explicit Rendering(const VulkanDevice& device, RenderPath path = RenderPath::automatic);
+  ~Rendering();
+
+  // With secondary contents everything up to end() has to be recorded into secondaries inheriting the returned state
+  RenderInheritance begin(VkCommandBuffer cmd, const RenderTarget& target, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+  void end(VkCommandBuffer cmd) const;
+
+  // Framebuffers bound to views have to go before the views do, imageless framebuffers are kept
+  void releaseViews();
+
+  [[nodiscard]] PipelineRendering pipelineRendering(const RenderFormats& formats);
+  [[nodiscard]] RenderPath getPath() const;
+  [[nodiscard]] size_t getPassCount() const;
+  [[nodiscard]] size_t getFramebufferCount() const;
+
+private:
+  struct AttachmentKey {
+    VkFormat format;
+    VkImageLayout layout;
+    VkAttachmentLoadOp loadOp;
+    VkAttachmentStoreOp storeOp;
+
+    bool operator==(const AttachmentKey&) const = default;
+  };
+
+  struct PassKey {
+    std::vector<AttachmentKey> colors;
+    std::optional<AttachmentKey> depth;
+
+    bool operator==(const PassKey&) const = default;
+  };
+
+  struct FramebufferKey {
+    VkRenderPass pass;
+    VkExtent2D extent;
+    // Imageless framebuffers are matched by usage, the others by views
+    std::vector<VkImageUsageFlags> usages;
+    std::vector<VkImageView> views;
+
+    bool operator==(const FramebufferKey& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const PassKey& key) const;
+    size_t operator()(const FramebufferKey& key) const;
+  };
+
+  VkDevice _device;
+  RenderPath _path;
+  bool _imageless;
+
+  mutable std::mutex _mutex;
+  std::unordered_map<PassKey, VkRenderPass, KeyHash> _passes;
+  std::unordered_map<FramebufferKey, VkFramebuffer, KeyHash> _framebuffers;
+
+  [[nodiscard]] VkRenderPass getPass(const PassKey& key);
+  [[nodiscard]] VkFramebuffer getFramebuffer(VkRenderPass pass, const RenderTarget& target);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_RENDERING_RENDERING */
@@ -0,0 +1,203 @@
+#include "rendering_benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "command/command_pools.hpp"
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "memory/image.hpp"
+#include "pipeline/layout_cache.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "rendering.hpp"
+#include "shader/embedded_shader.hpp"
+#include "shader/reflection.hpp"
+#include "shader/shader_module.hpp"
+#include "shader/specialization.hpp"
+
+namespace vulkan {
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr std::string_view vertexShader = "triangle.vert";
+static constexpr std::string_view fragmentShader = "triangle.frag";
+static constexpr VkExtent2D benchmarkExtent = {.width = 1920, .height = 1080};
+static constexpr VkFormat colorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+static constexpr VkImageUsageFlags colorUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+// ENCODE_SRGB_ID of shader/glsl/common.glsl
+using FragmentConstants = Specialization<SpecConstant<0, "encodeSrgb", bool>>;
+
+// Both stages of the triangle, shared by the pipelines of every path
+struct TriangleShaders {
+  ShaderModule vertex;
+  ShaderModule fragment;
+};
+
+static void begin(VkCommandBuffer cmd)
+{
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = nullptr,
+  };
+  if (const VkResult status = vkBeginCommandBuffer(cmd, &beginInfo); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to begin command buffer! status: {}", utils::result(status)));
+  }
+}
+
+static uint32_t graphicsFamily(const VulkanDevice& device)
+{
+  const auto& graphics = device.getQueue().getGraphics();
+  if (graphics.empty()) {
+    throw std::runtime_error("Device has no queue family able to render");
+  }
+  return graphics.front();
+}
+
+static VkPipeline compileTriangle(const VulkanDevice& device, PipelineCompiler& compiler, const TriangleShaders& shaders)
+{
+  const std::array<const ShaderReflection*, 2> stages = {&shaders.vertex.getReflection(), &shaders.fragment.getReflection()};
+  FragmentConstants constants;
+  constants.set<"encodeSrgb">(false);
+  const SpecializationView view = constants.view();
+  GraphicsPipelineInfo info{
+      .layout = device.getLayoutCache().getPipelineLayout(combine(stages)).layout,
+      .stages = {{.stage = VK_SHADER_STAGE_VERTEX_BIT,
+                  .module = shaders.vertex.get(),
+                  .entry = shaders.vertex.getReflection().entry,
+                  .hash = shaders.vertex.getHash()},
+                 {.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                  .module = shaders.fragment.get(),
+                  .entry = shaders.fragment.getReflection().entry,
+                  .hash = shaders.fragment.getHash(),
+                  .specialization = {view.entries.begin(), view.entries.end()},
+                  .specializationData = {view.data.begin(), view.data.end()}}},
+      .bindings = {},
+      .attributes = {},
+      .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+      .polygonMode = VK_POLYGON_MODE_FILL,
+      .cullMode = VK_CULL_MODE_NONE,
+      .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+      .depthTest = false,
+      .depthWrite = false,
+      .depthCompare = VK_COMPARE_OP_ALWAYS,
+      .blend = false,
+      .formats = {.colors = {colorFormat}, .depth = VK_FORMAT_UNDEFINED},
+  };
+  const PipelineHandle handle = compiler.compile(std::move(info));
+  compiler.wait();
+  VkPipeline pipeline = compiler.acquire(handle);
+  if (pipeline == nullptr) {
+    throw std::runtime_error(std::format("Failed to compile the pipeline of {} and {}", vertexShader, fragmentShader));
+  }
+  return pipeline;
+}
+
+// Passes of draws each into one primary, recorded but never submitted
+static void recordPasses(VkCommandBuffer cmd, Rendering& rendering, VkPipeline pipeline, const Image& color, VkImageView view,
+                         uint32_t draws, uint32_t passes)
+{
+  const VkImageMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = 0,
+      .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+      .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = color.get(),
+      .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1},
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                       &barrier);
+
+  const std::array<RenderAttachment, 1> colors = {{{.view = view,
+                                                     .format = colorFormat,
+                                                     .usage = colorUsage,
+                                                     .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                                     .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                                     .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                                     .clear = {}}}};
+  const RenderTarget target{.extent = benchmarkExtent, .colors = colors, .depth = std::nullopt};
+  const VkViewport viewport{.x = 0.0F,
+                            .y = 0.0F,
+                            .width = static_cast<float>(benchmarkExtent.width),
+                            .height = static_cast<float>(benchmarkExtent.height),
+                            .minDepth = 0.0F,
+                            .maxDepth = 1.0F};
+  const VkRect2D scissor{.offset = {.x = 0, .y = 0}, .extent = benchmarkExtent};
+  for (uint32_t pass = 0; pass < passes; ++pass) {
+    [[maybe_unused]] const RenderInheritance inheritance = rendering.begin(cmd, target);
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    for (uint32_t draw = 0; draw < draws; ++draw) {
+      vkCmdDraw(cmd, 3, 1, 0, 0);
+    }
+    rendering.end(cmd);
+  }
+}
+
+std::vector<RenderingThroughput> benchmarkRendering(const VulkanDevice& device, std::span<const uint32_t> drawsPerPass, uint32_t passes,
+                                                    uint32_t repeats)
+{
+  const uint32_t family = graphicsFamily(device);
+  const TriangleShaders shaders{.vertex = ShaderModule(device.get(), findShader(vertexShader)),
+                                .fragment = ShaderModule(device.get(), findShader(fragmentShader))};
+  const Image color(device, ImageInfo{.format = colorFormat, .extent = benchmarkExtent, .mipLevels = 1, .usage = colorUsage});
+  VkImageView view = createImageView(device.get(), color, VK_IMAGE_ASPECT_COLOR_BIT);
+
+  std::vector<RenderingThroughput> results;
+  try {
+    for (const RenderPath path : {RenderPath::dynamic, RenderPath::renderPass}) {
+      if (path == RenderPath::dynamic && !device.getFeatures().dynamicRendering) {
+        continue;
+      }
+      // Declared before the compiler so its passes and framebuffers outlive the pipelines compiled against them
+      Rendering rendering(device, path);
+      PipelineCompiler compiler(device, rendering, 1);
+      VkPipeline pipeline = compileTriangle(device, compiler, shaders);
+      CommandPools pools(device, 1);
+      uint64_t frame = 0;
+      for (const uint32_t draws : drawsPerPass) {
+        double best = std::numeric_limits<double>::max();
+        // The first run creates the render pass and framebuffer, it is not measured
+        for (uint32_t run = 0; run <= std::max(repeats, 1U); ++run) {
+          pools.beginFrame(frame++);
+          VkCommandBuffer cmd = pools.allocate(family);
+          const auto start = std::chrono::steady_clock::now();
+          begin(cmd);
+          recordPasses(cmd, rendering, pipeline, color, view, draws, passes);
+          if (const VkResult status = vkEndCommandBuffer(cmd); status != VK_SUCCESS) {
+            throw std::runtime_error(std::format("Failed to end command buffer! status: {}", utils::result(status)));
+          }
+          if (run != 0) {
+            best = std::min(best, Milliseconds(std::chrono::steady_clock::now() - start).count());
+          }
+        }
+        results.push_back({.path = path, .drawsPerPass = draws, .passes = passes, .ms = best});
+      }
+    }
+  }
+  catch (...) {
+    vkDestroyImageView(device.get(), view, nullptr);
+    throw;
+  }
+  vkDestroyImageView(device.get(), view, nullptr);
+  return results;
+}
+}  // namespace vulkan
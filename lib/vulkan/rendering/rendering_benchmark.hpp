@@ -0,0 +1,26 @@
+#ifndef LIB_VULKAN_RENDERING_RENDERING_BENCHMARK
+#define LIB_VULKAN_RENDERING_RENDERING_BENCHMARK
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "device/device.hpp"
+#include "render_path.hpp"
+
+namespace vulkan {
+struct RenderingThroughput {
+  RenderPath path;
+  uint32_t drawsPerPass;
+  uint32_t passes;
+  // Fastest recording of all passes into one primary, begin and end included, in milliseconds
+  double ms;
+};
+
+// Draws of the triangle pipeline recorded between Rendering::begin and end, once with dynamic rendering and once with
+// cached render passes on the same device. Nothing is submitted. The dynamic run is skipped without dynamic rendering
+[[nodiscard]] std::vector<RenderingThroughput> benchmarkRendering(const VulkanDevice& device, std::span<const uint32_t> drawsPerPass,
+                                                                  uint32_t passes, uint32_t repeats);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_RENDERING_RENDERING_BENCHMARK */
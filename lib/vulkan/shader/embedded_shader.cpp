@@ -0,0 +1,40 @@
+#include "embedded_shader.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "shaders/shaders.hpp"
+#include "shaders/variants.hpp"
+
+namespace vulkan {
+std::span<const EmbeddedShader> getEmbeddedShaders()
+{
+  return shaders::all;
+}
+
+const EmbeddedShader& findShader(std::string_view name)
+{
+  const auto* shader = std::ranges::find(shaders::all, name, &EmbeddedShader::name);
+  if (shader == shaders::all.end()) {
+    throw std::runtime_error(std::format("Shader {} is not embedded", name));
+  }
+  return *shader;
+}
+
+std::span<const EmbeddedVariant> getEmbeddedVariants()
+{
+  return shaders::variants;
+}
+
+const EmbeddedVariant* findVariant(std::string_view name, uint64_t source, uint64_t key)
+{
+  const auto* variant = std::ranges::find_if(shaders::variants, [name, source, key](const EmbeddedVariant& candidate) {
+    return candidate.name == name && candidate.source == source && candidate.key == key;
+  });
+  return variant == shaders::variants.end() ? nullptr : variant;
+}
+}  // namespace vulkan
@@ -0,0 +1,39 @@
+#ifndef LIB_VULKAN_SHADER_EMBEDDED_SHADER
+#define LIB_VULKAN_SHADER_EMBEDDED_SHADER
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+// SPIR-V compiled at build time from shader/glsl, the code lives in static memory for the whole run
+struct EmbeddedShader {
+  // Path relative to shader/glsl, e.g. "triangle.vert"
+  std::string_view name;
+  VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+  std::span<const uint32_t> code;
+};
+
+// Specialization of an embedded shader frozen into its own SPIR-V at build time, listed in shader/glsl/variants.txt
+struct EmbeddedVariant {
+  std::string_view name;
+  // ShaderModule::getHash of the code it was built from, a reloaded shader never matches
+  uint64_t source = 0;
+  // specializationKey of its constant values
+  uint64_t key = 0;
+  // Variants producing the same code share one array
+  std::span<const uint32_t> code;
+};
+
+[[nodiscard]] std::span<const EmbeddedShader> getEmbeddedShaders();
+// Throws when no shader of that name was built into the library
+[[nodiscard]] const EmbeddedShader& findShader(std::string_view name);
+// Empty when the build had no spirv-opt
+[[nodiscard]] std::span<const EmbeddedVariant> getEmbeddedVariants();
+// Null when that variant was not precompiled
+[[nodiscard]] const EmbeddedVariant* findVariant(std::string_view name, uint64_t source, uint64_t key);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_EMBEDDED_SHADER */
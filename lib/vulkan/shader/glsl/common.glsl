@@ -0,0 +1,10 @@
+#ifndef COMMON_GLSL
+#define COMMON_GLSL
+
+// Interface between the stages, both sides include it so locations can not drift apart
+#define COLOR_LOCATION 0
+
+// Specialization constant ids, RenderThread passes the same ones
+#define ENCODE_SRGB_ID 0
+
+#endif
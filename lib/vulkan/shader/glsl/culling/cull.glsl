@@ -0,0 +1,87 @@
+#ifndef CULL_GLSL
+#define CULL_GLSL
+
+// Instances, meshes and draw outputs of GpuCulling shared by the culling passes, every invocation turns one instance
+// into one VkDrawIndexedIndirectCommand of its material bucket
+
+// Visible draws are packed at the front of their bucket and counted. Otherwise every instance keeps its own slot and
+// culled ones draw zero instances
+layout(constant_id = 0) const bool COMPACT = true;
+// firstInstance carries the instance, otherwise it stays 0 and vertex shaders read visible[] at the slot of the draw
+layout(constant_id = 1) const bool FIRST_INSTANCE = true;
+
+struct Instance {
+  vec3 position;
+  float scale;
+  uint mesh;
+  uint bucket;
+  uint slot;
+};
+
+struct Lod {
+  uint firstIndex;
+  uint indexCount;
+  int vertexOffset;
+  float distance;
+};
+
+struct Mesh {
+  float radius;
+  uint firstLod;
+  uint lodCount;
+};
+
+// VkDrawIndexedIndirectCommand
+struct Command {
+  uint indexCount;
+  uint instanceCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances { Instance instances[]; };
+layout(std430, set = 0, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Lods { Lod lods[]; };
+// First slot of every bucket
+layout(std430, set = 0, binding = 3) readonly buffer Buckets { uint bucketOffsets[]; };
+layout(std430, set = 0, binding = 4) buffer Counts { uint counts[]; };
+layout(std430, set = 0, binding = 5) writeonly buffer Commands { Command commands[]; };
+layout(std430, set = 0, binding = 6) writeonly buffer Visible { uint visible[]; };
+
+// Planes point inside
+bool insideFrustum(vec4 planes[6], vec3 position, float radius)
+{
+  bool inside = true;
+  for (uint plane = 0; plane < 6; ++plane) {
+    inside = inside && dot(planes[plane].xyz, position) + planes[plane].w >= -radius;
+  }
+  return inside;
+}
+
+// A level is used up to its distance, the last one has no limit
+Lod selectLod(Mesh mesh, vec3 position, vec3 eye, float lodScale)
+{
+  float distance = length(position - eye) * lodScale;
+  uint lod = 0;
+  while (lod + 1 < mesh.lodCount && distance >= lods[mesh.firstLod + lod].distance) {
+    ++lod;
+  }
+  return lods[mesh.firstLod + lod];
+}
+
+void emit(uint index, Instance instance, Lod selected, bool drawn)
+{
+  uint slot = instance.slot;
+  if (COMPACT) {
+    if (!drawn) {
+      return;
+    }
+    slot = bucketOffsets[instance.bucket] + atomicAdd(counts[instance.bucket], 1u);
+  }
+  commands[slot] = Command(selected.indexCount, drawn ? 1u : 0u, selected.firstIndex, selected.vertexOffset,
+                           FIRST_INSTANCE ? index : 0u);
+  visible[slot] = index;
+}
+
+#endif
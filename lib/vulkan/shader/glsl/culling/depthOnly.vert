@@ -0,0 +1,20 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Depth only pass of the occlusion culling benchmark, vertices and instances are pulled from storage buffers and the
+// draws come from GpuCulling
+
+#define CULLING_SET 1
+#include "instance.glsl"
+
+layout(std430, set = 0, binding = 0) readonly buffer Positions { vec4 positions[]; };
+// xyz position, w scale
+layout(std430, set = 0, binding = 1) readonly buffer Instances { vec4 instances[]; };
+// Reversed depth
+layout(set = 0, binding = 2) uniform Camera { mat4 viewProjection; } camera;
+
+void main()
+{
+  vec4 instance = instances[cullingInstance()];
+  gl_Position = camera.viewProjection * vec4(positions[gl_VertexIndex].xyz * instance.w + instance.xyz, 1.0);
+}
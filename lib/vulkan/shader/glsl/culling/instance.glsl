@@ -0,0 +1,22 @@
+#ifndef INSTANCE_GLSL
+#define INSTANCE_GLSL
+
+// Vertex shader side of GpuCulling. Define CULLING_SET to the set GpuCulling::getVisible() is bound at before the
+// include. The push constant block is the draw slot GpuCulling::draw pushes without drawIndirectFirstInstance, so the
+// vertex shader has no push constants of its own
+
+layout(constant_id = 8) const bool CULLING_FIRST_INSTANCE = true;
+
+layout(std430, set = CULLING_SET, binding = 0) readonly buffer CullingVisible { uint cullingVisible[]; };
+
+layout(push_constant) uniform CullingDraw {
+  uint slot;
+} cullingDraw;
+
+// Index of the instance into the instances handed to GpuCulling::setInstances
+uint cullingInstance()
+{
+  return CULLING_FIRST_INSTANCE ? uint(gl_InstanceIndex) : cullingVisible[cullingDraw.slot];
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PRIMITIVES_GLSL
+#define PRIMITIVES_GLSL
+
+// Shared by the ComputePrimitives kernels, every buffer holds uint elements
+
+// Workgroup size is a power of two ComputePrimitives picks from the device limits, each invocation handles ITEMS elements
+layout(local_size_x_id = 0) in;
+layout(constant_id = 1) const uint ITEMS = 4;
+
+#define WORKGROUP gl_WorkGroupSize.x
+#define TILE (gl_WorkGroupSize.x * ITEMS)
+
+// Mode and value depend on the kernel. Dispatches larger than maxComputeWorkGroupCount are split, firstGroup is the
+// workgroup the split starts at
+layout(push_constant) uniform Push {
+  uint count;
+  uint firstGroup;
+  uint mode;
+  uint value;
+} push;
+
+uint group()
+{
+  return push.firstGroup + gl_WorkGroupID.x;
+}
+
+// Compare of ComputePrimitives
+bool passes(uint element)
+{
+  switch (push.mode) {
+  case 0: return element == push.value;
+  case 1: return element != push.value;
+  case 2: return element < push.value;
+  default: return element >= push.value;
+  }
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef RADIX_GLSL
+#define RADIX_GLSL
+
+#include "primitives.glsl"
+
+// 4 bit LSD radix sort, one digit per pass. Mode is the first bit of the digit, value the workgroup count of the pass
+#define RADIX 16
+
+// Keys are one or two uint words, low word first
+layout(constant_id = 3) const uint KEY_WORDS = 1;
+// Values move along with their keys
+layout(constant_id = 4) const bool PAYLOAD = false;
+
+layout(std430, set = 0, binding = 0) readonly buffer Keys { uint keys[]; };
+
+uint digitOf(uint index)
+{
+  return (keys[index * KEY_WORDS + push.mode / 32] >> (push.mode % 32)) & (RADIX - 1);
+}
+
+#endif
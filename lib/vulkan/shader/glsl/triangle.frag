@@ -0,0 +1,23 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "common.glsl"
+
+// Set when the swapchain stores UNORM, the hardware encodes to sRGB on write otherwise
+layout(constant_id = ENCODE_SRGB_ID) const bool ENCODE_SRGB = false;
+
+layout(location = COLOR_LOCATION) in vec3 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 linearToSrgb(vec3 color)
+{
+  vec3 low = color * 12.92;
+  vec3 high = 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055;
+  return mix(high, low, lessThanEqual(color, vec3(0.0031308)));
+}
+
+void main()
+{
+  outColor = vec4(ENCODE_SRGB ? linearToSrgb(inColor) : inColor, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "common.glsl"
+
+// Positions come from the vertex index, the triangle needs neither vertex buffers nor descriptors
+const vec2 positions[3] = vec2[](vec2(0.0, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));
+const vec3 colors[3] = vec3[](vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));
+
+layout(location = COLOR_LOCATION) out vec3 outColor;
+
+void main()
+{
+  gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+  outColor = colors[gl_VertexIndex];
+}
@@ -0,0 +1,573 @@
+#include "reflection.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+static constexpr uint32_t spirvMagic = 0x0723'0203;
+static constexpr size_t headerWords = 5;
+
+// The subset of the SPIR-V specification the reflection reads, values from its unified grammar
+enum class SpvOp : uint16_t {
+  entryPoint = 15,
+  executionMode = 16,
+  typeBool = 20,
+  typeInt = 21,
+  typeFloat = 22,
+  typeVector = 23,
+  typeMatrix = 24,
+  typeImage = 25,
+  typeSampler = 26,
+  typeSampledImage = 27,
+  typeArray = 28,
+  typeRuntimeArray = 29,
+  typeStruct = 30,
+  typePointer = 32,
+  constant = 43,
+  specConstantTrue = 48,
+  specConstantFalse = 49,
+  specConstant = 50,
+  variable = 59,
+  decorate = 71,
+  memberDecorate = 72,
+  typeAccelerationStructure = 5341,
+};
+
+enum class SpvDecoration : uint32_t {
+  specId = 1,
+  block = 2,
+  bufferBlock = 3,
+  arrayStride = 6,
+  matrixStride = 7,
+  builtIn = 11,
+  location = 30,
+  binding = 33,
+  descriptorSet = 34,
+  offset = 35,
+};
+
+enum class SpvStorage : uint32_t {
+  uniformConstant = 0,
+  input = 1,
+  uniform = 2,
+  pushConstant = 9,
+  storageBuffer = 12,
+};
+
+static constexpr uint32_t executionModeLocalSize = 17;
+static constexpr uint32_t dimBuffer = 5;
+static constexpr uint32_t dimSubpassData = 6;
+static constexpr uint32_t imageSampled = 1;
+
+struct Decorations {
+  std::optional<uint32_t> specId;
+  std::optional<uint32_t> set;
+  std::optional<uint32_t> binding;
+  std::optional<uint32_t> location;
+  std::optional<uint32_t> offset;
+  uint32_t arrayStride = 0;
+  uint32_t matrixStride = 0;
+  bool block = false;
+  bool bufferBlock = false;
+  bool builtIn = false;
+};
+
+struct SpvType {
+  SpvOp op;
+  // Operands after the result id
+  std::vector<uint32_t> operands;
+};
+
+struct SpvVariable {
+  uint32_t id;
+  uint32_t pointer;
+  SpvStorage storage;
+};
+
+struct SpvSpecConstant {
+  uint32_t id;
+  uint32_t type;
+};
+
+struct SpvEntry {
+  uint32_t model;
+  uint32_t id;
+  std::string name;
+};
+
+struct SpvModule {
+  std::unordered_map<uint32_t, SpvType> types;
+  std::unordered_map<uint32_t, uint32_t> constants;
+  std::unordered_map<uint32_t, Decorations> decorations;
+  std::unordered_map<uint32_t, std::vector<Decorations>> members;
+  std::vector<SpvVariable> variables;
+  std::vector<SpvSpecConstant> specConstants;
+  std::vector<SpvEntry> entries;
+  std::array<uint32_t, 3> localSize = {0, 0, 0};
+
+  [[nodiscard]] const SpvType& type(uint32_t id) const;
+  [[nodiscard]] Decorations decoration(uint32_t id) const;
+  [[nodiscard]] Decorations member(uint32_t id, size_t index) const;
+};
+
+const SpvType& SpvModule::type(uint32_t id) const
+{
+  const auto found = types.find(id);
+  if (found == types.end()) {
+    throw std::runtime_error(std::format("SPIR-V references unknown type %{}", id));
+  }
+  return found->second;
+}
+
+Decorations SpvModule::decoration(uint32_t id) const
+{
+  const auto found = decorations.find(id);
+  return found == decorations.end() ? Decorations{} : found->second;
+}
+
+Decorations SpvModule::member(uint32_t id, size_t index) const
+{
+  const auto found = members.find(id);
+  return found == members.end() || index >= found->second.size() ? Decorations{} : found->second.at(index);
+}
+
+static std::string literalString(std::span<const uint32_t> words)
+{
+  // Little endian bytes, nul terminated and padded to a whole word
+  std::string result;
+  for (const uint32_t word : words) {
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+      const auto character = static_cast<char>((word >> shift) & 0xFFU);
+      if (character == '\0') {
+        return result;
+      }
+      result.push_back(character);
+    }
+  }
+  return result;
+}
+
+static void decorate(Decorations& target, SpvDecoration decoration, std::span<const uint32_t> literals)
+{
+  const uint32_t value = literals.empty() ? 0 : literals.front();
+  switch (decoration) {
+  case SpvDecoration::specId: target.specId = value; break;
+  case SpvDecoration::block: target.block = true; break;
+  case SpvDecoration::bufferBlock: target.bufferBlock = true; break;
+  case SpvDecoration::arrayStride: target.arrayStride = value; break;
+  case SpvDecoration::matrixStride: target.matrixStride = value; break;
+  case SpvDecoration::builtIn: target.builtIn = true; break;
+  case SpvDecoration::location: target.location = value; break;
+  case SpvDecoration::binding: target.binding = value; break;
+  case SpvDecoration::descriptorSet: target.set = value; break;
+  case SpvDecoration::offset: target.offset = value; break;
+  }
+}
+
+static bool isKnown(SpvDecoration decoration)
+{
+  switch (decoration) {
+  case SpvDecoration::specId:
+  case SpvDecoration::block:
+  case SpvDecoration::bufferBlock:
+  case SpvDecoration::arrayStride:
+  case SpvDecoration::matrixStride:
+  case SpvDecoration::builtIn:
+  case SpvDecoration::location:
+  case SpvDecoration::binding:
+  case SpvDecoration::descriptorSet:
+  case SpvDecoration::offset: return true;
+  }
+  return false;
+}
+
+static bool isType(SpvOp op)
+{
+  switch (op) {
+  case SpvOp::typeBool:
+  case SpvOp::typeInt:
+  case SpvOp::typeFloat:
+  case SpvOp::typeVector:
+  case SpvOp::typeMatrix:
+  case SpvOp::typeImage:
+  case SpvOp::typeSampler:
+  case SpvOp::typeSampledImage:
+  case SpvOp::typeArray:
+  case SpvOp::typeRuntimeArray:
+  case SpvOp::typeStruct:
+  case SpvOp::typePointer:
+  case SpvOp::typeAccelerationStructure: return true;
+  default: return false;
+  }
+}
+
+static SpvModule parse(std::span<const uint32_t> code)
+{
+  if (code.size() < headerWords || code.front() != spirvMagic) {
+    throw std::runtime_error("Not a SPIR-V module, magic number is missing");
+  }
+
+  SpvModule module;
+  for (size_t at = headerWords; at < code.size();) {
+    const uint32_t wordCount = code[at] >> 16U;
+    const auto op = static_cast<SpvOp>(code[at] & 0xFFFFU);
+    if (wordCount == 0 || at + wordCount > code.size()) {
+      throw std::runtime_error(std::format("Malformed SPIR-V, instruction at word {} runs past the end", at));
+    }
+    const std::span<const uint32_t> words = code.subspan(at + 1, wordCount - 1);
+    at += wordCount;
+
+    if (isType(op) && !words.empty()) {
+      module.types.emplace(words[0], SpvType{.op = op, .operands = {words.begin() + 1, words.end()}});
+      continue;
+    }
+    switch (op) {
+    case SpvOp::entryPoint:
+      if (words.size() >= 2) {
+        module.entries.push_back({.model = words[0], .id = words[1], .name = literalString(words.subspan(2))});
+      }
+      break;
+    case SpvOp::executionMode:
+      if (words.size() >= 5 && words[1] == executionModeLocalSize) {
+        module.localSize = {words[2], words[3], words[4]};
+      }
+      break;
+    case SpvOp::constant:
+    case SpvOp::specConstant:
+      // Array lengths only, specialization constants count with their default value
+      if (words.size() >= 3) {
+        module.constants[words[1]] = words[2];
+      }
+      if (op == SpvOp::specConstant && words.size() >= 2) {
+        module.specConstants.push_back({.id = words[1], .type = words[0]});
+      }
+      break;
+    case SpvOp::specConstantTrue:
+    case SpvOp::specConstantFalse:
+      if (words.size() >= 2) {
+        module.specConstants.push_back({.id = words[1], .type = words[0]});
+      }
+      break;
+    case SpvOp::variable:
+      if (words.size() >= 3) {
+        module.variables.push_back({.id = words[1], .pointer = words[0], .storage = static_cast<SpvStorage>(words[2])});
+      }
+      break;
+    case SpvOp::decorate:
+      if (words.size() >= 2 && isKnown(static_cast<SpvDecoration>(words[1]))) {
+        decorate(module.decorations[words[0]], static_cast<SpvDecoration>(words[1]), words.subspan(2));
+      }
+      break;
+    case SpvOp::memberDecorate:
+      if (words.size() >= 3 && isKnown(static_cast<SpvDecoration>(words[2]))) {
+        auto& members = module.members[words[0]];
+        members.resize(std::max<size_t>(members.size(), words[1] + 1ULL));
+        decorate(members.at(words[1]), static_cast<SpvDecoration>(words[2]), words.subspan(3));
+      }
+      break;
+    default: break;
+    }
+  }
+  return module;
+}
+
+static VkShaderStageFlagBits stageOf(uint32_t model)
+{
+  switch (model) {
+  case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+  case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+  case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+  case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+  case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+  case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+  case 5364: return VK_SHADER_STAGE_TASK_BIT_EXT;
+  case 5365: return VK_SHADER_STAGE_MESH_BIT_EXT;
+  default: throw std::runtime_error(std::format("Unsupported SPIR-V execution model {}", model));
+  }
+}
+
+// Size in bytes under the explicit layout decorations, stride is the MatrixStride of the member holding a matrix
+static uint32_t sizeOf(const SpvModule& module, uint32_t id, uint32_t matrixStride = 0)
+{
+  const SpvType& type = module.type(id);
+  switch (type.op) {
+  case SpvOp::typeBool: return 4;
+  case SpvOp::typeInt:
+  case SpvOp::typeFloat: return type.operands.at(0) / 8;
+  case SpvOp::typeVector: return type.operands.at(1) * sizeOf(module, type.operands.at(0));
+  case SpvOp::typeMatrix: {
+    const uint32_t column = matrixStride != 0 ? matrixStride : sizeOf(module, type.operands.at(0));
+    return type.operands.at(1) * column;
+  }
+  case SpvOp::typeArray: {
+    const uint32_t stride = module.decoration(id).arrayStride;
+    const uint32_t length = module.constants.at(type.operands.at(1));
+    return length * (stride != 0 ? stride : sizeOf(module, type.operands.at(0), matrixStride));
+  }
+  case SpvOp::typeStruct: {
+    uint32_t size = 0;
+    uint32_t running = 0;
+    for (size_t i = 0; i < type.operands.size(); ++i) {
+      const Decorations member = module.member(id, i);
+      const uint32_t offset = member.offset.value_or(running);
+      running = offset + sizeOf(module, type.operands.at(i), member.matrixStride);
+      size = std::max(size, running);
+    }
+    return size;
+  }
+  default: return 0;
+  }
+}
+
+// Offset of the first member actually declared, push constant blocks of later stages often start past 0
+static uint32_t firstOffset(const SpvModule& module, uint32_t id)
+{
+  const SpvType& type = module.type(id);
+  uint32_t offset = type.operands.empty() ? 0 : UINT32_MAX;
+  for (size_t i = 0; i < type.operands.size(); ++i) {
+    offset = std::min(offset, module.member(id, i).offset.value_or(0));
+  }
+  return offset;
+}
+
+static std::optional<VkDescriptorType> descriptorType(const SpvModule& module, uint32_t id, SpvStorage storage)
+{
+  const SpvType& type = module.type(id);
+  if (storage == SpvStorage::storageBuffer) {
+    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  }
+  if (storage == SpvStorage::uniform) {
+    return module.decoration(id).bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  }
+  if (storage != SpvStorage::uniformConstant) {
+    return std::nullopt;
+  }
+  switch (type.op) {
+  case SpvOp::typeSampler: return VK_DESCRIPTOR_TYPE_SAMPLER;
+  case SpvOp::typeSampledImage: return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  case SpvOp::typeAccelerationStructure: return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+  case SpvOp::typeImage: {
+    const uint32_t dim = type.operands.at(1);
+    const bool sampled = type.operands.at(5) == imageSampled;
+    if (dim == dimBuffer) {
+      return sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+    }
+    if (dim == dimSubpassData) {
+      return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    }
+    return sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  }
+  default: return std::nullopt;
+  }
+}
+
+static std::optional<DescriptorBinding> descriptor(const SpvModule& module, const SpvVariable& variable, VkShaderStageFlagBits stage)
+{
+  const Decorations decorations = module.decoration(variable.id);
+  if (!decorations.binding.has_value()) {
+    return std::nullopt;
+  }
+
+  // Arrays of descriptors, nested ones multiply
+  uint32_t id = module.type(variable.pointer).operands.at(1);
+  uint32_t count = 1;
+  for (const SpvType* type = &module.type(id); type->op == SpvOp::typeArray || type->op == SpvOp::typeRuntimeArray;
+       type = &module.type(id)) {
+    count = type->op == SpvOp::typeArray ? count * module.constants.at(type->operands.at(1)) : 0;
+    id = type->operands.at(0);
+  }
+
+  const std::optional<VkDescriptorType> type = descriptorType(module, id, variable.storage);
+  if (!type.has_value()) {
+    return std::nullopt;
+  }
+  return DescriptorBinding{
+      .set = decorations.set.value_or(0),
+      .binding = *decorations.binding,
+      .type = *type,
+      .count = count,
+      .stages = static_cast<VkShaderStageFlags>(stage),
+  };
+}
+
+static VkFormat attributeFormat(const SpvType& scalar, uint32_t components)
+{
+  // Indexed by component count - 1
+  static constexpr std::array<VkFormat, 4> float16 = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT,
+                                                      VK_FORMAT_R16G16B16A16_SFLOAT};
+  static constexpr std::array<VkFormat, 4> float32 = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT,
+                                                      VK_FORMAT_R32G32B32A32_SFLOAT};
+  static constexpr std::array<VkFormat, 4> float64 = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT,
+                                                      VK_FORMAT_R64G64B64A64_SFLOAT};
+  static constexpr std::array<VkFormat, 4> sint32 = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT,
+                                                     VK_FORMAT_R32G32B32A32_SINT};
+  static constexpr std::array<VkFormat, 4> uint32 = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT,
+                                                     VK_FORMAT_R32G32B32A32_UINT};
+  const uint32_t width = scalar.operands.at(0);
+  const size_t index = components - 1;
+  if (scalar.op == SpvOp::typeFloat && width == 16) {
+    return float16.at(index);
+  }
+  if (scalar.op == SpvOp::typeFloat && width == 32) {
+    return float32.at(index);
+  }
+  if (scalar.op == SpvOp::typeFloat && width == 64) {
+    return float64.at(index);
+  }
+  if (scalar.op == SpvOp::typeInt && width == 32) {
+    return scalar.operands.at(1) != 0 ? sint32.at(index) : uint32.at(index);
+  }
+  throw std::runtime_error(std::format("Unsupported vertex input of {} bit components", width));
+}
+
+static void addInputs(const SpvModule& module, uint32_t id, uint32_t& location, std::vector<VertexAttribute>& inputs)
+{
+  const SpvType& type = module.type(id);
+  switch (type.op) {
+  case SpvOp::typeArray:
+    for (uint32_t i = 0; i < module.constants.at(type.operands.at(1)); ++i) {
+      addInputs(module, type.operands.at(0), location, inputs);
+    }
+    return;
+  case SpvOp::typeMatrix:
+    for (uint32_t i = 0; i < type.operands.at(1); ++i) {
+      addInputs(module, type.operands.at(0), location, inputs);
+    }
+    return;
+  case SpvOp::typeVector:
+  case SpvOp::typeInt:
+  case SpvOp::typeFloat: {
+    const uint32_t components = type.op == SpvOp::typeVector ? type.operands.at(1) : 1;
+    const SpvType& scalar = type.op == SpvOp::typeVector ? module.type(type.operands.at(0)) : type;
+    const uint32_t size = sizeOf(module, id);
+    inputs.push_back({.location = location, .format = attributeFormat(scalar, components), .size = size});
+    // 64 bit vectors with three or four components take two locations
+    location += size > 16 ? 2 : 1;
+    return;
+  }
+  default: throw std::runtime_error("Unsupported vertex input type");
+  }
+}
+
+static SpecConstantInfo specConstantInfo(const SpvType& type, uint32_t id)
+{
+  switch (type.op) {
+  case SpvOp::typeBool: return {.id = id, .kind = ScalarKind::boolean, .size = 4};
+  case SpvOp::typeInt:
+    return {.id = id, .kind = type.operands.at(1) != 0 ? ScalarKind::signedInt : ScalarKind::unsignedInt, .size = type.operands.at(0) / 8};
+  case SpvOp::typeFloat: return {.id = id, .kind = ScalarKind::floating, .size = type.operands.at(0) / 8};
+  default: throw std::runtime_error(std::format("Specialization constant {} is not a scalar", id));
+  }
+}
+
+ShaderReflection reflect(std::span<const uint32_t> code)
+{
+  const SpvModule module = parse(code);
+  if (module.entries.size() != 1) {
+    throw std::runtime_error(std::format("SPIR-V module has {} entry points, reflection needs exactly one", module.entries.size()));
+  }
+
+  ShaderReflection reflection;
+  reflection.stage = stageOf(module.entries.front().model);
+  reflection.entry = module.entries.front().name;
+  reflection.localSize = module.localSize;
+
+  uint32_t pushBegin = UINT32_MAX;
+  uint32_t pushEnd = 0;
+  for (const SpvVariable& variable : module.variables) {
+    if (variable.storage == SpvStorage::pushConstant) {
+      const uint32_t block = module.type(variable.pointer).operands.at(1);
+      pushBegin = std::min(pushBegin, firstOffset(module, block));
+      pushEnd = std::max(pushEnd, sizeOf(module, block));
+    }
+    else if (variable.storage == SpvStorage::input) {
+      const Decorations decorations = module.decoration(variable.id);
+      if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || decorations.builtIn || !decorations.location.has_value()) {
+        continue;
+      }
+      uint32_t location = *decorations.location;
+      addInputs(module, module.type(variable.pointer).operands.at(1), location, reflection.inputs);
+    }
+    else if (const auto binding = descriptor(module, variable, reflection.stage); binding.has_value()) {
+      reflection.bindings.push_back(*binding);
+    }
+  }
+
+  for (const SpvSpecConstant& constant : module.specConstants) {
+    // Without a SpecId the API can not set the constant
+    const std::optional<uint32_t> id = module.decoration(constant.id).specId;
+    if (id.has_value()) {
+      reflection.specConstants.push_back(specConstantInfo(module.type(constant.type), *id));
+    }
+  }
+
+  if (pushEnd > pushBegin) {
+    reflection.pushConstants = {.stageFlags = static_cast<VkShaderStageFlags>(reflection.stage), .offset = pushBegin, .size = pushEnd - pushBegin};
+  }
+  std::ranges::sort(reflection.bindings, {}, [](const DescriptorBinding& binding) { return std::pair(binding.set, binding.binding); });
+  std::ranges::sort(reflection.inputs, {}, &VertexAttribute::location);
+  std::ranges::sort(reflection.specConstants, {}, &SpecConstantInfo::id);
+  return reflection;
+}
+
+PipelineReflection combine(std::span<const ShaderReflection* const> stages)
+{
+  PipelineReflection pipeline;
+  VkPushConstantRange push = {.stageFlags = 0, .offset = UINT32_MAX, .size = 0};
+  uint32_t pushEnd = 0;
+  for (const ShaderReflection* stage : stages) {
+    for (const DescriptorBinding& binding : stage->bindings) {
+      auto found = std::ranges::find_if(pipeline.bindings, [&binding](const DescriptorBinding& existing) {
+        return existing.set == binding.set && existing.binding == binding.binding;
+      });
+      if (found == pipeline.bindings.end()) {
+        pipeline.bindings.push_back(binding);
+        continue;
+      }
+      if (found->type != binding.type || found->count != binding.count) {
+        throw std::runtime_error(std::format("Stages disagree on descriptor set {} binding {}", binding.set, binding.binding));
+      }
+      found->stages |= binding.stages;
+    }
+    if (stage->pushConstants.size != 0) {
+      push.stageFlags |= stage->pushConstants.stageFlags;
+      push.offset = std::min(push.offset, stage->pushConstants.offset);
+      pushEnd = std::max(pushEnd, stage->pushConstants.offset + stage->pushConstants.size);
+    }
+  }
+
+  if (push.stageFlags != 0) {
+    push.size = pushEnd - push.offset;
+    pipeline.pushConstants.push_back(push);
+  }
+  std::ranges::sort(pipeline.bindings, {}, [](const DescriptorBinding& binding) { return std::pair(binding.set, binding.binding); });
+  return pipeline;
+}
+
+VertexInput vertexInput(const ShaderReflection& vertex, uint32_t binding)
+{
+  VertexInput input;
+  uint32_t offset = 0;
+  for (const VertexAttribute& attribute : vertex.inputs) {
+    input.attributes.push_back({.location = attribute.location, .binding = binding, .format = attribute.format, .offset = offset});
+    // Every attribute starts 4 byte aligned, 16 bit vectors of three components are padded
+    offset += (attribute.size + 3U) & ~3U;
+  }
+  if (!input.attributes.empty()) {
+    input.bindings.push_back({.binding = binding, .stride = offset, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX});
+  }
+  return input;
+}
+}  // namespace vulkan
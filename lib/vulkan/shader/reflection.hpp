@@ -0,0 +1,81 @@
+#ifndef LIB_VULKAN_SHADER_REFLECTION
+#define LIB_VULKAN_SHADER_REFLECTION
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+struct DescriptorBinding {
+  uint32_t set = 0;
+  uint32_t binding = 0;
+  VkDescriptorType type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  // 0 for runtime sized arrays
+  uint32_t count = 1;
+  VkShaderStageFlags stages = 0;
+
+  bool operator==(const DescriptorBinding&) const = default;
+};
+
+enum class ScalarKind : uint8_t {
+  boolean,
+  signedInt,
+  unsignedInt,
+  floating,
+};
+
+struct SpecConstantInfo {
+  uint32_t id = 0;
+  ScalarKind kind = ScalarKind::unsignedInt;
+  // Bytes the constant takes in VkSpecializationInfo data, booleans are VkBool32
+  uint32_t size = 4;
+};
+
+struct VertexAttribute {
+  uint32_t location = 0;
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  uint32_t size = 0;
+};
+
+// Everything a layout needs from one entry point, read from the SPIR-V itself
+struct ShaderReflection {
+  VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+  std::string entry = "main";
+  // Sorted by set and binding
+  std::vector<DescriptorBinding> bindings;
+  // Size 0 when the stage has no push constants
+  VkPushConstantRange pushConstants = {.stageFlags = 0, .offset = 0, .size = 0};
+  // Vertex stage only, sorted by location, matrices take one attribute per column
+  std::vector<VertexAttribute> inputs;
+  // Compute stage only
+  std::array<uint32_t, 3> localSize = {0, 0, 0};
+  // Sorted by constant id
+  std::vector<SpecConstantInfo> specConstants;
+};
+
+// Stages of one pipeline combined, descriptors used by several stages are merged into one binding
+struct PipelineReflection {
+  // Sorted by set and binding
+  std::vector<DescriptorBinding> bindings;
+  // At most one range covering every stage that uses push constants, pipelines with the same one stay compatible
+  std::vector<VkPushConstantRange> pushConstants;
+};
+
+// Vertex input with every attribute interleaved into one binding in location order
+struct VertexInput {
+  std::vector<VkVertexInputBindingDescription> bindings;
+  std::vector<VkVertexInputAttributeDescription> attributes;
+};
+
+// Throws on malformed SPIR-V or modules without exactly one entry point
+[[nodiscard]] ShaderReflection reflect(std::span<const uint32_t> code);
+// Throws when two stages declare the same binding with different types or counts
+[[nodiscard]] PipelineReflection combine(std::span<const ShaderReflection* const> stages);
+[[nodiscard]] VertexInput vertexInput(const ShaderReflection& vertex, uint32_t binding = 0);
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_REFLECTION */
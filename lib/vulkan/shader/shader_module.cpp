@@ -0,0 +1,65 @@
+#include "shader_module.hpp"
+
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+
+#include <vulkan/vulkan_core.h>
+
+#include "embedded_shader.hpp"
+#include "format/string.hpp"
+#include "hash/hash.hpp"
+#include "reflection.hpp"
+
+namespace vulkan {
+ShaderModule::ShaderModule(VkDevice device, std::span<const uint32_t> code)
+    : _device(device),
+      _reflection(reflect(code)),
+      _hash(utils::fnv1a(std::as_bytes(code)))
+{
+  const VkShaderModuleCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .codeSize = code.size_bytes(),
+      .pCode = code.data(),
+  };
+
+  if (const VkResult status = vkCreateShaderModule(_device, &createInfo, nullptr, &_module); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create shader module! status: {}", utils::result(status)));
+  }
+}
+
+ShaderModule::ShaderModule(VkDevice device, const EmbeddedShader& shader) : ShaderModule(device, shader.code)
+{
+  if (_reflection.stage != shader.stage) {
+    throw std::runtime_error(std::format("Shader {} does not contain the stage its extension names", shader.name));
+  }
+}
+
+ShaderModule::~ShaderModule()
+{
+  vkDestroyShaderModule(_device, _module, nullptr);
+}
+
+VkShaderModule ShaderModule::get() const
+{
+  return _module;
+}
+
+VkShaderStageFlagBits ShaderModule::getStage() const
+{
+  return _reflection.stage;
+}
+
+const ShaderReflection& ShaderModule::getReflection() const
+{
+  return _reflection;
+}
+
+uint64_t ShaderModule::getHash() const
+{
+  return _hash;
+}
+}  // namespace vulkan
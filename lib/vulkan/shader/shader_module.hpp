@@ -0,0 +1,39 @@
+#ifndef LIB_VULKAN_SHADER_SHADER_MODULE
+#define LIB_VULKAN_SHADER_SHADER_MODULE
+
+#include <cstdint>
+#include <span>
+
+#include <vulkan/vulkan_core.h>
+
+#include "embedded_shader.hpp"
+#include "reflection.hpp"
+
+namespace vulkan {
+// VkShaderModule created straight from SPIR-V in memory, nothing is read from disk. The code is reflected once on creation
+class ShaderModule {
+public:
+  ShaderModule(const ShaderModule&) = delete;
+  ShaderModule(ShaderModule&&) = delete;
+  ShaderModule& operator=(const ShaderModule&) = delete;
+  ShaderModule& operator=(ShaderModule&&) = delete;
+
+  explicit ShaderModule(VkDevice device, std::span<const uint32_t> code);
+  explicit ShaderModule(VkDevice device, const EmbeddedShader& shader);
+  ~ShaderModule();
+
+  [[nodiscard]] VkShaderModule get() const;
+  [[nodiscard]] VkShaderStageFlagBits getStage() const;
+  [[nodiscard]] const ShaderReflection& getReflection() const;
+  // FNV-1a of the SPIR-V, equal code gives equal hashes in every run
+  [[nodiscard]] uint64_t getHash() const;
+
+private:
+  VkDevice _device;
+  ShaderReflection _reflection;
+  uint64_t _hash;
+  VkShaderModule _module = nullptr;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_SHADER_MODULE */
@@ -0,0 +1,59 @@
+#include "shader_variants.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include <vulkan/vulkan_core.h>
+
+#include "embedded_shader.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "shader_module.hpp"
+#include "specialization.hpp"
+
+namespace vulkan {
+ShaderVariants::ShaderVariants(VkDevice device)
+    : _device(device)
+{
+}
+
+ShaderStage ShaderVariants::stage(const ShaderModule& module, std::string_view name, const SpecializationView& constants)
+{
+  ShaderStage stage{.stage = module.getStage(), .module = module.get(), .entry = module.getReflection().entry, .hash = module.getHash()};
+  if (constants.entries.empty()) {
+    return stage;
+  }
+  validate(constants, module.getReflection());
+
+  // The variant is keyed by the code it was built from, a reloaded module falls back to the driver
+  if (const EmbeddedVariant* variant = findVariant(name, module.getHash(), specializationKey(constants)); variant != nullptr) {
+    auto& frozen = _frozen[variant];
+    const bool created = frozen == nullptr;
+    if (created) {
+      frozen = std::make_unique<ShaderModule>(_device, variant->code);
+    }
+    {
+      const std::scoped_lock lock(_mutex);
+      _stats.modules += created ? 1 : 0;
+      ++_stats.precompiled;
+    }
+    stage.module = frozen->get();
+    stage.hash = frozen->getHash();
+    return stage;
+  }
+
+  {
+    const std::scoped_lock lock(_mutex);
+    ++_stats.specialized;
+  }
+  stage.specialization.assign(constants.entries.begin(), constants.entries.end());
+  stage.specializationData.assign(constants.data.begin(), constants.data.end());
+  return stage;
+}
+
+VariantStats ShaderVariants::getStats() const
+{
+  const std::scoped_lock lock(_mutex);
+  return _stats;
+}
+}  // namespace vulkan
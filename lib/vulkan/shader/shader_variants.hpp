@@ -0,0 +1,54 @@
+#ifndef LIB_VULKAN_SHADER_SHADER_VARIANTS
+#define LIB_VULKAN_SHADER_SHADER_VARIANTS
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include <vulkan/vulkan_core.h>
+
+#include "embedded_shader.hpp"
+#include "pipeline/pipeline_compiler.hpp"
+#include "shader_module.hpp"
+#include "specialization.hpp"
+
+namespace vulkan {
+struct VariantStats {
+  // Stages served by SPIR-V frozen at build time
+  uint64_t precompiled = 0;
+  // Stages passed on with VkSpecializationInfo, the driver folds the constants while compiling the pipeline
+  uint64_t specialized = 0;
+  // Modules created for frozen variants
+  uint64_t modules = 0;
+};
+
+// Turns a shader module and constant values into a pipeline stage, on demand. A variant the permutation tool froze at
+// build time becomes its own module, anything else is specialized by the driver. Pipelines of either kind go through
+// PipelineCompiler, equal variants hit its table and the VkPipelineCache instead of compiling again. Not thread safe,
+// only getStats() may be called from other threads
+class ShaderVariants {
+public:
+  ShaderVariants(const ShaderVariants&) = delete;
+  ShaderVariants(ShaderVariants&&) = delete;
+  ShaderVariants& operator=(const ShaderVariants&) = delete;
+  ShaderVariants& operator=(ShaderVariants&&) = delete;
+
+  explicit ShaderVariants(VkDevice device);
+  ~ShaderVariants() = default;
+
+  // Name is the embedded shader name of the module. Throws when a constant does not match the reflected ones.
+  // Frozen modules live as long as this object, compiles using them have to finish first
+  [[nodiscard]] ShaderStage stage(const ShaderModule& module, std::string_view name, const SpecializationView& constants = {});
+  [[nodiscard]] VariantStats getStats() const;
+
+private:
+  VkDevice _device;
+  std::unordered_map<const EmbeddedVariant*, std::unique_ptr<ShaderModule>> _frozen;
+  mutable std::mutex _mutex;
+  VariantStats _stats;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_SHADER_VARIANTS */
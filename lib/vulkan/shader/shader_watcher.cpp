@@ -0,0 +1,284 @@
+#include "shader_watcher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "format/logtime.hpp"
+#include "process/spawn.hpp"
+#include "reflection.hpp"
+
+namespace vulkan {
+static constexpr int pollTimeoutMs = 100;
+// Editors save in bursts (truncate, write, rename), events closer together than this are one change
+static constexpr int settleTimeMs = 50;
+static constexpr std::array<std::string_view, 3> shaderExtensions = {".vert", ".frag", ".comp"};
+
+static std::atomic<uint64_t> tempCounter = 0;
+
+static bool isShader(const std::filesystem::path& path)
+{
+  return std::ranges::find(shaderExtensions, path.extension().string()) != shaderExtensions.end();
+}
+
+// Quoted #include directives, resolved the way glslangValidator does: relative to the including file
+static std::vector<std::filesystem::path> includesOf(const std::filesystem::path& file)
+{
+  std::vector<std::filesystem::path> includes;
+  std::ifstream stream(file);
+  for (std::string line; std::getline(stream, line);) {
+    std::string_view view = line;
+    const auto skipSpaces = [&view] {
+      while (!view.empty() && (view.front() == ' ' || view.front() == '\t')) {
+        view.remove_prefix(1);
+      }
+    };
+    skipSpaces();
+    if (!view.starts_with('#')) {
+      continue;
+    }
+    view.remove_prefix(1);
+    skipSpaces();
+    if (!view.starts_with("include")) {
+      continue;
+    }
+    view.remove_prefix(std::string_view("include").size());
+    skipSpaces();
+    if (!view.starts_with('"')) {
+      continue;
+    }
+    view.remove_prefix(1);
+    if (const size_t end = view.find('"'); end != std::string_view::npos) {
+      includes.push_back((file.parent_path() / view.substr(0, end)).lexically_normal());
+    }
+  }
+  return includes;
+}
+
+static std::vector<uint32_t> readSpirv(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  const std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+  if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+    return {};
+  }
+  std::vector<uint32_t> code(bytes.size() / sizeof(uint32_t));
+  std::memcpy(code.data(), bytes.data(), bytes.size());
+  return code;
+}
+
+ShaderWatcher::ShaderWatcher(std::filesystem::path sources, std::filesystem::path compiler)
+    : _sources(sources.lexically_normal()),
+      _compiler(std::move(compiler))
+{
+#ifdef __linux__
+  if (!std::filesystem::is_directory(_sources)) {
+    std::cerr << std::format("Shader hot reload disabled, {} does not exist\n", _sources.string());
+    return;
+  }
+  _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_inotify < 0) {
+    throw std::runtime_error(std::format("Failed to initialize inotify! error: {}", std::generic_category().message(errno)));
+  }
+  watch(_sources);
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(_sources)) {
+    if (entry.is_directory()) {
+      watch(entry.path());
+    }
+  }
+  _thread = std::jthread([this](const std::stop_token& token) { loop(token); });
+#else
+  std::cerr << "Shader hot reload needs inotify, it is disabled on this platform\n";
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+#ifdef __linux__
+  if (_inotify >= 0) {
+    close(_inotify);
+  }
+#endif
+}
+
+std::shared_ptr<ShaderWatcher> ShaderWatcher::acquire()
+{
+  static std::mutex mutex;
+  static std::weak_ptr<ShaderWatcher> shared;
+
+  const std::scoped_lock lock(mutex);
+  std::shared_ptr<ShaderWatcher> watcher = shared.lock();
+  if (watcher == nullptr) {
+    watcher = std::make_shared<ShaderWatcher>(SHADER_SOURCE_DIR, SHADER_COMPILER);
+    shared = watcher;
+  }
+  return watcher;
+}
+
+uint64_t ShaderWatcher::getVersion() const
+{
+  return _version;
+}
+
+std::shared_ptr<const std::vector<uint32_t>> ShaderWatcher::getReloaded(std::string_view name, uint64_t since) const
+{
+  const std::scoped_lock lock(_mutex);
+  const auto found = _reloaded.find(std::string(name));
+  if (found == _reloaded.end() || found->second.version <= since) {
+    return nullptr;
+  }
+  return found->second.code;
+}
+
+bool ShaderWatcher::isWatching() const
+{
+  return _thread.joinable();
+}
+
+void ShaderWatcher::loop(const std::stop_token& token)
+{
+#ifdef __linux__
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+  std::set<std::filesystem::path> changed;
+  while (!token.stop_requested()) {
+    pollfd descriptor{.fd = _inotify, .events = POLLIN, .revents = 0};
+    // Once something changed, a quiet settle time ends the burst
+    if (poll(&descriptor, 1, changed.empty() ? pollTimeoutMs : settleTimeMs) > 0) {
+      for (ssize_t length = read(_inotify, buffer.data(), buffer.size()); length > 0;
+           length = read(_inotify, buffer.data(), buffer.size())) {
+        for (size_t at = 0; at < static_cast<size_t>(length);) {
+          inotify_event event{};
+          std::memcpy(&event, buffer.data() + at, sizeof(inotify_event));
+          const std::string name = event.len > 0 ? std::string(buffer.data() + at + sizeof(inotify_event)) : std::string();
+          at += sizeof(inotify_event) + event.len;
+
+          const auto directory = _watches.find(event.wd);
+          if (directory == _watches.end() || name.empty()) {
+            continue;
+          }
+          const std::filesystem::path path = (directory->second / name).lexically_normal();
+          if ((event.mask & IN_ISDIR) != 0) {
+            watch(path);
+            continue;
+          }
+          changed.insert(path);
+        }
+      }
+      continue;
+    }
+    if (changed.empty()) {
+      continue;
+    }
+
+    for (const std::filesystem::path& shader : affected(changed)) {
+      try {
+        recompile(shader);
+      }
+      catch (const std::exception& e) {
+        std::cerr << std::format("Shader reload failed, the running version stays:\n\t{}\n", e.what());
+      }
+    }
+    changed.clear();
+  }
+#else
+  static_cast<void>(token);
+#endif
+}
+
+void ShaderWatcher::watch(const std::filesystem::path& directory)
+{
+#ifdef __linux__
+  // Editors replacing the file by a rename show up as moved to, in place writes as close after write
+  static constexpr uint32_t events = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+  const int descriptor = inotify_add_watch(_inotify, directory.c_str(), events);
+  if (descriptor < 0) {
+    std::cerr << std::format("Failed to watch {}: {}\n", directory.string(), std::generic_category().message(errno));
+    return;
+  }
+  _watches[descriptor] = directory.lexically_normal();
+#else
+  static_cast<void>(directory);
+#endif
+}
+
+std::set<std::filesystem::path> ShaderWatcher::affected(const std::set<std::filesystem::path>& changed) const
+{
+  // Includes are scanned again on every change, an edit may have added or removed some
+  std::set<std::filesystem::path> shaders;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(_sources)) {
+    if (!entry.is_regular_file() || !isShader(entry.path())) {
+      continue;
+    }
+    const std::filesystem::path shader = entry.path().lexically_normal();
+    std::vector<std::filesystem::path> pending = {shader};
+    std::set<std::filesystem::path> seen;
+    while (!pending.empty()) {
+      const std::filesystem::path file = pending.back();
+      pending.pop_back();
+      if (!seen.insert(file).second) {
+        continue;
+      }
+      if (changed.contains(file)) {
+        shaders.insert(shader);
+        break;
+      }
+      std::ranges::copy(includesOf(file), std::back_inserter(pending));
+    }
+  }
+  return shaders;
+}
+
+void ShaderWatcher::recompile(const std::filesystem::path& shader)
+{
+  const std::string name = shader.lexically_relative(_sources).generic_string();
+  const utils::LogTime time(std::format("Shader reload {}", name));
+
+  // Same compiler and stage as the build, spirv-opt is skipped to keep the turnaround short
+  const std::filesystem::path output = std::filesystem::temp_directory_path() / std::format("shader_reload_{}.spv", tempCounter++);
+  const std::vector<std::string> args = {_compiler.string(), "-V", "-S", shader.extension().string().substr(1),
+                                         shader.string(), "-o", output.string()};
+  const int status = utils::run(args);
+  std::vector<uint32_t> code = readSpirv(output);
+  std::error_code ignored;
+  std::filesystem::remove(output, ignored);
+  if (status != 0 || code.empty()) {
+    throw std::runtime_error(std::format("Failed to compile {}", name));
+  }
+  // Modules the renderer could not reflect are rejected here instead of at the frame boundary
+  [[maybe_unused]] const ShaderReflection reflection = reflect(code);
+
+  const std::scoped_lock lock(_mutex);
+  const uint64_t version = _version + 1;
+  _reloaded[name] = {.version = version, .code = std::make_shared<const std::vector<uint32_t>>(std::move(code))};
+  _version = version;
+}
+}  // namespace vulkan
@@ -0,0 +1,65 @@
+#ifndef LIB_VULKAN_SHADER_SHADER_WATCHER
+#define LIB_VULKAN_SHADER_SHADER_WATCHER
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vulkan {
+// Development mode: watches the shader sources with inotify and recompiles a changed shader, or every shader including
+// a changed file, on its own thread. Consumers poll getVersion() at a frame boundary and pull the code they use
+class ShaderWatcher {
+public:
+  ShaderWatcher(const ShaderWatcher&) = delete;
+  ShaderWatcher(ShaderWatcher&&) = delete;
+  ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+  ShaderWatcher& operator=(ShaderWatcher&&) = delete;
+
+  // Compiler is the glslangValidator the build used, both paths are baked in at build time
+  explicit ShaderWatcher(std::filesystem::path sources, std::filesystem::path compiler);
+  ~ShaderWatcher();
+
+  // One watcher for the whole process, it lives while someone holds it
+  static std::shared_ptr<ShaderWatcher> acquire();
+
+  // Grows with every successful recompile
+  [[nodiscard]] uint64_t getVersion() const;
+  // Code of the shader if it was recompiled after version since, null otherwise. Names match EmbeddedShader::name
+  [[nodiscard]] std::shared_ptr<const std::vector<uint32_t>> getReloaded(std::string_view name, uint64_t since) const;
+  // False where inotify is not available or the sources are missing
+  [[nodiscard]] bool isWatching() const;
+
+private:
+  struct Reloaded {
+    uint64_t version;
+    std::shared_ptr<const std::vector<uint32_t>> code;
+  };
+
+  std::filesystem::path _sources;
+  std::filesystem::path _compiler;
+  int _inotify = -1;
+  std::unordered_map<int, std::filesystem::path> _watches;
+
+  mutable std::mutex _mutex;
+  std::unordered_map<std::string, Reloaded> _reloaded;
+  std::atomic<uint64_t> _version = 0;
+
+  std::jthread _thread;
+
+  void loop(const std::stop_token& token);
+  void watch(const std::filesystem::path& directory);
+  [[nodiscard]] std::set<std::filesystem::path> affected(const std::set<std::filesystem::path>& changed) const;
+  void recompile(const std::filesystem::path& shader);
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_SHADER_WATCHER */
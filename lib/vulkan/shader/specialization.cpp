@@ -0,0 +1,52 @@
+#include "specialization.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "hash/hash.hpp"
+#include "reflection.hpp"
+
+namespace vulkan {
+uint64_t specializationKey(const SpecializationView& constants)
+{
+  std::vector<VkSpecializationMapEntry> entries(constants.entries.begin(), constants.entries.end());
+  std::ranges::sort(entries, {}, &VkSpecializationMapEntry::constantID);
+
+  // Id and value of each constant, offsets differ between callers passing the same values
+  std::vector<std::byte> bytes;
+  for (const VkSpecializationMapEntry& entry : entries) {
+    if (entry.offset + entry.size > constants.data.size()) {
+      throw std::runtime_error(std::format("Specialization constant {} is outside of its data", entry.constantID));
+    }
+    const auto id = std::as_bytes(std::span(&entry.constantID, 1));
+    bytes.insert(bytes.end(), id.begin(), id.end());
+    const auto value = constants.data.subspan(entry.offset, entry.size);
+    bytes.insert(bytes.end(), value.begin(), value.end());
+  }
+  return utils::fnv1a(bytes);
+}
+
+void validate(const SpecializationView& constants, const ShaderReflection& reflection)
+{
+  for (const VkSpecializationMapEntry& entry : constants.entries) {
+    const auto found = std::ranges::lower_bound(reflection.specConstants, entry.constantID, {}, &SpecConstantInfo::id);
+    if (found == reflection.specConstants.end() || found->id != entry.constantID) {
+      throw std::runtime_error(std::format("Shader has no specialization constant {}", entry.constantID));
+    }
+    if (found->size != entry.size) {
+      throw std::runtime_error(std::format("Specialization constant {} is {} bytes, {} given", entry.constantID,
+                                           found->size, entry.size));
+    }
+    if (entry.offset + entry.size > constants.data.size()) {
+      throw std::runtime_error(std::format("Specialization constant {} is outside of its data", entry.constantID));
+    }
+  }
+}
+}  // namespace vulkan
@@ -0,0 +1,115 @@
+#ifndef LIB_VULKAN_SHADER_SPECIALIZATION
+#define LIB_VULKAN_SHADER_SPECIALIZATION
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <vulkan/vulkan_core.h>
+
+#include "memory/gpu_struct.hpp"
+#include "reflection.hpp"
+
+namespace vulkan {
+// One layout(constant_id = Id) constant of a shader. Default is the value the GLSL declaration has, so an untouched
+// constant gives the same code as no specialization at all
+template <uint32_t Id, FieldName Name, typename T, T Default = T{}>
+struct SpecConstant {
+  static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+                    std::is_same_v<T, float>,
+                "Specialization constants are bool, int, uint or float");
+
+  using Type = T;
+  static constexpr uint32_t id = Id;
+  static constexpr std::string_view name = Name.view();
+  static constexpr T defaultValue = Default;
+};
+
+// Constants of one variant as VkSpecializationInfo takes them, entries point into data
+struct SpecializationView {
+  std::span<const VkSpecializationMapEntry> entries;
+  std::span<const std::byte> data;
+};
+
+// FNV-1a over the constants in id order, equal values give equal keys in every run and in the permutation tool
+[[nodiscard]] uint64_t specializationKey(const SpecializationView& constants);
+// Throws when a constant is not declared by the shader or its size does not match the declaration
+void validate(const SpecializationView& constants, const ShaderReflection& reflection);
+
+// Typed options of one shader, every constant is always passed. Booleans are stored as VkBool32
+template <typename... Constants>
+class Specialization {
+  static constexpr size_t count = sizeof...(Constants);
+  static constexpr std::array<std::string_view, count> names = {Constants::name...};
+  static_assert(count > 0, "Specialization needs at least one constant");
+  static_assert(layout::uniqueNames(names), "Specialization constant names have to be unique");
+
+public:
+  template <FieldName Name>
+  using TypeOf = std::tuple_element_t<layout::indexOf(names, Name.view()), std::tuple<typename Constants::Type...>>;
+
+  Specialization()
+  {
+    size_t index = 0;
+    (store(index++, Constants::defaultValue), ...);
+  }
+
+  template <FieldName Name>
+  void set(TypeOf<Name> value)
+  {
+    store(layout::indexOf(names, Name.view()), value);
+  }
+
+  template <FieldName Name>
+  [[nodiscard]] TypeOf<Name> get() const
+  {
+    constexpr size_t index = layout::indexOf(names, Name.view());
+    if constexpr (std::is_same_v<TypeOf<Name>, bool>) {
+      return load<VkBool32>(index) != VK_FALSE;
+    }
+    else {
+      return load<TypeOf<Name>>(index);
+    }
+  }
+
+  [[nodiscard]] SpecializationView view() const { return {.entries = entries, .data = _data}; }
+  [[nodiscard]] uint64_t key() const { return specializationKey(view()); }
+
+private:
+  static constexpr uint32_t slot = 4;
+  static constexpr std::array<VkSpecializationMapEntry, count> entries = [] {
+    std::array<VkSpecializationMapEntry, count> result{};
+    uint32_t index = 0;
+    ((result.at(index) = {.constantID = Constants::id, .offset = index * slot, .size = slot}, ++index), ...);
+    return result;
+  }();
+
+  std::array<std::byte, count * slot> _data{};
+
+  template <typename T>
+  void store(size_t index, T value)
+  {
+    if constexpr (std::is_same_v<T, bool>) {
+      store<VkBool32>(index, value ? VK_TRUE : VK_FALSE);
+    }
+    else {
+      std::memcpy(_data.data() + (index * slot), &value, slot);
+    }
+  }
+
+  template <typename T>
+  [[nodiscard]] T load(size_t index) const
+  {
+    T value{};
+    std::memcpy(&value, _data.data() + (index * slot), slot);
+    return value;
+  }
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SHADER_SPECIALIZATION */
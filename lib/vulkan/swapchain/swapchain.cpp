@@ -0,0 +1,233 @@
+#include "swapchain.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "format/string.hpp"
+#include "window/window_info.hpp"
+
+namespace vulkan {
+static VkSurfaceFormatKHR chooseFormat(VkPhysicalDevice device, VkSurfaceKHR surface)
+{
+  uint32_t count = 0;
+  if (const VkResult status = vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &count, nullptr); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get surface formats! status: {}", utils::result(status)));
+  }
+  std::vector<VkSurfaceFormatKHR> formats(count);
+  if (const VkResult status = vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &count, formats.data()); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get surface formats! status: {}", utils::result(status)));
+  }
+  if (formats.empty()) {
+    throw std::runtime_error("Surface does not expose any format");
+  }
+
+  static constexpr auto preferred = [](const VkSurfaceFormatKHR& format) {
+    return (format.format == VK_FORMAT_B8G8R8A8_SRGB || format.format == VK_FORMAT_R8G8B8A8_SRGB) &&
+           format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+  };
+  if (auto found = std::ranges::find_if(formats, preferred); found != formats.end()) {
+    return *found;
+  }
+  return formats.front();
+}
+
+static VkPresentModeKHR choosePresentMode(VkPhysicalDevice device, VkSurfaceKHR surface, VkPresentModeKHR wanted)
+{
+  uint32_t count = 0;
+  if (const VkResult status = vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &count, nullptr); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get present modes! status: {}", utils::result(status)));
+  }
+  std::vector<VkPresentModeKHR> modes(count);
+  if (const VkResult status = vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &count, modes.data()); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get present modes! status: {}", utils::result(status)));
+  }
+
+  // FIFO is the only mode every implementation has to support
+  return std::ranges::find(modes, wanted) != modes.end() ? wanted : VK_PRESENT_MODE_FIFO_KHR;
+}
+
+static VkExtent2D chooseExtent(const VkSurfaceCapabilitiesKHR& capabilities, VkExtent2D fallback)
+{
+  if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
+    return capabilities.currentExtent;
+  }
+
+  // Surface size is defined by the swapchain, GLFW can not be queried from the render thread
+  return {
+      .width = std::clamp(fallback.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width),
+      .height = std::clamp(fallback.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height),
+  };
+}
+
+static std::vector<VkImage> queryImages(VkDevice device, VkSwapchainKHR swapchain)
+{
+  uint32_t count = 0;
+  if (const VkResult status = vkGetSwapchainImagesKHR(device, swapchain, &count, nullptr); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get swapchain images! status: {}", utils::result(status)));
+  }
+  std::vector<VkImage> images(count);
+  if (const VkResult status = vkGetSwapchainImagesKHR(device, swapchain, &count, images.data()); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get swapchain images! status: {}", utils::result(status)));
+  }
+  return images;
+}
+
+static VkImageView createView(VkDevice device, VkImage image, VkFormat format)
+{
+  const VkImageViewCreateInfo createInfo{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .image = image,
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format = format,
+      .components = {.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                     .a = VK_COMPONENT_SWIZZLE_IDENTITY},
+      .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1},
+  };
+
+  VkImageView view = nullptr;
+  if (const VkResult status = vkCreateImageView(device, &createInfo, nullptr, &view); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create swapchain image view! status: {}", utils::result(status)));
+  }
+  return view;
+}
+
+Swapchain::Swapchain(const VulkanDevice& device, VkSurfaceKHR surface, const WindowInfo& info)
+    : _device(device.get()),
+      _physical(device.getPhysical()),
+      _surface(surface),
+      _fallback{.width = static_cast<uint32_t>(info.width), .height = static_cast<uint32_t>(info.height)},
+      _presentMode(choosePresentMode(_physical, surface, info.presentMode))
+{
+  _format = chooseFormat(_physical, _surface);
+  [[maybe_unused]] const bool created = recreate();
+}
+
+Swapchain::~Swapchain()
+{
+  destroyViews();
+  if (_swapchain != nullptr) {
+    vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+  }
+}
+
+bool Swapchain::recreate()
+{
+  VkSurfaceCapabilitiesKHR capabilities{};
+  if (const VkResult status = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(_physical, _surface, &capabilities); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to get surface capabilities! status: {}", utils::result(status)));
+  }
+
+  const VkExtent2D extent = chooseExtent(capabilities, _fallback);
+  if (extent.width == 0 || extent.height == 0) {
+    return false;
+  }
+
+  uint32_t imageCount = capabilities.minImageCount + 1;
+  if (capabilities.maxImageCount != 0) {
+    imageCount = std::min(imageCount, capabilities.maxImageCount);
+  }
+
+  // Transfer usage is needed for clears and readback, ask only for what the surface allows
+  static constexpr VkImageUsageFlags wantedUsage = static_cast<uint32_t>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) |
+                                                   static_cast<uint32_t>(VK_IMAGE_USAGE_TRANSFER_DST_BIT) |
+                                                   static_cast<uint32_t>(VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+  const VkImageUsageFlags usage = wantedUsage & capabilities.supportedUsageFlags;
+
+  VkSwapchainKHR oldSwapchain = _swapchain;
+  const VkSwapchainCreateInfoKHR createInfo{
+      .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+      .pNext = nullptr,
+      .flags = 0,
+      .surface = _surface,
+      .minImageCount = imageCount,
+      .imageFormat = _format.format,
+      .imageColorSpace = _format.colorSpace,
+      .imageExtent = extent,
+      .imageArrayLayers = 1,
+      .imageUsage = usage,
+      .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+      .preTransform = capabilities.currentTransform,
+      .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+      .presentMode = _presentMode,
+      .clipped = VK_TRUE,
+      .oldSwapchain = oldSwapchain,
+  };
+
+  VkSwapchainKHR swapchain = nullptr;
+  if (const VkResult status = vkCreateSwapchainKHR(_device, &createInfo, nullptr, &swapchain); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create swapchain! status: {}", utils::result(status)));
+  }
+
+  destroyViews();
+  if (oldSwapchain != nullptr) {
+    vkDestroySwapchainKHR(_device, oldSwapchain, nullptr);
+  }
+
+  _swapchain = swapchain;
+  _extent = extent;
+  _usage = usage;
+  _images = queryImages(_device, _swapchain);
+  _views.reserve(_images.size());
+  for (VkImage image : _images) {
+    _views.push_back(createView(_device, image, _format.format));
+  }
+
+  return true;
+}
+
+VkResult Swapchain::acquire(VkSemaphore signal, uint32_t& index, uint64_t timeout) const
+{
+  return vkAcquireNextImageKHR(_device, _swapchain, timeout, signal, nullptr, &index);
+}
+
+VkSwapchainKHR Swapchain::get() const
+{
+  return _swapchain;
+}
+
+VkFormat Swapchain::getFormat() const
+{
+  return _format.format;
+}
+
+VkExtent2D Swapchain::getExtent() const
+{
+  return _extent;
+}
+
+VkImageUsageFlags Swapchain::getUsage() const
+{
+  return _usage;
+}
+
+const std::vector<VkImage>& Swapchain::getImages() const
+{
+  return _images;
+}
+
+const std::vector<VkImageView>& Swapchain::getViews() const
+{
+  return _views;
+}
+
+void Swapchain::destroyViews()
+{
+  for (VkImageView view : _views) {
+    vkDestroyImageView(_device, view, nullptr);
+  }
+  _views.clear();
+}
+}  // namespace vulkan
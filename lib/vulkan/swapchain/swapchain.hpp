@@ -0,0 +1,52 @@
+#ifndef LIB_VULKAN_SWAPCHAIN_SWAPCHAIN
+#define LIB_VULKAN_SWAPCHAIN_SWAPCHAIN
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "device/device.hpp"
+#include "window/window_info.hpp"
+
+namespace vulkan {
+class Swapchain {
+public:
+  Swapchain(const Swapchain&) = delete;
+  Swapchain(Swapchain&&) = delete;
+  Swapchain& operator=(const Swapchain&) = delete;
+  Swapchain& operator=(Swapchain&&) = delete;
+
+  explicit Swapchain(const VulkanDevice& device, VkSurfaceKHR surface, const WindowInfo& info);
+  ~Swapchain();
+
+  // Returns false while the surface has no area (minimized window), the old swapchain stays untouched
+  [[nodiscard]] bool recreate();
+  [[nodiscard]] VkResult acquire(VkSemaphore signal, uint32_t& index, uint64_t timeout) const;
+
+  [[nodiscard]] VkSwapchainKHR get() const;
+  [[nodiscard]] VkFormat getFormat() const;
+  [[nodiscard]] VkExtent2D getExtent() const;
+  [[nodiscard]] VkImageUsageFlags getUsage() const;
+  [[nodiscard]] const std::vector<VkImage>& getImages() const;
+  [[nodiscard]] const std::vector<VkImageView>& getViews() const;
+
+private:
+  VkDevice _device;
+  VkPhysicalDevice _physical;
+  VkSurfaceKHR _surface;
+  VkExtent2D _fallback;
+  VkPresentModeKHR _presentMode;
+
+  VkSwapchainKHR _swapchain = nullptr;
+  VkSurfaceFormatKHR _format{};
+  VkExtent2D _extent{};
+  VkImageUsageFlags _usage = 0;
+  std::vector<VkImage> _images;
+  std::vector<VkImageView> _views;
+
+  void destroyViews();
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SWAPCHAIN_SWAPCHAIN */
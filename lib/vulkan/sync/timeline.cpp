@@ -0,0 +1,81 @@
+#include "timeline.hpp"
+
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+
+#include <vulkan/vulkan_core.h>
+
+#include "format/string.hpp"
+
+namespace vulkan {
+Timeline::Timeline(VkDevice device, uint64_t initial) : _device(device), _next(initial)
+{
+  const VkSemaphoreTypeCreateInfo typeInfo{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .pNext = nullptr,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue = initial,
+  };
+  const VkSemaphoreCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &typeInfo, .flags = 0};
+
+  if (const VkResult status = vkCreateSemaphore(_device, &createInfo, nullptr, &_semaphore); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to create timeline semaphore! status: {}", utils::result(status)));
+  }
+}
+
+Timeline::~Timeline()
+{
+  vkDestroySemaphore(_device, _semaphore, nullptr);
+}
+
+uint64_t Timeline::next()
+{
+  return ++_next;
+}
+
+uint64_t Timeline::value() const
+{
+  uint64_t value = 0;
+  if (const VkResult status = vkGetSemaphoreCounterValue(_device, _semaphore, &value); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to read timeline semaphore! status: {}", utils::result(status)));
+  }
+  return value;
+}
+
+bool Timeline::wait(uint64_t value, uint64_t timeout) const
+{
+  const VkSemaphoreWaitInfo waitInfo{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .semaphoreCount = 1,
+      .pSemaphores = &_semaphore,
+      .pValues = &value,
+  };
+
+  const VkResult status = vkWaitSemaphores(_device, &waitInfo, timeout);
+  if (status != VK_SUCCESS && status != VK_TIMEOUT) {
+    throw std::runtime_error(std::format("Failed to wait for timeline semaphore! status: {}", utils::result(status)));
+  }
+  return status == VK_SUCCESS;
+}
+
+void Timeline::signal(uint64_t value) const
+{
+  const VkSemaphoreSignalInfo signalInfo{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+      .pNext = nullptr,
+      .semaphore = _semaphore,
+      .value = value,
+  };
+  if (const VkResult status = vkSignalSemaphore(_device, &signalInfo); status != VK_SUCCESS) {
+    throw std::runtime_error(std::format("Failed to signal timeline semaphore! status: {}", utils::result(status)));
+  }
+}
+
+VkSemaphore Timeline::get() const
+{
+  return _semaphore;
+}
+}  // namespace vulkan
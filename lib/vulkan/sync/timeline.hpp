@@ -0,0 +1,45 @@
+#ifndef LIB_VULKAN_SYNC_TIMELINE
+#define LIB_VULKAN_SYNC_TIMELINE
+
+#include <atomic>
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+namespace vulkan {
+// Wait on a timeline value from another submission, value 0 marks a binary semaphore
+struct SemaphoreWait {
+  VkSemaphore semaphore = nullptr;
+  uint64_t value = 0;
+  VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+// Timeline semaphore, values have to be signaled in the order they are handed out by next()
+class Timeline {
+public:
+  Timeline(const Timeline&) = delete;
+  Timeline(Timeline&&) = delete;
+  Timeline& operator=(const Timeline&) = delete;
+  Timeline& operator=(Timeline&&) = delete;
+
+  explicit Timeline(VkDevice device, uint64_t initial = 0);
+  ~Timeline();
+
+  // Reserves the next value to be signaled by a submission
+  [[nodiscard]] uint64_t next();
+  // Value currently reached by the device
+  [[nodiscard]] uint64_t value() const;
+  // Returns false on timeout
+  [[nodiscard]] bool wait(uint64_t value, uint64_t timeout) const;
+  void signal(uint64_t value) const;
+
+  [[nodiscard]] VkSemaphore get() const;
+
+private:
+  VkDevice _device;
+  VkSemaphore _semaphore = nullptr;
+  std::atomic<uint64_t> _next;
+};
+}  // namespace vulkan
+
+#endif /* LIB_VULKAN_SYNC_TIMELINE */
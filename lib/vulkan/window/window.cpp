@@ -2,10 +2,12 @@
 
 #include <memory>
 #include <stdexcept>
+#include <string>
 
 #include "GLFW/glfw3.h"
 
 #include "device/device.hpp"
+#include "render/render_thread.hpp"
 #include "window_info.hpp"
 
 namespace vulkan {
@@ -30,10 +32,24 @@ static void destroyWindow(GLFWwindow* window)
 }
 
 Window::Window(const WindowInfo& info)
-    : _window(createWindow(info), destroyWindow),  //
+    : _title(info.title),
+      _window(createWindow(info), destroyWindow),  //
       _surface(_window.get()),
       _device(info, _surface.get())
 {
+  if (info.renderThread) {
+    _renderer = std::make_unique<RenderThread>(_device, _surface.get(), info);
+  }
+}
+
+bool Window::shouldClose() const
+{
+  return glfwWindowShouldClose(_window.get()) != 0;
+}
+
+const std::string& Window::getTitle() const
+{
+  return _title;
 }
 
 GLFWwindow* Window::getWindow() const
@@ -41,4 +57,19 @@ GLFWwindow* Window::getWindow() const
   return _window.get();
 }
 
+VkSurfaceKHR Window::getSurface() const
+{
+  return _surface.get();
+}
+
+const VulkanDevice& Window::getDevice() const
+{
+  return _device;
+}
+
+const RenderThread* Window::getRenderer() const
+{
+  return _renderer.get();
+}
+
 }  // namespace vulkan
\ No newline at end of file
@@ -2,11 +2,13 @@
 #define LIB_VULKAN_WINDOW_WINDOW
 
 #include <memory>
+#include <string>
 
 #include "GLFW/glfw3.h"
 #include <vulkan/vulkan_core.h>
 
 #include "device/device.hpp"
+#include "render/render_thread.hpp"
 #include "surface/surface.hpp"
 #include "window_info.hpp"
 
@@ -22,13 +24,19 @@ public:
   ~Window() = default;
 
   [[nodiscard]] bool shouldClose() const;
+  [[nodiscard]] const std::string& getTitle() const;
   [[nodiscard]] GLFWwindow* getWindow() const;
   [[nodiscard]] VkSurfaceKHR getSurface() const;
+  [[nodiscard]] const VulkanDevice& getDevice() const;
+  [[nodiscard]] const RenderThread* getRenderer() const;
 
 private:
+  std::string _title;
   std::unique_ptr<GLFWwindow, void (*)(GLFWwindow*)> _window;
   Surface _surface;
   VulkanDevice _device;
+  // Declared last, the thread has to stop before the device and surface go away
+  std::unique_ptr<RenderThread> _renderer;
 };
 
 }  // namespace vulkan
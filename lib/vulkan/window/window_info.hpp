@@ -1,12 +1,16 @@
 #ifndef LIB_VULKAN_WINDOW_WINDOW_INFO
 #define LIB_VULKAN_WINDOW_WINDOW_INFO
 
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <vector>
 
 #include "GLFW/glfw3.h"
 #include <vulkan/vulkan_core.h>
 
+#include "rendering/render_path.hpp"
+
 namespace vulkan {
 struct WindowInfo {
   static constexpr int defaultWidth = 800;
@@ -17,12 +21,34 @@ struct WindowInfo {
   std::string title = "Vulkan window";
   int resize = GLFW_FALSE;
 
+  // Record, submit and present this window from its own thread
+  bool renderThread = false;
+  VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+  VkClearColorValue clearColor = {.float32 = {0.0F, 0.0F, 0.0F, 1.0F}};
+  // Continuous capture of the render thread output, *.y4m for one stream, other paths for numbered PPM files, empty disables it
+  std::filesystem::path capture;
+  // Directory of the persistent pipeline cache, one file per physical device, empty keeps it in memory
+  std::filesystem::path pipelineCache = "pipeline_cache";
+  RenderPath renderPath = RenderPath::automatic;
+  // Render passes begun per frame, the first clears and the rest load, to compare the cost of both paths
+  uint32_t passes = 1;
+  // Submits a compute job per frame to the async compute queue, overlapping with the rendering of the next frame
+  bool asyncCompute = false;
+  // Stand-in draws recorded per frame into secondaries on TBB workers, 0 records the clear pass inline
+  uint32_t draws = 0;
+  // Workers recording draws, 0 uses every hardware thread
+  uint32_t recordThreads = 0;
+  // Draws a triangle from the embedded shaders in a pass of its own, skipped until its pipeline compile is usable
+  bool triangle = false;
+  // Development mode: recompiles edited shaders from the source tree and swaps the affected pipelines in
+  bool hotReload = false;
+
   std::vector<std::string> layers = {
 #ifdef DEBUG
       "VK_LAYER_KHRONOS_validation"
 #endif
   };
-  std::vector<std::string> extensions;
+  std::vector<std::string> extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 };
 }  // namespace vulkan
 
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "compress/checksum.hpp"
+#include "container/archive.hpp"
+#include "container/format.hpp"
+#include "container/packer.hpp"
+#include "cook/cook.hpp"
+#include "core/image.hpp"
+#include "core/mesh.hpp"
+#include "format/string.hpp"
+#include "format/table.hpp"
+#include "io/obj.hpp"
+#include "io/pnm.hpp"
+#include "process/process.hpp"
+#include "quantize/quantize.hpp"
+
+// Offline packer: OBJ meshes go through the import pipeline of lib/mesh, PPM/PAM images are cooked by lib/texture,
+// .spv files are stored as shaders and anything else as a blob. The written container is opened again and every
+// chunk checked before the tool reports it.
+// assetpack [--lz4] [--align <bytes>] [--format bc1|bc3|bc4|bc5|bc7] <out.pack> <input>... | assetpack --list <file.pack>
+
+struct ChunkReport {
+  std::string name;
+  assets::ChunkType type;
+  assets::Compression compression;
+  uint64_t rawSize;
+  uint64_t storedSize;
+  bool verified;
+};
+
+static std::string_view typeName(assets::ChunkType type)
+{
+  switch (type) {
+  case assets::ChunkType::mesh: return "mesh";
+  case assets::ChunkType::texture: return "texture";
+  case assets::ChunkType::shader: return "shader";
+  case assets::ChunkType::blob: return "blob";
+  }
+  return "unknown";
+}
+
+static std::vector<std::byte> readFile(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to open {}", path.string()));
+  }
+  const std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+  std::vector<std::byte> data(bytes.size());
+  std::memcpy(data.data(), bytes.data(), bytes.size());
+  return data;
+}
+
+static texture::BlockFormat parseFormat(std::string_view text)
+{
+  static constexpr std::array<std::pair<std::string_view, texture::BlockFormat>, 5> formats = {{
+      {"bc1", texture::BlockFormat::bc1},
+      {"bc3", texture::BlockFormat::bc3},
+      {"bc4", texture::BlockFormat::bc4},
+      {"bc5", texture::BlockFormat::bc5},
+      {"bc7", texture::BlockFormat::bc7},
+  }};
+  const auto* found = std::ranges::find(formats, text, &std::pair<std::string_view, texture::BlockFormat>::first);
+  if (found == formats.end()) {
+    throw std::runtime_error(std::format("Unknown block format {}", text));
+  }
+  return found->second;
+}
+
+static void addMeshes(assets::Packer& packer, const std::vector<std::filesystem::path>& paths)
+{
+  std::vector<mesh::Mesh> meshes;
+  for (const std::filesystem::path& path : paths) {
+    meshes.push_back(mesh::loadObj(path));
+  }
+  for (const mesh::ProcessedMesh& processed : mesh::process(std::move(meshes)).meshes) {
+    const mesh::QuantizedMesh& quantized = processed.quantized;
+    packer.addMesh(std::format("mesh/{}", quantized.name),
+                   {
+                       .vertexCount = 0,
+                       .vertexStride = sizeof(mesh::QuantizedVertex),
+                       .indexCount = 0,
+                       .indexOffset = 0,
+                       .positionOffset = quantized.positionOffset,
+                       .positionScale = quantized.positionScale,
+                       .uvOffset = quantized.uvOffset,
+                       .uvScale = quantized.uvScale,
+                   },
+                   std::as_bytes(std::span(quantized.vertices)), quantized.indices);
+  }
+}
+
+static void addTexture(assets::Packer& packer, const std::filesystem::path& path, texture::BlockFormat format)
+{
+  const texture::CookedTexture cooked = texture::cook(texture::loadImage(path), {.format = format, .srgb = true, .mips = true});
+  std::vector<assets::MipRegion> levels;
+  for (const texture::MipLevel& level : cooked.levels) {
+    levels.push_back({.width = level.width, .height = level.height, .offset = level.offset, .size = level.size});
+  }
+  packer.addTexture(std::format("texture/{}", path.stem().string()), texture::vkFormat(cooked.format, cooked.srgb), levels, cooked.data);
+}
+
+static void addShader(assets::Packer& packer, const std::filesystem::path& path)
+{
+  const std::vector<std::byte> bytes = readFile(path);
+  if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+    throw std::runtime_error(std::format("{} is not SPIR-V", path.string()));
+  }
+  std::vector<uint32_t> code(bytes.size() / sizeof(uint32_t));
+  std::memcpy(code.data(), bytes.data(), bytes.size());
+  packer.addShader(std::format("shader/{}", path.stem().string()), code);
+}
+
+static std::vector<ChunkReport> list(const std::filesystem::path& path)
+{
+  const assets::Archive archive(path);
+  std::vector<ChunkReport> reports;
+  for (uint32_t index = 0; index < archive.getChunkCount(); ++index) {
+    const assets::ChunkEntry entry = archive.getChunk(index);
+    reports.push_back({
+        .name = std::string(archive.getName(entry)),
+        .type = entry.type,
+        .compression = entry.compression,
+        .rawSize = entry.rawSize,
+        .storedSize = entry.size,
+        .verified = archive.verify(entry),
+    });
+  }
+  return reports;
+}
+
+static void report(const std::filesystem::path& path, const std::vector<ChunkReport>& chunks)
+{
+  static constexpr auto kb = [](uint64_t bytes) { return utils::number(bytes / 1024); };
+  // clang-format off
+  utils::table<ChunkReport>(std::format("Asset container {}", path.filename().string()), chunks, std::vector<utils::TableColumn<ChunkReport>>{{
+    {.title = "Chunk", .align = utils::Align::left, .toString = [](const ChunkReport& ele) { return ele.name; }},
+    {.title = "Type", .align = utils::Align::left, .toString = [](const ChunkReport& ele) { return std::string(typeName(ele.type)); }},
+    {.title = "Compression", .align = utils::Align::left, .toString = [](const ChunkReport& ele) { return std::string(ele.compression == assets::Compression::lz4 ? "lz4" : "none"); }},
+    {.title = "Raw [KB]", .toString = [](const ChunkReport& ele) { return kb(ele.rawSize); }},
+    {.title = "Stored [KB]", .toString = [](const ChunkReport& ele) { return kb(ele.storedSize); }},
+    {.title = "Checksum", .align = utils::Align::left, .toString = [](const ChunkReport& ele) { return std::string(ele.verified ? "ok" : "CORRUPTED"); }},
+  }});
+  // clang-format on
+
+  uint64_t raw = 0;
+  uint64_t stored = 0;
+  uint32_t corrupted = 0;
+  for (const ChunkReport& chunk : chunks) {
+    raw += chunk.rawSize;
+    stored += chunk.storedSize;
+    corrupted += chunk.verified ? 0U : 1U;
+  }
+  std::cout << std::format("{}: {} chunks, {} of {} bytes stored, {} corrupted\n", path.string(), chunks.size(), stored, raw, corrupted);
+  if (corrupted != 0) {
+    throw std::runtime_error(std::format("{} has {} corrupted chunks", path.string(), corrupted));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  try {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() == 2 && args[0] == "--list") {
+      report(args[1], list(args[1]));
+      return EXIT_SUCCESS;
+    }
+
+    assets::PackOptions options;
+    texture::BlockFormat format = texture::BlockFormat::bc7;
+    size_t next = 0;
+    for (; next < args.size() && args[next].starts_with("--"); ++next) {
+      if (args[next] == "--lz4") {
+        options.lz4 = true;
+      }
+      else if (args[next] == "--align" && next + 1 < args.size()) {
+        const std::string& text = args[++next];
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), options.alignment);
+        if (error != std::errc() || end != text.data() + text.size()) {
+          throw std::runtime_error(std::format("Invalid alignment {}", text));
+        }
+      }
+      else if (args[next] == "--format" && next + 1 < args.size()) {
+        format = parseFormat(args[++next]);
+      }
+      else {
+        throw std::runtime_error(std::format("Unknown option {}", args[next]));
+      }
+    }
+    if (args.size() - next < 2) {
+      std::cerr << "usage: assetpack [--lz4] [--align <bytes>] [--format bc1|bc3|bc4|bc5|bc7] <out.pack> <input>... | "
+                   "assetpack --list <file.pack>\n";
+      return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    assets::Packer packer(options);
+    std::vector<std::filesystem::path> meshes;
+    for (size_t index = next + 1; index < args.size(); ++index) {
+      const std::filesystem::path path = args[index];
+      const std::string extension = path.extension().string();
+      if (extension == ".obj") {
+        meshes.push_back(path);
+      }
+      else if (extension == ".ppm" || extension == ".pam") {
+        addTexture(packer, path, format);
+      }
+      else if (extension == ".spv") {
+        addShader(packer, path);
+      }
+      else {
+        packer.addBlob(std::format("blob/{}", path.filename().string()), readFile(path));
+      }
+    }
+    addMeshes(packer, meshes);
+    const assets::PackStats stats = packer.write(args[next]);
+    std::cout << std::format("Packed {} chunks ({} compressed) in {:.1f} ms, {} bytes\n", stats.chunks, stats.compressed,
+                             std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), stats.fileSize);
+    report(args[next], list(args[next]));
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
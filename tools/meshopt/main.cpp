@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <chrono>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <numbers>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/mesh.hpp"
+#include "core/simd.hpp"
+#include "format/string.hpp"
+#include "format/table.hpp"
+#include "io/obj.hpp"
+#include "lod/select.hpp"
+#include "process/process.hpp"
+
+// Offline mesh tool: runs the import time pipeline of lib/mesh over OBJ files, or over a generated set of spheres
+// in exporter order, and reports triangles per second and bytes saved of every step. Then flies a camera over a field
+// of instances of the meshes and reports the triangles LOD selection submits per frame.
+// meshopt <mesh.obj>... | meshopt --sample <meshes>
+
+using Vec3 = std::array<float, 3>;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr uint32_t fieldSize = 128;
+static constexpr uint32_t frames = 240;
+// 1080p at a vertical field of view of 60 degrees
+static constexpr float projection = 1080.0F / (2.0F * 0.57735F);
+
+struct LodRow {
+  float threshold;
+  float hysteresis;
+  uint64_t instances;
+  // Averages over the frames
+  double fullTriangles;
+  double lodTriangles;
+  double switches;
+  double selectMs;
+};
+
+// UV sphere with its vertices and triangles shuffled, about what an exporter that ignores the GPU caches writes
+static mesh::Mesh sphere(uint32_t rings, std::mt19937& random)
+{
+  const uint32_t segments = rings * 2;
+  mesh::Mesh result{.name = std::format("sphere {}", rings), .vertices = {}, .indices = {}};
+  for (uint32_t ring = 0; ring <= rings; ++ring) {
+    const float theta = std::numbers::pi_v<float> * static_cast<float>(ring) / static_cast<float>(rings);
+    for (uint32_t segment = 0; segment <= segments; ++segment) {
+      const float phi = 2.0F * std::numbers::pi_v<float> * static_cast<float>(segment) / static_cast<float>(segments);
+      const Vec3 normal = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+      result.vertices.push_back({.position = normal,
+                                 .normal = normal,
+                                 .uv = {static_cast<float>(segment) / static_cast<float>(segments),
+                                        static_cast<float>(ring) / static_cast<float>(rings)}});
+    }
+  }
+  for (uint32_t ring = 0; ring < rings; ++ring) {
+    for (uint32_t segment = 0; segment < segments; ++segment) {
+      const uint32_t corner = (ring * (segments + 1)) + segment;
+      result.indices.insert(result.indices.end(),
+                            {corner, corner + 1, corner + segments + 1, corner + 1, corner + segments + 2, corner + segments + 1});
+    }
+  }
+
+  std::vector<uint32_t> order(result.vertices.size());
+  std::iota(order.begin(), order.end(), 0U);
+  std::ranges::shuffle(order, random);
+  std::vector<mesh::Vertex> vertices(result.vertices.size());
+  for (size_t vertex = 0; vertex < order.size(); ++vertex) {
+    vertices[order[vertex]] = result.vertices[vertex];
+  }
+  result.vertices = std::move(vertices);
+
+  std::vector<uint32_t> triangles(result.indices.size() / 3);
+  std::iota(triangles.begin(), triangles.end(), 0U);
+  std::ranges::shuffle(triangles, random);
+  std::vector<uint32_t> indices;
+  indices.reserve(result.indices.size());
+  for (const uint32_t triangle : triangles) {
+    for (size_t corner = 0; corner < 3; ++corner) {
+      indices.push_back(order[result.indices[(static_cast<size_t>(triangle) * 3) + corner]]);
+    }
+  }
+  result.indices = std::move(indices);
+  return result;
+}
+
+static std::vector<mesh::Mesh> sample(uint32_t count)
+{
+  std::mt19937 random(46);
+  std::vector<mesh::Mesh> meshes;
+  for (uint32_t i = 0; i < count; ++i) {
+    meshes.push_back(sphere(16 + ((i % 8) * 16), random));
+  }
+  return meshes;
+}
+
+static void report(const mesh::ProcessResult& result)
+{
+  static constexpr auto kb = [](uint64_t bytes) { return utils::number(bytes / 1024); };
+  // clang-format off
+  utils::table<mesh::StepReport>(std::format("Mesh processing, {} float lanes", mesh::simd::width()), result.steps, std::vector<utils::TableColumn<mesh::StepReport>>{{
+    {.title = "Step", .align = utils::Align::left, .toString = [](const mesh::StepReport& ele) { return ele.step; }},
+    {.title = "Meshes", .toString = [](const mesh::StepReport& ele) { return utils::number(ele.meshes); }},
+    {.title = "Triangles", .toString = [](const mesh::StepReport& ele) { return utils::number(ele.triangles); }},
+    {.title = "[ms]", .toString = [](const mesh::StepReport& ele) { return std::format("{:.3f}", ele.seconds * 1'000.0); }},
+    {.title = "Mtriangles/s", .toString = [](const mesh::StepReport& ele) { return std::format("{:.2f}", ele.seconds > 0.0 ? static_cast<double>(ele.triangles) / ele.seconds / 1'000'000.0 : 0.0); }},
+    {.title = "Measure", .align = utils::Align::left, .toString = [](const mesh::StepReport& ele) { return ele.measure; }},
+    {.title = "Before [KB]", .toString = [](const mesh::StepReport& ele) { return kb(ele.bytesBefore); }},
+    {.title = "After [KB]", .toString = [](const mesh::StepReport& ele) { return kb(ele.bytesAfter); }},
+    {.title = "Saved [%]", .toString = [](const mesh::StepReport& ele) { return std::format("{:.1f}", ele.bytesBefore > 0 ? 100.0 * (static_cast<double>(ele.bytesBefore) - static_cast<double>(ele.bytesAfter)) / static_cast<double>(ele.bytesBefore) : 0.0); }},
+  }});
+  // clang-format on
+
+  for (const mesh::StepReport& step : result.steps) {
+    std::cout << std::format("{}: {:.2f} Mtriangles/s, {} saved {} of {} bytes\n", step.step,
+                             step.seconds > 0.0 ? static_cast<double>(step.triangles) / step.seconds / 1'000'000.0 : 0.0, step.measure,
+                             static_cast<int64_t>(step.bytesBefore) - static_cast<int64_t>(step.bytesAfter), step.bytesBefore);
+  }
+}
+
+// Grid of instances spaced 3 bounding spheres apart, the camera moves over its first quarter along z and sways back and
+// forth more than it moves every frame, which is what makes instances at the edge of two levels switch without hysteresis
+static LodRow flythrough(const mesh::ProcessResult& result, float threshold, float hysteresis)
+{
+  std::vector<mesh::LodErrors> errors;
+  float radius = 0.0F;
+  for (const mesh::ProcessedMesh& processed : result.meshes) {
+    errors.push_back(mesh::lodErrors(processed.lods));
+    radius = std::max(radius, processed.lods.radius);
+  }
+  const float spacing = 3.0F * std::max(radius, 0.001F);
+
+  mesh::LodInstances instances;
+  for (uint32_t row = 0; row < fieldSize; ++row) {
+    for (uint32_t column = 0; column < fieldSize; ++column) {
+      const auto meshIndex = static_cast<uint32_t>(instances.x.size() % result.meshes.size());
+      const mesh::Lods& lods = result.meshes[meshIndex].lods;
+      instances.x.push_back((static_cast<float>(column) * spacing) + lods.center[0]);
+      instances.y.push_back(lods.center[1]);
+      instances.z.push_back((static_cast<float>(row) * spacing) + lods.center[2]);
+      instances.radius.push_back(lods.radius);
+      instances.mesh.push_back(meshIndex);
+      instances.level.push_back(0);
+    }
+  }
+
+  LodRow row{.threshold = threshold, .hysteresis = hysteresis, .instances = instances.x.size(), .fullTriangles = 0.0, .lodTriangles = 0.0,
+             .switches = 0.0, .selectMs = 0.0};
+  const float depth = static_cast<float>(fieldSize) * spacing;
+  const auto camera = [&](uint32_t frame) {
+    const float travel = depth * 0.25F * static_cast<float>(frame) / static_cast<float>(frames);
+    return mesh::LodCamera{
+        .position = {depth * 0.5F, spacing, travel - (spacing * 4.0F) + (std::sin(static_cast<float>(frame) * 1.3F) * spacing * 0.25F)},
+        .projection = projection,
+        .threshold = threshold,
+        .hysteresis = hysteresis,
+    };
+  };
+  // Every instance starts at the full mesh, the first selection is not a switch anyone would see
+  static_cast<void>(mesh::selectLods(camera(0), errors, instances));
+  for (uint32_t frame = 0; frame < frames; ++frame) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t switches = mesh::selectLods(camera(frame), errors, instances);
+    row.selectMs += Milliseconds(std::chrono::steady_clock::now() - start).count();
+    row.switches += static_cast<double>(switches);
+    for (size_t instance = 0; instance < instances.x.size(); ++instance) {
+      const mesh::Lods& lods = result.meshes[instances.mesh[instance]].lods;
+      row.fullTriangles += static_cast<double>(lods.levels.front().indices.size() / 3);
+      row.lodTriangles += static_cast<double>(lods.levels[instances.level[instance]].indices.size() / 3);
+    }
+  }
+  row.fullTriangles /= frames;
+  row.lodTriangles /= frames;
+  row.switches /= frames;
+  row.selectMs /= frames;
+  return row;
+}
+
+static void reportLod(const mesh::ProcessResult& result)
+{
+  static constexpr std::array<std::pair<float, float>, 4> configs = {{{1.0F, 0.0F}, {1.0F, 0.25F}, {2.0F, 0.25F}, {4.0F, 0.25F}}};
+  std::vector<LodRow> rows;
+  for (const auto& [threshold, hysteresis] : configs) {
+    rows.push_back(flythrough(result, threshold, hysteresis));
+  }
+
+  // clang-format off
+  utils::table<LodRow>(std::format("LOD selection, {} frames", frames), rows, std::vector<utils::TableColumn<LodRow>>{{
+    {.title = "Threshold [px]", .toString = [](const LodRow& ele) { return std::format("{:.1f}", ele.threshold); }},
+    {.title = "Hysteresis", .toString = [](const LodRow& ele) { return std::format("{:.2f}", ele.hysteresis); }},
+    {.title = "Instances", .toString = [](const LodRow& ele) { return utils::number(ele.instances); }},
+    {.title = "Triangles/frame full", .toString = [](const LodRow& ele) { return utils::number(static_cast<uint64_t>(ele.fullTriangles)); }},
+    {.title = "Triangles/frame LOD", .toString = [](const LodRow& ele) { return utils::number(static_cast<uint64_t>(ele.lodTriangles)); }},
+    {.title = "Saved [%]", .toString = [](const LodRow& ele) { return std::format("{:.1f}", ele.fullTriangles > 0.0 ? 100.0 * (ele.fullTriangles - ele.lodTriangles) / ele.fullTriangles : 0.0); }},
+    {.title = "Switches/frame", .toString = [](const LodRow& ele) { return std::format("{:.1f}", ele.switches); }},
+    {.title = "Select [ms]", .toString = [](const LodRow& ele) { return std::format("{:.3f}", ele.selectMs); }},
+    {.title = "Minstances/s", .toString = [](const LodRow& ele) { return std::format("{:.1f}", ele.selectMs > 0.0 ? static_cast<double>(ele.instances) / ele.selectMs / 1'000.0 : 0.0); }},
+  }});
+  // clang-format on
+
+  for (const LodRow& row : rows) {
+    std::cout << std::format("lod {:.1f}px hysteresis {:.2f}: {:.0f} of {:.0f} triangles per frame, {:.1f} switches per frame\n", row.threshold,
+                             row.hysteresis, row.lodTriangles, row.fullTriangles, row.switches);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  try {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty() || (args[0] == "--sample" && args.size() != 2)) {
+      std::cerr << "usage: meshopt <mesh.obj>... | meshopt --sample <meshes>\n";
+      return EXIT_FAILURE;
+    }
+
+    std::vector<mesh::Mesh> meshes;
+    if (args[0] == "--sample") {
+      uint32_t count = 0;
+      const auto [end, error] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), count);
+      if (error != std::errc() || end != args[1].data() + args[1].size() || count == 0) {
+        throw std::runtime_error(std::format("Invalid mesh count {}", args[1]));
+      }
+      meshes = sample(count);
+    }
+    else {
+      for (const std::string& path : args) {
+        meshes.push_back(mesh::loadObj(path));
+      }
+    }
+    const mesh::ProcessResult result = mesh::process(std::move(meshes));
+    report(result);
+    reportLod(result);
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
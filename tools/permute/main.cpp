@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <vulkan/vulkan_core.h>
+
+#include "hash/hash.hpp"
+#include "process/spawn.hpp"
+#include "shader/reflection.hpp"
+#include "shader/specialization.hpp"
+
+// Offline permutation tool: freezes the shader variants listed in a manifest into their own SPIR-V, spirv-opt folds
+// the constants and strips the dead branches. Variants run in parallel, equal outputs are written once.
+// permute <spirv-opt> <manifest> <output header> <shader name>=<spv>...
+
+struct Variant {
+  std::string name;
+  std::string line;
+  uint64_t source = 0;
+  uint64_t key = 0;
+  // --set-spec-const-default-value argument, "<id>:<value> ..."
+  std::string values;
+  std::vector<uint32_t> code = {};
+};
+
+static std::vector<uint32_t> readSpirv(const std::filesystem::path& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  const std::vector<char> bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+  if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0) {
+    throw std::runtime_error(std::format("{} is not a SPIR-V binary", path.string()));
+  }
+  std::vector<uint32_t> code(bytes.size() / sizeof(uint32_t));
+  std::memcpy(code.data(), bytes.data(), bytes.size());
+  return code;
+}
+
+template <typename T>
+static T parseNumber(std::string_view text, std::string_view line)
+{
+  T value{};
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size()) {
+    throw std::runtime_error(std::format("Invalid value {} in \"{}\"", text, line));
+  }
+  return value;
+}
+
+// Value bytes as VkSpecializationInfo carries them, booleans are VkBool32
+static void encode(const vulkan::SpecConstantInfo& info, std::string_view text, std::string_view line, std::vector<std::byte>& data)
+{
+  const auto append = [&data](const auto value) {
+    const auto bytes = std::as_bytes(std::span(&value, 1));
+    data.insert(data.end(), bytes.begin(), bytes.end());
+  };
+  switch (info.kind) {
+  case vulkan::ScalarKind::boolean:
+    if (text != "true" && text != "false") {
+      throw std::runtime_error(std::format("Constant {} is a bool, \"{}\"", info.id, line));
+    }
+    append(VkBool32{text == "true" ? VK_TRUE : VK_FALSE});
+    return;
+  case vulkan::ScalarKind::signedInt: append(parseNumber<int32_t>(text, line)); return;
+  case vulkan::ScalarKind::unsignedInt: append(parseNumber<uint32_t>(text, line)); return;
+  case vulkan::ScalarKind::floating: append(parseNumber<float>(text, line)); return;
+  }
+}
+
+static Variant parseVariant(const std::string& line, const std::unordered_map<std::string, std::vector<uint32_t>>& inputs)
+{
+  std::istringstream stream(line);
+  Variant variant{.name = {}, .line = line, .source = 0, .key = 0, .values = {}};
+  stream >> variant.name;
+  const auto input = inputs.find(variant.name);
+  if (input == inputs.end()) {
+    throw std::runtime_error(std::format("Unknown shader in \"{}\"", line));
+  }
+  variant.source = utils::fnv1a(std::as_bytes(std::span(input->second)));
+  const vulkan::ShaderReflection reflection = vulkan::reflect(input->second);
+
+  std::vector<VkSpecializationMapEntry> entries;
+  std::vector<std::byte> data;
+  for (std::string assignment; stream >> assignment;) {
+    const size_t equal = assignment.find('=');
+    if (equal == std::string::npos) {
+      throw std::runtime_error(std::format("Expected <id>=<value> in \"{}\"", line));
+    }
+    const auto id = parseNumber<uint32_t>(std::string_view(assignment).substr(0, equal), line);
+    const auto info = std::ranges::find(reflection.specConstants, id, &vulkan::SpecConstantInfo::id);
+    if (info == reflection.specConstants.end()) {
+      throw std::runtime_error(std::format("{} has no specialization constant {}", variant.name, id));
+    }
+    const auto value = std::string_view(assignment).substr(equal + 1);
+    entries.push_back({.constantID = id, .offset = static_cast<uint32_t>(data.size()), .size = info->size});
+    encode(*info, value, line, data);
+    variant.values += std::format("{}{}:{}", variant.values.empty() ? "" : " ", id, value);
+  }
+  // The renderer always passes every constant, a partial list would never match its key
+  if (entries.size() != reflection.specConstants.size()) {
+    throw std::runtime_error(std::format("\"{}\" has to set all {} constants", line, reflection.specConstants.size()));
+  }
+  variant.key = vulkan::specializationKey({.entries = entries, .data = data});
+  return variant;
+}
+
+static std::string words(std::span<const uint32_t> code)
+{
+  std::string result;
+  for (size_t i = 0; i < code.size(); ++i) {
+    result += std::format("{}{:#010x},", i % 8 == 0 ? "\n    " : " ", code[i]);
+  }
+  return result;
+}
+
+static void writeHeader(const std::filesystem::path& output, const std::vector<Variant>& variants)
+{
+  // Variants freezing to the same code share one array
+  std::map<uint64_t, size_t> unique;
+  std::vector<size_t> arrays(variants.size());
+  std::string content = R"(// Generated from variants.txt at build time, do not edit
+#ifndef LIB_VULKAN_SHADERS_VARIANTS
+#define LIB_VULKAN_SHADERS_VARIANTS
+
+#include <array>
+#include <cstdint>
+
+#include "shader/embedded_shader.hpp"
+
+namespace vulkan::shaders {
+)";
+  for (size_t i = 0; i < variants.size(); ++i) {
+    const auto [found, added] = unique.try_emplace(utils::fnv1a(std::as_bytes(std::span(variants[i].code))), unique.size());
+    arrays[i] = found->second;
+    if (added) {
+      content += std::format("inline constexpr std::array<uint32_t, {}> variant{} = {{{}\n}};\n", variants[i].code.size(),
+                             found->second, words(variants[i].code));
+    }
+  }
+  content += std::format("\ninline constexpr std::array<EmbeddedVariant, {}> variants{{{{\n", variants.size());
+  for (size_t i = 0; i < variants.size(); ++i) {
+    content += std::format("    {{.name = \"{}\", .source = {:#x}ULL, .key = {:#x}ULL, .code = variant{}}},\n", variants[i].name,
+                           variants[i].source, variants[i].key, arrays[i]);
+  }
+  content += "}};\n}  // namespace vulkan::shaders\n\n#endif /* LIB_VULKAN_SHADERS_VARIANTS */\n";
+
+  std::ofstream stream(output, std::ios::binary);
+  stream << content;
+  if (!stream) {
+    throw std::runtime_error(std::format("Failed to write {}", output.string()));
+  }
+  std::cout << std::format("shader variants: {} frozen, {} unique\n", variants.size(), unique.size());
+}
+
+// Intermediate SPIR-V goes next to the generated header, the build directory is private to this run
+static void freeze(const std::string& optimizer, Variant& variant, const std::filesystem::path& input, const std::filesystem::path& output)
+{
+  const std::vector<std::string> args = {optimizer, "--set-spec-const-default-value", variant.values, "--freeze-spec-const", "-O",
+                                         input.string(), "-o", output.string()};
+  const int status = utils::run(args);
+  if (status != 0) {
+    throw std::runtime_error(std::format("spirv-opt failed on \"{}\"", variant.line));
+  }
+  variant.code = readSpirv(output);
+  std::error_code ignored;
+  std::filesystem::remove(output, ignored);
+}
+
+int main(int argc, char** argv)
+{
+  try {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() < 3) {
+      std::cerr << "usage: permute <spirv-opt> <manifest> <output header> <shader name>=<spv>...\n";
+      return EXIT_FAILURE;
+    }
+
+    std::unordered_map<std::string, std::vector<uint32_t>> inputs;
+    std::unordered_map<std::string, std::filesystem::path> paths;
+    for (const std::string& arg : std::span(args).subspan(3)) {
+      const size_t equal = arg.find('=');
+      if (equal == std::string::npos) {
+        throw std::runtime_error(std::format("Expected <shader name>=<spv>, got {}", arg));
+      }
+      paths[arg.substr(0, equal)] = arg.substr(equal + 1);
+      inputs[arg.substr(0, equal)] = readSpirv(arg.substr(equal + 1));
+    }
+
+    std::vector<Variant> variants;
+    std::ifstream manifest(args[1]);
+    if (!manifest) {
+      throw std::runtime_error(std::format("Failed to open {}", args[1]));
+    }
+    for (std::string line; std::getline(manifest, line);) {
+      if (line.empty() || line.starts_with('#') || line.find_first_not_of(" \t\r") == std::string::npos) {
+        continue;
+      }
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      variants.push_back(parseVariant(line, inputs));
+    }
+    // Lines asking for the same constants twice are frozen once
+    std::ranges::sort(variants, {}, [](const Variant& variant) { return std::pair(variant.name, variant.key); });
+    const auto [first, last] = std::ranges::unique(variants, {}, [](const Variant& variant) { return std::pair(variant.name, variant.key); });
+    variants.erase(first, last);
+
+    std::atomic<bool> failed = false;
+    tbb::parallel_for(size_t{0}, variants.size(), [&](size_t i) {
+      try {
+        const std::filesystem::path output = std::filesystem::path(args[2]).parent_path() / std::format("variant_{}.spv", i);
+        freeze(args[0], variants[i], paths.at(variants[i].name), output);
+      }
+      catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        failed = true;
+      }
+    });
+    if (failed) {
+      return EXIT_FAILURE;
+    }
+    writeHeader(args[2], variants);
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
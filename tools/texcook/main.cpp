@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cook/cook.hpp"
+#include "cook/mips.hpp"
+#include "core/image.hpp"
+#include "format/string.hpp"
+#include "format/table.hpp"
+#include "io/pnm.hpp"
+
+// Offline texture tool: generates the mip chain of every image, encodes it with each BCn format of lib/texture and
+// reports megapixels per second, PSNR of level 0 and the size against RGBA8.
+// texcook <image.ppm|image.pam>... | texcook --sample <size>
+
+struct FormatReport {
+  std::string image;
+  texture::BlockFormat format;
+  uint64_t pixels;
+  double mipSeconds;
+  double encodeSeconds;
+  double psnr;
+  uint64_t rgbaBytes;
+  uint64_t cookedBytes;
+};
+
+static constexpr std::array formats = {texture::BlockFormat::bc1, texture::BlockFormat::bc3, texture::BlockFormat::bc4,
+                                       texture::BlockFormat::bc5, texture::BlockFormat::bc7};
+
+static uint32_t parseSize(const std::string& text)
+{
+  uint32_t value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size() || value == 0) {
+    throw std::runtime_error(std::format("Invalid size {}", text));
+  }
+  return value;
+}
+
+// Smooth gradients, hard edged shapes and noise in color, a radial alpha. Roughly what albedo and mask textures mix
+static texture::Image sample(uint32_t size)
+{
+  std::mt19937 random(47);
+  std::uniform_int_distribution<int> noise(-12, 12);
+  texture::Image image{.width = size, .height = size, .rgba = std::vector<uint8_t>(size_t{size} * size * 4)};
+  const float scale = 1.0F / static_cast<float>(size);
+  const auto toByte = [](float value) { return static_cast<uint8_t>(std::clamp(value, 0.0F, 255.0F)); };
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      const float u = static_cast<float>(x) * scale;
+      const float v = static_cast<float>(y) * scale;
+      const bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+      const bool circle = ((u - 0.5F) * (u - 0.5F)) + ((v - 0.5F) * (v - 0.5F)) < 0.09F;
+      const float grain = static_cast<float>(noise(random));
+      const size_t texel = ((size_t{y} * size) + x) * 4;
+      image.rgba[texel] = toByte((circle ? 230.0F : 255.0F * u) + grain);
+      image.rgba[texel + 1] = toByte((checker ? 200.0F : 60.0F) * v + grain);
+      image.rgba[texel + 2] = toByte((circle ? 40.0F : 128.0F + (127.0F * std::sin(u * 12.0F))) + grain);
+      image.rgba[texel + 3] = toByte(255.0F * (1.0F - std::min(1.0F, 2.0F * std::hypot(u - 0.5F, v - 0.5F))));
+    }
+  }
+  return image;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void cookImage(const std::string& name, const texture::Image& image, std::vector<FormatReport>& reports)
+{
+  for (const texture::BlockFormat format : formats) {
+    const bool srgb = format != texture::BlockFormat::bc4 && format != texture::BlockFormat::bc5;
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<texture::Image> levels = texture::generateMips(image, srgb);
+    const double mipSeconds = seconds(start);
+
+    start = std::chrono::steady_clock::now();
+    const texture::CookedTexture cooked = texture::encode(levels, format, srgb);
+    const double encodeSeconds = seconds(start);
+
+    FormatReport& report = reports.emplace_back(FormatReport{.image = name,
+                                                             .format = format,
+                                                             .pixels = 0,
+                                                             .mipSeconds = mipSeconds,
+                                                             .encodeSeconds = encodeSeconds,
+                                                             .psnr = texture::psnr(image, texture::decode(cooked, 0), texture::channelCount(format)),
+                                                             .rgbaBytes = 0,
+                                                             .cookedBytes = cooked.data.size()});
+    for (const texture::Image& level : levels) {
+      report.pixels += uint64_t{level.width} * level.height;
+      report.rgbaBytes += level.rgba.size();
+    }
+  }
+}
+
+static void report(const std::vector<FormatReport>& reports)
+{
+  static constexpr auto mpix = [](const FormatReport& ele) {
+    return ele.encodeSeconds > 0.0 ? static_cast<double>(ele.pixels) / ele.encodeSeconds / 1'000'000.0 : 0.0;
+  };
+  // clang-format off
+  utils::table<FormatReport>("Texture cooking", reports, std::vector<utils::TableColumn<FormatReport>>{{
+    {.title = "Image", .align = utils::Align::left, .toString = [](const FormatReport& ele) { return ele.image; }},
+    {.title = "Format", .align = utils::Align::left, .toString = [](const FormatReport& ele) { return std::string(texture::formatName(ele.format)); }},
+    {.title = "Pixels", .toString = [](const FormatReport& ele) { return utils::number(ele.pixels); }},
+    {.title = "Mips [ms]", .toString = [](const FormatReport& ele) { return std::format("{:.3f}", ele.mipSeconds * 1'000.0); }},
+    {.title = "Encode [ms]", .toString = [](const FormatReport& ele) { return std::format("{:.3f}", ele.encodeSeconds * 1'000.0); }},
+    {.title = "MPix/s", .toString = [](const FormatReport& ele) { return std::format("{:.2f}", mpix(ele)); }},
+    {.title = "PSNR [dB]", .toString = [](const FormatReport& ele) { return std::format("{:.2f}", ele.psnr); }},
+    {.title = "RGBA8 [KB]", .toString = [](const FormatReport& ele) { return utils::number(ele.rgbaBytes / 1024); }},
+    {.title = "Cooked [KB]", .toString = [](const FormatReport& ele) { return utils::number(ele.cookedBytes / 1024); }},
+  }});
+  // clang-format on
+
+  for (const FormatReport& ele : reports) {
+    std::cout << std::format("{} {}: {:.2f} MPix/s, {:.2f} dB, {} of {} bytes\n", ele.image, texture::formatName(ele.format), mpix(ele),
+                             ele.psnr, ele.cookedBytes, ele.rgbaBytes);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  try {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty() || (args[0] == "--sample" && args.size() != 2)) {
+      std::cerr << "usage: texcook <image.ppm|image.pam>... | texcook --sample <size>\n";
+      return EXIT_FAILURE;
+    }
+
+    std::vector<FormatReport> reports;
+    if (args[0] == "--sample") {
+      cookImage(std::format("sample {}", args[1]), sample(parseSize(args[1])), reports);
+    }
+    else {
+      for (const std::string& path : args) {
+        cookImage(std::filesystem::path(path).filename().string(), texture::loadImage(path), reports);
+      }
+    }
+    report(reports);
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}